@@ -0,0 +1,308 @@
+
+#include "bench.h"
+
+#define NUM_ENTITIES (1024*1024)
+
+FDB_BEGIN_COMPONENT(Position, KILOBYTES(4))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(Velocity, KILOBYTES(4))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(Acceleration, KILOBYTES(4))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+/**
+ * \brief Joins the blocks of two tables the way the generated code does: a
+ * cluster is built for each block of each table, and the clusters with the
+ * same block id are merged with fdb_bcluster_append_cluster
+ */
+static void
+bench_join(fdb_bench_t* bench,
+           uint32_t density)
+{
+  char params[256];
+  snprintf(params, 256, "\"columns\":2,\"density\":%u", density);
+
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* pos_table = FDB_CREATE_TABLE(&database, Position, nullptr);
+  fdb_table_t* vel_table = FDB_CREATE_TABLE(&database, Velocity, nullptr);
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Position* pos = FDB_ADD_COMPONENT(pos_table, Position, i);
+    pos->m_x = pos->m_y = pos->m_z = 0.0f;
+    if(i % 100 < density)
+    {
+      Velocity* vel = FDB_ADD_COMPONENT(vel_table, Velocity, i);
+      vel->m_x = vel->m_y = vel->m_z = 1.0f;
+    }
+  }
+
+  fdb_stack_alloc_t allocator;
+  fdb_stack_alloc_init(&allocator, KILOBYTES(4), fdb_get_global_mem_allocator());
+
+  uint32_t num_iterations = fdb_bench_iterations(20);
+  fdb_bench_timer_t timer;
+  fdb_bench_timer_init(&timer);
+  fdb_bench_timer_start(&timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    fdb_table_iter_t iter;
+    fdb_table_iter_init(&iter, pos_table, 1, 0, 1);
+    while(fdb_table_iter_has_next(&iter))
+    {
+      fdb_table_block_t* pos_block = fdb_table_iter_next(&iter);
+      fdb_table_block_t* vel_block = fdb_table_get_block(vel_table,
+                                                         pos_block->m_start / FDB_TABLE_BLOCK_SIZE);
+      if(vel_block == NULL)
+      {
+        continue;
+      }
+
+      fdb_bcluster_t pos_cluster;
+      fdb_bcluster_init(&pos_cluster, &allocator.m_super);
+      fdb_bcluster_append_block(&pos_cluster, pos_block);
+      fdb_bcluster_t vel_cluster;
+      fdb_bcluster_init(&vel_cluster, &allocator.m_super);
+      fdb_bcluster_append_block(&vel_cluster, vel_block);
+
+      fdb_bcluster_append_cluster(&pos_cluster, &vel_cluster);
+      if(fdb_bcluster_has_elements(&pos_cluster))
+      {
+        Position* pos = (Position*)fdb_bcluster_get_tblock(&pos_cluster, 0)->p_data;
+        const Velocity* vel = (const Velocity*)fdb_bcluster_get_tblock(&pos_cluster, 1)->p_data;
+        for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+        {
+          if(fdb_bitmap_is_set(&pos_cluster.m_enabled, i))
+          {
+            pos[i].m_x += vel[i].m_x;
+            pos[i].m_y += vel[i].m_y;
+            pos[i].m_z += vel[i].m_z;
+          }
+        }
+      }
+      fdb_bcluster_release(&vel_cluster, &allocator.m_super);
+      fdb_bcluster_release(&pos_cluster, &allocator.m_super);
+    }
+    fdb_table_iter_release(&iter);
+  }
+  fdb_bench_timer_stop(&timer);
+  fdb_bench_report(bench, &timer, "join", params, NUM_ENTITIES, num_iterations);
+
+  fdb_stack_alloc_release(&allocator);
+  fdb_database_release(&database);
+}
+
+/**
+ * \brief Joins the blocks of two tables the way the generated merge joins do:
+ * an iterator over the left table is advanced in lockstep with the blocks of
+ * the right table, and the blocks with the same block id are merged
+ */
+static void
+bench_merge_join(fdb_bench_t* bench,
+                 uint32_t density)
+{
+  char params[256];
+  snprintf(params, 256, "\"columns\":2,\"density\":%u", density);
+
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* pos_table = FDB_CREATE_TABLE(&database, Position, nullptr);
+  fdb_table_t* vel_table = FDB_CREATE_TABLE(&database, Velocity, nullptr);
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Position* pos = FDB_ADD_COMPONENT(pos_table, Position, i);
+    pos->m_x = pos->m_y = pos->m_z = 0.0f;
+    if(i % 100 < density)
+    {
+      Velocity* vel = FDB_ADD_COMPONENT(vel_table, Velocity, i);
+      vel->m_x = vel->m_y = vel->m_z = 1.0f;
+    }
+  }
+
+  fdb_stack_alloc_t allocator;
+  fdb_stack_alloc_init(&allocator, KILOBYTES(4), fdb_get_global_mem_allocator());
+
+  uint32_t num_iterations = fdb_bench_iterations(20);
+  fdb_bench_timer_t timer;
+  fdb_bench_timer_init(&timer);
+  fdb_bench_timer_start(&timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    fdb_table_iter_t merge_iter;
+    fdb_table_iter_init(&merge_iter, pos_table, 1, 0, 1);
+    fdb_table_block_t* merge_block = NULL;
+
+    fdb_table_iter_t iter;
+    fdb_table_iter_init(&iter, vel_table, 1, 0, 1);
+    while(fdb_table_iter_has_next(&iter))
+    {
+      fdb_bcluster_t vel_cluster;
+      fdb_bcluster_init(&vel_cluster, &allocator.m_super);
+      fdb_bcluster_append_block(&vel_cluster, fdb_table_iter_next(&iter));
+
+      uint32_t probe = vel_cluster.m_start / FDB_TABLE_BLOCK_SIZE;
+      while((merge_block == NULL || merge_block->m_start / FDB_TABLE_BLOCK_SIZE < probe) && 
+            fdb_table_iter_has_next(&merge_iter))
+      {
+        merge_block = fdb_table_iter_next(&merge_iter);
+      }
+
+      if(merge_block != NULL && merge_block->m_start / FDB_TABLE_BLOCK_SIZE == probe)
+      {
+        fdb_bcluster_t cluster;
+        fdb_bcluster_init(&cluster, &allocator.m_super);
+        fdb_bcluster_append_block(&cluster, merge_block);
+        fdb_bcluster_append_cluster(&cluster, &vel_cluster);
+        if(cluster.m_enabled.m_num_set != 0)
+        {
+          Position* pos = (Position*)fdb_bcluster_get_tblock(&cluster, 0)->p_data;
+          const Velocity* vel = (const Velocity*)fdb_bcluster_get_tblock(&cluster, 1)->p_data;
+          fdb_bitmap_iter_t bit_iter;
+          fdb_bitmap_iter_init(&bit_iter, &cluster.m_enabled);
+          uint32_t i;
+          while(fdb_bitmap_iter_next(&bit_iter, &i))
+          {
+            pos[i].m_x += vel[i].m_x;
+            pos[i].m_y += vel[i].m_y;
+            pos[i].m_z += vel[i].m_z;
+          }
+        }
+        fdb_bcluster_release(&cluster, &allocator.m_super);
+      }
+      fdb_bcluster_release(&vel_cluster, &allocator.m_super);
+    }
+    fdb_table_iter_release(&iter);
+    fdb_table_iter_release(&merge_iter);
+  }
+  fdb_bench_timer_stop(&timer);
+  fdb_bench_report(bench, &timer, "merge_join", params, NUM_ENTITIES, num_iterations);
+
+  fdb_stack_alloc_release(&allocator);
+  fdb_database_release(&database);
+}
+
+/**
+ * \brief Joins the blocks of three tables the way the generated multi joins do:
+ * the blocks of the table with fewest components are streamed, and the blocks
+ * with the same id are looked up in the other tables and intersected at once
+ */
+static void
+bench_multi_join(fdb_bench_t* bench,
+                 uint32_t density)
+{
+  char params[256];
+  snprintf(params, 256, "\"columns\":3,\"density\":%u", density);
+
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* pos_table = FDB_CREATE_TABLE(&database, Position, nullptr);
+  fdb_table_t* vel_table = FDB_CREATE_TABLE(&database, Velocity, nullptr);
+  fdb_table_t* acc_table = FDB_CREATE_TABLE(&database, Acceleration, nullptr);
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Position* pos = FDB_ADD_COMPONENT(pos_table, Position, i);
+    pos->m_x = pos->m_y = pos->m_z = 0.0f;
+    Velocity* vel = FDB_ADD_COMPONENT(vel_table, Velocity, i);
+    vel->m_x = vel->m_y = vel->m_z = 0.0f;
+    if(i % 100 < density)
+    {
+      Acceleration* acc = FDB_ADD_COMPONENT(acc_table, Acceleration, i);
+      acc->m_x = acc->m_y = acc->m_z = 1.0f;
+    }
+  }
+
+  fdb_stack_alloc_t allocator;
+  fdb_stack_alloc_init(&allocator, KILOBYTES(4), fdb_get_global_mem_allocator());
+
+  uint32_t num_iterations = fdb_bench_iterations(20);
+  fdb_bench_timer_t timer;
+  fdb_bench_timer_init(&timer);
+  fdb_bench_timer_start(&timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    fdb_table_t* tables[3] = {pos_table, vel_table, acc_table};
+    uint32_t driver = 0;
+    for(uint32_t i = 1; i < 3; ++i)
+    {
+      if(tables[i]->m_num_components < tables[driver]->m_num_components)
+      {
+        driver = i;
+      }
+    }
+
+    fdb_table_iter_t iter;
+    fdb_table_iter_init(&iter, tables[driver], 1, 0, 1);
+    while(fdb_table_iter_has_next(&iter))
+    {
+      fdb_table_block_t* next = fdb_table_iter_next(&iter);
+      uint32_t block_id = next->m_start / FDB_TABLE_BLOCK_SIZE;
+      fdb_table_block_t* blocks[3];
+      bool found = true;
+      for(uint32_t i = 0; i < 3 && found; ++i)
+      {
+        blocks[i] = i == driver ? next : fdb_table_get_block(tables[i], block_id);
+        found = blocks[i] != NULL;
+      }
+
+      if(found)
+      {
+        fdb_bcluster_t cluster;
+        fdb_bcluster_init(&cluster, &allocator.m_super);
+        fdb_bcluster_append_blocks(&cluster, blocks, 3);
+        if(cluster.m_enabled.m_num_set != 0)
+        {
+          Position* pos = (Position*)fdb_bcluster_get_tblock(&cluster, 0)->p_data;
+          Velocity* vel = (Velocity*)fdb_bcluster_get_tblock(&cluster, 1)->p_data;
+          const Acceleration* acc = (const Acceleration*)fdb_bcluster_get_tblock(&cluster, 2)->p_data;
+          fdb_bitmap_iter_t bit_iter;
+          fdb_bitmap_iter_init(&bit_iter, &cluster.m_enabled);
+          uint32_t i;
+          while(fdb_bitmap_iter_next(&bit_iter, &i))
+          {
+            vel[i].m_x += acc[i].m_x;
+            vel[i].m_y += acc[i].m_y;
+            vel[i].m_z += acc[i].m_z;
+            pos[i].m_x += vel[i].m_x;
+            pos[i].m_y += vel[i].m_y;
+            pos[i].m_z += vel[i].m_z;
+          }
+        }
+        fdb_bcluster_release(&cluster, &allocator.m_super);
+      }
+    }
+    fdb_table_iter_release(&iter);
+  }
+  fdb_bench_timer_stop(&timer);
+  fdb_bench_report(bench, &timer, "multi_join", params, NUM_ENTITIES, num_iterations);
+
+  fdb_stack_alloc_release(&allocator);
+  fdb_database_release(&database);
+}
+
+int main(int argc, char *argv[])
+{
+  fdb_bench_t bench;
+  fdb_bench_init(&bench, "bcluster", argc, argv);
+
+  const uint32_t densities[] = {100, 50, 10};
+  for(uint32_t density : densities)
+  {
+    bench_join(&bench, density);
+    bench_merge_join(&bench, density);
+    bench_multi_join(&bench, density);
+  }
+
+  fdb_bench_release(&bench);
+  return 0;
+}
@@ -0,0 +1,145 @@
+#ifndef _FDB_BENCH_H_
+#define _FDB_BENCH_H_ value
+
+#include "furious.h"
+#include "common/memory/memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * \brief Minimal benchmarking harness shared by the benchmarks. Each
+ * measurement is reported as a JSON line:
+ *
+ * {"suite":"table","bench":"scan","params":{...},"entities":N,"iterations":I,
+ *  "ns_per_entity":X,"allocs_per_iteration":Y}
+ *
+ * Allocations are those served by any runtime allocator, as counted by
+ * fdb_mem_num_allocs.
+ *
+ * Results are written to stdout and, if a path is passed as the first command
+ * line argument, appended to that file, so that runs of different releases can
+ * be compared.
+ */
+typedef struct fdb_bench_t
+{
+  const char*   p_suite;
+  FILE*         p_output;
+} fdb_bench_t;
+
+/**
+ * \brief Accumulates the wall time and the allocations of the measured
+ * sections of a benchmark, delimited by fdb_bench_timer_start/stop
+ */
+typedef struct fdb_bench_timer_t
+{
+  uint64_t      m_start_ns;
+  uint64_t      m_start_allocs;
+  uint64_t      m_elapsed_ns;
+  uint64_t      m_num_allocs;
+} fdb_bench_timer_t;
+
+/**
+ * \brief The number of iterations of each benchmark. Can be overriden through
+ * the FDB_BENCH_ITERATIONS environment variable
+ */
+static inline uint32_t
+fdb_bench_iterations(uint32_t default_iterations)
+{
+  const char* value = getenv("FDB_BENCH_ITERATIONS");
+  if(value != NULL && atoi(value) > 0)
+  {
+    return (uint32_t)atoi(value);
+  }
+  return default_iterations;
+}
+
+static inline void
+fdb_bench_init(fdb_bench_t* bench,
+               const char* suite,
+               int argc,
+               char** argv)
+{
+  bench->p_suite = suite;
+  bench->p_output = NULL;
+  if(argc > 1)
+  {
+    bench->p_output = fopen(argv[1], "a");
+    FDB_PERMA_ASSERT(bench->p_output != NULL && "Unable to open the benchmark output file");
+  }
+}
+
+static inline void
+fdb_bench_release(fdb_bench_t* bench)
+{
+  if(bench->p_output != NULL)
+  {
+    fclose(bench->p_output);
+    bench->p_output = NULL;
+  }
+}
+
+static inline void
+fdb_bench_timer_init(fdb_bench_timer_t* timer)
+{
+  memset(timer, 0, sizeof(fdb_bench_timer_t));
+}
+
+static inline void
+fdb_bench_timer_start(fdb_bench_timer_t* timer)
+{
+  timer->m_start_allocs = fdb_mem_num_allocs();
+  timer->m_start_ns = fdb_profiler_now_ns();
+}
+
+static inline void
+fdb_bench_timer_stop(fdb_bench_timer_t* timer)
+{
+  timer->m_elapsed_ns += fdb_profiler_now_ns() - timer->m_start_ns;
+  timer->m_num_allocs += fdb_mem_num_allocs() - timer->m_start_allocs;
+}
+
+/**
+ * \brief Reports the measurements accumulated by a timer
+ *
+ * \param bench The benchmark suite
+ * \param timer The timer accumulating the measured iterations
+ * \param name The name of the benchmark
+ * \param params The parameters of the benchmark, as the members of a JSON object
+ * \param num_entities The number of entities processed per iteration
+ * \param num_iterations The number of iterations measured
+ */
+static inline void
+fdb_bench_report(fdb_bench_t* bench,
+                 const fdb_bench_timer_t* timer,
+                 const char* name,
+                 const char* params,
+                 uint64_t num_entities,
+                 uint32_t num_iterations)
+{
+  double ns_per_entity = (double)timer->m_elapsed_ns / ((double)num_entities*num_iterations);
+  double allocs_per_iteration = (double)timer->m_num_allocs / num_iterations;
+
+  char line[1024];
+  snprintf(line,
+           1024,
+           "{\"suite\":\"%s\",\"bench\":\"%s\",\"params\":{%s},\"entities\":%lu,\"iterations\":%u,\"ns_per_entity\":%.3f,\"allocs_per_iteration\":%.2f}\n",
+           bench->p_suite,
+           name,
+           params,
+           (unsigned long)num_entities,
+           num_iterations,
+           ns_per_entity,
+           allocs_per_iteration);
+
+  fputs(line, stdout);
+  fflush(stdout);
+  if(bench->p_output != NULL)
+  {
+    fputs(line, bench->p_output);
+    fflush(bench->p_output);
+  }
+}
+
+#endif /* ifndef _FDB_BENCH_H_ */
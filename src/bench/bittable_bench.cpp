@@ -0,0 +1,141 @@
+
+#include "bench.h"
+
+#define NUM_ENTITIES (1024*1024)
+
+static void
+fill_bittable(fdb_bittable_t* bittable,
+              uint32_t density,
+              uint32_t seed)
+{
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    if((((i + seed) * 2654435761u) >> 16) % 100 < density)
+    {
+      fdb_bittable_add(bittable, i);
+    }
+  }
+}
+
+static void
+bench_add_remove(fdb_bench_t* bench)
+{
+  fdb_bittable_t bittable;
+  fdb_bittable_init(&bittable, nullptr);
+
+  uint32_t num_iterations = fdb_bench_iterations(5);
+  fdb_bench_timer_t add_timer;
+  fdb_bench_timer_t remove_timer;
+  fdb_bench_timer_init(&add_timer);
+  fdb_bench_timer_init(&remove_timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    fdb_bench_timer_start(&add_timer);
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      fdb_bittable_add(&bittable, i);
+    }
+    fdb_bench_timer_stop(&add_timer);
+
+    fdb_bench_timer_start(&remove_timer);
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      fdb_bittable_remove(&bittable, i);
+    }
+    fdb_bench_timer_stop(&remove_timer);
+  }
+  fdb_bench_report(bench, &add_timer, "add", "", NUM_ENTITIES, num_iterations);
+  fdb_bench_report(bench, &remove_timer, "remove", "", NUM_ENTITIES, num_iterations);
+
+  fdb_bittable_release(&bittable);
+}
+
+static void
+bench_exists(fdb_bench_t* bench,
+             uint32_t density)
+{
+  char params[256];
+  snprintf(params, 256, "\"density\":%u", density);
+
+  fdb_bittable_t bittable;
+  fdb_bittable_init(&bittable, nullptr);
+  fill_bittable(&bittable, density, 0);
+
+  uint32_t num_iterations = fdb_bench_iterations(20);
+  volatile uint32_t sink = 0;
+  fdb_bench_timer_t timer;
+  fdb_bench_timer_init(&timer);
+  fdb_bench_timer_start(&timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    uint32_t count = 0;
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      count += fdb_bittable_exists(&bittable, i);
+    }
+    sink = sink + count;
+  }
+  fdb_bench_timer_stop(&timer);
+  fdb_bench_report(bench, &timer, "exists", params, NUM_ENTITIES, num_iterations);
+
+  fdb_bittable_release(&bittable);
+}
+
+static void
+bench_set_ops(fdb_bench_t* bench,
+              uint32_t density)
+{
+  char params[256];
+  snprintf(params, 256, "\"density\":%u", density);
+
+  fdb_bittable_t first;
+  fdb_bittable_t second;
+  fdb_bittable_t result;
+  fdb_bittable_init(&first, nullptr);
+  fdb_bittable_init(&second, nullptr);
+  fdb_bittable_init(&result, nullptr);
+  fill_bittable(&first, density, 0);
+  fill_bittable(&second, density, 7);
+
+  uint32_t num_iterations = fdb_bench_iterations(20);
+  fdb_bench_timer_t union_timer;
+  fdb_bench_timer_t diff_timer;
+  fdb_bench_timer_init(&union_timer);
+  fdb_bench_timer_init(&diff_timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    fdb_bittable_clear(&result);
+    fdb_bittable_union(&result, &first);
+
+    fdb_bench_timer_start(&union_timer);
+    fdb_bittable_union(&result, &second);
+    fdb_bench_timer_stop(&union_timer);
+
+    fdb_bench_timer_start(&diff_timer);
+    fdb_bittable_difference(&result, &first);
+    fdb_bench_timer_stop(&diff_timer);
+  }
+  fdb_bench_report(bench, &union_timer, "union", params, NUM_ENTITIES, num_iterations);
+  fdb_bench_report(bench, &diff_timer, "difference", params, NUM_ENTITIES, num_iterations);
+
+  fdb_bittable_release(&result);
+  fdb_bittable_release(&second);
+  fdb_bittable_release(&first);
+}
+
+int main(int argc, char *argv[])
+{
+  fdb_bench_t bench;
+  fdb_bench_init(&bench, "bittable", argc, argv);
+
+  bench_add_remove(&bench);
+  const uint32_t densities[] = {100, 50, 10};
+  for(uint32_t density : densities)
+  {
+    bench_exists(&bench, density);
+    bench_set_ops(&bench, density);
+  }
+
+  fdb_bench_release(&bench);
+  return 0;
+}
@@ -0,0 +1,22 @@
+
+#include "lang/lang.h"
+#include "world_header.h"
+
+BEGIN_FDB_SCRIPT
+
+struct Propagate
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Transform* transform,
+           const Transform* parent_transform)
+  {
+    transform->m_x += parent_transform->m_x;
+    transform->m_y += parent_transform->m_y;
+    transform->m_z += parent_transform->m_z;
+  }
+};
+
+match<Transform>().expand<Transform>("parent").foreach<Propagate>();
+
+END_FDB_SCRIPT
@@ -0,0 +1,17 @@
+
+#include "world.h"
+
+int main(int argc, char *argv[])
+{
+  fdb_bench_t bench;
+  fdb_bench_init(&bench, "frame", argc, argv);
+
+  const uint32_t depths[] = {4, 16, 64};
+  for(uint32_t depth : depths)
+  {
+    fdb_bench_world_run(&bench, "furious_frame", depth);
+  }
+
+  fdb_bench_release(&bench);
+  return 0;
+}
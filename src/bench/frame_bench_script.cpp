@@ -0,0 +1,63 @@
+
+#include "lang/lang.h"
+#include "world_header.h"
+
+BEGIN_FDB_SCRIPT
+
+struct Move
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Position* position,
+           const Velocity* velocity)
+  {
+    position->m_x += velocity->m_x*context->m_dt;
+    position->m_y += velocity->m_y*context->m_dt;
+    position->m_z += velocity->m_z*context->m_dt;
+  }
+};
+
+struct Damp
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Velocity* velocity)
+  {
+    velocity->m_x *= 0.99f;
+    velocity->m_y *= 0.99f;
+    velocity->m_z *= 0.99f;
+  }
+};
+
+struct Attach
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Transform* transform,
+           const Position* parent_position)
+  {
+    transform->m_x = parent_position->m_x;
+    transform->m_y = parent_position->m_y;
+    transform->m_z = parent_position->m_z;
+  }
+};
+
+struct Propagate
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Transform* transform,
+           const Transform* parent_transform)
+  {
+    transform->m_x += parent_transform->m_x;
+    transform->m_y += parent_transform->m_y;
+    transform->m_z += parent_transform->m_z;
+  }
+};
+
+match<Position,Velocity>().foreach<Move>();
+match<Velocity>().has_not_tag("frozen").foreach<Damp>();
+match<Transform>().expand<Position>("parent").foreach<Attach>();
+match<Transform>().expand<Transform>("parent").foreach<Propagate>();
+
+END_FDB_SCRIPT
@@ -0,0 +1,22 @@
+
+#include "lang/lang.h"
+#include "world_header.h"
+
+BEGIN_FDB_SCRIPT
+
+struct Attach
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Transform* transform,
+           const Position* parent_position)
+  {
+    transform->m_x = parent_position->m_x;
+    transform->m_y = parent_position->m_y;
+    transform->m_z = parent_position->m_z;
+  }
+};
+
+match<Transform>().expand<Position>("parent").foreach<Attach>();
+
+END_FDB_SCRIPT
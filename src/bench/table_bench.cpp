@@ -0,0 +1,160 @@
+
+#include "bench.h"
+
+#define NUM_ENTITIES (1024*1024)
+
+#define BENCH_COMPONENT(name, size) \
+FDB_BEGIN_COMPONENT(name, KILOBYTES(4)) \
+  float m_value; \
+  char  m_padding[size - sizeof(float)]; \
+FDB_END_COMPONENT
+
+BENCH_COMPONENT(Component16, 16)
+BENCH_COMPONENT(Component64, 64)
+BENCH_COMPONENT(Component128, 128)
+BENCH_COMPONENT(Component256, 256)
+
+/**
+ * \brief Whether the given entity is present in a table with the given density.
+ * Entities are spread using a multiplicative hash so partially filled blocks
+ * are spread through the whole table
+ */
+static inline bool
+is_present(entity_id_t id,
+           uint32_t density)
+{
+  return ((id * 2654435761u) >> 16) % 100 < density;
+}
+
+template<typename TComponent>
+static void
+bench_create_destroy(fdb_bench_t* bench,
+                     const char* component_name)
+{
+  char params[256];
+  snprintf(params, 256, "\"component_size\":%zu", sizeof(TComponent));
+
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* table = fdb_database_create_table(&database,
+                                                 component_name,
+                                                 sizeof(TComponent),
+                                                 nullptr);
+
+  uint32_t num_iterations = fdb_bench_iterations(5);
+  fdb_bench_timer_t create_timer;
+  fdb_bench_timer_t destroy_timer;
+  fdb_bench_timer_init(&create_timer);
+  fdb_bench_timer_init(&destroy_timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    fdb_bench_timer_start(&create_timer);
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      TComponent* component = (TComponent*)fdb_table_create_component(table, i);
+      component->m_value = i;
+    }
+    fdb_bench_timer_stop(&create_timer);
+
+    fdb_bench_timer_start(&destroy_timer);
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      fdb_table_destroy_component(table, i);
+    }
+    fdb_bench_timer_stop(&destroy_timer);
+  }
+  fdb_bench_report(bench, &create_timer, "create_component", params, NUM_ENTITIES, num_iterations);
+  fdb_bench_report(bench, &destroy_timer, "destroy_component", params, NUM_ENTITIES, num_iterations);
+
+  fdb_database_release(&database);
+}
+
+template<typename TComponent>
+static void
+bench_scan(fdb_bench_t* bench,
+           const char* component_name,
+           uint32_t density)
+{
+  char params[256];
+  snprintf(params, 256, "\"component_size\":%zu,\"density\":%u", sizeof(TComponent), density);
+
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* table = fdb_database_create_table(&database,
+                                                 component_name,
+                                                 sizeof(TComponent),
+                                                 nullptr);
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    if(is_present(i, density))
+    {
+      TComponent* component = (TComponent*)fdb_table_create_component(table, i);
+      component->m_value = 1.0f;
+    }
+  }
+
+  uint32_t num_iterations = fdb_bench_iterations(20);
+  volatile float sink = 0.0f;
+  fdb_bench_timer_t timer;
+  fdb_bench_timer_init(&timer);
+  fdb_bench_timer_start(&timer);
+  for(uint32_t it = 0; it < num_iterations; ++it)
+  {
+    float sum = 0.0f;
+    fdb_table_iter_t iter;
+    fdb_table_iter_init(&iter, table, 1, 0, 1);
+    while(fdb_table_iter_has_next(&iter))
+    {
+      fdb_table_block_t* block = fdb_table_iter_next(&iter);
+      TComponent* data = (TComponent*)block->p_data;
+      const fdb_bitmap_t* enabled = &block->m_enabled;
+      // Mirrors the code generated for a foreach
+      if(enabled->m_num_set == FDB_TABLE_BLOCK_SIZE)
+      {
+        for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+        {
+          sum += data[i].m_value;
+        }
+      }
+      else
+      {
+        fdb_bitmap_iter_t bit_iter;
+        fdb_bitmap_iter_init(&bit_iter, enabled);
+        uint32_t i;
+        while(fdb_bitmap_iter_next(&bit_iter, &i))
+        {
+          sum += data[i].m_value;
+        }
+      }
+    }
+    fdb_table_iter_release(&iter);
+    sink = sink + sum;
+  }
+  fdb_bench_timer_stop(&timer);
+  fdb_bench_report(bench, &timer, "scan", params, NUM_ENTITIES, num_iterations);
+
+  fdb_database_release(&database);
+}
+
+int main(int argc, char *argv[])
+{
+  fdb_bench_t bench;
+  fdb_bench_init(&bench, "table", argc, argv);
+
+  bench_create_destroy<Component16>(&bench, "Component16");
+  bench_create_destroy<Component64>(&bench, "Component64");
+  bench_create_destroy<Component128>(&bench, "Component128");
+  bench_create_destroy<Component256>(&bench, "Component256");
+
+  const uint32_t densities[] = {100, 50, 10};
+  for(uint32_t density : densities)
+  {
+    bench_scan<Component16>(&bench, "Component16", density);
+    bench_scan<Component64>(&bench, "Component64", density);
+    bench_scan<Component128>(&bench, "Component128", density);
+    bench_scan<Component256>(&bench, "Component256", density);
+  }
+
+  fdb_bench_release(&bench);
+  return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef _FDB_BENCH_WORLD_H_
+#define _FDB_BENCH_WORLD_H_ value
+
+#include "bench.h"
+#include "world_header.h"
+
+#include <unistd.h>
+
+#define FDB_BENCH_WORLD_NUM_ENTITIES (1024*1024)
+
+/**
+ * \brief Populates a synthetic world. All entities have a Position, a Velocity
+ * and a Transform, one every eight is tagged as "frozen", and the entities are
+ * organized in chains of depth entities linked through the "parent" reference
+ */
+static inline void
+fdb_bench_world_build(fdb_database_t* database,
+                      uint32_t num_entities,
+                      uint32_t depth)
+{
+  fdb_table_t* pos_table = fdb_database_find_or_create_table(database, "Position", sizeof(Position), nullptr);
+  fdb_table_t* vel_table = fdb_database_find_or_create_table(database, "Velocity", sizeof(Velocity), nullptr);
+  fdb_table_t* trans_table = fdb_database_find_or_create_table(database, "Transform", sizeof(Transform), nullptr);
+  fdb_reftable_t* parent_table = fdb_database_find_or_create_reftable(database, "parent");
+  fdb_bittable_t* frozen_table = FDB_FIND_TAG_TABLE(database, "frozen");
+
+  for(entity_id_t i = 0; i < num_entities; ++i)
+  {
+    Position* pos = (Position*)fdb_table_create_component(pos_table, i);
+    pos->m_x = pos->m_y = pos->m_z = 0.0f;
+    Velocity* vel = (Velocity*)fdb_table_create_component(vel_table, i);
+    vel->m_x = vel->m_y = vel->m_z = 1.0f;
+    Transform* trans = (Transform*)fdb_table_create_component(trans_table, i);
+    trans->m_x = trans->m_y = trans->m_z = 0.0f;
+
+    if(i % 8 == 0)
+    {
+      FDB_ADD_TAG(frozen_table, i);
+    }
+
+    if(i % depth != 0)
+    {
+      FDB_ADD_REFERENCE(parent_table, i, i - 1);
+    }
+  }
+}
+
+/**
+ * \brief Benchmarks the fcc-generated furious_frame on a synthetic world, both
+ * serially and with an executor using all the available cores
+ *
+ * \param bench The benchmark suite
+ * \param name The name of the benchmark
+ * \param depth The depth of the hierarchies of the world
+ */
+static inline void
+fdb_bench_world_run(fdb_bench_t* bench,
+                    const char* name,
+                    uint32_t depth)
+{
+  uint32_t max_threads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+  if(max_threads > FDB_EXECUTOR_MAX_THREADS)
+  {
+    max_threads = FDB_EXECUTOR_MAX_THREADS;
+  }
+  const uint32_t num_threads[] = {1, max_threads};
+
+  for(uint32_t t = 0; t < 2; ++t)
+  {
+    if(t > 0 && num_threads[t] <= 1)
+    {
+      break;
+    }
+
+    fdb_database_t database;
+    fdb_database_init(&database, nullptr);
+    furious_init(&database);
+    fdb_bench_world_build(&database, FDB_BENCH_WORLD_NUM_ENTITIES, depth);
+
+    fdb_executor_t executor;
+    if(num_threads[t] > 1)
+    {
+      fdb_executor_init(&executor, num_threads[t]);
+      fdb_task_graph_set_executor(furious_task_graph(), &executor);
+    }
+
+    // Warm up frame, which allocates the pages used by the temporal tables
+    furious_frame(0.016f, &database, nullptr);
+
+    char params[256];
+    snprintf(params, 256, "\"depth\":%u,\"threads\":%u", depth, num_threads[t]);
+    uint32_t num_iterations = fdb_bench_iterations(10);
+    fdb_bench_timer_t timer;
+    fdb_bench_timer_init(&timer);
+    fdb_bench_timer_start(&timer);
+    for(uint32_t it = 0; it < num_iterations; ++it)
+    {
+      furious_frame(0.016f, &database, nullptr);
+    }
+    fdb_bench_timer_stop(&timer);
+    fdb_bench_report(bench, &timer, name, params, FDB_BENCH_WORLD_NUM_ENTITIES, num_iterations);
+
+    if(num_threads[t] > 1)
+    {
+      fdb_task_graph_set_executor(furious_task_graph(), NULL);
+      fdb_executor_release(&executor);
+    }
+    furious_release();
+    fdb_database_release(&database);
+  }
+}
+
+#endif /* ifndef _FDB_BENCH_WORLD_H_ */
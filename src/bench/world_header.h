@@ -0,0 +1,24 @@
+#ifndef _FDB_BENCH_WORLD_HEADER_H_
+#define _FDB_BENCH_WORLD_HEADER_H_ value
+
+#include "furious_macros.h"
+
+FDB_BEGIN_COMPONENT(Position, KILOBYTES(64))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(Velocity, KILOBYTES(64))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(Transform, KILOBYTES(64))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+#endif /* ifndef _FDB_BENCH_WORLD_HEADER_H_ */
@@ -0,0 +1,92 @@
+#ifdef FDB_OS_LINUX
+  #ifndef _GNU_SOURCE
+  #define _GNU_SOURCE
+  #endif
+#endif
+
+#include "barrier.h"
+
+#ifdef FDB_OS_LINUX
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FDB_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define FDB_CPU_RELAX() 
+#endif
+
+static void
+fdb_sync_barrier_sleep(fdb_sync_barrier_t* barrier,
+                       int32_t count)
+{
+#ifdef FDB_OS_LINUX
+  // Returns immediately if the counter has changed since it was read
+  syscall(SYS_futex, &barrier->m_count, FUTEX_WAIT_PRIVATE, count, NULL, NULL, 0);
+#else
+  FDB_CPU_RELAX();
+#endif
+}
+
+static void
+fdb_sync_barrier_wake(fdb_sync_barrier_t* barrier)
+{
+#ifdef FDB_OS_LINUX
+  syscall(SYS_futex, &barrier->m_count, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+#endif
+}
+
+void
+fdb_sync_barrier_init(fdb_sync_barrier_t* barrier,
+                      uint32_t spin_count)
+{
+  barrier->m_count = 0;
+  barrier->m_num_sleepers = 0;
+  barrier->m_spin_count = spin_count;
+}
+
+void
+fdb_sync_barrier_release(fdb_sync_barrier_t* barrier)
+{
+  FDB_ASSERT(barrier->m_num_sleepers == 0 && "Releasing a barrier with sleeping threads");
+}
+
+void
+fdb_sync_barrier_wait(fdb_sync_barrier_t* barrier,
+                      int32_t target)
+{
+  int32_t count = __sync_add_and_fetch(&barrier->m_count, 1);
+  if(count >= target)
+  {
+    if(barrier->m_num_sleepers > 0)
+    {
+      fdb_sync_barrier_wake(barrier);
+    }
+    return;
+  }
+
+  for(uint32_t i = 0; i < barrier->m_spin_count; ++i)
+  {
+    if(barrier->m_count >= target)
+    {
+      return;
+    }
+    FDB_CPU_RELAX();
+  }
+
+  __sync_add_and_fetch(&barrier->m_num_sleepers, 1);
+  while((count = barrier->m_count) < target)
+  {
+    fdb_sync_barrier_sleep(barrier, count);
+  }
+  __sync_sub_and_fetch(&barrier->m_num_sleepers, 1);
+}
+
+void
+fdb_sync_barrier_reset(fdb_sync_barrier_t* barrier)
+{
+  barrier->m_count = 0;
+  fdb_mem_barrier();
+}
@@ -0,0 +1,71 @@
+
+#ifndef _FDB_BARRIER_H_
+#define _FDB_BARRIER_H_ value
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FDB_SYNC_BARRIER_DEFAULT_SPIN_COUNT 4096
+
+/**
+ * \brief Counting barrier shared by the threads running the parts of a task.
+ * Each call to wait increments the arrival counter and blocks until the counter
+ * reaches the given target. Threads calling wait with a cumulative target (e.g.
+ * num_threads, 2*num_threads, ...) thus synchronize at each phase without
+ * needing to reset the barrier in between. Waiting threads spin for a bounded
+ * number of iterations before sleeping on a futex.
+ */
+typedef struct fdb_sync_barrier_t
+{
+  volatile int32_t  m_count;          //< The number of arrivals. Used as the futex word
+  volatile int32_t  m_num_sleepers;   //< The number of threads sleeping on the futex
+  uint32_t          m_spin_count;     //< The number of spins before sleeping
+} fdb_sync_barrier_t;
+
+/**
+ * \brief Initializes a barrier
+ *
+ * \param barrier The barrier to initialize
+ * \param spin_count The number of spin iterations before a waiting thread
+ * sleeps
+ */
+void
+fdb_sync_barrier_init(fdb_sync_barrier_t* barrier,
+                      uint32_t spin_count);
+
+/**
+ * \brief Releases a barrier
+ *
+ * \param barrier The barrier to release
+ */
+void
+fdb_sync_barrier_release(fdb_sync_barrier_t* barrier);
+
+/**
+ * \brief Arrives at the barrier and waits until the number of arrivals reaches
+ * the given target
+ *
+ * \param barrier The barrier to wait on
+ * \param target The number of arrivals to wait for
+ */
+void
+fdb_sync_barrier_wait(fdb_sync_barrier_t* barrier,
+                      int32_t target);
+
+/**
+ * \brief Resets the arrivals counter of the barrier. Must not be called while
+ * threads are waiting on the barrier
+ *
+ * \param barrier The barrier to reset
+ */
+void
+fdb_sync_barrier_reset(fdb_sync_barrier_t* barrier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef _FDB_BARRIER_H_ */
@@ -3,63 +3,53 @@
 #include "bitmap.h"
 #include <string.h>
 
-void
-fdb_bitmap_refresh_num_set(fdb_bitmap_t* bitmap);
-
-// Lookup table used to efficiently implement refresh_num_set operation
-uint8_t count_bits_lookup[16] = {
-  0, // 0:0000 
-  1, // 1:0001 
-  1, // 2:0010 
-  2, // 3:0011
-  1, // 4:0100
-  2, // 5:0101
-  2, // 6:0110
-  3, // 7:0111
-  1, // 8:1000
-  2, // 9:1001
-  2, // 10:1010
-  3, // 11:1011
-  2, // 12:1100
-  3, // 13:1101
-  3, // 14:1110
-  4, // 15:1111
-};
-
-bool 
-set_bit_true(uint8_t* data, uint32_t bit)
-{
-  FDB_ASSERT(bit >= 0 && bit <= 7 && "Cannot set bit. Bit is out of range");
-  uint8_t val = *data;
-  uint8_t mask =  1 << bit;
-  val = val | mask;
-  bool changed = *data != val;
-  *data = val;
-  return changed;
-}
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FDB_BITMAP_SIMD_WORDS 4
+typedef __m256i fdb_bitmap_vec_t;
+#define FDB_BITMAP_VEC_LOAD(ptr) _mm256_loadu_si256((const __m256i*)(ptr))
+#define FDB_BITMAP_VEC_STORE(ptr, v) _mm256_storeu_si256((__m256i*)(ptr), v)
+#define FDB_BITMAP_VEC_AND(a, b) _mm256_and_si256(a, b)
+#define FDB_BITMAP_VEC_OR(a, b) _mm256_or_si256(a, b)
+#define FDB_BITMAP_VEC_ANDNOT(a, b) _mm256_andnot_si256(a, b)
+#define FDB_BITMAP_VEC_ONES() _mm256_set1_epi32(-1)
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FDB_BITMAP_SIMD_WORDS 2
+typedef __m128i fdb_bitmap_vec_t;
+#define FDB_BITMAP_VEC_LOAD(ptr) _mm_loadu_si128((const __m128i*)(ptr))
+#define FDB_BITMAP_VEC_STORE(ptr, v) _mm_storeu_si128((__m128i*)(ptr), v)
+#define FDB_BITMAP_VEC_AND(a, b) _mm_and_si128(a, b)
+#define FDB_BITMAP_VEC_OR(a, b) _mm_or_si128(a, b)
+#define FDB_BITMAP_VEC_ANDNOT(a, b) _mm_andnot_si128(a, b)
+#define FDB_BITMAP_VEC_ONES() _mm_set1_epi32(-1)
+#endif
 
-bool 
-set_bit_false(uint8_t* data, uint32_t bit)
+/**
+ * \brief Counts the bits set in an array of words
+ */
+static inline uint32_t
+fdb_bitmap_popcount(const uint64_t* data, 
+                    uint32_t nwords)
 {
-  FDB_ASSERT(bit >= 0 && bit <= 7 && "Cannot set bit. Bit is out of range");
-  uint8_t val = *data;
-  uint8_t mask =  1 << bit;
-  mask = ~mask;
-  val = val & mask;
-  bool changed = *data != val;
-  *data = val;
-  return changed;
+  uint32_t count = 0;
+  for(uint32_t i = 0; i < nwords; ++i)
+  {
+    count += __builtin_popcountll(data[i]);
+  }
+  return count;
 }
 
-bool
-read_bit(const uint8_t* data, uint32_t bit)
+/**
+ * \brief Mask of the valid bits of the last word of a bitmap
+ */
+static inline uint64_t
+fdb_bitmap_tail_mask(uint32_t max_bits)
 {
-  FDB_ASSERT(bit >= 0 && bit <= 7 && "Cannot set bit. Bit is out of range");
-  uint32_t mask = 1 << bit;
-  return (*data & mask);
+  uint32_t rem = max_bits & 63;
+  return rem == 0 ? ~(uint64_t)0 : (((uint64_t)1 << rem) - 1);
 }
 
-
 /**
  * \brief Initializes a bitmap
  *
@@ -76,12 +66,12 @@ fdb_bitmap_init(fdb_bitmap_t* bitmap,
 
   bitmap->m_max_bits = max_bits;
   bitmap->m_num_set = 0;
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(bitmap->m_max_bits);
-  bitmap->p_data = (uint8_t*)mem_alloc(allocator, 
-                                      FDB_BITMAP_ALIGNMENT, 
-                                      sizeof(uint8_t)*nchunks, 
-                                      -1);
-  memset(bitmap->p_data, 0, sizeof(uint8_t)*nchunks);
+  uint32_t size = FDB_BITMAP_DATA_SIZE(bitmap->m_max_bits);
+  bitmap->p_data = (uint64_t*)mem_alloc(allocator, 
+                                        FDB_BITMAP_ALIGNMENT, 
+                                        size, 
+                                        -1);
+  memset(bitmap->p_data, 0, size);
 }
 
 /**
@@ -109,10 +99,10 @@ fdb_bitmap_set(fdb_bitmap_t* bitmap,
            uint32_t element)
 {
   FDB_ASSERT(element < bitmap->m_max_bits && "Bit out of range");
-  uint32_t chunk = element / 8;
-  uint32_t offset = element % 8;
-  bool res = set_bit_true(&bitmap->p_data[chunk], offset);
-  bitmap->m_num_set += res*1;
+  uint64_t* word = &bitmap->p_data[element >> 6];
+  uint64_t mask = (uint64_t)1 << (element & 63);
+  bitmap->m_num_set += (*word & mask) == 0;
+  *word |= mask;
 }
 
 /**
@@ -126,10 +116,10 @@ fdb_bitmap_unset(fdb_bitmap_t* bitmap,
              uint32_t element)
 {
   FDB_ASSERT(element < bitmap->m_max_bits && "Bit out of range");
-  uint32_t chunk = element / 8;
-  uint32_t offset = element % 8;
-  bool res = set_bit_false(&bitmap->p_data[chunk], offset);
-  bitmap->m_num_set -= res*1;
+  uint64_t* word = &bitmap->p_data[element >> 6];
+  uint64_t mask = (uint64_t)1 << (element & 63);
+  bitmap->m_num_set -= (*word & mask) != 0;
+  *word &= ~mask;
 }
 
 /**
@@ -145,36 +135,12 @@ fdb_bitmap_set_bit(fdb_bitmap_t* bitmap,
                bool value)
 {
   FDB_ASSERT(element < bitmap->m_max_bits && "Bit out of range");
-  uint32_t chunk = element / 8;
-  uint32_t offset = element % 8;
-  if(value)
-  {
-    bool res = set_bit_true(&bitmap->p_data[chunk], offset);
-    bitmap->m_num_set += res*1;
-  } 
-  else
-  {
-    bool res = set_bit_false(&bitmap->p_data[chunk], offset);
-    bitmap->m_num_set -= res*1;
-  }
-}
-
-/**
- * \brief Checks if a given element is set to 1
- *
- * \param bitmap The bitmap to perform the operation
- * \param element The element to check
- *
- * \return True if the element is set to 1
- */
-bool
-fdb_bitmap_is_set(const fdb_bitmap_t* bitmap, 
-              uint32_t element)
-{
-  FDB_ASSERT(element < bitmap->m_max_bits && "Bit out of range");
-  uint32_t chunk = element / 8;
-  uint32_t offset = element % 8;
-  return read_bit(&bitmap->p_data[chunk], offset);
+  uint64_t* word = &bitmap->p_data[element >> 6];
+  uint32_t offset = element & 63;
+  uint64_t old_bit = (*word >> offset) & 1;
+  uint64_t new_bit = value ? 1 : 0;
+  *word = (*word & ~((uint64_t)1 << offset)) | (new_bit << offset);
+  bitmap->m_num_set += (int32_t)new_bit - (int32_t)old_bit;
 }
 
 /**
@@ -188,11 +154,10 @@ fdb_bitmap_set_bitmap(FDB_RESTRICT(fdb_bitmap_t*) dst_bitmap,
                   FDB_RESTRICT(const fdb_bitmap_t*) src_bitmap)
 {
   FDB_ASSERT(dst_bitmap->m_max_bits == src_bitmap->m_max_bits && "Incompatible bitmaps");
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(dst_bitmap->m_max_bits);
   dst_bitmap->m_num_set = src_bitmap->m_num_set;
   FDB_ALIGNED(FDB_RESTRICT(void*), dst_data, FDB_BITMAP_ALIGNMENT) = dst_bitmap->p_data;
   FDB_ALIGNED(FDB_RESTRICT(void*), src_data, FDB_BITMAP_ALIGNMENT) = src_bitmap->p_data;
-  memcpy(dst_data, src_data, sizeof(uint8_t)*nchunks);
+  memcpy(dst_data, src_data, FDB_BITMAP_DATA_SIZE(dst_bitmap->m_max_bits));
 }
 
 /**
@@ -206,14 +171,23 @@ fdb_bitmap_set_and(FDB_RESTRICT(fdb_bitmap_t*) dst_bitmap,
                FDB_RESTRICT(const fdb_bitmap_t*) src_bitmap)
 {
   FDB_ASSERT(dst_bitmap->m_max_bits == src_bitmap->m_max_bits && "Incompatible bitmaps");
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(dst_bitmap->m_max_bits);
-  FDB_ALIGNED(FDB_RESTRICT(uint8_t*), dst_data, FDB_BITMAP_ALIGNMENT) = dst_bitmap->p_data;
-  FDB_ALIGNED(FDB_RESTRICT(uint8_t*), src_data, FDB_BITMAP_ALIGNMENT) = src_bitmap->p_data;
-  for(uint32_t i = 0; i < nchunks; ++i)
+  uint32_t nwords = FDB_BITMAP_NUM_WORDS(dst_bitmap->m_max_bits);
+  FDB_ALIGNED(FDB_RESTRICT(uint64_t*), dst_data, FDB_BITMAP_ALIGNMENT) = dst_bitmap->p_data;
+  FDB_ALIGNED(FDB_RESTRICT(const uint64_t*), src_data, FDB_BITMAP_ALIGNMENT) = src_bitmap->p_data;
+  uint32_t i = 0;
+#ifdef FDB_BITMAP_SIMD_WORDS
+  for(; i + FDB_BITMAP_SIMD_WORDS <= nwords; i+=FDB_BITMAP_SIMD_WORDS)
+  {
+    fdb_bitmap_vec_t dst = FDB_BITMAP_VEC_LOAD(&dst_data[i]);
+    fdb_bitmap_vec_t src = FDB_BITMAP_VEC_LOAD(&src_data[i]);
+    FDB_BITMAP_VEC_STORE(&dst_data[i], FDB_BITMAP_VEC_AND(dst, src));
+  }
+#endif
+  for(; i < nwords; ++i)
   {
     dst_data[i] = dst_data[i] & src_data[i];
   }
-  fdb_bitmap_refresh_num_set(dst_bitmap);
+  dst_bitmap->m_num_set = fdb_bitmap_popcount(dst_data, nwords);
 }
 
 /**
@@ -227,14 +201,23 @@ fdb_bitmap_set_or(FDB_RESTRICT(fdb_bitmap_t*) dst_bitmap,
               FDB_RESTRICT(const fdb_bitmap_t*) src_bitmap)
 {
   FDB_ASSERT(dst_bitmap->m_max_bits == src_bitmap->m_max_bits && "Incompatible bitmaps");
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(dst_bitmap->m_max_bits);
-  for(uint32_t i = 0; i < nchunks; ++i)
+  uint32_t nwords = FDB_BITMAP_NUM_WORDS(dst_bitmap->m_max_bits);
+  FDB_ALIGNED(FDB_RESTRICT(uint64_t*), dst_data, FDB_BITMAP_ALIGNMENT) = dst_bitmap->p_data;
+  FDB_ALIGNED(FDB_RESTRICT(const uint64_t*), src_data, FDB_BITMAP_ALIGNMENT) = src_bitmap->p_data;
+  uint32_t i = 0;
+#ifdef FDB_BITMAP_SIMD_WORDS
+  for(; i + FDB_BITMAP_SIMD_WORDS <= nwords; i+=FDB_BITMAP_SIMD_WORDS)
   {
-    dst_bitmap->p_data[i] = dst_bitmap->p_data[i] | src_bitmap->p_data[i];
+    fdb_bitmap_vec_t dst = FDB_BITMAP_VEC_LOAD(&dst_data[i]);
+    fdb_bitmap_vec_t src = FDB_BITMAP_VEC_LOAD(&src_data[i]);
+    FDB_BITMAP_VEC_STORE(&dst_data[i], FDB_BITMAP_VEC_OR(dst, src));
   }
-
-  // This needs to be improved with a lookup table
-  fdb_bitmap_refresh_num_set(dst_bitmap);
+#endif
+  for(; i < nwords; ++i)
+  {
+    dst_data[i] = dst_data[i] | src_data[i];
+  }
+  dst_bitmap->m_num_set = fdb_bitmap_popcount(dst_data, nwords);
 }
 
 /**
@@ -248,12 +231,23 @@ fdb_bitmap_set_diff(FDB_RESTRICT(fdb_bitmap_t*) dst_bitmap,
                 FDB_RESTRICT(const fdb_bitmap_t*) src_bitmap)
 {
   FDB_ASSERT(dst_bitmap->m_max_bits == src_bitmap->m_max_bits && "Incompatible bitmaps");
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(dst_bitmap->m_max_bits);
-  for(uint32_t i = 0; i < nchunks; ++i)
+  uint32_t nwords = FDB_BITMAP_NUM_WORDS(dst_bitmap->m_max_bits);
+  FDB_ALIGNED(FDB_RESTRICT(uint64_t*), dst_data, FDB_BITMAP_ALIGNMENT) = dst_bitmap->p_data;
+  FDB_ALIGNED(FDB_RESTRICT(const uint64_t*), src_data, FDB_BITMAP_ALIGNMENT) = src_bitmap->p_data;
+  uint32_t i = 0;
+#ifdef FDB_BITMAP_SIMD_WORDS
+  for(; i + FDB_BITMAP_SIMD_WORDS <= nwords; i+=FDB_BITMAP_SIMD_WORDS)
   {
-    dst_bitmap->p_data[i] = dst_bitmap->p_data[i] & (dst_bitmap->p_data[i] ^ src_bitmap->p_data[i]);
+    fdb_bitmap_vec_t dst = FDB_BITMAP_VEC_LOAD(&dst_data[i]);
+    fdb_bitmap_vec_t src = FDB_BITMAP_VEC_LOAD(&src_data[i]);
+    FDB_BITMAP_VEC_STORE(&dst_data[i], FDB_BITMAP_VEC_ANDNOT(src, dst));
   }
-  fdb_bitmap_refresh_num_set(dst_bitmap);
+#endif
+  for(; i < nwords; ++i)
+  {
+    dst_data[i] = dst_data[i] & ~src_data[i];
+  }
+  dst_bitmap->m_num_set = fdb_bitmap_popcount(dst_data, nwords);
 }
 
 /**
@@ -264,12 +258,27 @@ fdb_bitmap_set_diff(FDB_RESTRICT(fdb_bitmap_t*) dst_bitmap,
 void
 fdb_bitmap_negate(fdb_bitmap_t* bitmap)
 {
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(bitmap->m_max_bits);
-  for(uint32_t i = 0; i < nchunks; ++i)
+  uint32_t nwords = FDB_BITMAP_NUM_WORDS(bitmap->m_max_bits);
+  FDB_ALIGNED(uint64_t*, data, FDB_BITMAP_ALIGNMENT) = bitmap->p_data;
+  uint32_t i = 0;
+#ifdef FDB_BITMAP_SIMD_WORDS
+  fdb_bitmap_vec_t ones = FDB_BITMAP_VEC_ONES();
+  for(; i + FDB_BITMAP_SIMD_WORDS <= nwords; i+=FDB_BITMAP_SIMD_WORDS)
   {
-    bitmap->p_data[i] = ~bitmap->p_data[i];
+    fdb_bitmap_vec_t v = FDB_BITMAP_VEC_LOAD(&data[i]);
+    FDB_BITMAP_VEC_STORE(&data[i], FDB_BITMAP_VEC_ANDNOT(v, ones));
   }
-  fdb_bitmap_refresh_num_set(bitmap);
+#endif
+  for(; i < nwords; ++i)
+  {
+    data[i] = ~data[i];
+  }
+  // Bits beyond m_max_bits must remain unset
+  if(nwords > 0)
+  {
+    data[nwords - 1] &= fdb_bitmap_tail_mask(bitmap->m_max_bits);
+  }
+  bitmap->m_num_set = bitmap->m_max_bits - bitmap->m_num_set;
 }
 
 /**
@@ -280,20 +289,13 @@ fdb_bitmap_negate(fdb_bitmap_t* bitmap)
 void
 fdb_bitmap_nullify(fdb_bitmap_t* bitmap)
 {
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(bitmap->m_max_bits);
   bitmap->m_num_set = 0;
-  memset(bitmap->p_data, 0, sizeof(uint8_t)*nchunks);
+  memset(bitmap->p_data, 0, FDB_BITMAP_DATA_SIZE(bitmap->m_max_bits));
 }
 
 void
 fdb_bitmap_refresh_num_set(fdb_bitmap_t* bitmap)
 {
-  bitmap->m_num_set = 0;
-  uint32_t nchunks = FDB_BITMAP_NUM_CHUNKS(bitmap->m_max_bits);
-  for(uint32_t i = 0; i < nchunks; ++i)
-  {
-    uint8_t left = bitmap->p_data[i] >> 4;
-    uint8_t right = bitmap->p_data[i] & 0x0f;
-    bitmap->m_num_set+=count_bits_lookup[left] + count_bits_lookup[right];
-  }
+  bitmap->m_num_set = fdb_bitmap_popcount(bitmap->p_data, 
+                                          FDB_BITMAP_NUM_WORDS(bitmap->m_max_bits));
 }
@@ -14,12 +14,19 @@ extern "C" {
 
 #define FDB_BITMAP_ALIGNMENT 64
 #define FDB_BITMAP_NUM_CHUNKS(bits) (bits + 7) / 8
+#define FDB_BITMAP_NUM_WORDS(bits) (((bits) + 63) / 64)
+#define FDB_BITMAP_DATA_SIZE(bits) (FDB_BITMAP_NUM_WORDS(bits) * sizeof(uint64_t))
 
+/**
+ * \brief A fixed size bitmap. Bits are stored in 64 bit words (bit i is bit
+ * i%64 of word i/64), so that bulk operations work a word (or a SIMD vector of
+ * words) at a time. Bits beyond m_max_bits are always kept to zero.
+ */
 typedef struct fdb_bitmap_t 
 {
   uint32_t m_max_bits;          //< The maximum number of bits
   uint32_t m_num_set;           //< The number of bits set to one
-  FDB_ALIGNED(uint8_t*,p_data,FDB_BITMAP_ALIGNMENT);  //< The buffer with the bitmap
+  FDB_ALIGNED(uint64_t*,p_data,FDB_BITMAP_ALIGNMENT);  //< The buffer with the bitmap
 } fdb_bitmap_t;
 
 /**
@@ -86,9 +93,13 @@ fdb_bitmap_set_bit(fdb_bitmap_t* bitmap,
  * \return True if the element is set to 1
  */
 
-bool
+static inline bool
 fdb_bitmap_is_set(const fdb_bitmap_t* bitmap, 
-                  uint32_t element);
+                  uint32_t element)
+{
+  FDB_ASSERT(element < bitmap->m_max_bits && "Bit out of range");
+  return (bitmap->p_data[element >> 6] >> (element & 63)) & 1;
+}
 
 /**
  * \brief Sets the bits based on the given bitmap
@@ -151,6 +162,100 @@ fdb_bitmap_negate(fdb_bitmap_t* bitmap);
 void
 fdb_bitmap_nullify(fdb_bitmap_t* bitmap);
 
+/**
+ * \brief Recomputes the number of bits set of the bitmap
+ *
+ * \param bitmap The bitmap to recount the bits of
+ */
+void
+fdb_bitmap_refresh_num_set(fdb_bitmap_t* bitmap);
+
+/**
+ * \brief Returns the first set element of the bitmap at or after the given
+ * element
+ *
+ * \param bitmap The bitmap to search
+ * \param element The element to start searching from
+ *
+ * \return The first set element at or after element, or m_max_bits if there
+ * are none
+ */
+static inline uint32_t
+fdb_bitmap_next_set(const fdb_bitmap_t* bitmap, 
+                    uint32_t element)
+{
+  if(element >= bitmap->m_max_bits)
+  {
+    return bitmap->m_max_bits;
+  }
+  uint32_t nwords = FDB_BITMAP_NUM_WORDS(bitmap->m_max_bits);
+  uint32_t word_idx = element >> 6;
+  uint64_t word = bitmap->p_data[word_idx] & (~(uint64_t)0 << (element & 63));
+  while(word == 0)
+  {
+    if(++word_idx == nwords)
+    {
+      return bitmap->m_max_bits;
+    }
+    word = bitmap->p_data[word_idx];
+  }
+  return (word_idx << 6) + (uint32_t)__builtin_ctzll(word);
+}
+
+/**
+ * \brief Iterator over the set bits of a bitmap. It visits the words of the
+ * bitmap and extracts the set bits with count-trailing-zeros, so iterating a
+ * bitmap costs one step per set bit plus one per word.
+ */
+typedef struct fdb_bitmap_iter_t
+{
+  const uint64_t* p_data;       //< The words of the bitmap being iterated
+  uint32_t        m_num_words;  //< The number of words of the bitmap
+  uint32_t        m_word_idx;   //< The index of the word being iterated
+  uint64_t        m_word;       //< The bits of the current word not yet visited
+} fdb_bitmap_iter_t;
+
+/**
+ * \brief Initializes a set-bit iterator on the given bitmap
+ *
+ * \param iter The iterator to initialize
+ * \param bitmap The bitmap to iterate. It must not change while iterating
+ */
+static inline void
+fdb_bitmap_iter_init(fdb_bitmap_iter_t* iter, 
+                     const fdb_bitmap_t* bitmap)
+{
+  iter->p_data = bitmap->p_data;
+  iter->m_num_words = FDB_BITMAP_NUM_WORDS(bitmap->m_max_bits);
+  iter->m_word_idx = 0;
+  iter->m_word = iter->m_num_words > 0 ? iter->p_data[0] : 0;
+}
+
+/**
+ * \brief Gets the next set element of the bitmap
+ *
+ * \param iter The iterator
+ * \param element Pointer where the next set element is stored
+ *
+ * \return True if there was a next set element. False otherwise
+ */
+static inline bool
+fdb_bitmap_iter_next(fdb_bitmap_iter_t* iter, 
+                     uint32_t* element)
+{
+  while(iter->m_word == 0)
+  {
+    if(++iter->m_word_idx >= iter->m_num_words)
+    {
+      return false;
+    }
+    iter->m_word = iter->p_data[iter->m_word_idx];
+  }
+  *element = (iter->m_word_idx << 6) + (uint32_t)__builtin_ctzll(iter->m_word);
+  iter->m_word &= iter->m_word - 1;
+  return true;
+}
+
 #ifdef __cplusplus
 }
 #endif
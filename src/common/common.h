@@ -10,5 +10,6 @@
 #include "memory/stack_allocator.h"
 #include "hashtable.h"
 #include "thread.h"
+#include "barrier.h"
 
 #endif
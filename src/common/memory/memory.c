@@ -5,6 +5,7 @@
 #include "numa_alloc.h"
 
 fdb_mem_allocator_t  global_mem_allocator;
+static volatile uint64_t m_num_allocs = 0;
 
 void*
 mem_alloc(fdb_mem_allocator_t* mem_allocator, 
@@ -32,6 +33,18 @@ mem_stats(fdb_mem_allocator_t* mem_allocator)
   return mem_allocator->p_mem_stats(mem_allocator->p_mem_state);
 }
 
+void
+fdb_mem_count_alloc()
+{
+  __sync_fetch_and_add(&m_num_allocs, 1);
+}
+
+uint64_t
+fdb_mem_num_allocs()
+{
+  return m_num_allocs;
+}
+
 fdb_mem_allocator_t*
 fdb_get_global_mem_allocator()
 {
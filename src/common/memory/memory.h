@@ -54,6 +54,23 @@ mem_free(fdb_mem_allocator_t* mem_allocator,
 fdb_mem_stats_t 
 mem_stats(fdb_mem_allocator_t* mem_allocator);
 
+/**
+ * \brief Records an allocation. Called by every allocator (numa, pool, stack
+ * and page) when it serves a block, whether through mem_alloc or directly
+ */
+void
+fdb_mem_count_alloc();
+
+/**
+ * \brief Gets the number of allocations served by all the allocators since
+ * the program started. The pages allocators take from their parents are
+ * counted as allocations too.
+ *
+ * \return The number of allocations performed
+ */
+uint64_t
+fdb_mem_num_allocs();
+
 /**
  * \brief gets the global mem  allocator
  *
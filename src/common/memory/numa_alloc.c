@@ -9,7 +9,6 @@
 #include <numa.h>
 #include <stdlib.h>
 
-
 int32_t numa_nodes() {
   return 0;
 }
@@ -29,6 +28,7 @@ void* fdb_numa_alloc(void* state,
   //}
   void* ptr = NULL;
   posix_memalign(&ptr, min_alignment, size);
+  fdb_mem_count_alloc();
   return ptr;
 }
 
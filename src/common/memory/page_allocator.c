@@ -86,6 +86,7 @@ fdb_page_alloc_alloc(fdb_page_alloc_t* palloc,
                      uint32_t size,
                      uint32_t hint)
 {
+  fdb_mem_count_alloc();
   fdb_mutex_lock(&palloc->m_mutex);
   FDB_ASSERT((size == palloc->m_ssize || 
              size == palloc->m_lsize) &&
@@ -6,6 +6,177 @@
 
 
 #define FDB_POOL_ALLOC_MIN_ALLOC 4096
+#define FDB_POOL_ALLOC_INVALID_SLOT 0xffffffff
+#define FDB_POOL_ALLOC_MAGAZINE_BATCH (FDB_POOL_ALLOC_MAGAZINE_SIZE / 2)
+
+// The slots handed out to threads and the list of pools with magazines are
+// shared by all pools and guarded by m_slots_mutex. While holding it, the
+// mutex of a pool is only ever tried, never waited for
+static fdb_mutex_t m_slots_mutex = {PTHREAD_MUTEX_INITIALIZER};
+static uint32_t m_num_slots = 0;
+static uint32_t m_free_slots[FDB_POOL_ALLOC_MAX_THREADS];
+static uint32_t m_num_free_slots = 0;
+static fdb_pool_alloc_t* p_first_pool = NULL;
+static pthread_key_t m_slot_key;
+static pthread_once_t m_slot_key_once = PTHREAD_ONCE_INIT;
+static __thread uint32_t m_slot = FDB_POOL_ALLOC_INVALID_SLOT;
+
+/**
+ * @brief Returns all the blocks cached by a magazine to the shared free list.
+ * The pool must be locked
+ */
+static void
+fdb_pool_alloc_drain_magazine(fdb_pool_alloc_t* palloc, 
+                              fdb_pool_alloc_magazine_t* magazine)
+{
+  while(magazine->p_first != NULL)
+  {
+    fdb_pool_alloc_header_t* hdr = (fdb_pool_alloc_header_t*)magazine->p_first;
+    magazine->p_first = hdr->p_next;
+    hdr->p_next = palloc->p_first_free;
+    palloc->p_first_free = hdr;
+  }
+  magazine->m_count = 0;
+  // Blocks handed out through the magazine are still in use
+  palloc->m_stats.m_used += magazine->m_used;
+  magazine->m_used = 0;
+}
+
+/**
+ * @brief Called when a thread holding a slot exits. Drains the magazines of
+ * the slot in every pool and hands the slot back, so threads that come and go
+ * keep getting magazines and no free block stays stranded in them
+ *
+ * @param value The slot of the thread plus one
+ */
+static void
+fdb_pool_alloc_thread_exit(void* value)
+{
+  uint32_t slot = (uint32_t)((uintptr_t)value - 1);
+  fdb_mutex_lock(&m_slots_mutex);
+  fdb_pool_alloc_t* palloc = p_first_pool;
+  while(palloc != NULL)
+  {
+    // A thread holding the mutex of a pool can be waiting for the slots mutex,
+    // e.g. while taking a page from a parent pool. Backing off avoids the
+    // deadlock, and restarting is safe since drained magazines stay empty
+    if(!fdb_mutex_trylock(&palloc->m_mutex))
+    {
+      fdb_mutex_unlock(&m_slots_mutex);
+      fdb_mutex_lock(&m_slots_mutex);
+      palloc = p_first_pool;
+      continue;
+    }
+    fdb_pool_alloc_drain_magazine(palloc, &palloc->p_magazines[slot]);
+    fdb_mutex_unlock(&palloc->m_mutex);
+    palloc = palloc->p_next_pool;
+  }
+  m_free_slots[m_num_free_slots++] = slot;
+  fdb_mutex_unlock(&m_slots_mutex);
+
+  // Blocks freed by later thread exit handlers go to the shared free list
+  m_slot = FDB_POOL_ALLOC_MAX_THREADS;
+}
+
+static void
+fdb_pool_alloc_slot_key_init()
+{
+  pthread_key_create(&m_slot_key, fdb_pool_alloc_thread_exit);
+}
+
+/**
+ * @brief Gets the magazine slot of the calling thread. Slots are handed out
+ * on first use and given back when the thread exits. Threads finding all
+ * FDB_POOL_ALLOC_MAX_THREADS slots taken get FDB_POOL_ALLOC_MAX_THREADS and
+ * always go through the shared free list
+ */
+static uint32_t
+fdb_pool_alloc_thread_slot()
+{
+  if(m_slot == FDB_POOL_ALLOC_INVALID_SLOT)
+  {
+    pthread_once(&m_slot_key_once, fdb_pool_alloc_slot_key_init);
+    uint32_t slot = FDB_POOL_ALLOC_MAX_THREADS;
+    fdb_mutex_lock(&m_slots_mutex);
+    if(m_num_free_slots > 0)
+    {
+      slot = m_free_slots[--m_num_free_slots];
+    }
+    else if(m_num_slots < FDB_POOL_ALLOC_MAX_THREADS)
+    {
+      slot = m_num_slots++;
+    }
+    fdb_mutex_unlock(&m_slots_mutex);
+    if(slot != FDB_POOL_ALLOC_MAX_THREADS)
+    {
+      pthread_setspecific(m_slot_key, (void*)((uintptr_t)slot + 1));
+    }
+    m_slot = slot;
+  }
+  return m_slot;
+}
+
+/**
+ * @brief Gets the magazine of the calling thread, or NULL if the pool has no
+ * magazines or the thread has no slot
+ */
+static fdb_pool_alloc_magazine_t*
+fdb_pool_alloc_get_magazine(fdb_pool_alloc_t* palloc)
+{
+  fdb_pool_alloc_magazine_t* magazines = palloc->p_magazines;
+  if(magazines == NULL)
+  {
+    return NULL;
+  }
+  uint32_t slot = fdb_pool_alloc_thread_slot();
+  if(slot == FDB_POOL_ALLOC_MAX_THREADS)
+  {
+    return NULL;
+  }
+  return &magazines[slot];
+}
+
+/**
+ * @brief Locks the shared state of the pool. The first time the lock is found
+ * taken by another thread, the per-thread magazines are created, so pools only
+ * used by a single thread never pay for them. Magazines are taken from the
+ * global allocator, since the parent allocator can be a stack allocator whose
+ * pages cannot hold them. Pools with magazines are registered so exiting
+ * threads can drain them
+ */
+static void
+fdb_pool_alloc_lock(fdb_pool_alloc_t* palloc)
+{
+  if(fdb_mutex_trylock(&palloc->m_mutex))
+  {
+    return;
+  }
+
+  if(palloc->p_magazines == NULL)
+  {
+    fdb_mutex_lock(&m_slots_mutex);
+    if(palloc->p_magazines == NULL)
+    {
+      uint32_t size = sizeof(fdb_pool_alloc_magazine_t)*FDB_POOL_ALLOC_MAX_THREADS;
+      fdb_pool_alloc_magazine_t* magazines = (fdb_pool_alloc_magazine_t*)mem_alloc(fdb_get_global_mem_allocator(), 
+                                                                                   FDB_POOL_ALLOC_MAGAZINE_ALIGNMENT, 
+                                                                                   size, 
+                                                                                   FDB_NO_HINT);
+      memset(magazines, 0, size);
+      palloc->p_prev_pool = NULL;
+      palloc->p_next_pool = p_first_pool;
+      if(p_first_pool != NULL)
+      {
+        p_first_pool->p_prev_pool = palloc;
+      }
+      p_first_pool = palloc;
+      fdb_mem_barrier();
+      palloc->p_magazines = magazines;
+    }
+    fdb_mutex_unlock(&m_slots_mutex);
+  }
+  fdb_mutex_lock(&palloc->m_mutex);
+}
 
 
 void* 
@@ -98,6 +269,29 @@ fdb_pool_alloc_release(fdb_pool_alloc_t* palloc)
 void
 fdb_pool_alloc_flush(fdb_pool_alloc_t* fdb_pool_alloc)
 {
+  // Exiting threads stop draining the magazines before they are released.
+  // The slots mutex is not held while releasing the pages, since the parent
+  // allocator can be a pool too
+  fdb_mutex_lock(&m_slots_mutex);
+  if(fdb_pool_alloc->p_magazines != NULL)
+  {
+    if(fdb_pool_alloc->p_prev_pool != NULL)
+    {
+      fdb_pool_alloc->p_prev_pool->p_next_pool = fdb_pool_alloc->p_next_pool;
+    }
+    else
+    {
+      p_first_pool = fdb_pool_alloc->p_next_pool;
+    }
+    if(fdb_pool_alloc->p_next_pool != NULL)
+    {
+      fdb_pool_alloc->p_next_pool->p_prev_pool = fdb_pool_alloc->p_prev_pool;
+    }
+    fdb_pool_alloc->p_prev_pool = NULL;
+    fdb_pool_alloc->p_next_pool = NULL;
+  }
+  fdb_mutex_unlock(&m_slots_mutex);
+
   fdb_mutex_lock(&fdb_pool_alloc->m_mutex);
   void* next = fdb_pool_alloc->p_first_chunk;
   while(next != NULL)
@@ -107,6 +301,17 @@ fdb_pool_alloc_flush(fdb_pool_alloc_t* fdb_pool_alloc)
     next = hdr->p_next;
     mem_free(fdb_pool_alloc->p_allocator, to_release);
   }
+  fdb_pool_alloc->p_first_chunk = NULL;
+  fdb_pool_alloc->p_last_chunk = NULL;
+  fdb_pool_alloc->p_first_free = NULL;
+  fdb_pool_alloc->m_next_free = 0;
+
+  // The blocks cached by the magazines lived in the released pages
+  if(fdb_pool_alloc->p_magazines != NULL)
+  {
+    mem_free(fdb_get_global_mem_allocator(), fdb_pool_alloc->p_magazines);
+    fdb_pool_alloc->p_magazines = NULL;
+  }
   fdb_pool_alloc->m_stats.m_allocated = 0;
   fdb_pool_alloc->m_stats.m_used = 0;
   fdb_pool_alloc->m_stats.m_lost = 0;
@@ -114,30 +319,18 @@ fdb_pool_alloc_flush(fdb_pool_alloc_t* fdb_pool_alloc)
 }
 
 /**
- * @brief Allocates a memory block in a numa node
+ * @brief Takes a block from the shared free list or, if it is empty, from the
+ * last page. The pool must be locked
  *
- * @param ptr The state
- * @param alignment The alignment of the memory allocator 
- * @param size The size in bytes of the memory block to allocate
- * @param hint The hint to the allocator. It corresponds to id of the allocated
- * block
+ * @param palloc The pool allocator
+ * @param hint The hint to pass to the parent allocator if a page is needed
  *
- * @return 
+ * @return The block
  */
-void* fdb_pool_alloc_alloc(fdb_pool_alloc_t* palloc, 
-                           uint32_t alignment, 
-                           uint32_t size,
-                           uint32_t hint)
+static void*
+fdb_pool_alloc_carve(fdb_pool_alloc_t* palloc, 
+                     uint32_t hint)
 {
-
-  fdb_mutex_lock(&palloc->m_mutex);
-
-#ifdef FDB_ENABLE_ASSERTS
-  uint32_t min_alignment = alignment > FDB_MIN_ALIGNMENT ? alignment : FDB_MIN_ALIGNMENT;
-  FDB_ASSERT(palloc->m_alignment == min_alignment && "Requested alignment mismatches the pool allocator alignment");
-  FDB_ASSERT(palloc->m_block_size == size && "Requested size mismatches the pool allocator size");
-#endif
-
   void* ret = NULL;
   if(palloc->p_first_free != NULL)
   {
@@ -194,10 +387,63 @@ void* fdb_pool_alloc_alloc(fdb_pool_alloc_t* palloc,
       palloc->m_next_free += palloc->m_grow_offset;
 
       palloc->m_stats.m_allocated += (palloc->m_page_size-palloc->m_grow_offset);
-      palloc->m_stats.m_used += palloc->m_grow_offset;
       palloc->m_stats.m_lost += palloc->m_lost_bytes;
     }
   }
+  return ret;
+}
+
+/**
+ * @brief Allocates a memory block in a numa node
+ *
+ * @param ptr The state
+ * @param alignment The alignment of the memory allocator 
+ * @param size The size in bytes of the memory block to allocate
+ * @param hint The hint to the allocator. It corresponds to id of the allocated
+ * block
+ *
+ * @return 
+ */
+void* fdb_pool_alloc_alloc(fdb_pool_alloc_t* palloc, 
+                           uint32_t alignment, 
+                           uint32_t size,
+                           uint32_t hint)
+{
+
+#ifdef FDB_ENABLE_ASSERTS
+  uint32_t min_alignment = alignment > FDB_MIN_ALIGNMENT ? alignment : FDB_MIN_ALIGNMENT;
+  FDB_ASSERT(palloc->m_alignment == min_alignment && "Requested alignment mismatches the pool allocator alignment");
+  FDB_ASSERT(palloc->m_block_size == size && "Requested size mismatches the pool allocator size");
+#endif
+
+  fdb_mem_count_alloc();
+  fdb_pool_alloc_magazine_t* magazine = fdb_pool_alloc_get_magazine(palloc);
+  if(magazine != NULL)
+  {
+    if(magazine->m_count == 0)
+    {
+      // Refilling half a magazine in a single critical section
+      fdb_pool_alloc_lock(palloc);
+      for(uint32_t i = 0; i < FDB_POOL_ALLOC_MAGAZINE_BATCH; ++i)
+      {
+        fdb_pool_alloc_header_t* hdr = (fdb_pool_alloc_header_t*)fdb_pool_alloc_carve(palloc, hint);
+        hdr->p_next = magazine->p_first;
+        magazine->p_first = hdr;
+      }
+      magazine->m_count = FDB_POOL_ALLOC_MAGAZINE_BATCH;
+      fdb_mem_barrier();
+      fdb_mutex_unlock(&palloc->m_mutex);
+    }
+    fdb_pool_alloc_header_t* hdr = (fdb_pool_alloc_header_t*)magazine->p_first;
+    magazine->p_first = hdr->p_next;
+    magazine->m_count--;
+    magazine->m_used += palloc->m_grow_offset;
+    return hdr;
+  }
+
+  fdb_pool_alloc_lock(palloc);
+  void* ret = fdb_pool_alloc_carve(palloc, hint);
+  palloc->m_stats.m_used += palloc->m_grow_offset;
   fdb_mem_barrier();
   //printf("NEXT FREE %lu LAST CHUNK %lu \n", palloc->m_next_free, (uint64_t)palloc->p_last_chunk);
   fdb_mutex_unlock(&palloc->m_mutex);
@@ -214,7 +460,33 @@ void* fdb_pool_alloc_alloc(fdb_pool_alloc_t* palloc,
 void fdb_pool_alloc_free(fdb_pool_alloc_t* palloc, 
                          void* ptr )
 {
-  fdb_mutex_lock(&palloc->m_mutex);
+  fdb_pool_alloc_magazine_t* magazine = fdb_pool_alloc_get_magazine(palloc);
+  if(magazine != NULL)
+  {
+    fdb_pool_alloc_header_t* hdr = (fdb_pool_alloc_header_t*)ptr;
+    hdr->p_next = magazine->p_first;
+    magazine->p_first = ptr;
+    magazine->m_count++;
+    magazine->m_used -= palloc->m_grow_offset;
+    if(magazine->m_count > FDB_POOL_ALLOC_MAGAZINE_SIZE)
+    {
+      // Spilling half a magazine to the shared free list
+      fdb_pool_alloc_lock(palloc);
+      for(uint32_t i = 0; i < FDB_POOL_ALLOC_MAGAZINE_BATCH; ++i)
+      {
+        hdr = (fdb_pool_alloc_header_t*)magazine->p_first;
+        magazine->p_first = hdr->p_next;
+        hdr->p_next = palloc->p_first_free;
+        palloc->p_first_free = hdr;
+      }
+      magazine->m_count -= FDB_POOL_ALLOC_MAGAZINE_BATCH;
+      fdb_mem_barrier();
+      fdb_mutex_unlock(&palloc->m_mutex);
+    }
+    return;
+  }
+
+  fdb_pool_alloc_lock(palloc);
   fdb_pool_alloc_header_t* hdr = (fdb_pool_alloc_header_t*)ptr;
   hdr->p_next = palloc->p_first_free;
   palloc->p_first_free = ptr;
@@ -227,6 +499,15 @@ fdb_pool_alloc_stats(fdb_pool_alloc_t* palloc)
 {
   fdb_mutex_lock(&palloc->m_mutex);
   fdb_mem_stats_t stats =  palloc->m_stats;
+  if(palloc->p_magazines != NULL)
+  {
+    // Blocks cached by the magazines are free, only what the threads handed
+    // out counts as used
+    for(uint32_t i = 0; i < FDB_POOL_ALLOC_MAX_THREADS; ++i)
+    {
+      stats.m_used += (uint64_t)palloc->p_magazines[i].m_used;
+    }
+  }
   fdb_mutex_unlock(&palloc->m_mutex);
   return stats;
 }
@@ -6,6 +6,7 @@
 
 #include "memory.h"
 #include "../types.h"
+#include "../platform.h"
 #include "../mutex.h"
 
 #ifdef __cplusplus
@@ -17,6 +18,18 @@ typedef struct fdb_pool_alloc_header_t
   void*   p_next;
 } fdb_pool_alloc_header_t;
 
+/**
+ * \brief Per-thread cache of free blocks of a pool allocator. Only the owning
+ * thread touches it, so blocks are taken and returned without locking. It is
+ * refilled from and spilled to the shared free list in batches
+ */
+typedef struct fdb_pool_alloc_magazine_t
+{
+  FDB_ALIGNED(void*, p_first, FDB_POOL_ALLOC_MAGAZINE_ALIGNMENT); //< The first block of the local free list
+  uint32_t                m_count;        //< The number of blocks in the local free list
+  int64_t                 m_used;         //< The bytes handed out minus the bytes taken back through this magazine
+} fdb_pool_alloc_magazine_t;
+
 typedef struct fdb_pool_alloc_t
 {
   void*                   p_first_chunk; //< Pointer to the first memory chunk/page
@@ -32,6 +45,9 @@ typedef struct fdb_pool_alloc_t
   fdb_mem_allocator_t     m_super;
   fdb_mem_stats_t         m_stats;
   fdb_mutex_t             m_mutex;
+  fdb_pool_alloc_magazine_t* p_magazines; //< The per-thread magazines. NULL until the pool is contended
+  struct fdb_pool_alloc_t*   p_prev_pool; //< The previous pool with magazines, drained when threads exit
+  struct fdb_pool_alloc_t*   p_next_pool; //< The next pool with magazines, drained when threads exit
 } fdb_pool_alloc_t;
 
 /**
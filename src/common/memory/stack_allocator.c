@@ -199,6 +199,7 @@ void* fdb_stack_alloc_alloc(fdb_stack_alloc_t* salloc,
   FDB_ASSERT(salloc->m_page_size >= alignment && "Alignment cannot be larger than the page alignment");
   int32_t min_alignment = alignment > FDB_MIN_ALIGNMENT ? alignment : FDB_MIN_ALIGNMENT;
 
+  fdb_mem_count_alloc();
   fdb_mutex_lock(&salloc->m_mutex);
 
   uint32_t modulo = ((uint64_t)salloc->p_next_page + salloc->m_next_offset) & (min_alignment-1);
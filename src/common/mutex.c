@@ -24,3 +24,9 @@ fdb_mutex_unlock(fdb_mutex_t* mutex)
 {
   pthread_mutex_unlock(&mutex->m_mutex);
 }
+
+bool
+fdb_mutex_trylock(fdb_mutex_t* mutex)
+{
+  return pthread_mutex_trylock(&mutex->m_mutex) == 0;
+}
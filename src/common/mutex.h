@@ -4,6 +4,7 @@
 #define _FDB_MUTEX_H_ value
 
 #include <pthread.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +49,16 @@ fdb_mutex_lock(fdb_mutex_t*  mutex);
 void
 fdb_mutex_unlock(fdb_mutex_t* mutex);
 
+/**
+ * \brief Tries to lock a mutex without blocking
+ *
+ * \param mutex The mutex to lock
+ *
+ * \return True if the mutex was locked. False if it is held by another thread
+ */
+bool
+fdb_mutex_trylock(fdb_mutex_t* mutex);
+
 #ifdef __cplusplus
 }
 #endif
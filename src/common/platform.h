@@ -50,6 +50,10 @@
 
 #define FDB_MIN_ALIGNMENT                     16
 
+#define FDB_POOL_ALLOC_MAX_THREADS            64 // Threads beyond this one share the locked free list
+#define FDB_POOL_ALLOC_MAGAZINE_SIZE          32 // Blocks a thread caches before spilling half of them
+#define FDB_POOL_ALLOC_MAGAZINE_ALIGNMENT     64
+
 #define FDB_BTREE_ALIGNMENT                   64 
 #define FDB_BTREE_PAGE_SIZE                   KILOBYTES(4)
 
@@ -67,15 +71,45 @@
 #define FDB_DATABASE_TABLE_ALIGNMENT          64
 #define FDB_DATABASE_BITTABLE_ALIGNMENT       64 
 #define FDB_DATABASE_GLOBAL_ALIGNMENT         64 
-#define FDB_DATABASE_TABLE_PAGE_SIZE          KILOBYTES(4)
+#define FDB_DATABASE_TABLE_PAGE_SIZE          KILOBYTES(16)
 #define FDB_DATABASE_BITTABLE_PAGE_SIZE       KILOBYTES(4)
+#define FDB_DATABASE_REFTABLE_PAGE_SIZE       KILOBYTES(16)
 #define FDB_DATABASE_GLOBAL_PAGE_SIZE         KILOBYTES(4)
 
 #define FDB_INVALID_ID                        0xffffffff
 #define FDB_INVALID_TABLE_ID                  FDB_INVALID_ID 
+#ifndef FDB_TABLE_BLOCK_SIZE
 #define FDB_TABLE_BLOCK_SIZE                  256
+#endif
+#if FDB_TABLE_BLOCK_SIZE % 64 != 0
+#error "FDB_TABLE_BLOCK_SIZE must be a multiple of 64"
+#endif
+#define FDB_TABLE_BLOCK_DENSE_THRESHOLD       (FDB_TABLE_BLOCK_SIZE - FDB_TABLE_BLOCK_SIZE/4)
+#define FDB_TABLE_SEGMENT_TARGET_SIZE         KILOBYTES(16)
+#define FDB_TABLE_MAX_SEGMENT_SIZE            64
+#define FDB_TABLE_DIRECTORY_FANOUT            512
+#define FDB_TABLE_DIRECTORY_ALIGNMENT         64
+#define FDB_TABLE_DIRECTORY_PAGE_SIZE         KILOBYTES(64)
+#define FDB_TABLE_MORSEL_SIZE                 4
+#define FDB_TABLE_BLOCK_CHANGED_ALIGNMENT     64
+#define FDB_TABLE_BLOCK_CHANGED_PAGE_SIZE     KILOBYTES(16)
+#define FDB_TABLE_EVENT_LOG_CHUNK_SIZE        1024
+#define FDB_TABLE_EVENT_LOG_ALIGNMENT         64
+#define FDB_TABLE_EVENT_LOG_PAGE_SIZE         KILOBYTES(64)
 #define FDB_MAX_TABLE_NAME                    256
 
+#define FDB_BITTABLE_CONTAINER_BITS           4096
+#if FDB_BITTABLE_CONTAINER_BITS % FDB_TABLE_BLOCK_SIZE != 0 || FDB_BITTABLE_CONTAINER_BITS > 65536
+#error "FDB_BITTABLE_CONTAINER_BITS must be a multiple of FDB_TABLE_BLOCK_SIZE no larger than 65536"
+#endif
+#define FDB_BITTABLE_INLINE_CAPACITY          24
+#define FDB_BITTABLE_CONTAINER_ALIGNMENT      64
+#define FDB_BITTABLE_CONTAINER_PAGE_SIZE      KILOBYTES(4)
+#define FDB_BITTABLE_CHUNK_ALIGNMENT          64
+#define FDB_BITTABLE_CHUNK_PAGE_SIZE          KILOBYTES(4)
+#define FDB_REFTABLE_LEVEL_ALIGNMENT          64
+#define FDB_REFTABLE_LEVEL_PAGE_SIZE          KILOBYTES(4)
+
 #define FDB_MAX_COMPONENT_FIELDS              32
 
 #define FDB_REFLECTION_STRUCT_PAGE_SIZE       KILOBYTES(4)
@@ -107,11 +141,15 @@
 #define FCC_MAX_SUBPLAN_NODES                     32
 #define FCC_MAX_TASK_PARENTS                      FCC_MAX_OPERATOR_NUM_COLUMNS
 #define FCC_MAX_TASK_CHILDREN                     FCC_MAX_OPERATOR_NUM_COLUMNS
+#define FCC_MAX_MULTI_JOIN_INPUTS                 FCC_MAX_OPERATOR_NUM_COLUMNS
+#define FCC_MIN_MULTI_JOIN_INPUTS                 3
+#define FCC_MAX_FOREACH_SYSTEMS                   16
 
 #define FCC_MAX_CTOR_PARAMS                       16
 #define FCC_MAX_SYSTEM_COMPONENTS                 FCC_MAX_OPERATOR_NUM_COLUMNS
 #define FCC_MAX_HAS_COMPONENTS                    FCC_MAX_OPERATOR_NUM_COLUMNS
 #define FCC_MAX_HAS_NOT_COMPONENTS                FCC_MAX_HAS_COMPONENTS
+#define FCC_MAX_CHANGED_COMPONENTS                FCC_MAX_HAS_COMPONENTS
 #define FCC_MAX_HAS_TAGS                          16 
 #define FCC_MAX_HAS_NOT_TAGS                      FCC_MAX_HAS_TAGS
 #define FCC_MAX_FILTER_FUNC                       8 
@@ -42,11 +42,16 @@ fdb_str_builder_append(fdb_str_builder_t* str_builder,
   va_start(myargs, str);
 
   uint32_t nwritten = 0;
+  va_list args;
+  va_copy(args, myargs);
   while( (nwritten = vsnprintf(&str_builder->p_buffer[str_builder->m_pos], 
                                str_builder->m_capacity - str_builder->m_pos,
                                str, 
-                               myargs)) > (str_builder->m_capacity - str_builder->m_pos - 1))
+                               args)) > (str_builder->m_capacity - str_builder->m_pos - 1))
   {
+    // vsnprintf consumes the va_list, thus a fresh copy is needed to retry
+    va_end(args);
+    va_copy(args, myargs);
     uint32_t new_capacity = str_builder->m_capacity + 2048;
     char* new_buffer = (char*) mem_alloc(fdb_get_global_mem_allocator(), 
                                          1, 
@@ -64,6 +69,7 @@ fdb_str_builder_append(fdb_str_builder_t* str_builder,
   str_builder->p_buffer[str_builder->m_pos] = '\0';
 
   /* Clean up the va_list */
+  va_end(args);
   va_end(myargs);
 }
 
@@ -0,0 +1,67 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. **/
+
+#include "cchar_ptr_array.h"
+#include <common/memory/memory.h>
+
+#include <string.h>
+
+
+
+
+cchar_ptr_array_t
+cchar_ptr_array_init()
+{
+  cchar_ptr_array_t array;
+  array.m_count = 0;
+  array.m_capacity = 16;
+  array.m_data = (const char**)mem_alloc(fdb_get_global_mem_allocator(), 
+                           64, 
+                           sizeof(const char*)*array.m_capacity, 
+                           FDB_NO_HINT);
+  return array;
+}
+
+void
+cchar_ptr_array_release(cchar_ptr_array_t* array)
+{
+  mem_free(fdb_get_global_mem_allocator(), array->m_data);
+}
+
+void
+cchar_ptr_array_append(cchar_ptr_array_t* array, const char** e)
+{
+  if(array->m_count == array->m_capacity)
+  {
+    uint32_t tmp = array->m_capacity*2;
+    const char** buffer = (const char**)mem_alloc(fdb_get_global_mem_allocator(), 
+                             64, 
+                             sizeof(const char*)*tmp, 
+                             FDB_NO_HINT);
+    memcpy(buffer, array->m_data, sizeof(const char*)*array->m_capacity);
+    array->m_capacity = tmp;
+    mem_free(fdb_get_global_mem_allocator(), array->m_data);
+    array->m_data = buffer;
+  }
+
+  array->m_data[array->m_count++] = *e;
+}
+
+void
+cchar_ptr_array_copy(cchar_ptr_array_t* dst, 
+                            cchar_ptr_array_t* src)
+{
+  if(dst->m_capacity < src->m_capacity)
+  {
+    mem_free(fdb_get_global_mem_allocator(), dst->m_data);
+    dst->m_capacity = src->m_capacity;
+    dst->m_data = (const char**)mem_alloc(fdb_get_global_mem_allocator(), 
+                            64, 
+                            sizeof(const char*)*dst->m_capacity, 
+                            FDB_NO_HINT);
+  }
+  dst->m_count = src->m_count;
+  memcpy(dst->m_data, src->m_data, sizeof(const char*)*dst->m_count);
+}
+
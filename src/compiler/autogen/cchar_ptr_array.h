@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  CCHAR_PTR   specifies the header guard name
+**  cchar_ptr  specifies the prefix of the array name and methods
+**   specifies the forward declaration statement for the 
+**  array type
+**   specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_CCHAR_PTR_H_
+#define _FDB_CCHAR_PTR_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+struct cchar_ptr_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  const char**   m_data;
+};
+
+cchar_ptr_array_t
+cchar_ptr_array_init();
+
+void
+cchar_ptr_array_release(cchar_ptr_array_t* array);
+
+void
+cchar_ptr_array_append(cchar_ptr_array_t* array, 
+                              const char** e);
+
+void
+cchar_ptr_array_copy(cchar_ptr_array_t* dst, 
+                            cchar_ptr_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
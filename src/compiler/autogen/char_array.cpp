@@ -0,0 +1,67 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. **/
+
+#include "char_array.h"
+#include <common/memory/memory.h>
+
+#include <string.h>
+
+
+
+
+char_array_t
+char_array_init()
+{
+  char_array_t array;
+  array.m_count = 0;
+  array.m_capacity = 16;
+  array.m_data = (char*)mem_alloc(fdb_get_global_mem_allocator(), 
+                           64, 
+                           sizeof(char)*array.m_capacity, 
+                           FDB_NO_HINT);
+  return array;
+}
+
+void
+char_array_release(char_array_t* array)
+{
+  mem_free(fdb_get_global_mem_allocator(), array->m_data);
+}
+
+void
+char_array_append(char_array_t* array, char* e)
+{
+  if(array->m_count == array->m_capacity)
+  {
+    uint32_t tmp = array->m_capacity*2;
+    char* buffer = (char*)mem_alloc(fdb_get_global_mem_allocator(), 
+                             64, 
+                             sizeof(char)*tmp, 
+                             FDB_NO_HINT);
+    memcpy(buffer, array->m_data, sizeof(char)*array->m_capacity);
+    array->m_capacity = tmp;
+    mem_free(fdb_get_global_mem_allocator(), array->m_data);
+    array->m_data = buffer;
+  }
+
+  array->m_data[array->m_count++] = *e;
+}
+
+void
+char_array_copy(char_array_t* dst, 
+                            char_array_t* src)
+{
+  if(dst->m_capacity < src->m_capacity)
+  {
+    mem_free(fdb_get_global_mem_allocator(), dst->m_data);
+    dst->m_capacity = src->m_capacity;
+    dst->m_data = (char*)mem_alloc(fdb_get_global_mem_allocator(), 
+                            64, 
+                            sizeof(char)*dst->m_capacity, 
+                            FDB_NO_HINT);
+  }
+  dst->m_count = src->m_count;
+  memcpy(dst->m_data, src->m_data, sizeof(char)*dst->m_count);
+}
+
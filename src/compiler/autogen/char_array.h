@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  CHAR   specifies the header guard name
+**  char  specifies the prefix of the array name and methods
+**   specifies the forward declaration statement for the 
+**  array type
+**   specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_CHAR_H_
+#define _FDB_CHAR_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+struct char_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  char*   m_data;
+};
+
+char_array_t
+char_array_init();
+
+void
+char_array_release(char_array_t* array);
+
+void
+char_array_append(char_array_t* array, 
+                              char* e);
+
+void
+char_array_copy(char_array_t* dst, 
+                            char_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. **/
+
+#include "fcc_decl_array.h"
+#include <common/memory/memory.h>
+
+#include <string.h>
+
+
+
+
+fcc_decl_array_t
+fcc_decl_array_init()
+{
+  fcc_decl_array_t array;
+  array.m_count = 0;
+  array.m_capacity = 16;
+  array.m_data = (void**)mem_alloc(fdb_get_global_mem_allocator(), 
+                           64, 
+                           sizeof(void*)*array.m_capacity, 
+                           FDB_NO_HINT);
+  return array;
+}
+
+void
+fcc_decl_array_release(fcc_decl_array_t* array)
+{
+  mem_free(fdb_get_global_mem_allocator(), array->m_data);
+}
+
+void
+fcc_decl_array_append(fcc_decl_array_t* array, void** e)
+{
+  if(array->m_count == array->m_capacity)
+  {
+    uint32_t tmp = array->m_capacity*2;
+    void** buffer = (void**)mem_alloc(fdb_get_global_mem_allocator(), 
+                             64, 
+                             sizeof(void*)*tmp, 
+                             FDB_NO_HINT);
+    memcpy(buffer, array->m_data, sizeof(void*)*array->m_capacity);
+    array->m_capacity = tmp;
+    mem_free(fdb_get_global_mem_allocator(), array->m_data);
+    array->m_data = buffer;
+  }
+
+  array->m_data[array->m_count++] = *e;
+}
+
+void
+fcc_decl_array_copy(fcc_decl_array_t* dst, 
+                            fcc_decl_array_t* src)
+{
+  if(dst->m_capacity < src->m_capacity)
+  {
+    mem_free(fdb_get_global_mem_allocator(), dst->m_data);
+    dst->m_capacity = src->m_capacity;
+    dst->m_data = (void**)mem_alloc(fdb_get_global_mem_allocator(), 
+                            64, 
+                            sizeof(void*)*dst->m_capacity, 
+                            FDB_NO_HINT);
+  }
+  dst->m_count = src->m_count;
+  memcpy(dst->m_data, src->m_data, sizeof(void*)*dst->m_count);
+}
+
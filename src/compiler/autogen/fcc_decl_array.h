@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  FCC_DECL   specifies the header guard name
+**  fcc_decl  specifies the prefix of the array name and methods
+**   specifies the forward declaration statement for the 
+**  array type
+**   specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_FCC_DECL_H_
+#define _FDB_FCC_DECL_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+struct fcc_decl_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  void**   m_data;
+};
+
+fcc_decl_array_t
+fcc_decl_array_init();
+
+void
+fcc_decl_array_release(fcc_decl_array_t* array);
+
+void
+fcc_decl_array_append(fcc_decl_array_t* array, 
+                              void** e);
+
+void
+fcc_decl_array_copy(fcc_decl_array_t* dst, 
+                            fcc_decl_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
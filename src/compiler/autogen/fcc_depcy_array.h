@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  FCC_DEPCY   specifies the header guard name
+**  fcc_depcy  specifies the prefix of the array name and methods
+**  struct fcc_depcy_t; specifies the forward declaration statement for the 
+**  array type
+**  #include "../driver.h" specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_FCC_DEPCY_H_
+#define _FDB_FCC_DEPCY_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct fcc_depcy_t;
+
+struct fcc_depcy_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  fcc_depcy_t*   m_data;
+};
+
+fcc_depcy_array_t
+fcc_depcy_array_init();
+
+void
+fcc_depcy_array_release(fcc_depcy_array_t* array);
+
+void
+fcc_depcy_array_append(fcc_depcy_array_t* array, 
+                              fcc_depcy_t* e);
+
+void
+fcc_depcy_array_copy(fcc_depcy_array_t* dst, 
+                            fcc_depcy_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
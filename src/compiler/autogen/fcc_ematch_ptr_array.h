@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  FCC_EMATCH_PTR   specifies the header guard name
+**  fcc_ematch_ptr  specifies the prefix of the array name and methods
+**  struct fcc_entity_match_t; specifies the forward declaration statement for the 
+**  array type
+**  #include "../fcc_context.h" specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_FCC_EMATCH_PTR_H_
+#define _FDB_FCC_EMATCH_PTR_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct fcc_entity_match_t;
+
+struct fcc_ematch_ptr_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  fcc_entity_match_t**   m_data;
+};
+
+fcc_ematch_ptr_array_t
+fcc_ematch_ptr_array_init();
+
+void
+fcc_ematch_ptr_array_release(fcc_ematch_ptr_array_t* array);
+
+void
+fcc_ematch_ptr_array_append(fcc_ematch_ptr_array_t* array, 
+                              fcc_entity_match_t** e);
+
+void
+fcc_ematch_ptr_array_copy(fcc_ematch_ptr_array_t* dst, 
+                            fcc_ematch_ptr_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. **/
+
+#include "fcc_stmt_ptr_array.h"
+#include <common/memory/memory.h>
+
+#include <string.h>
+
+#include "../fcc_context.h"
+
+
+fcc_stmt_ptr_array_t
+fcc_stmt_ptr_array_init()
+{
+  fcc_stmt_ptr_array_t array;
+  array.m_count = 0;
+  array.m_capacity = 16;
+  array.m_data = (fcc_stmt_t**)mem_alloc(fdb_get_global_mem_allocator(), 
+                           64, 
+                           sizeof(fcc_stmt_t*)*array.m_capacity, 
+                           FDB_NO_HINT);
+  return array;
+}
+
+void
+fcc_stmt_ptr_array_release(fcc_stmt_ptr_array_t* array)
+{
+  mem_free(fdb_get_global_mem_allocator(), array->m_data);
+}
+
+void
+fcc_stmt_ptr_array_append(fcc_stmt_ptr_array_t* array, fcc_stmt_t** e)
+{
+  if(array->m_count == array->m_capacity)
+  {
+    uint32_t tmp = array->m_capacity*2;
+    fcc_stmt_t** buffer = (fcc_stmt_t**)mem_alloc(fdb_get_global_mem_allocator(), 
+                             64, 
+                             sizeof(fcc_stmt_t*)*tmp, 
+                             FDB_NO_HINT);
+    memcpy(buffer, array->m_data, sizeof(fcc_stmt_t*)*array->m_capacity);
+    array->m_capacity = tmp;
+    mem_free(fdb_get_global_mem_allocator(), array->m_data);
+    array->m_data = buffer;
+  }
+
+  array->m_data[array->m_count++] = *e;
+}
+
+void
+fcc_stmt_ptr_array_copy(fcc_stmt_ptr_array_t* dst, 
+                            fcc_stmt_ptr_array_t* src)
+{
+  if(dst->m_capacity < src->m_capacity)
+  {
+    mem_free(fdb_get_global_mem_allocator(), dst->m_data);
+    dst->m_capacity = src->m_capacity;
+    dst->m_data = (fcc_stmt_t**)mem_alloc(fdb_get_global_mem_allocator(), 
+                            64, 
+                            sizeof(fcc_stmt_t*)*dst->m_capacity, 
+                            FDB_NO_HINT);
+  }
+  dst->m_count = src->m_count;
+  memcpy(dst->m_data, src->m_data, sizeof(fcc_stmt_t*)*dst->m_count);
+}
+
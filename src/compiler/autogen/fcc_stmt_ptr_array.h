@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  FCC_STMT_PTR   specifies the header guard name
+**  fcc_stmt_ptr  specifies the prefix of the array name and methods
+**  struct fcc_stmt_t; specifies the forward declaration statement for the 
+**  array type
+**  #include "../fcc_context.h" specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_FCC_STMT_PTR_H_
+#define _FDB_FCC_STMT_PTR_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct fcc_stmt_t;
+
+struct fcc_stmt_ptr_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  fcc_stmt_t**   m_data;
+};
+
+fcc_stmt_ptr_array_t
+fcc_stmt_ptr_array_init();
+
+void
+fcc_stmt_ptr_array_release(fcc_stmt_ptr_array_t* array);
+
+void
+fcc_stmt_ptr_array_append(fcc_stmt_ptr_array_t* array, 
+                              fcc_stmt_t** e);
+
+void
+fcc_stmt_ptr_array_copy(fcc_stmt_ptr_array_t* dst, 
+                            fcc_stmt_ptr_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
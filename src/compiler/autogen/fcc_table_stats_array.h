@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  FCC_TABLE_STATS   specifies the header guard name
+**  fcc_table_stats  specifies the prefix of the array name and methods
+**  struct fcc_table_stats_t; specifies the forward declaration statement for the 
+**  array type
+**  #include "../frontend/transforms.h" specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_FCC_TABLE_STATS_H_
+#define _FDB_FCC_TABLE_STATS_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct fcc_table_stats_t;
+
+struct fcc_table_stats_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  fcc_table_stats_t*   m_data;
+};
+
+fcc_table_stats_array_t
+fcc_table_stats_array_init();
+
+void
+fcc_table_stats_array_release(fcc_table_stats_array_t* array);
+
+void
+fcc_table_stats_array_append(fcc_table_stats_array_t* array, 
+                              fcc_table_stats_t* e);
+
+void
+fcc_table_stats_array_copy(fcc_table_stats_array_t* dst, 
+                            fcc_table_stats_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
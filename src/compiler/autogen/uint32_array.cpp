@@ -0,0 +1,67 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. **/
+
+#include "uint32_array.h"
+#include <common/memory/memory.h>
+
+#include <string.h>
+
+
+
+
+uint32_array_t
+uint32_array_init()
+{
+  uint32_array_t array;
+  array.m_count = 0;
+  array.m_capacity = 16;
+  array.m_data = (uint32_t*)mem_alloc(fdb_get_global_mem_allocator(), 
+                           64, 
+                           sizeof(uint32_t)*array.m_capacity, 
+                           FDB_NO_HINT);
+  return array;
+}
+
+void
+uint32_array_release(uint32_array_t* array)
+{
+  mem_free(fdb_get_global_mem_allocator(), array->m_data);
+}
+
+void
+uint32_array_append(uint32_array_t* array, uint32_t* e)
+{
+  if(array->m_count == array->m_capacity)
+  {
+    uint32_t tmp = array->m_capacity*2;
+    uint32_t* buffer = (uint32_t*)mem_alloc(fdb_get_global_mem_allocator(), 
+                             64, 
+                             sizeof(uint32_t)*tmp, 
+                             FDB_NO_HINT);
+    memcpy(buffer, array->m_data, sizeof(uint32_t)*array->m_capacity);
+    array->m_capacity = tmp;
+    mem_free(fdb_get_global_mem_allocator(), array->m_data);
+    array->m_data = buffer;
+  }
+
+  array->m_data[array->m_count++] = *e;
+}
+
+void
+uint32_array_copy(uint32_array_t* dst, 
+                            uint32_array_t* src)
+{
+  if(dst->m_capacity < src->m_capacity)
+  {
+    mem_free(fdb_get_global_mem_allocator(), dst->m_data);
+    dst->m_capacity = src->m_capacity;
+    dst->m_data = (uint32_t*)mem_alloc(fdb_get_global_mem_allocator(), 
+                            64, 
+                            sizeof(uint32_t)*dst->m_capacity, 
+                            FDB_NO_HINT);
+  }
+  dst->m_count = src->m_count;
+  memcpy(dst->m_data, src->m_data, sizeof(uint32_t)*dst->m_count);
+}
+
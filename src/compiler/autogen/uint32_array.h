@@ -0,0 +1,49 @@
+
+
+/** THIS FILE IS AUTOGENERATED DO NOT EDIT THIS FILE. 
+**
+**  UINT32   specifies the header guard name
+**  uint32  specifies the prefix of the array name and methods
+**   specifies the forward declaration statement for the 
+**  array type
+**   specifies the include statement in the .cpp file 
+**  to include the header with the array type
+*/
+
+#ifndef _FDB_UINT32_H_
+#define _FDB_UINT32_H_
+
+#include <common/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+struct uint32_array_t
+{
+  uint32_t          m_count;
+  uint32_t          m_capacity;
+  uint32_t*   m_data;
+};
+
+uint32_array_t
+uint32_array_init();
+
+void
+uint32_array_release(uint32_array_t* array);
+
+void
+uint32_array_append(uint32_array_t* array, 
+                              uint32_t* e);
+
+void
+uint32_array_copy(uint32_array_t* dst, 
+                            uint32_array_t* src);
+  
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -59,6 +59,206 @@ fcc_generate_task_graph(FILE* fd,
   }
 }
 
+/**
+ * \brief Checks if the code of a subplan allocates whole blocks of components
+ * from the task allocator (see generate_block_snapshot and
+ * generate_masked_dense_loop in consumer.cpp). These need pages as large as
+ * those holding the data of table blocks
+ *
+ * \param subplan The subplan to check
+ *
+ * \return True if the task allocator of the subplan must use large pages
+ */
+static bool
+requires_block_allocations(const fcc_subplan_t* subplan)
+{
+  for(uint32_t i = 0; i < subplan->m_num_nodes; ++i)
+  {
+    const fcc_operator_t* op = &subplan->m_nodes[i];
+    if(op->m_type != fcc_operator_type_t::E_FOREACH)
+    {
+      continue;
+    }
+
+    // Block systems snapshot the whole blocks of their tracked columns, and
+    // systems run on mostly dense clusters back up their writable columns
+    const bool block = op->m_foreach.p_systems[0]->m_block;
+    const bool masked = !block && can_run_masked(op);
+    for(uint32_t j = 0; j < op->m_num_columns; ++j)
+    {
+      const fcc_column_t* column = &op->m_columns[j];
+      if(block && is_changed_tracked(column))
+      {
+        return true;
+      }
+
+      if(masked &&
+         column->m_type == fcc_column_type_t::E_COMPONENT &&
+         column->m_access_mode == fcc_access_mode_t::E_READ_WRITE)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Checks if an operator is a changed filter
+ *
+ * \param op The operator to check
+ *
+ * \return True if the operator filters the components changed since its last
+ * run
+ */
+static bool
+is_changed_filter(const fcc_operator_t* op)
+{
+  return op->m_type == fcc_operator_type_t::E_COMPONENT_FILTER &&
+         op->m_component_filter.m_op_type == fcc_filter_op_type_t::E_CHANGED;
+}
+
+/**
+ * \brief Generates the declarations of the state of the changed filters of a
+ * subplan. The state is shared by all the threads running the task, and is
+ * reset by furious_init, since frames start again with each database
+ *
+ * \param fd The file to generate the code to
+ * \param task_prefix The prefix of the task function name
+ * \param id The id of the task
+ * \param subplan The subplan to generate the filters of
+ */
+static void
+generate_changed_filter_decls(FILE* fd, 
+                              const char* task_prefix,
+                              uint32_t id,
+                              const fcc_subplan_t* subplan)
+{
+  for(uint32_t i = 0; i < subplan->m_num_nodes; ++i)
+  {
+    const fcc_operator_t* op = &subplan->m_nodes[i];
+    if(is_changed_filter(op))
+    {
+      fprintf(fd, 
+              "static fdb_table_changed_filter_t %s_%u_changed_filter_%u;\n", 
+              task_prefix,
+              id,
+              op->m_id);
+    }
+  }
+}
+
+/**
+ * \brief Generates the initialization of the state of the changed filters of
+ * a subplan
+ *
+ * \param fd The file to generate the code to
+ * \param task_prefix The prefix of the task function name
+ * \param id The id of the task
+ * \param subplan The subplan to generate the filters of
+ */
+static void
+generate_changed_filter_inits(FILE* fd, 
+                              const char* task_prefix,
+                              uint32_t id,
+                              const fcc_subplan_t* subplan)
+{
+  for(uint32_t i = 0; i < subplan->m_num_nodes; ++i)
+  {
+    const fcc_operator_t* op = &subplan->m_nodes[i];
+    if(is_changed_filter(op))
+    {
+      fprintf(fd, 
+              "fdb_table_changed_filter_init(&%s_%u_changed_filter_%u);\n", 
+              task_prefix,
+              id,
+              op->m_id);
+    }
+  }
+}
+
+/**
+ * \brief Generates the first frame whose changes each changed filter of a
+ * subplan passes in this run (see fdb_table_changed_filter_begin)
+ *
+ * \param fd The file to generate the code to
+ * \param task_prefix The prefix of the task function name
+ * \param id The id of the task
+ * \param subplan The subplan to generate the filters of
+ */
+static void
+generate_changed_filters(FILE* fd, 
+                         const char* task_prefix,
+                         uint32_t id,
+                         const fcc_subplan_t* subplan)
+{
+  for(uint32_t i = 0; i < subplan->m_num_nodes; ++i)
+  {
+    const fcc_operator_t* op = &subplan->m_nodes[i];
+    if(is_changed_filter(op))
+    {
+      fprintf(fd, 
+              "const uint32_t changed_since_%u = fdb_table_changed_filter_begin(&%s_%u_changed_filter_%u, database->m_frame);\n", 
+              op->m_id,
+              task_prefix,
+              id,
+              op->m_id);
+    }
+  }
+}
+
+/**
+ * \brief Generates the code of the task function running the given subplan
+ *
+ * \param fd The file to generate the code to
+ * \param task_prefix The prefix of the task function name
+ * \param id The id of the task
+ * \param subplan The subplan the task runs
+ */
+static void
+fcc_generate_task(FILE* fd, 
+                  const char* task_prefix,
+                  uint32_t id,
+                  const fcc_subplan_t* subplan)
+{
+  fcc_subplan_printer_t printer;
+  fcc_subplan_printer_init(&printer, true, false);
+  fcc_subplan_printer_print(&printer, 
+                            subplan);
+  fprintf(fd,"const char* %s_%d_info = \"%s\";\n", task_prefix, id, printer.m_str_builder.p_buffer);
+  generate_changed_filter_decls(fd, task_prefix, id, subplan);
+  fprintf(fd,"void %s_%d(float delta,\n\
+    fdb_database_t* database,\n\
+            void* user_data,\n\
+            uint32_t chunk_size,\n\
+            uint32_t offset,\n\
+            uint32_t stride,\n\
+            fdb_barrier_t* barrier)\n", 
+          task_prefix,
+          id);
+
+  fprintf(fd,"{\n");
+
+  fprintf(fd, "fdb_context_t context;\n");
+  fprintf(fd, "fdb_context_init(&context, delta,database,user_data, chunk_size, offset, stride);\n");
+  fprintf(fd, "fdb_stack_alloc_t task_allocator;\n");
+  fprintf(fd, 
+          "fdb_stack_alloc_init(&task_allocator, %s, fdb_get_global_mem_allocator());\n",
+          requires_block_allocations(subplan) ? "FDB_TABLE_BLOCK_DATA_PAGE_SIZE" : "KILOBYTES(4)");
+  generate_changed_filters(fd, task_prefix, id, subplan);
+  if(subplan->m_requires_sync)
+  {
+    // Cumulative number of arrivals to wait for at each synchronization point
+    fprintf(fd, "FDB_PERMA_ASSERT(stride == 1 || barrier != nullptr);\n");
+    fprintf(fd, "int32_t last_barrier = 0;\n");
+  }
+  const fcc_operator_t* root = &subplan->m_nodes[subplan->m_root];
+  produce(fd,root, true);
+  fprintf(fd, "fdb_stack_alloc_release(&task_allocator);\n");
+  fprintf(fd,"}\n");
+  fcc_subplan_printer_release(&printer);
+}
+
 int32_t 
 fcc_generate_code(const fcc_exec_plan_t* exec_plan,
                   const fcc_exec_plan_t* post_exec_plan,
@@ -219,59 +419,14 @@ fcc_generate_code(const fcc_exec_plan_t* exec_plan,
   num_nodes = exec_plan->m_nnodes;
   for(uint32_t i = 0; i < num_nodes; ++i)
   {
-    fcc_subplan_printer_t printer;
-    fcc_subplan_printer_init(&printer, true, false);
-    fcc_subplan_printer_print(&printer, 
-                              exec_plan->m_subplans[i]);
-    fprintf(fd,"const char* __task_%d_info = \"%s\";\n", i, printer.m_str_builder.p_buffer);
-    fprintf(fd,"void __task_%d(float delta,\n\
-    fdb_database_t* database,\n\
-            void* user_data,\n\
-            uint32_t chunk_size,\n\
-            uint32_t offset,\n\
-            uint32_t stride,\n\
-            fdb_barrier_t* barrier)\n", 
-            i);
-
-    fprintf(fd,"{\n");
-
-    fprintf(fd, "fdb_context_t context;\n");
-    fprintf(fd, "fdb_context_init(&context, delta,database,user_data, chunk_size, offset, stride);\n");
-    fprintf(fd, "fdb_stack_alloc_t task_allocator;\n");
-    fprintf(fd, "fdb_stack_alloc_init(&task_allocator, KILOBYTES(4), fdb_get_global_mem_allocator());\n");
-    const fcc_operator_t* root = &exec_plan->m_subplans[i]->m_nodes[exec_plan->m_subplans[i]->m_root];
-    produce(fd,root, true);
-    fprintf(fd, "fdb_stack_alloc_release(&task_allocator);\n");
-    fprintf(fd,"}\n");
-    fcc_subplan_printer_release(&printer);
+    fcc_generate_task(fd, "__task", i, exec_plan->m_subplans[i]);
   }
 
   // DEFINING TASKS CODE BASED ON POST FRAME EXECUTION PLAN ROOTS
   num_nodes = post_exec_plan->m_nnodes;
   for(uint32_t i = 0; i < num_nodes; ++i)
   {
-    fcc_subplan_printer_t printer;
-    fcc_subplan_printer_init(&printer, true, false);
-    fcc_subplan_printer_print(&printer, 
-                              post_exec_plan->m_subplans[i]);
-    fprintf(fd,"const char* __pf_task_%d_info = \"%s\";\n", i, printer.m_str_builder.p_buffer);
-    fprintf(fd,"void __pf_task_%d(float delta,\n\
-    databaset* database,\n\
-            void* user_data,\n\
-            uint32_t chunk_size,\n\
-            uint32_t offset,\n\
-            uint32_t stride,\n\
-            fdb_barrier_t* barrier)\n", i);
-    fprintf(fd,"{\n");
-
-    fprintf(fd, "fdb_context_t context;\n");
-    fprintf(fd, "fdb_stack_alloc_t task_allocator;\n");
-    fprintf(fd, "fdb_stack_alloc_init(&task_allocator, KILOBYTES(4), fdb_get_global_mem_allocator());\n");
-    const fcc_operator_t* root = &post_exec_plan->m_subplans[i]->m_nodes[post_exec_plan->m_subplans[i]->m_root];
-    produce(fd,root, true);
-    fprintf(fd, "fdb_stack_alloc_release(&task_allocator);\n");
-    fprintf(fd,"}\n");
-    fcc_subplan_printer_release(&printer);
+    fcc_generate_task(fd, "__pf_task", i, post_exec_plan->m_subplans[i]);
   }
 
   /// GENERATING furious__init  
@@ -300,6 +455,50 @@ fcc_generate_code(const fcc_exec_plan_t* exec_plan,
     }
   }
 
+  // TRACKING THE CHANGES OF THE COMPONENTS USED BY CHANGED FILTERS
+  {
+    const uint32_t nchanged = vars_extr.m_changed.m_count;
+    const char**  changed = vars_extr.m_changed.m_data;
+    for (uint32_t i = 0; i < nchanged; ++i) 
+    {
+      char tmp[FCC_MAX_TABLE_VARNAME];
+      generate_table_name(changed[i],
+                          tmp,
+                          FCC_MAX_TABLE_VARNAME);
+
+      fprintf(fd,
+              "fdb_table_track_changes(%s);\n",
+              tmp);
+    }
+
+    for(uint32_t i = 0; i < exec_plan->m_nnodes; ++i)
+    {
+      generate_changed_filter_inits(fd, "__task", i, exec_plan->m_subplans[i]);
+    }
+
+    for(uint32_t i = 0; i < post_exec_plan->m_nnodes; ++i)
+    {
+      generate_changed_filter_inits(fd, "__pf_task", i, post_exec_plan->m_subplans[i]);
+    }
+  }
+
+  // TRACKING THE EVENTS OF THE COMPONENTS USED BY SCANS OF EVENTS
+  {
+    const uint32_t nevents = vars_extr.m_events.m_count;
+    const char**  events = vars_extr.m_events.m_data;
+    for (uint32_t i = 0; i < nevents; ++i) 
+    {
+      char tmp[FCC_MAX_TABLE_VARNAME];
+      generate_table_name(events[i],
+                          tmp,
+                          FCC_MAX_TABLE_VARNAME);
+
+      fprintf(fd,
+              "fdb_table_track_events(%s);\n",
+              tmp);
+    }
+  }
+
   {
     const uint32_t nrefs = vars_extr.m_refs.m_count;
     const char** refs = vars_extr.m_refs.m_data;
@@ -398,7 +597,19 @@ fcc_generate_code(const fcc_exec_plan_t* exec_plan,
       generate_reflection_code(fd, decls[i]);
     }
   }
-  fcc_vars_extr_release(&vars_extr);
+
+  // SETTING THE LAYOUT OF THE TABLES DECLARED SOA. The code generated for the
+  // systems only handles this layout, so it must be set
+  {
+    const uint32_t nsoa = vars_extr.m_soa.m_count;
+    const char**  soa = vars_extr.m_soa.m_data;
+    for (uint32_t i = 0; i < nsoa; ++i) 
+    {
+      fprintf(fd,
+              "FDB_PERMA_ASSERT(FDB_SET_TABLE_LAYOUT(database, %s, E_FDB_TABLE_LAYOUT_SOA) && \"Cannot set the SoA layout of a non-empty table\");\n",
+              soa[i]);
+    }
+  }
 
   fprintf(fd, 
           "fdb_task_graph_init(&task_graph, %d, %d);\n", 
@@ -422,10 +633,28 @@ fcc_generate_code(const fcc_exec_plan_t* exec_plan,
     fprintf(fd,"\n\n\n");
     fprintf(fd,"void furious_frame(float delta, fdb_database_t* database, void* user_data)\n{\n");
 
+    fprintf(fd, "database->m_frame++;\n");
+
+    // The events logged since the last frame become visible to this one
+    const uint32_t nevents = vars_extr.m_events.m_count;
+    const char**  events = vars_extr.m_events.m_data;
+    for (uint32_t i = 0; i < nevents; ++i) 
+    {
+      char tmp[FCC_MAX_TABLE_VARNAME];
+      generate_table_name(events[i],
+                          tmp,
+                          FCC_MAX_TABLE_VARNAME);
+
+      fprintf(fd,
+              "fdb_table_swap_events(%s);\n",
+              tmp);
+    }
+
     fprintf(fd, "fdb_task_graph_run(&task_graph, delta, database, user_data);\n");
 
     fprintf(fd, "}\n");
   }
+  fcc_vars_extr_release(&vars_extr);
 
 
   /// GENERATING furious_post_frame CODE
@@ -44,6 +44,10 @@ static void
 fcc_deps_extr_extract_leftfilter_join(fcc_deps_extr_t* deps_extr,
                                       const fcc_operator_t* left_filter_join);
 
+static void
+fcc_deps_extr_extract_multi_join(fcc_deps_extr_t* deps_extr,
+                                 const fcc_operator_t* multi_join);
+
 static void
 fcc_deps_extr_extract_gather(fcc_deps_extr_t* deps_extr,
                              const fcc_operator_t* gather);
@@ -171,6 +175,9 @@ fcc_deps_extr_extract(fcc_deps_extr_t* deps_extr,
     case fcc_operator_type_t::E_CROSS_JOIN:
       fcc_deps_extr_extract_cross_join(deps_extr, fcc_operator);
       break;
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      fcc_deps_extr_extract_multi_join(deps_extr, fcc_operator);
+      break;
     case fcc_operator_type_t::E_FETCH:
       fcc_deps_extr_extract_fetch(deps_extr, fcc_operator);
       break;
@@ -196,12 +203,15 @@ void
 fcc_deps_extr_extract_foreach(fcc_deps_extr_t* deps_extr,
                               const fcc_operator_t* foreach)
 {
-  const fcc_system_t* system = foreach->m_foreach.p_system;
-  fcc_depcy_array_t array = fcc_depcy_array_init();
-  fcc_type_dependencies(system->m_system_type, &array);
-  fcc_deps_extr_extract(deps_extr,
-                        &array);
-  fcc_depcy_array_release(&array);
+  for(uint32_t i = 0; i < foreach->m_foreach.m_num_systems; ++i)
+  {
+    const fcc_system_t* system = foreach->m_foreach.p_systems[i];
+    fcc_depcy_array_t array = fcc_depcy_array_init();
+    fcc_type_dependencies(system->m_system_type, &array);
+    fcc_deps_extr_extract(deps_extr,
+                          &array);
+    fcc_depcy_array_release(&array);
+  }
   const uint32_t child_idx = foreach->m_foreach.m_child;
   fcc_operator_t* op =&foreach->p_subplan->m_nodes[child_idx];
   fcc_deps_extr_extract(deps_extr, op);
@@ -248,6 +258,17 @@ fcc_deps_extr_extract_cross_join(fcc_deps_extr_t* deps_extr,
   fcc_deps_extr_extract(deps_extr, &subplan->m_nodes[cross_join->m_cross_join.m_right]);
 }
 
+void
+fcc_deps_extr_extract_multi_join(fcc_deps_extr_t* deps_extr,
+                                 const fcc_operator_t* multi_join) 
+{
+  fcc_subplan_t* subplan = multi_join->p_subplan;
+  for(uint32_t i = 0; i < multi_join->m_multi_join.m_num_inputs; ++i)
+  {
+    fcc_deps_extr_extract(deps_extr, &subplan->m_nodes[multi_join->m_multi_join.m_inputs[i]]);
+  }
+}
+
 void
 fcc_deps_extr_extract_fetch(fcc_deps_extr_t* deps_extr,
                             const fcc_operator_t* fetch) 
@@ -347,6 +368,10 @@ static void
 fcc_vars_extr_extract_leftfilter_join(fcc_vars_extr_t* vars_extr,
                                       const fcc_operator_t* left_filter_join);
 
+static void
+fcc_vars_extr_extract_multi_join(fcc_vars_extr_t* vars_extr,
+                                 const fcc_operator_t* multi_join);
+
 static void
 fcc_vars_extr_extract_gather(fcc_vars_extr_t* vars_extr,
                              const fcc_operator_t* gather);
@@ -379,6 +404,9 @@ fcc_vars_extr_init(fcc_vars_extr_t* vars_extr)
   vars_extr->m_tags = cchar_ptr_array_init();
   vars_extr->m_refs = cchar_ptr_array_init();
   vars_extr->m_comps = cchar_ptr_array_init();
+  vars_extr->m_changed = cchar_ptr_array_init();
+  vars_extr->m_events = cchar_ptr_array_init();
+  vars_extr->m_soa = cchar_ptr_array_init();
 }
 
 void
@@ -405,9 +433,33 @@ fcc_vars_extr_release(fcc_vars_extr_t* vars_extr)
     delete [] refs[i];
   }
 
+  const uint32_t nchanged = vars_extr->m_changed.m_count;
+  const char** changed = vars_extr->m_changed.m_data;
+  for (uint32_t i = 0; i < nchanged; ++i) 
+  {
+    delete [] changed[i];
+  }
+
+  const uint32_t nevents = vars_extr->m_events.m_count;
+  const char** events = vars_extr->m_events.m_data;
+  for (uint32_t i = 0; i < nevents; ++i) 
+  {
+    delete [] events[i];
+  }
+
+  const uint32_t nsoa = vars_extr->m_soa.m_count;
+  const char** soa = vars_extr->m_soa.m_data;
+  for (uint32_t i = 0; i < nsoa; ++i) 
+  {
+    delete [] soa[i];
+  }
+
   cchar_ptr_array_release(&vars_extr->m_tags);
   cchar_ptr_array_release(&vars_extr->m_refs);
   cchar_ptr_array_release(&vars_extr->m_comps);
+  cchar_ptr_array_release(&vars_extr->m_changed);
+  cchar_ptr_array_release(&vars_extr->m_events);
+  cchar_ptr_array_release(&vars_extr->m_soa);
 }
 
 void 
@@ -431,6 +483,9 @@ fcc_vars_extr_extract(fcc_vars_extr_t* vars_extr,
     case fcc_operator_type_t::E_CROSS_JOIN:
       fcc_vars_extr_extract_cross_join(vars_extr, fcc_operator);
       break;
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      fcc_vars_extr_extract_multi_join(vars_extr, fcc_operator);
+      break;
     case fcc_operator_type_t::E_FETCH:
       fcc_vars_extr_extract_fetch(vars_extr, fcc_operator);
       break;
@@ -505,6 +560,37 @@ fcc_vars_extr_extract_scan(fcc_vars_extr_t* vars_extr,
       {
         fcc_decl_array_append(&vars_extr->m_comp_decls, &decl);
       }
+
+      if(fcc_context_is_soa_component(scan->m_columns[0].m_component_type))
+      {
+        char* soa_buffer = new char [FCC_MAX_TYPE_NAME];
+        FDB_COPY_AND_CHECK_STR(soa_buffer, tmp, FCC_MAX_TYPE_NAME);
+        const char* soa_ptr = soa_buffer;
+        cchar_ptr_array_append(&vars_extr->m_soa, &soa_ptr);
+      }
+    }
+
+    if(scan->m_scan.m_event != fcc_event_type_t::E_NONE)
+    {
+      bool tracked = false;
+      const uint32_t nevents = vars_extr->m_events.m_count;
+      const char** events = vars_extr->m_events.m_data;
+      for(uint32_t i = 0; i < nevents; ++i)
+      {
+        if(strcmp(events[i], tmp) == 0)
+        {
+          tracked = true;
+          break;
+        }
+      }
+
+      if(!tracked)
+      {
+        char* buffer = new char[FCC_MAX_TYPE_NAME];
+        FDB_COPY_AND_CHECK_STR(buffer, tmp, FCC_MAX_TYPE_NAME);
+        const char* ptr = buffer;
+        cchar_ptr_array_append(&vars_extr->m_events, &ptr);
+      }
     }
   }
   else
@@ -558,6 +644,17 @@ fcc_vars_extr_extract_cross_join(fcc_vars_extr_t* vars_extr,
   fcc_vars_extr_extract(vars_extr, &subplan->m_nodes[cross_join->m_cross_join.m_right]);
 }
 
+void
+fcc_vars_extr_extract_multi_join(fcc_vars_extr_t* vars_extr, 
+                      const fcc_operator_t* multi_join) 
+{
+  fcc_subplan_t* subplan = multi_join->p_subplan;
+  for(uint32_t i = 0; i < multi_join->m_multi_join.m_num_inputs; ++i)
+  {
+    fcc_vars_extr_extract(vars_extr, &subplan->m_nodes[multi_join->m_multi_join.m_inputs[i]]);
+  }
+}
+
 void
 fcc_vars_extr_extract_fetch(fcc_vars_extr_t* vars_extr, 
                       const fcc_operator_t* fetch)
@@ -624,9 +721,34 @@ fcc_vars_extr_extract_component_filter(fcc_vars_extr_t* vars_extr,
     fcc_decl_t decl;
     fcc_type_decl(component_filter->m_component_filter.m_filter_type, &decl);
     fcc_decl_array_append(&vars_extr->m_comp_decls, &decl);
-    fcc_subplan_t* subplan = component_filter->p_subplan;
-    fcc_vars_extr_extract(vars_extr, &subplan->m_nodes[component_filter->m_component_filter.m_child]);
   }
+
+  if(component_filter->m_component_filter.m_op_type == fcc_filter_op_type_t::E_CHANGED)
+  {
+    bool tracked = false;
+    const uint32_t nchanged = vars_extr->m_changed.m_count;
+    const char** changed = vars_extr->m_changed.m_data;
+    for(uint32_t i = 0; i < nchanged; ++i)
+    {
+      if(strcmp(changed[i], tmp) == 0)
+      {
+        tracked = true;
+      }
+    }
+
+    if(!tracked)
+    {
+      char* buffer = new char[FCC_MAX_TYPE_NAME];
+      FDB_COPY_AND_CHECK_STR(buffer, tmp, FCC_MAX_TYPE_NAME);
+      const char* ptr = buffer;
+      cchar_ptr_array_append(&vars_extr->m_changed, &ptr);
+    }
+  }
+
+  // The child is extracted even if the component was already found, since it
+  // can contain other tables
+  fcc_subplan_t* subplan = component_filter->p_subplan;
+  fcc_vars_extr_extract(vars_extr, &subplan->m_nodes[component_filter->m_component_filter.m_child]);
 }
 
 void
@@ -732,28 +854,6 @@ generate_table_name(const char* type_name,
   return length;
 }
 
-uint32_t
-generate_temp_table_name(const char* type_name, 
-                         char * buffer,
-                         uint32_t buffer_length,
-                         const fcc_operator_t* op)
-{
-  char tmp[FCC_MAX_TABLE_VARNAME];
-  generate_table_name(type_name, 
-                      tmp,
-                      FCC_MAX_TABLE_VARNAME,
-                      op);
-
-  fdb_str_builder_t str_builder;
-  fdb_str_builder_init(&str_builder);
-  fdb_str_builder_append(&str_builder, "temp_%s", tmp);
-
-  const uint32_t length = str_builder.m_pos;
-  FDB_COPY_AND_CHECK_STR(buffer, str_builder.p_buffer, buffer_length);
-  fdb_str_builder_release(&str_builder);
-  return length;
-}
-
 uint32_t
 generate_ref_table_name(const char* ref_name, 
                         char* buffer,
@@ -883,6 +983,120 @@ generate_hashtable_name(const fcc_operator_t* op,
   return length;
 }
 
+uint32_t
+generate_merge_iter_name(const fcc_operator_t* op,
+                         char* buffer,
+                         uint32_t buffer_length)
+{
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  fdb_str_builder_append(&str_builder, "merge_iter_%u",op->m_id);
+  const uint32_t length = str_builder.m_pos;
+  FDB_COPY_AND_CHECK_STR(buffer, str_builder.p_buffer, buffer_length);
+  fdb_str_builder_release(&str_builder);
+  return length;
+}
+
+uint32_t
+generate_scan_table_expr(const fcc_operator_t* scan,
+                         char* buffer,
+                         uint32_t buffer_length)
+{
+  char tablename[FCC_MAX_TABLE_VARNAME];
+  const fcc_column_t* column = &scan->m_columns[0];
+  if(column->m_type == fcc_column_type_t::E_COMPONENT)
+  {
+    char ctype[FCC_MAX_TYPE_NAME];
+    fcc_type_name(column->m_component_type,
+                  ctype,
+                  FCC_MAX_TYPE_NAME);
+    generate_table_name(ctype,
+                        tablename,
+                        FCC_MAX_TABLE_VARNAME);
+  }
+  else
+  {
+    generate_ref_table_name(column->m_ref_name,
+                            tablename,
+                            FCC_MAX_TABLE_VARNAME);
+  }
+
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  if(column->m_type == fcc_column_type_t::E_ID)
+  {
+    fdb_str_builder_append(&str_builder, "&%s->m_table", tablename);
+  }
+  else
+  {
+    fdb_str_builder_append(&str_builder, "%s", tablename);
+  }
+  const uint32_t length = str_builder.m_pos;
+  FDB_COPY_AND_CHECK_STR(buffer, str_builder.p_buffer, buffer_length);
+  fdb_str_builder_release(&str_builder);
+  return length;
+}
+
+/**
+ * \brief Checks whether the blocks produced by an operator are sorted by block
+ * id. Table scans and multi joins iterate the tables in block order, and
+ * filters and joins (which stream their right input) preserve the order of their
+ * input
+ *
+ * \param op The operator to check
+ *
+ * \return True if the operator produces its blocks sorted by block id
+ */
+static bool
+is_sorted_stream(const fcc_operator_t* op)
+{
+  const fcc_subplan_t* subplan = op->p_subplan;
+  switch(op->m_type)
+  {
+    case fcc_operator_type_t::E_SCAN:
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      return true;
+    case fcc_operator_type_t::E_TAG_FILTER:
+      return is_sorted_stream(&subplan->m_nodes[op->m_tag_filter.m_child]);
+    case fcc_operator_type_t::E_PREDICATE_FILTER:
+      return is_sorted_stream(&subplan->m_nodes[op->m_predicate_filter.m_child]);
+    case fcc_operator_type_t::E_COMPONENT_FILTER:
+      return is_sorted_stream(&subplan->m_nodes[op->m_component_filter.m_child]);
+    case fcc_operator_type_t::E_JOIN:
+      return is_sorted_stream(&subplan->m_nodes[op->m_join.m_right]);
+    case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      return is_sorted_stream(&subplan->m_nodes[op->m_leftfilter_join.m_right]);
+    default:
+      return false;
+  }
+}
+
+bool
+is_merge_join(const fcc_operator_t* join)
+{
+  const fcc_subplan_t* subplan = join->p_subplan;
+  const fcc_operator_t* left = nullptr;
+  const fcc_operator_t* right = nullptr;
+  switch(join->m_type)
+  {
+    case fcc_operator_type_t::E_JOIN:
+      left = &subplan->m_nodes[join->m_join.m_left];
+      right = &subplan->m_nodes[join->m_join.m_right];
+      break;
+    case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      left = &subplan->m_nodes[join->m_leftfilter_join.m_left];
+      right = &subplan->m_nodes[join->m_leftfilter_join.m_right];
+      break;
+    default:
+      return false;
+  }
+  // Scans of events cannot be iterated in lockstep, since they are not
+  // iterated through a table iterator
+  return left->m_type == fcc_operator_type_t::E_SCAN && 
+         left->m_scan.m_event == fcc_event_type_t::E_NONE &&
+         is_sorted_stream(right);
+}
+
 uint32_t
 generate_system_wrapper_name(const char* system_name,
                              uint32_t system_id,
@@ -931,3 +1145,61 @@ generate_global_name(const char* type_name,
   return length;
 }
 
+
+bool
+is_changed_tracked(const fcc_column_t* column)
+{
+  if(column->m_type != fcc_column_type_t::E_COMPONENT ||
+     column->m_access_mode != fcc_access_mode_t::E_READ_WRITE)
+  {
+    return false;
+  }
+
+  char column_type[FCC_MAX_TYPE_NAME];
+  fcc_type_name(column->m_component_type,
+                column_type,
+                FCC_MAX_TYPE_NAME);
+  const uint32_t nstmts = p_fcc_context->m_stmts.m_count;
+  for(uint32_t i = 0; i < nstmts; ++i)
+  {
+    const fcc_stmt_t* stmt = p_fcc_context->m_stmts.m_data[i];
+    for(uint32_t j = 0; j < stmt->m_ematches.m_count; ++j)
+    {
+      const fcc_entity_match_t* ematch = stmt->m_ematches.m_data[j];
+      for(uint32_t k = 0; k < ematch->m_nchanged_components; ++k)
+      {
+        char changed_type[FCC_MAX_TYPE_NAME];
+        fcc_type_name(ematch->m_changed_components[k],
+                      changed_type,
+                      FCC_MAX_TYPE_NAME);
+        if(strcmp(column_type, changed_type) == 0)
+        {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool
+can_run_masked(const fcc_operator_t* foreach)
+{
+  for(uint32_t s = 0; s < foreach->m_foreach.m_num_systems; ++s)
+  {
+    if(!foreach->m_foreach.p_systems[s]->m_pure)
+    {
+      return false;
+    }
+  }
+
+  for(uint32_t i = 0; i < foreach->m_num_columns; ++i)
+  {
+    if(foreach->m_columns[i].m_type == fcc_column_type_t::E_REFERENCE ||
+       is_changed_tracked(&foreach->m_columns[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
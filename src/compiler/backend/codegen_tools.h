@@ -15,6 +15,7 @@
 
 struct fcc_subplan_t;
 struct fcc_operator_t;
+struct fcc_column_t;
 
 /**
  * @brief Tool used to extract the dependencies of an execution plan, which
@@ -51,6 +52,9 @@ struct fcc_vars_extr_t
   cchar_ptr_array_t m_tags;
   cchar_ptr_array_t m_refs;
   cchar_ptr_array_t m_comps;
+  cchar_ptr_array_t m_changed;    // The components whose changes are tracked (used by changed filters)
+  cchar_ptr_array_t m_events;     // The components whose events are tracked (used by scans of events)
+  cchar_ptr_array_t m_soa;        // The components whose tables are stored as SoA (see set_soa_layout)
 };
 
 void
@@ -76,12 +80,6 @@ generate_table_name(const char* type_name,
                     uint32_t buffer_length, 
                     const fcc_operator_t* op = nullptr);
 
-uint32_t
-generate_temp_table_name(const char* type_name,
-                         char* buffer,
-                         uint32_t buffer_length,
-                         const fcc_operator_t* op = nullptr);
-
 uint32_t
 generate_ref_table_name(const char* ref_name,
                         char* buffer,
@@ -122,6 +120,57 @@ generate_hashtable_name(const fcc_operator_t* op,
                         char* buffer,
                         uint32_t buffer_length);
 
+uint32_t
+generate_merge_iter_name(const fcc_operator_t* op,
+                         char* buffer,
+                         uint32_t buffer_length);
+
+uint32_t
+generate_scan_table_expr(const fcc_operator_t* scan,
+                         char* buffer,
+                         uint32_t buffer_length);
+
+/**
+ * \brief Checks whether a join can be generated as a streaming merge join,
+ * which advances a table iterator over its left input in lockstep with the
+ * blocks of its right input instead of materializing the left input into a
+ * hashtable. This requires the left input to be a plain scan and the right
+ * input to produce its blocks sorted by block id
+ *
+ * \param join The join or left filter join operator to check
+ *
+ * \return True if the join can be generated as a merge join
+ */
+bool
+is_merge_join(const fcc_operator_t* join);
+
+/**
+ * \brief Checks if the writes to a column must be recorded in the change
+ * frames of its blocks, which is the case for writable components used by
+ * some changed filter (see fdb_table_track_changes)
+ *
+ * \param column The column to check
+ *
+ * \return True if the changes to the column are tracked
+ */
+bool
+is_changed_tracked(const fcc_column_t* column);
+
+/**
+ * \brief Checks if the systems of a foreach operator can be run on all the rows
+ * of a mostly dense cluster, including the disabled ones, whose writable
+ * columns are restored afterwards. This requires all the systems to be
+ * declared pure, and no reference columns, since these can be null for
+ * disabled rows. Columns whose changes are tracked are also excluded, since
+ * the writes to the disabled rows would be recorded before being restored
+ *
+ * \param foreach The foreach operator to check
+ *
+ * \return True if the systems can run on the disabled rows
+ */
+bool
+can_run_masked(const fcc_operator_t* foreach);
+
 uint32_t
 generate_system_wrapper_name(const char* system_name,
                              uint32_t system_id,
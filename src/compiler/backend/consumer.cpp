@@ -1,7 +1,9 @@
 
 
 #include "../../common/str_builder.h"
+#include "../../runtime/data/reflection.h"
 #include "../frontend/operator.h"
+#include "../driver.h"
 #include "backend/codegen.h"
 #include "codegen_tools.h"
 #include "consumer.h"
@@ -45,6 +47,12 @@ consume_leftfilter_join(FILE*fd,
                         const char* source,
                         const fcc_operator_t* caller);
 
+static void
+consume_multi_join(FILE*fd,
+                   const fcc_operator_t* multi_join,
+                   const char* source,
+                   const fcc_operator_t* caller);
+
 static void
 consume_gather(FILE*fd,
                const fcc_operator_t* gather,
@@ -81,6 +89,453 @@ consume_component_filter(FILE*fd,
                          const char* source,
                          const fcc_operator_t* caller);
 
+/**
+ * \brief Gets the reflection data of the components of a column, if its table
+ * was declared SoA (see set_soa_layout). Only these columns get the code for
+ * the SoA layout.
+ *
+ * \param column The column to get the reflection data for
+ * \param reg The registry to create the reflection data into
+ *
+ * \return The reflection data of the column components, or nullptr if the
+ * column is stored as AoS
+ */
+static fdb_mstruct_t*
+get_soa_mstruct(const fcc_column_t* column, 
+                fdb_mregistry_t* reg)
+{
+  fcc_decl_t decl;
+  if(column->m_type != fcc_column_type_t::E_COMPONENT || 
+     !fcc_context_is_soa_component(column->m_component_type) ||
+     !fcc_type_decl(column->m_component_type, &decl))
+  {
+    return nullptr;
+  }
+  return get_reflection_data(decl, reg);
+}
+
+/**
+ * \brief Generates the expression with the size of the SoA column of the
+ * given field of a component, which also covers the padding up to the next
+ * field. This must match the columns built by fdb_table_set_layout
+ */
+static void
+generate_soa_column_size(fdb_str_builder_t* str_builder,
+                         const char* type_name,
+                         const fdb_mstruct_t* mstruct, 
+                         uint32_t field)
+{
+  if(field + 1 < mstruct->m_nfields)
+  {
+    fdb_str_builder_append(str_builder,
+                           "(offsetof(%s, %s) - offsetof(%s, %s))", 
+                           type_name,
+                           mstruct->p_fields[field+1]->m_name,
+                           type_name,
+                           mstruct->p_fields[field]->m_name);
+  }
+  else
+  {
+    fdb_str_builder_append(str_builder,
+                           "(sizeof(%s) - offsetof(%s, %s))", 
+                           type_name,
+                           type_name,
+                           mstruct->p_fields[field]->m_name);
+  }
+}
+
+/**
+ * \brief Generates the code that checks that the block of column index has the
+ * layout the code was generated for
+ */
+static void
+generate_layout_check(FILE* fd,
+                      const char* source,
+                      uint32_t index,
+                      bool soa)
+{
+  fprintf(fd, 
+          "FDB_PERMA_ASSERT(fdb_bcluster_get_tblock(%s, %d)->p_soa %s NULL && \"Unexpected layout of the table block\");\n", 
+          source, 
+          index, 
+          soa ? "!=" : "==");
+}
+
+/**
+ * \brief Generates the pointers to the columns of the SoA block of column
+ * index, one per field: soa_<index>_<field>. The columns start at
+ * compile-time offsets of the block data, and field f of row i is at
+ * soa_<index>_<f> + i*<column size>
+ */
+static void
+generate_soa_columns(FILE* fd,
+                     const char* type_name,
+                     const fdb_mstruct_t* mstruct, 
+                     uint32_t index,
+                     bool writable)
+{
+  for(uint32_t f = 0; f < mstruct->m_nfields; ++f)
+  {
+    fprintf(fd, 
+            "%s soa_%d_%d = ((%s)data_%d) + FDB_TABLE_BLOCK_SIZE*offsetof(%s, %s);\n", 
+            writable ? "char*" : "const char*",
+            index, 
+            f,
+            writable ? "char*" : "const char*",
+            index, 
+            type_name, 
+            mstruct->p_fields[f]->m_name);
+  }
+}
+
+/**
+ * \brief Generates the code that loads row i of the SoA block of column index
+ * into row_<index>, field by field from its columns. Only the enabled rows
+ * the systems run on are loaded, and once the systems are inlined the loads of
+ * the fields they do not use are dropped
+ */
+static void
+generate_soa_row_load(fdb_str_builder_t* str_builder,
+                      const char* type_name,
+                      const fdb_mstruct_t* mstruct, 
+                      uint32_t index)
+{
+  fdb_str_builder_append(str_builder, 
+                         "alignas(%s) char row_%d[sizeof(%s)];\n", 
+                         type_name, 
+                         index, 
+                         type_name);
+  for(uint32_t f = 0; f < mstruct->m_nfields; ++f)
+  {
+    fdb_str_builder_t size;
+    fdb_str_builder_init(&size);
+    generate_soa_column_size(&size, type_name, mstruct, f);
+    fdb_str_builder_append(str_builder, 
+                           "memcpy(&row_%d[offsetof(%s, %s)], soa_%d_%d + i*%s, %s);\n", 
+                           index, 
+                           type_name, 
+                           mstruct->p_fields[f]->m_name,
+                           index,
+                           f,
+                           size.p_buffer,
+                           size.p_buffer);
+    fdb_str_builder_release(&size);
+  }
+}
+
+/**
+ * \brief Generates the code that stores row_<index> back into row i of the
+ * columns of the SoA block of column index, after the systems ran on it
+ */
+static void
+generate_soa_row_store(fdb_str_builder_t* str_builder,
+                       const char* type_name,
+                       const fdb_mstruct_t* mstruct, 
+                       uint32_t index)
+{
+  for(uint32_t f = 0; f < mstruct->m_nfields; ++f)
+  {
+    fdb_str_builder_t size;
+    fdb_str_builder_init(&size);
+    generate_soa_column_size(&size, type_name, mstruct, f);
+    fdb_str_builder_append(str_builder, 
+                           "memcpy(soa_%d_%d + i*%s, &row_%d[offsetof(%s, %s)], %s);\n", 
+                           index,
+                           f,
+                           size.p_buffer,
+                           index, 
+                           type_name, 
+                           mstruct->p_fields[f]->m_name,
+                           size.p_buffer);
+    fdb_str_builder_release(&size);
+  }
+}
+
+/**
+ * \brief Generates the code that copies the component of column index at ptr
+ * before a system runs, so that the changes it makes can be detected by
+ * generate_changed_check
+ */
+static void
+generate_changed_snapshot(fdb_str_builder_t* str_builder,
+                          const char* type_name,
+                          uint32_t index,
+                          const char* ptr)
+{
+  fdb_str_builder_append(str_builder, 
+                         "alignas(%s) char prev_%d[sizeof(%s)];\n", 
+                         type_name, 
+                         index, 
+                         type_name);
+  fdb_str_builder_append(str_builder, 
+                         "memcpy(prev_%d, %s, sizeof(%s));\n", 
+                         index, 
+                         ptr,
+                         type_name);
+}
+
+/**
+ * \brief Generates the code that copies the whole block of column index, at
+ * ptr, before a block system runs. Blocks are too large for the stacks of the
+ * workers, so the snapshot is taken from the task allocator and must be
+ * released with generate_block_snapshot_release in reverse order
+ */
+static void
+generate_block_snapshot(fdb_str_builder_t* str_builder,
+                        const char* type_name,
+                        uint32_t index,
+                        const char* ptr)
+{
+  fdb_str_builder_append(str_builder, 
+                         "char* prev_%d = (char*)fdb_stack_alloc_alloc(&task_allocator, alignof(%s), FDB_TABLE_BLOCK_SIZE*sizeof(%s), FDB_NO_HINT);\n", 
+                         index, 
+                         type_name, 
+                         type_name);
+  fdb_str_builder_append(str_builder, 
+                         "memcpy(prev_%d, %s, FDB_TABLE_BLOCK_SIZE*sizeof(%s));\n", 
+                         index, 
+                         ptr,
+                         type_name);
+}
+
+/**
+ * \brief Generates the code that releases a snapshot taken with
+ * generate_block_snapshot
+ */
+static void
+generate_block_snapshot_release(fdb_str_builder_t* str_builder,
+                                uint32_t index)
+{
+  fdb_str_builder_append(str_builder, 
+                         "fdb_stack_alloc_pop(&task_allocator, prev_%d);\n", 
+                         index);
+}
+
+/**
+ * \brief Generates the code that records row i of column index as changed
+ * if its component, at ptr, differs from its snapshot at the given row 
+ */
+static void
+generate_changed_check(fdb_str_builder_t* str_builder,
+                       const char* type_name,
+                       uint32_t index,
+                       const char* ptr,
+                       const char* row,
+                       const char* source)
+{
+  fdb_str_builder_append(str_builder, 
+                         "if(memcmp(&prev_%d[(%s)*sizeof(%s)], %s, sizeof(%s)) != 0)\n{\n", 
+                         index, 
+                         row,
+                         type_name,
+                         ptr,
+                         type_name);
+  fdb_str_builder_append(str_builder, 
+                         "fdb_table_block_set_changed(fdb_bcluster_get_tblock(%s, %d), i, context.p_database->m_frame);\n}\n", 
+                         source,
+                         index);
+}
+
+/**
+ * \brief Generates the call to the run_block method of a system, which
+ * processes all the rows of the source cluster at once. Entities that are not
+ * enabled in the cluster are masked out through its enabled bitmap. The
+ * components are passed as the arrays of the blocks, so SoA columns are not
+ * supported.
+ */
+static void
+generate_block_call(fdb_str_builder_t* str_builder,
+                    const fcc_operator_t* foreach,
+                    const char* wrapper_name,
+                    const char* source,
+                    bool all_globals,
+                    char (*changed_type_names)[FCC_MAX_QUALIFIED_TYPE_NAME])
+{
+  const uint32_t ncols = foreach->m_num_columns;
+  char ptr[FCC_MAX_BLOCK_VARNAME];
+  for(uint32_t j = 0; j < ncols; ++j) 
+  {
+    if(changed_type_names[j][0] != '\0')
+    {
+      snprintf(ptr, FCC_MAX_BLOCK_VARNAME, "data_%d", j);
+      generate_block_snapshot(str_builder, changed_type_names[j], j, ptr);
+    }
+  }
+
+  if(all_globals)
+  {
+    fdb_str_builder_append(str_builder, "%s->run_block(&context,\n0,\nNULL,\n1", 
+                           wrapper_name);
+  }
+  else
+  {
+    fdb_str_builder_append(str_builder, "%s->run_block(&context,\n%s->m_start,\n&%s->m_enabled,\nFDB_TABLE_BLOCK_SIZE", 
+                           wrapper_name, 
+                           source,
+                           source);
+  }
+
+  for(uint32_t j = 0; j < ncols; ++j) 
+  {
+    // Components and references are passed as the arrays of the block, and
+    // globals as the pointer to the global
+    fdb_str_builder_append(str_builder,",\ndata_%d",j);
+  }
+  fdb_str_builder_append(str_builder,");\n"); 
+
+  for(uint32_t j = 0; j < ncols; ++j) 
+  {
+    if(changed_type_names[j][0] != '\0')
+    {
+      fdb_str_builder_append(str_builder, "{\n");
+      fdb_str_builder_append(str_builder, "fdb_bitmap_iter_t changed_iter;\n");
+      fdb_str_builder_append(str_builder, "fdb_bitmap_iter_init(&changed_iter, &%s->m_enabled);\n", source);
+      fdb_str_builder_append(str_builder, "uint32_t i;\n");
+      fdb_str_builder_append(str_builder, "while(fdb_bitmap_iter_next(&changed_iter, &i))\n{\n");
+      snprintf(ptr, FCC_MAX_BLOCK_VARNAME, "&data_%d[i]", j);
+      generate_changed_check(str_builder, changed_type_names[j], j, ptr, "i", source);
+      fdb_str_builder_append(str_builder, "}\n}\n");
+    }
+  }
+
+  for(uint32_t j = ncols; j > 0; --j) 
+  {
+    if(changed_type_names[j-1][0] != '\0')
+    {
+      generate_block_snapshot_release(str_builder, j-1);
+    }
+  }
+}
+
+/**
+ * \brief Generates the branch that runs pure systems on mostly dense clusters
+ * (at least FDB_TABLE_BLOCK_DENSE_THRESHOLD enabled rows). The systems run
+ * on all the rows in a branch-free loop, as for fully dense clusters, and the
+ * writable columns of the disabled rows are then restored from a backup taken
+ * before the loop. The backups are too large for the stacks of the workers, so
+ * they are taken from the task allocator and released in reverse order at the
+ * end of the branch. The backups of SoA columns are copies of their raw
+ * blocks, and are restored field by field (see generate_soa_columns).
+ *
+ * \param fd The file to write the code to
+ * \param foreach The foreach operator
+ * \param source The cluster the systems run on
+ * \param soa_mstructs The reflection data of the SoA columns
+ * \param body The code running the systems on row i
+ */
+static void
+generate_masked_dense_loop(FILE* fd,
+                           const fcc_operator_t* foreach,
+                           const char* source,
+                           fdb_mstruct_t** soa_mstructs,
+                           const char* body)
+{
+  fprintf(fd,
+          "else if(%s->m_enabled.m_num_set >= FDB_TABLE_BLOCK_DENSE_THRESHOLD)\n{\n",
+          source);
+
+  bool writable[FCC_MAX_OPERATOR_NUM_COLUMNS];
+  char type_names[FCC_MAX_OPERATOR_NUM_COLUMNS][FCC_MAX_QUALIFIED_TYPE_NAME];
+  for(uint32_t j = 0; j < foreach->m_num_columns; ++j)
+  {
+    const fcc_column_t* column = &foreach->m_columns[j];
+    writable[j] = column->m_type == fcc_column_type_t::E_COMPONENT && 
+                  column->m_access_mode == fcc_access_mode_t::E_READ_WRITE;
+    if(!writable[j])
+    {
+      continue;
+    }
+    fcc_type_qualified_name(column->m_component_type,
+                            type_names[j],
+                            FCC_MAX_QUALIFIED_TYPE_NAME);
+    fprintf(fd,
+            "char* backup_%d = (char*)fdb_stack_alloc_alloc(&task_allocator, alignof(%s), FDB_TABLE_BLOCK_SIZE*sizeof(%s), FDB_NO_HINT);\n",
+            j,
+            type_names[j],
+            type_names[j]);
+    fprintf(fd,
+            "memcpy(backup_%d, data_%d, FDB_TABLE_BLOCK_SIZE*sizeof(%s));\n",
+            j,
+            j,
+            type_names[j]);
+  }
+
+  fprintf(fd,
+          "for (size_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)\n{\n");
+  fprintf(fd,
+          "%s",
+          body);
+  fprintf(fd,
+          "}\n");
+
+  // The disabled rows are visited word by word from the complement of the
+  // enabled bitmap
+  fprintf(fd,
+          "for (uint32_t w = 0; w < FDB_BITMAP_NUM_WORDS(FDB_TABLE_BLOCK_SIZE); ++w)\n{\n");
+  fprintf(fd,
+          "uint64_t holes = ~%s->m_enabled.p_data[w];\n",
+          source);
+  fprintf(fd,
+          "while(holes != 0)\n{\n");
+  fprintf(fd,
+          "const uint32_t i = (w << 6) + (uint32_t)__builtin_ctzll(holes);\n");
+  for(uint32_t j = 0; j < foreach->m_num_columns; ++j)
+  {
+    if(!writable[j])
+    {
+      continue;
+    }
+
+    const fdb_mstruct_t* mstruct = soa_mstructs[j];
+    if(mstruct == nullptr)
+    {
+      fprintf(fd,
+              "memcpy(&data_%d[i], &backup_%d[i*sizeof(%s)], sizeof(%s));\n",
+              j,
+              j,
+              type_names[j],
+              type_names[j]);
+      continue;
+    }
+
+    for(uint32_t f = 0; f < mstruct->m_nfields; ++f)
+    {
+      fdb_str_builder_t size;
+      fdb_str_builder_init(&size);
+      generate_soa_column_size(&size, type_names[j], mstruct, f);
+      fprintf(fd,
+              "memcpy(soa_%d_%d + i*%s, &backup_%d[FDB_TABLE_BLOCK_SIZE*offsetof(%s, %s) + i*%s], %s);\n",
+              j,
+              f,
+              size.p_buffer,
+              j,
+              type_names[j],
+              mstruct->p_fields[f]->m_name,
+              size.p_buffer,
+              size.p_buffer);
+      fdb_str_builder_release(&size);
+    }
+  }
+  fprintf(fd,
+          "holes &= holes - 1;\n");
+  fprintf(fd,
+          "}\n");
+  fprintf(fd,
+          "}\n");
+
+  for(uint32_t j = foreach->m_num_columns; j > 0; --j)
+  {
+    if(writable[j-1])
+    {
+      fprintf(fd,
+              "fdb_stack_alloc_pop(&task_allocator, backup_%d);\n",
+              j-1);
+    }
+  }
+  fprintf(fd,
+          "}\n");
+}
+
 void 
 consume(FILE*fd,
         const fcc_operator_t* fcc_operator,
@@ -104,6 +559,9 @@ consume(FILE*fd,
     case fcc_operator_type_t::E_CROSS_JOIN:
       consume_cross_join(fd, fcc_operator, source, caller);
       break;
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      consume_multi_join(fd, fcc_operator, source, caller);
+      break;
     case fcc_operator_type_t::E_FETCH:
       consume_fetch(fd, fcc_operator, source, caller);
       break;
@@ -144,10 +602,22 @@ consume_foreach(FILE*fd,
   }
 
 
+  // The systems access the components of SoA tables through row_<i>, loaded
+  // from the columns of the block before running them on row i and stored back
+  // after
+  const bool block = foreach->m_foreach.p_systems[0]->m_block;
+  fdb_mregistry_t reg;
+  fdb_mregistry_init(&reg, NULL);
+  fdb_mstruct_t* soa_mstructs[FCC_MAX_OPERATOR_NUM_COLUMNS];
+  char soa_type_names[FCC_MAX_OPERATOR_NUM_COLUMNS][FCC_MAX_QUALIFIED_TYPE_NAME];
+  // The type names of the columns whose changes are tracked, or empty
+  char changed_type_names[FCC_MAX_OPERATOR_NUM_COLUMNS][FCC_MAX_QUALIFIED_TYPE_NAME];
+
   int param_index = 0;
   for(uint32_t i = 0; i < ncols; ++i) 
   {
     const fcc_column_t* column = &foreach->m_columns[i];
+    soa_mstructs[i] = get_soa_mstruct(column, &reg);
     if(column->m_type == fcc_column_type_t::E_ID)
     {
       FCC_CONTEXT_REPORT_COMPILATION_ERROR(fcc_compilation_error_type_t::E_INVALID_COLUMN_TYPE,
@@ -159,6 +629,11 @@ consume_foreach(FILE*fd,
     fcc_type_qualified_name(column->m_component_type,
                             tmp,
                             FCC_MAX_QUALIFIED_TYPE_NAME);
+    changed_type_names[i][0] = '\0';
+    if(is_changed_tracked(column))
+    {
+      FDB_COPY_AND_CHECK_STR(changed_type_names[i], tmp, FCC_MAX_QUALIFIED_TYPE_NAME);
+    }
 
     switch(column->m_type)
     {
@@ -170,6 +645,23 @@ consume_foreach(FILE*fd,
                 tmp, 
                 source, 
                 param_index);
+        generate_layout_check(fd, source, param_index, soa_mstructs[i] != nullptr);
+        if(soa_mstructs[i] != nullptr)
+        {
+          if(block)
+          {
+            FCC_CONTEXT_REPORT_COMPILATION_ERROR(fcc_compilation_error_type_t::E_INVALID_COLUMN_TYPE,
+                                                 "Systems with run_block cannot be applied to \
+                                                 components of SoA tables: \"%s\"", 
+                                                 tmp);
+          }
+          FDB_COPY_AND_CHECK_STR(soa_type_names[i], tmp, FCC_MAX_QUALIFIED_TYPE_NAME);
+          generate_soa_columns(fd, 
+                               soa_type_names[i], 
+                               soa_mstructs[i], 
+                               param_index, 
+                               column->m_access_mode == fcc_access_mode_t::E_READ_WRITE);
+        }
         break;
       case fcc_column_type_t::E_REFERENCE:
         fprintf(fd,
@@ -199,11 +691,20 @@ consume_foreach(FILE*fd,
 
   fdb_str_builder_t str_builder;
   fdb_str_builder_init(&str_builder);
-  //uint32_t size = foreach->p_systems.size();
-  //for(uint32_t i = 0; i < size; ++i)
+  // Merged foreach operators run all their systems on each row before moving
+  // to the next one, so the row is loaded only once. Systems with run_block
+  // are called once for the whole cluster instead (see generate_block_call)
+  for(uint32_t j = 0; j < ncols && !block; ++j) 
   {
-    //const fcc_system_t* info = foreach->p_systems[i];
-    const fcc_system_t* info = foreach->m_foreach.p_system;
+    if(soa_mstructs[j] != nullptr)
+    {
+      generate_soa_row_load(&str_builder, soa_type_names[j], soa_mstructs[j], j);
+    }
+  }
+  const uint32_t num_systems = foreach->m_foreach.m_num_systems;
+  for(uint32_t s = 0; s < num_systems; ++s)
+  {
+    const fcc_system_t* info = foreach->m_foreach.p_systems[s];
 
     char system_name[FCC_MAX_TYPE_NAME];
     fcc_type_name(info->m_system_type, 
@@ -217,6 +718,30 @@ consume_foreach(FILE*fd,
                                  wrapper_name, 
                                  FCC_MAX_SYSTEM_WRAPPER_VARNAME);
 
+    // Each system gets its own scope, since the snapshots of the tracked
+    // columns are declared once per system
+    fdb_str_builder_append(&str_builder, "{\n");
+    if(block)
+    {
+      generate_block_call(&str_builder, 
+                          foreach, 
+                          wrapper_name, 
+                          source, 
+                          all_globals, 
+                          changed_type_names);
+      fdb_str_builder_append(&str_builder, "}\n");
+      continue;
+    }
+
+    char ptr[FCC_MAX_BLOCK_VARNAME];
+    for(uint32_t j = 0; j < ncols; ++j) 
+    {
+      if(changed_type_names[j][0] != '\0' && !all_globals)
+      {
+        snprintf(ptr, FCC_MAX_BLOCK_VARNAME, soa_mstructs[j] != nullptr ? "row_%d" : "&data_%d[i]", j);
+        generate_changed_snapshot(&str_builder, changed_type_names[j], j, ptr);
+      }
+    }
 
     if(all_globals)
     {
@@ -237,7 +762,14 @@ consume_foreach(FILE*fd,
       {
         case fcc_column_type_t::E_COMPONENT:
           // It is a component, thus we need to pass a pointer to data[i] 
-          fdb_str_builder_append(&str_builder,",\n&data_%d[i]",j);
+          if(soa_mstructs[j] != nullptr)
+          {
+            fdb_str_builder_append(&str_builder,",\n(%s*)row_%d",soa_type_names[j], j);
+          }
+          else
+          {
+            fdb_str_builder_append(&str_builder,",\n&data_%d[i]",j);
+          }
           break;
         case fcc_column_type_t::E_REFERENCE:
           // It is a reference, thus data[i] already contains a pointer
@@ -253,16 +785,56 @@ consume_foreach(FILE*fd,
       }
     }
     fdb_str_builder_append(&str_builder,");\n"); 
+
+    for(uint32_t j = 0; j < ncols; ++j) 
+    {
+      if(changed_type_names[j][0] != '\0' && !all_globals)
+      {
+        snprintf(ptr, FCC_MAX_BLOCK_VARNAME, soa_mstructs[j] != nullptr ? "row_%d" : "&data_%d[i]", j);
+        generate_changed_check(&str_builder, changed_type_names[j], j, ptr, "0", source);
+      }
+    }
+    fdb_str_builder_append(&str_builder, "}\n");
   }
 
-  if(all_globals)
+  for(uint32_t j = 0; j < ncols && !block; ++j) 
   {
+    const fcc_column_t* column = &foreach->m_columns[j];
+    if(soa_mstructs[j] != nullptr &&
+       column->m_access_mode == fcc_access_mode_t::E_READ_WRITE)
+    {
+      generate_soa_row_store(&str_builder, soa_type_names[j], soa_mstructs[j], j);
+    }
+  }
+
+  if(block && !all_globals)
+  {
+    fprintf(fd,
+            "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_ROWS_RUN, %s->m_enabled.m_num_set);\n",
+            foreach->m_id,
+            foreach->m_name,
+            source);
+    fprintf(fd,
+            "%s",
+            str_builder.p_buffer);
+  }
+  else if(all_globals)
+  {
+    fprintf(fd,
+            "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_ROWS_RUN, 1);\n",
+            foreach->m_id,
+            foreach->m_name);
     fprintf(fd,
             "%s",
             str_builder.p_buffer);
   }
   else
   {
+    fprintf(fd,
+            "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_ROWS_RUN, %s->m_enabled.m_num_set);\n",
+            foreach->m_id,
+            foreach->m_name,
+            source);
     fprintf(fd,
             "if(%s->m_enabled.m_num_set == FDB_TABLE_BLOCK_SIZE)\n{\n", 
             source);
@@ -276,18 +848,30 @@ consume_foreach(FILE*fd,
             "}\n");
     fprintf(fd,
             "}\n");
+    if(can_run_masked(foreach))
+    {
+      generate_masked_dense_loop(fd, 
+                                 foreach, 
+                                 source, 
+                                 soa_mstructs, 
+                                 str_builder.p_buffer);
+    }
     fprintf(fd,
             "else\n{\n");
+    // Visit only the set bits, so sparse blocks cost one iteration per
+    // enabled entity
     fprintf(fd,
-            "for (size_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)\n{\n");
+            "fdb_bitmap_iter_t bit_iter;\n");
     fprintf(fd,
-            "if(fdb_bitmap_is_set(&%s->m_enabled, i))\n{\n", 
+            "fdb_bitmap_iter_init(&bit_iter, &%s->m_enabled);\n", 
             source);
+    fprintf(fd,
+            "uint32_t i;\n");
+    fprintf(fd,
+            "while(fdb_bitmap_iter_next(&bit_iter, &i))\n{\n");
     fprintf(fd,
             "%s",
             str_builder.p_buffer);
-    fprintf(fd,
-            "}\n");
 
     fprintf(fd,
             "}\n");
@@ -296,6 +880,7 @@ consume_foreach(FILE*fd,
             "}\n");
   }
   fdb_str_builder_release(&str_builder);
+  fdb_mregistry_release(&reg);
 
   if(foreach->m_parent != FCC_INVALID_ID)
   {
@@ -316,12 +901,119 @@ consume_scan(FILE*fd,
 {
 }
 
+/**
+ * \brief Consumes a block of the right input of a merge join (see
+ * produce_merge_join). The iterator over the left table is advanced until it
+ * reaches the block id of the consumed block, and if the left table has a block
+ * with such id, both are joined and pushed to the parent operator. Since the
+ * right input comes sorted by block id, the left table is traversed only once.
+ *
+ * \param fd The file to write the code to
+ * \param join The join or left filter join operator 
+ * \param source The cluster of the right input to consume
+ * \param filter Whether the right input only filters the left one (left filter
+ * join) or its columns are appended to the joined cluster (join)
+ */
+static void
+consume_merge_join(FILE*fd, 
+                   const fcc_operator_t* join,
+                   const char* source,
+                   bool filter)
+{
+  char itername[FCC_MAX_ITER_VARNAME];
+  generate_merge_iter_name(join,
+                           itername,
+                           FCC_MAX_ITER_VARNAME);
+
+  fprintf(fd,
+          "uint32_t %s_probe = %s->m_start / FDB_TABLE_BLOCK_SIZE;\n",
+          itername,
+          source);
+  fprintf(fd,
+          "while((%s_block == NULL || %s_block->m_start / FDB_TABLE_BLOCK_SIZE < %s_probe) && fdb_table_iter_has_next(&%s))\n{\n",
+          itername,
+          itername,
+          itername,
+          itername);
+  fprintf(fd,
+          "%s_block = fdb_table_iter_next(&%s);\n",
+          itername,
+          itername);
+  fprintf(fd,"}\n");
+
+  fprintf(fd,
+          "if(%s_block != NULL && %s_block->m_start / FDB_TABLE_BLOCK_SIZE == %s_probe)\n{\n",
+          itername,
+          itername,
+          itername);
+
+  char clustername[FCC_MAX_CLUSTER_VARNAME];
+  generate_cluster_name(join,
+                        clustername,
+                        FCC_MAX_CLUSTER_VARNAME);
+
+  fprintf(fd,
+          "fdb_bcluster_t %s;\n", 
+          clustername);
+  fprintf(fd,
+          "fdb_bcluster_init(&%s, &task_allocator.m_super);\n", 
+          clustername);
+  // Swapped joins produce the columns of the streamed input first
+  bool swapped = join->m_type == fcc_operator_type_t::E_JOIN && 
+                 join->m_join.m_swapped;
+  if(swapped)
+  {
+    fprintf(fd,
+            "fdb_bcluster_append_cluster(&%s, %s);\n", 
+            clustername, 
+            source);
+  }
+  fprintf(fd,
+          "fdb_bcluster_append_block(&%s, %s_block);\n", 
+          clustername,
+          itername);
+  if(!swapped)
+  {
+    fprintf(fd,
+            "%s(&%s, %s);\n", 
+            filter ? "fdb_bcluster_filter" : "fdb_bcluster_append_cluster",
+            clustername, 
+            source);
+  }
+  fprintf(fd,
+          "if(%s.m_enabled.m_num_set != 0)\n{\n", 
+          clustername);
+
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  fdb_str_builder_append(&str_builder, "(&%s)", clustername);
+  fcc_subplan_t* subplan = join->p_subplan;
+  consume(fd,
+          &subplan->m_nodes[join->m_parent],
+          str_builder.p_buffer,
+          join);
+  fdb_str_builder_release(&str_builder);
+
+  fprintf(fd,"}\n");
+
+  fprintf(fd,
+          "fdb_bcluster_release(&%s, &task_allocator.m_super);\n", 
+          clustername);
+
+  fprintf(fd,"}\n");
+}
+
 void
 consume_join(FILE*fd, 
              const fcc_operator_t* join,
              const char* source,
              const fcc_operator_t* caller)
 {
+  if(is_merge_join(join))
+  {
+    consume_merge_join(fd, join, source, false);
+    return;
+  }
 
   char hashtable[FCC_MAX_HASHTABLE_VARNAME];
   generate_hashtable_name(join,
@@ -364,13 +1056,27 @@ consume_join(FILE*fd,
     fprintf(fd,
             "fdb_bcluster_init(&%s, &task_allocator.m_super);\n", 
             clustername);
-    fprintf(fd,
-            "fdb_bcluster_append_cluster(&%s, build);\n", 
-            clustername);
-    fprintf(fd,
-            "fdb_bcluster_append_cluster(&%s, %s);\n", 
-            clustername, 
-            source);
+    // Swapped joins produce the columns of the probe input first
+    if(join->m_join.m_swapped)
+    {
+      fprintf(fd,
+              "fdb_bcluster_append_cluster(&%s, %s);\n", 
+              clustername, 
+              source);
+      fprintf(fd,
+              "fdb_bcluster_append_cluster(&%s, build);\n", 
+              clustername);
+    }
+    else
+    {
+      fprintf(fd,
+              "fdb_bcluster_append_cluster(&%s, build);\n", 
+              clustername);
+      fprintf(fd,
+              "fdb_bcluster_append_cluster(&%s, %s);\n", 
+              clustername, 
+              source);
+    }
     fprintf(fd,
             "if(%s.m_enabled.m_num_set != 0)\n{\n", 
             clustername);
@@ -401,6 +1107,12 @@ consume_leftfilter_join(FILE*fd,
                         const char* source,
                         const fcc_operator_t* caller)
 {
+  if(is_merge_join(left_filter_join))
+  {
+    consume_merge_join(fd, left_filter_join, source, true);
+    return;
+  }
+
   char hashtable[FCC_MAX_HASHTABLE_VARNAME];
   generate_hashtable_name(left_filter_join,
                           hashtable,
@@ -531,6 +1243,17 @@ consume_cross_join(FILE*fd,
   }
 }
 
+void
+consume_multi_join(FILE*fd, 
+                   const fcc_operator_t* multi_join,
+                   const char* source,
+                   const fcc_operator_t* caller)
+{
+  // The inputs of a multi join are never produced, since produce_multi_join
+  // iterates their tables directly
+  FDB_ASSERT(false && "Multi join inputs cannot be consumed");
+}
+
 void
 consume_fetch(FILE*fd, 
               const fcc_operator_t* fetch,
@@ -556,54 +1279,31 @@ consume_tag_filter(FILE*fd,
 
   if(!tag_filter->m_tag_filter.m_on_column)
   {
-    fprintf(fd,
-            "const fdb_bitmap_t* filter = fdb_bittable_get_bitmap(%s, %s->m_start);\n", 
-            fdb_bittable_name, 
-            source);
-
+    // The bits of the block are intersected straight from the containers of
+    // the bittable, without materializing a bitmap per block
     switch(tag_filter->m_tag_filter.m_op_type) 
     {
       case fcc_filter_op_type_t::E_HAS:
         {
-
-          fprintf(fd,
-                  "if(filter != nullptr){\n");
           fprintf(fd,
-                  "fdb_bitmap_set_and(&%s->m_enabled, filter);\n",
+                  "fdb_bittable_block_and(%s, %s->m_start, &%s->m_enabled);\n",
+                  fdb_bittable_name, 
+                  source,
                   source);
-          fprintf(fd,
-                  "}\n");
-          fprintf(fd,
-                  "else {\n");
-          fprintf(fd,
-                  "fdb_bitmap_nullify(&%s->m_enabled);\n",
-                  source);
-          fprintf(fd,
-                  "}\n");
           break;
         }
       case fcc_filter_op_type_t::E_HAS_NOT:
         {
-
-          fprintf(fd, 
-                  "fdb_bitmap_t negate;\n");
-          fprintf(fd, 
-                  "fdb_bitmap_init(&negate, FDB_TABLE_BLOCK_SIZE, &task_allocator.m_super);\n");
           fprintf(fd,
-                  "if(filter != nullptr){\n");
-          fprintf(fd, 
-                  "fdb_bitmap_set_bitmap(&negate, filter);\n");
-          fprintf(fd,
-                  "}\n");
-          fprintf(fd, 
-                  "fdb_bitmap_negate(&negate);\n");
-          fprintf(fd,
-                  "fdb_bitmap_set_and(&%s->m_enabled, &negate);\n",
+                  "fdb_bittable_block_diff(%s, %s->m_start, &%s->m_enabled);\n",
+                  fdb_bittable_name, 
+                  source,
                   source);
-          fprintf(fd, 
-                  "fdb_bitmap_release(&negate, &task_allocator.m_super);\n");
           break;
         }
+      default:
+        FDB_ASSERT(false && "Should not reach this point");
+        break;
     }
   }
   else
@@ -634,9 +1334,17 @@ consume_tag_filter(FILE*fd,
                   source);
           break;
         }
+      default:
+        FDB_ASSERT(false && "Should not reach this point");
+        break;
     }
   }
 
+  fprintf(fd,
+          "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_ROWS_FILTERED, %s->m_enabled.m_num_set);\n",
+          tag_filter->m_id,
+          tag_filter->m_name,
+          source);
   fprintf(fd,
           "if(%s->m_enabled.m_num_set != 0)\n{\n",
           source); 
@@ -655,14 +1363,66 @@ consume_component_filter(FILE*fd,
                          const char* source,
                          const fcc_operator_t* caller)
 {
-  FCC_CONTEXT_REPORT_COMPILATION_ERROR(fcc_compilation_error_type_t::E_INVALID_COLUMN_TYPE,
-                                       "Component filter not yet implemented");
-  // if ...
+  if(component_filter->m_component_filter.m_op_type != fcc_filter_op_type_t::E_CHANGED)
+  {
+    FCC_CONTEXT_REPORT_COMPILATION_ERROR(fcc_compilation_error_type_t::E_INVALID_COLUMN_TYPE,
+                                         "Component filter not yet implemented");
+  }
+
+  // Changed filters read the change frames of the block of the filtered
+  // component, which must be one of the columns 
+  char filter_type[FCC_MAX_TYPE_NAME];
+  fcc_type_name(component_filter->m_component_filter.m_filter_type,
+                filter_type,
+                FCC_MAX_TYPE_NAME);
+  uint32_t column_idx = FCC_INVALID_ID;
+  for(uint32_t i = 0; 
+      i < component_filter->m_num_columns && !component_filter->m_component_filter.m_on_column; 
+      ++i)
+  {
+    const fcc_column_t* column = &component_filter->m_columns[i];
+    char column_type[FCC_MAX_TYPE_NAME];
+    fcc_type_name(column->m_component_type,
+                  column_type,
+                  FCC_MAX_TYPE_NAME);
+    if(column->m_type == fcc_column_type_t::E_COMPONENT && 
+       strcmp(column_type, filter_type) == 0)
+    {
+      column_idx = i;
+      break;
+    }
+  }
+
+  if(column_idx == FCC_INVALID_ID)
+  {
+    FCC_CONTEXT_REPORT_COMPILATION_ERROR(fcc_compilation_error_type_t::E_INVALID_COLUMN_TYPE,
+                                         "Changed filter on component \"%s\" requires\
+                                         the component to be matched", 
+                                         filter_type);
+  }
+
+  fprintf(fd,"\n");
+  fprintf(fd,
+          "fdb_table_block_filter_changed(fdb_bcluster_get_tblock(%s, %u), &%s->m_enabled, changed_since_%u, context.p_database->m_frame);\n",
+          source,
+          column_idx,
+          source,
+          component_filter->m_id);
+  fprintf(fd,
+          "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_ROWS_FILTERED, %s->m_enabled.m_num_set);\n",
+          component_filter->m_id,
+          component_filter->m_name,
+          source);
+  fprintf(fd,
+          "if(%s->m_enabled.m_num_set != 0)\n{\n",
+          source); 
   fcc_subplan_t* subplan = component_filter->p_subplan;
   consume(fd,
           &subplan->m_nodes[component_filter->m_parent],
-          "cluster",
+          source,
           component_filter);
+  fprintf(fd,
+          "}\n");
 }
 
 void
@@ -673,11 +1433,17 @@ consume_predicate_filter(FILE*fd,
 {
   // if ...
   fprintf(fd,"\n");
+  fdb_mregistry_t reg;
+  fdb_mregistry_init(&reg, NULL);
+  fdb_mstruct_t* soa_mstructs[FCC_MAX_OPERATOR_NUM_COLUMNS];
+  char soa_type_names[FCC_MAX_OPERATOR_NUM_COLUMNS][FCC_MAX_QUALIFIED_TYPE_NAME];
+
   int param_index = 0;
   uint32_t ncols = predicate_filter->m_num_columns;
   for(uint32_t i = 0; i < ncols; ++i)  
   {
     const fcc_column_t* column = &predicate_filter->m_columns[i];
+    soa_mstructs[i] = get_soa_mstruct(column, &reg);
     if(column->m_type == fcc_column_type_t::E_ID)
     {
       FCC_CONTEXT_REPORT_COMPILATION_ERROR(fcc_compilation_error_type_t::E_INVALID_COLUMN_TYPE,
@@ -701,6 +1467,14 @@ consume_predicate_filter(FILE*fd,
                 tmp, 
                 source, 
                 param_index);
+        generate_layout_check(fd, source, param_index, soa_mstructs[i] != nullptr);
+        if(soa_mstructs[i] != nullptr)
+        {
+          // Predicates only read the components, so the rows of SoA columns
+          // are loaded but not stored back
+          FDB_COPY_AND_CHECK_STR(soa_type_names[i], tmp, FCC_MAX_QUALIFIED_TYPE_NAME);
+          generate_soa_columns(fd, soa_type_names[i], soa_mstructs[i], param_index, false);
+        }
         break;
       case fcc_column_type_t::E_REFERENCE:
         fprintf(fd,
@@ -752,6 +1526,19 @@ consume_predicate_filter(FILE*fd,
   fprintf(fd,
           "for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE && (%s->m_enabled.m_num_set != 0); ++i) \n{\n",
           source);
+
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  for(uint32_t i = 0; i < ncols; ++i)
+  {
+    if(soa_mstructs[i] != nullptr)
+    {
+      generate_soa_row_load(&str_builder, soa_type_names[i], soa_mstructs[i], i);
+    }
+  }
+  fprintf(fd, "%s", str_builder.p_buffer);
+  fdb_str_builder_release(&str_builder);
+
   fprintf(fd,
           "fdb_bitmap_set_bit(&%s->m_enabled, i, fdb_bitmap_is_set(&%s->m_enabled, i) && %s(",
           source,
@@ -764,7 +1551,14 @@ consume_predicate_filter(FILE*fd,
   {
     case fcc_column_type_t::E_COMPONENT:
       // It is a component, thus we need to pass a pointer to data[i] 
-      fprintf(fd,"&data_0[i]");
+      if(soa_mstructs[0] != nullptr)
+      {
+        fprintf(fd,"(%s*)row_0", soa_type_names[0]);
+      }
+      else
+      {
+        fprintf(fd,"&data_0[i]");
+      }
       break;
     case fcc_column_type_t::E_REFERENCE:
       // It is a reference, thus data[i] already contains a pointer
@@ -786,7 +1580,14 @@ consume_predicate_filter(FILE*fd,
     {
       case fcc_column_type_t::E_COMPONENT:
         // It is a component, thus we need to pass a pointer to data[i] 
-        fprintf(fd,",&data_%zu[i]", i);
+        if(soa_mstructs[i] != nullptr)
+        {
+          fprintf(fd,",(%s*)row_%zu", soa_type_names[i], i);
+        }
+        else
+        {
+          fprintf(fd,",&data_%zu[i]", i);
+        }
         break;
       case fcc_column_type_t::E_REFERENCE:
         // It is a reference, thus data[i] already contains a pointer
@@ -803,6 +1604,11 @@ consume_predicate_filter(FILE*fd,
   }
   fprintf(fd, "));\n");
   fprintf(fd, "}\n");
+  fprintf(fd,
+          "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_ROWS_FILTERED, %s->m_enabled.m_num_set);\n",
+          predicate_filter->m_id,
+          predicate_filter->m_name,
+          source);
   fprintf(fd,
           "if(%s->m_enabled.m_num_set != 0)\n{\n",
           source); 
@@ -812,6 +1618,7 @@ consume_predicate_filter(FILE*fd,
           source,
           predicate_filter);
   fprintf(fd, "}\n");
+  fdb_mregistry_release(&reg);
 }
 
 void
@@ -824,35 +1631,46 @@ consume_gather(FILE*fd,
 
   if(caller->m_id == gather->m_gather.m_ref_table) 
   {
-    // FILLING UP TEMPORAL TABLES
-    fprintf(fd,
-            "fdb_table_t* temp_tables[] = {");
+    // GATHERING THE BLOCK INTO THE COLUMNS OF POINTERS
     fcc_operator_t* child = &subplan->m_nodes[gather->m_gather.m_child];
-    fcc_column_t* child_columns = child->m_columns;
     uint32_t ncols = child->m_num_columns;
-    for(uint32_t i = 0; i < ncols; ++i)
-    {
-      fcc_column_t* column = &child_columns[i];
-      char ctype[FCC_MAX_TYPE_NAME];
-      fcc_type_name(column->m_component_type,
-                    ctype,
-                    FCC_MAX_TYPE_NAME); 
-
-      char tablename[FCC_MAX_TABLE_VARNAME];
-      generate_temp_table_name(ctype, tablename, 
-                               FCC_MAX_TABLE_VARNAME,
-                               gather);
-
+    fprintf(fd,
+            "gather(%s, hash_tables, chunk_size, stride, gather_columns_%u, %u);\n",
+            source,
+            gather->m_id,
+            ncols);
 
-      fprintf(fd,"%s, ",
-              tablename);
-    }
-    fprintf(fd,"nullptr};\n");
+    char clustername[FCC_MAX_CLUSTER_VARNAME];
+    generate_cluster_name(gather,
+                          clustername,
+                          FCC_MAX_CLUSTER_VARNAME);
 
+    fprintf(fd, "fdb_bcluster_t %s;\n", clustername);
+    fprintf(fd, "fdb_bcluster_init(&%s, &task_allocator.m_super);\n", clustername);
     fprintf(fd,
-            "gather(%s,hash_tables, chunk_size, stride, temp_tables, %d);\n",
-            source,
+            "for(uint32_t i = 0; i < %u; ++i)\n{\n",
             ncols);
+    fprintf(fd,
+            "fdb_bcluster_append_block(&%s, &gather_columns_%u[i]);\n",
+            clustername,
+            gather->m_id);
+    fprintf(fd,
+            "}\n");
+
+    fprintf(fd,
+            "if(%s.m_enabled.m_num_set != 0)\n{\n",
+            clustername); 
+    fdb_str_builder_t str_builder;
+    fdb_str_builder_init(&str_builder);
+    fdb_str_builder_append(&str_builder, "(&%s)", clustername);
+    consume(fd,
+            &subplan->m_nodes[gather->m_parent],
+            str_builder.p_buffer,
+            gather);
+    fdb_str_builder_release(&str_builder);
+    fprintf(fd, "}\n");
+
+    fprintf(fd, "fdb_bcluster_release(&%s, &task_allocator.m_super);\n", clustername);
   }
   else
   {
@@ -890,62 +1708,48 @@ consume_cascading_gather(FILE*fd,
   fcc_subplan_t* subplan = casc_gather->p_subplan;
   if(caller->m_id == casc_gather->m_cascading_gather.m_ref_table) 
   {
+    // Roots are only needed when the reference table has no hierarchy index
+    // to take the levels from
+    char reftable[FCC_MAX_REF_TABLE_VARNAME];
+    generate_ref_table_name(caller->m_columns[0].m_ref_name,
+                            reftable,
+                            FCC_MAX_REF_TABLE_VARNAME);
+    fprintf(fd,
+            "if(!fdb_reftable_has_hierarchy(%s))\n{\n",
+            reftable);
     fprintf(fd,
             "find_roots_and_blacklist(%s, &next_frontier_%u, &partial_blacklist_%u);\n", 
             source,
             casc_gather->m_id,
             casc_gather->m_id);
-
-    // FILLING UP TEMPORAL TABLES
     fprintf(fd,
-            "fdb_table_t* temp_tables[] = {");
+            "}\n");
 
+    // GATHERING THE BLOCK INTO ITS OWN COLUMNS OF POINTERS, which are kept
+    // together with the references until the traversal ends
     fcc_operator_t* child = &subplan->m_nodes[casc_gather->m_gather.m_child];
-    fcc_column_t* child_columns = child->m_columns;
     uint32_t ncols = child->m_num_columns;
-    for(uint32_t i = 0; i < ncols; ++i)
-    {
-      fcc_column_t* column = &child_columns[i];
-      char ctype[FCC_MAX_TYPE_NAME];
-      fcc_type_name(column->m_component_type,
-                    ctype,
-                    FCC_MAX_TYPE_NAME); 
-
-      char tablename[FCC_MAX_TABLE_VARNAME];
-      generate_temp_table_name(ctype, tablename, 
-                               FCC_MAX_TABLE_VARNAME,
-                               casc_gather);
-
-
-      fprintf(fd,"%s, ",
-              tablename);
-    }
-    fprintf(fd,"nullptr};\n");
-
-    fprintf(fd,
-            "gather(%s, hash_tables, chunk_size, stride, temp_tables, %d);\n",
-            source,
-            ncols);
 
     char hashtable[FCC_MAX_HASHTABLE_VARNAME];
     generate_hashtable_name(casc_gather,
                             hashtable,
                             FCC_MAX_HASHTABLE_VARNAME);
 
-
     fprintf(fd, 
-            "fdb_bcluster_t* cluster = (fdb_bcluster_t*)mem_alloc(&task_allocator.m_super, 64, sizeof(fdb_bcluster_t), %s->m_start / FDB_TABLE_BLOCK_SIZE);\n", 
+            "fdb_gather_block_t* gblock = (fdb_gather_block_t*)mem_alloc(&task_allocator.m_super, 64, sizeof(fdb_gather_block_t), %s->m_start / FDB_TABLE_BLOCK_SIZE);\n", 
             source); 
 
     fprintf(fd, 
-            "fdb_bcluster_init(cluster, &task_allocator.m_super);\n");
+            "gather_block_init(gblock, %s, %u, &task_allocator.m_super);\n",
+            source,
+            ncols);
 
-    fprintf(fd, 
-            "fdb_bcluster_append_cluster(cluster, %s);\n", 
-            source); 
+    fprintf(fd,
+            "gather(%s, hash_tables, chunk_size, stride, gblock->p_columns, gblock->m_num_columns);\n",
+            source);
 
     fprintf(fd, 
-            "fdb_btree_insert(&ref_%s, %s->m_start / FDB_TABLE_BLOCK_SIZE, cluster);\n", 
+            "fdb_btree_insert(&ref_%s, %s->m_start / FDB_TABLE_BLOCK_SIZE, gblock);\n", 
             hashtable, 
             source); 
   }
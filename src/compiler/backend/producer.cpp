@@ -71,6 +71,11 @@ produce_component_filter(FILE* fd,
         const fcc_operator_t* component_filter,
         bool parallel_stream);
 
+static void
+produce_multi_join(FILE* fd,
+                   const fcc_operator_t* multi_join,
+                   bool parallel_stream);
+
 void 
 produce(FILE* fd,
         const fcc_operator_t* fcc_operator,
@@ -93,6 +98,9 @@ produce(FILE* fd,
     case fcc_operator_type_t::E_CROSS_JOIN:
       produce_cross_join(fd, fcc_operator, parallel_stream);
       break;
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      produce_multi_join(fd, fcc_operator, parallel_stream);
+      break;
     case fcc_operator_type_t::E_FETCH:
       produce_fetch(fd, fcc_operator, parallel_stream);
       break;
@@ -151,6 +159,92 @@ produce_foreach(FILE* fd,
   }
 }
 
+/**
+ * \brief Emits a synchronization point among the threads running the current
+ * task. The barrier counts arrivals cumulatively, thus each synchronization
+ * point waits for stride more arrivals than the previous one. The last_barrier
+ * counter is declared in the task prologue of tasks requiring synchronization.
+ *
+ * \param fd The file to emit the code to
+ */
+static void
+produce_barrier(FILE* fd)
+{
+  fprintf(fd,
+          "if(stride > 1)\n{\n");
+  fprintf(fd,
+          "last_barrier += stride;\n");
+  fprintf(fd,
+          "barrier->p_wait(barrier->p_state, last_barrier);\n");
+  fprintf(fd,
+          "}\n");
+}
+
+/**
+ * \brief Checks if the blocks of a scan can be distributed dynamically among
+ * threads (morsel-driven). This is only possible when the scan is the only
+ * stream reaching the root of the subplan. Joins and gathers rely on all their
+ * input streams being partitioned identically by block id, so these require
+ * the static chunk_size/offset/stride partitioning.
+ *
+ * \param scan The scan operator to check
+ *
+ * \return True if the scan can use a morsel-driven iterator
+ */
+static bool
+is_morsel_stream(const fcc_operator_t* scan)
+{
+  if(scan->m_type == fcc_operator_type_t::E_SCAN && 
+     scan->m_scan.m_event != fcc_event_type_t::E_NONE)
+  {
+    return false;
+  }
+
+  const fcc_subplan_t* subplan = scan->p_subplan;
+  uint32_t parent = scan->m_parent;
+  while(parent != FCC_INVALID_ID)
+  {
+    const fcc_operator_t* op = &subplan->m_nodes[parent];
+    switch(op->m_type)
+    {
+      case fcc_operator_type_t::E_JOIN:
+      case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      case fcc_operator_type_t::E_CROSS_JOIN:
+      case fcc_operator_type_t::E_MULTI_JOIN:
+      case fcc_operator_type_t::E_GATHER:
+      case fcc_operator_type_t::E_CASCADING_GATHER:
+        return false;
+      default:
+        break;
+    }
+    parent = op->m_parent;
+  }
+  return true;
+}
+
+/**
+ * \brief Generates the code discarding the block being scanned by a scan or
+ * multi join loop
+ */
+static void
+generate_skip_block(FILE* fd, 
+                    const fcc_operator_t* op)
+{
+  fprintf(fd,
+          "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_BLOCKS_SKIPPED, 1);\n",
+          op->m_id,
+          op->m_name);
+  fprintf(fd, "continue;\n");
+}
+
+static bool
+is_filter(const fcc_operator_t* op)
+{
+  return op->m_type == fcc_operator_type_t::E_TAG_FILTER ||
+         op->m_type == fcc_operator_type_t::E_COMPONENT_FILTER ||
+         op->m_type == fcc_operator_type_t::E_PREDICATE_FILTER;
+}
+
 void 
 produce_scan(FILE* fd,
         const fcc_operator_t* scan,
@@ -214,69 +308,151 @@ produce_scan(FILE* fd,
 
   }
 
-  if(parallel_stream)
-  {
-    if(column[0].m_type == fcc_column_type_t::E_ID)
-    {
-      fprintf(fd,
-              "fdb_table_iter_t %s;\n",
-              itername);
-      fprintf(fd,
-              "fdb_table_iter_init(&%s, &%s->m_table, chunk_size, offset, stride);\n",
-              itername,
-              tablename);
-
-    }
-    else
-    {
+  char tableexpr[FCC_MAX_TABLE_VARNAME+16];
+  generate_scan_table_expr(scan, 
+                           tableexpr, 
+                           FCC_MAX_TABLE_VARNAME+16);
 
-      fprintf(fd,
-              "fdb_table_iter_t %s;\n",
-              itername);
-      fprintf(fd,
-              "fdb_table_iter_init(&%s, %s, chunk_size, offset, stride);\n",
-              itername,
-              tablename);
+  // Scans of events iterate the blocks with events instead of the whole
+  // table. These come sorted by block id, so they can feed any stream 
+  const char* event_type = nullptr;
+  switch(scan->m_scan.m_event)
+  {
+    case fcc_event_type_t::E_ADDED:
+      event_type = "E_FDB_TABLE_EVENT_ADDED";
+      break;
+    case fcc_event_type_t::E_REMOVED:
+      event_type = "E_FDB_TABLE_EVENT_REMOVED";
+      break;
+    default:
+      break;
+  }
+  const char* iter_prefix = event_type != nullptr ? "fdb_table_event_iter" : "fdb_table_iter";
 
-    }
+  fprintf(fd,
+          "%s_t %s;\n",
+          iter_prefix,
+          itername);
+  if(event_type != nullptr)
+  {
+    fprintf(fd,
+            "fdb_table_event_iter_init(&%s, %s, %s, %s);\n",
+            itername,
+            tableexpr,
+            event_type,
+            parallel_stream ? "chunk_size, offset, stride" : "1, 0, 1");
+  }
+  else if(parallel_stream && is_morsel_stream(scan))
+  {
+    // The morsel cursor is shared among all the threads running this task 
+    fprintf(fd,
+            "static fdb_table_morsel_t %s_morsel;\n",
+            itername);
+    fprintf(fd,
+            "fdb_table_iter_init_morsel(&%s, %s, &%s_morsel, FDB_TABLE_MORSEL_SIZE, stride);\n",
+            itername,
+            tableexpr,
+            itername);
+  }
+  else if(parallel_stream)
+  {
+    fprintf(fd,
+            "fdb_table_iter_init(&%s, %s, chunk_size, offset, stride);\n",
+            itername,
+            tableexpr);
   }
   else
   {
-    if(column[0].m_type == fcc_column_type_t::E_ID)
+    fprintf(fd,
+            "fdb_table_iter_init(&%s, %s, 1, 0, 1);\n",
+            itername,
+            tableexpr);
+  }
+
+  fprintf(fd,
+          "while(%s_has_next(&%s))\n{\n",
+          iter_prefix,
+          itername);
+  fprintf(fd, 
+          "fdb_table_block_t* %s_next = %s_next(&%s);\n",
+          blockname,
+          iter_prefix,
+          itername);
+
+  // Blocks are discarded from their summaries before building the cluster:
+  // blocks without enabled components, and blocks without any of the tags
+  // required by the filters right above the scan, and blocks without changes
+  // when the changed filters right above the scan are on the scanned component
+  fprintf(fd, 
+          "if(%s_next->m_num_enabled_components == 0)\n{\n",
+          blockname);
+  generate_skip_block(fd, scan);
+  fprintf(fd, "}\n");
+
+  fcc_subplan_t* subplan = scan->p_subplan;
+  for(uint32_t parent_id = scan->m_parent; 
+      parent_id != FCC_INVALID_ID && is_filter(&subplan->m_nodes[parent_id]); 
+      parent_id = subplan->m_nodes[parent_id].m_parent)
+  {
+    const fcc_operator_t* filter = &subplan->m_nodes[parent_id];
+    if(filter->m_type == fcc_operator_type_t::E_COMPONENT_FILTER &&
+       filter->m_component_filter.m_op_type == fcc_filter_op_type_t::E_CHANGED &&
+       !filter->m_component_filter.m_on_column && 
+       scan->m_columns[0].m_type == fcc_column_type_t::E_COMPONENT)
     {
-      fprintf(fd,
-              "fdb_table_iter_t %s;\n",
-              itername);
-      fprintf(fd,
-              "fdb_table_iter_init(&%s, &%s->m_table, 1, 0, 1);\n",
-              itername,
-              tablename);
+      char filter_type[FCC_MAX_TYPE_NAME];
+      fcc_type_name(filter->m_component_filter.m_filter_type,
+                    filter_type,
+                    FCC_MAX_TYPE_NAME);
+      char scan_type[FCC_MAX_TYPE_NAME];
+      fcc_type_name(scan->m_columns[0].m_component_type,
+                    scan_type,
+                    FCC_MAX_TYPE_NAME);
+      if(strcmp(filter_type, scan_type) == 0)
+      {
+        fprintf(fd,
+                "if(!fdb_table_block_has_changes(%s_next, changed_since_%u))\n{\n",
+                blockname,
+                filter->m_id);
+        generate_skip_block(fd, scan);
+        fprintf(fd, "}\n");
+      }
+      continue;
     }
-    else
+
+    if(filter->m_type != fcc_operator_type_t::E_TAG_FILTER || 
+       filter->m_tag_filter.m_on_column ||
+       filter->m_tag_filter.m_op_type != fcc_filter_op_type_t::E_HAS)
     {
-      fprintf(fd,
-              "fdb_table_iter_t %s;\n",
-              itername);
-      fprintf(fd,
-              "fdb_table_iter_init(&%s, %s, 1, 0, 1);\n",
-              itername,
-              tablename);
+      continue;
     }
+
+    char bittable[FCC_MAX_TAG_TABLE_VARNAME];
+    generate_bittable_name(filter->m_tag_filter.m_tag,
+                           bittable,
+                           FCC_MAX_TAG_TABLE_VARNAME);
+    fprintf(fd,
+            "if(!fdb_bittable_block_any(%s, %s_next->m_start))\n{\n",
+            bittable,
+            blockname);
+    generate_skip_block(fd, scan);
+    fprintf(fd, "}\n");
   }
 
   fprintf(fd,
-          "while(fdb_table_iter_has_next(&%s))\n\
-          {\n\
-          fdb_bcluster_t %s;\n\
-          fdb_bcluster_init(&%s, &task_allocator.m_super);\n",
-          itername,
-          blockname, 
+          "fdb_bcluster_t %s;\n",
+          blockname);
+  fprintf(fd,
+          "fdb_bcluster_init(&%s, &task_allocator.m_super);\n",
           blockname);
   fprintf(fd, 
-          "fdb_bcluster_append_block(&%s,fdb_table_iter_next(&%s));\n",
+          "fdb_bcluster_append_block(&%s, %s_next);\n",
           blockname,
-          itername
-         );
+          blockname);
+  fprintf(fd,
+          "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_BLOCKS_SCANNED, 1);\n",
+          scan->m_id,
+          scan->m_name);
 
   fdb_str_builder_t str_builder;
   fdb_str_builder_init(&str_builder);
@@ -284,7 +460,6 @@ produce_scan(FILE* fd,
                      "(&%s)", 
                      blockname);
 
-  fcc_subplan_t* subplan = scan->p_subplan;
   consume(fd,
           &subplan->m_nodes[scan->m_parent],
           str_builder.p_buffer,
@@ -300,15 +475,76 @@ produce_scan(FILE* fd,
           "}\n\n");
 
     fprintf(fd,
-            "fdb_table_iter_release(&%s);\n",
+            "%s_release(&%s);\n",
+            iter_prefix,
             itername);
 }
 
+/**
+ * \brief Produces a merge join. Instead of materializing its left input, the
+ * join iterates the table scanned by its left input in lockstep with the
+ * blocks streamed by its right input, which come sorted by block id (see
+ * consume_merge_join)
+ *
+ * \param fd The file to write the code to
+ * \param join The join or left filter join to produce
+ * \param left The left input of the join, which is a scan
+ * \param right The right input of the join
+ * \param parallel_stream Whether the right input is a parallel stream
+ */
+static void
+produce_merge_join(FILE* fd,
+                   const fcc_operator_t* join,
+                   const fcc_operator_t* left,
+                   const fcc_operator_t* right,
+                   bool parallel_stream)
+{
+  char itername[FCC_MAX_ITER_VARNAME];
+  generate_merge_iter_name(join,
+                           itername,
+                           FCC_MAX_ITER_VARNAME);
+
+  char tableexpr[FCC_MAX_TABLE_VARNAME+16];
+  generate_scan_table_expr(left, 
+                           tableexpr, 
+                           FCC_MAX_TABLE_VARNAME+16);
+
+  // The left table is iterated as a whole, since the right input might be
+  // partitioned among threads
+  fprintf(fd,
+          "fdb_table_iter_t %s;\n",
+          itername);
+  fprintf(fd,
+          "fdb_table_iter_init(&%s, %s, 1, 0, 1);\n",
+          itername,
+          tableexpr);
+  fprintf(fd,
+          "fdb_table_block_t* %s_block = NULL;\n",
+          itername);
+
+  produce(fd, right, parallel_stream);
+
+  fprintf(fd,
+          "fdb_table_iter_release(&%s);\n",
+          itername);
+}
+
 void
 produce_join(FILE* fd,
              const fcc_operator_t* join, 
              bool parallel_stream)
 {
+  fcc_subplan_t* subplan = join->p_subplan;
+  if(is_merge_join(join))
+  {
+    produce_merge_join(fd, 
+                       join, 
+                       &subplan->m_nodes[join->m_join.m_left], 
+                       &subplan->m_nodes[join->m_join.m_right], 
+                       parallel_stream);
+    return;
+  }
+
   char hashtable[FCC_MAX_HASHTABLE_VARNAME];
   generate_hashtable_name(join,
                           hashtable,
@@ -323,7 +559,6 @@ produce_join(FILE* fd,
           "fdb_btree_init(&%s, &task_allocator.m_super);\n", 
           hashtable);
 
-  fcc_subplan_t* subplan = join->p_subplan;
   produce(fd,&subplan->m_nodes[join->m_join.m_left], parallel_stream);
 
 
@@ -362,6 +597,16 @@ produce_leftfilter_join(FILE* fd,
                         const fcc_operator_t* left_filter_join,
                         bool parallel_stream)
 {
+  fcc_subplan_t* subplan = left_filter_join->p_subplan;
+  if(is_merge_join(left_filter_join))
+  {
+    produce_merge_join(fd, 
+                       left_filter_join, 
+                       &subplan->m_nodes[left_filter_join->m_leftfilter_join.m_left], 
+                       &subplan->m_nodes[left_filter_join->m_leftfilter_join.m_right], 
+                       parallel_stream);
+    return;
+  }
 
   char hashtable[FCC_MAX_HASHTABLE_VARNAME];
   generate_hashtable_name(left_filter_join,
@@ -376,7 +621,6 @@ produce_leftfilter_join(FILE* fd,
           "fdb_btree_init(&%s, &task_allocator.m_super);\n", 
           hashtable);
 
-  fcc_subplan_t* subplan = left_filter_join->p_subplan;
   produce(fd,&subplan->m_nodes[left_filter_join->m_leftfilter_join.m_left], parallel_stream);
   produce(fd,&subplan->m_nodes[left_filter_join->m_leftfilter_join.m_right], parallel_stream);
 
@@ -403,6 +647,219 @@ produce_leftfilter_join(FILE* fd,
   fprintf(fd,"fdb_btree_release(&%s);\n", hashtable);
 }
 
+/**
+ * \brief Produces a multi join. The input table with the fewest components
+ * drives the join: it is chosen once per frame for all the threads running the
+ * join, its blocks are streamed (and partitioned among threads), and
+ * the blocks with the same id are looked up in the rest of input tables through
+ * their block directories. The first missing block discards the block id, and
+ * the enabled bitmaps of the found blocks are intersected at once into a single
+ * cluster
+ */
+void
+produce_multi_join(FILE* fd,
+                   const fcc_operator_t* multi_join,
+                   bool parallel_stream)
+{
+  char itername[FCC_MAX_ITER_VARNAME];
+  generate_merge_iter_name(multi_join,
+                           itername,
+                           FCC_MAX_ITER_VARNAME);
+
+  char clustername[FCC_MAX_CLUSTER_VARNAME];
+  generate_cluster_name(multi_join,
+                        clustername,
+                        FCC_MAX_CLUSTER_VARNAME);
+
+  fcc_subplan_t* subplan = multi_join->p_subplan;
+  const uint32_t num_inputs = multi_join->m_multi_join.m_num_inputs;
+  fprintf(fd,
+          "fdb_table_t* %s_tables[%u] = {",
+          itername,
+          num_inputs);
+  for(uint32_t i = 0; i < num_inputs; ++i)
+  {
+    char tableexpr[FCC_MAX_TABLE_VARNAME+16];
+    generate_scan_table_expr(&subplan->m_nodes[multi_join->m_multi_join.m_inputs[i]],
+                             tableexpr,
+                             FCC_MAX_TABLE_VARNAME+16);
+    fprintf(fd,
+            "%s%s",
+            i > 0 ? ", " : "",
+            tableexpr);
+  }
+  fprintf(fd, "};\n");
+
+  // The smallest input drives the join. The choice is shared by all the
+  // threads, since they partition the blocks of the same driving table
+  fprintf(fd,
+          "static fdb_table_driver_t %s_driver_choice;\n",
+          itername);
+  fprintf(fd,
+          "uint32_t %s_driver = fdb_table_choose_driver(&%s_driver_choice, %s_tables, %u, database->m_frame);\n",
+          itername,
+          itername,
+          itername,
+          num_inputs);
+
+  // The rest of inputs are probed from the most to the least selective, so
+  // blocks missing in any input are discarded early
+  fprintf(fd,
+          "uint32_t %s_order[%u];\n",
+          itername,
+          num_inputs);
+  fprintf(fd,
+          "%s_order[0] = %s_driver;\n",
+          itername,
+          itername);
+  fprintf(fd,
+          "uint32_t %s_num_probes = 1;\n",
+          itername);
+  fprintf(fd,
+          "for(uint32_t i = 0; i < %u; ++i)\n{\n",
+          num_inputs);
+  fprintf(fd,
+          "if(i == %s_driver)\n{\ncontinue;\n}\n",
+          itername);
+  fprintf(fd,
+          "uint32_t j = %s_num_probes++;\n",
+          itername);
+  fprintf(fd,
+          "while(j > 1 && %s_tables[i]->m_num_components < %s_tables[%s_order[j-1]]->m_num_components)\n{\n",
+          itername,
+          itername,
+          itername);
+  fprintf(fd,
+          "%s_order[j] = %s_order[j-1];\n",
+          itername,
+          itername);
+  fprintf(fd, "--j;\n}\n");
+  fprintf(fd,
+          "%s_order[j] = i;\n",
+          itername);
+  fprintf(fd, "}\n");
+
+  fprintf(fd,
+          "fdb_table_iter_t %s;\n",
+          itername);
+  if(parallel_stream && is_morsel_stream(multi_join))
+  {
+    fprintf(fd,
+            "static fdb_table_morsel_t %s_morsel;\n",
+            itername);
+    fprintf(fd,
+            "fdb_table_iter_init_morsel(&%s, %s_tables[%s_driver], &%s_morsel, FDB_TABLE_MORSEL_SIZE, stride);\n",
+            itername,
+            itername,
+            itername,
+            itername);
+  }
+  else if(parallel_stream)
+  {
+    fprintf(fd,
+            "fdb_table_iter_init(&%s, %s_tables[%s_driver], chunk_size, offset, stride);\n",
+            itername,
+            itername,
+            itername);
+  }
+  else
+  {
+    fprintf(fd,
+            "fdb_table_iter_init(&%s, %s_tables[%s_driver], 1, 0, 1);\n",
+            itername,
+            itername,
+            itername);
+  }
+
+  fprintf(fd,
+          "while(fdb_table_iter_has_next(&%s))\n{\n",
+          itername);
+  fprintf(fd,
+          "fdb_table_block_t* %s_next = fdb_table_iter_next(&%s);\n",
+          itername,
+          itername);
+  fprintf(fd,
+          "if(%s_next->m_num_enabled_components == 0)\n{\n",
+          itername);
+  generate_skip_block(fd, multi_join);
+  fprintf(fd, "}\n");
+  fprintf(fd,
+          "FDB_PROFILER_COUNT(%u, \"%s\", E_FDB_PROFILER_BLOCKS_SCANNED, 1);\n",
+          multi_join->m_id,
+          multi_join->m_name);
+  fprintf(fd,
+          "uint32_t %s_block_id = %s_next->m_start / FDB_TABLE_BLOCK_SIZE;\n",
+          itername,
+          itername);
+  fprintf(fd,
+          "fdb_table_block_t* %s_blocks[%u];\n",
+          itername,
+          num_inputs);
+  fprintf(fd,
+          "%s_blocks[%s_driver] = %s_next;\n",
+          itername,
+          itername,
+          itername);
+  fprintf(fd,
+          "bool %s_found = true;\n",
+          itername);
+  fprintf(fd,
+          "for(uint32_t i = 1; i < %u && %s_found; ++i)\n{\n",
+          num_inputs,
+          itername);
+  fprintf(fd,
+          "uint32_t input = %s_order[i];\n",
+          itername);
+  fprintf(fd,
+          "%s_blocks[input] = fdb_table_lookup_block(%s_tables[input], %s_block_id);\n",
+          itername,
+          itername,
+          itername);
+  fprintf(fd,
+          "%s_found = %s_blocks[input] != NULL;\n",
+          itername,
+          itername);
+  fprintf(fd, "}\n");
+
+  fprintf(fd,
+          "if(%s_found)\n{\n",
+          itername);
+  fprintf(fd,
+          "fdb_bcluster_t %s;\n", 
+          clustername);
+  fprintf(fd,
+          "fdb_bcluster_init(&%s, &task_allocator.m_super);\n", 
+          clustername);
+  fprintf(fd,
+          "fdb_bcluster_append_blocks(&%s, %s_blocks, %u);\n", 
+          clustername,
+          itername,
+          num_inputs);
+  fprintf(fd,
+          "if(%s.m_enabled.m_num_set != 0)\n{\n", 
+          clustername);
+
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  fdb_str_builder_append(&str_builder, "(&%s)", clustername);
+  consume(fd,
+          &subplan->m_nodes[multi_join->m_parent],
+          str_builder.p_buffer,
+          multi_join);
+  fdb_str_builder_release(&str_builder);
+
+  fprintf(fd,"}\n");
+  fprintf(fd,
+          "fdb_bcluster_release(&%s, &task_allocator.m_super);\n", 
+          clustername);
+  fprintf(fd,"}\n");
+  fprintf(fd,"}\n");
+
+  fprintf(fd,
+          "fdb_table_iter_release(&%s);\n",
+          itername);
+}
+
 void
 produce_cross_join(FILE* fd,
                    const fcc_operator_t* cross_join,
@@ -692,11 +1149,8 @@ produce_gather(FILE* fd,
 {
   fcc_subplan_t* subplan = gather->p_subplan;
 
-  fprintf(fd,
-          "int32_t last_barrier = 0;\n");
-
-  // This is a temporal buffer needed for generating temporal table names from
-  // threading parameters to make them unique
+  // This is a temporal buffer needed for generating the names registered in
+  // the hashtable registry from threading parameters to make them unique
   fprintf(fd,
           "char tmp_buffer_%d_%d[256];\n", 
           gather->p_subplan->m_id,
@@ -729,7 +1183,7 @@ produce_gather(FILE* fd,
   fcc_operator_t* child = &subplan->m_nodes[gather->m_gather.m_child];
   produce(fd, child, parallel_stream);
 
-  // CREATING TEMPORAL TABLES 
+  // VALIDATING GATHERED COLUMNS 
   fcc_column_t* child_columns = child->m_columns;
   uint32_t ncolumns = child->m_num_columns;
   for(uint32_t i = 0; i < ncolumns; ++i)
@@ -758,39 +1212,27 @@ produce_gather(FILE* fd,
                                            access mode READ: \"%s\"",
                                            ctype);
     }
-    char temptablename[FCC_MAX_TABLE_VARNAME];
-    generate_temp_table_name(ctype, 
-                             temptablename, 
-                             FCC_MAX_TABLE_VARNAME, 
-                             gather);
-
-    fprintf(fd,"snprintf(tmp_buffer_%d_%d, 256-1, \"%s_%d_%d_%%d_%%d_%%d\", chunk_size, offset, stride);\n", 
-            gather->p_subplan->m_id,
-            gather->m_id, 
-            temptablename,
-            gather->p_subplan->m_id,
-            gather->m_id);
-
-    fprintf(fd,"fdb_table_t* %s = FDB_CREATE_TEMP_TABLE(database, %s*, tmp_buffer_%d_%d, nullptr);\n", 
-            temptablename,
-            ctype,
-            gather->p_subplan->m_id,
-            gather->m_id);
-
-    fprintf(fd,"fdb_table_clear(%s);\n", 
-            temptablename);
   }
 
-  // SYNCHRONIZING THREADS TO MAKE SURE HASHTABLES ARE AVAILABLE
+  // DECLARING THE COLUMNS OF POINTERS. These are taken from the task allocator
+  // and reused for every block of references, so gathering does not go
+  // through any table
   fprintf(fd,
-          "if(stride > 1)\n{\n");
+          "fdb_table_block_t gather_columns_%u[%u];\n",
+          gather->m_id,
+          ncolumns);
   fprintf(fd,
-          "last_barrier += stride;\n");
+          "for(uint32_t i = 0; i < %u; ++i)\n{\n",
+          ncolumns);
   fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
+          "gather_column_init(&gather_columns_%u[i], &task_allocator.m_super);\n",
+          gather->m_id);
   fprintf(fd,
           "}\n");
 
+  // SYNCHRONIZING THREADS TO MAKE SURE HASHTABLES ARE AVAILABLE
+  produce_barrier(fd);
+
   fprintf(fd, 
           "FDB_RESTRICT(fdb_btree_t*) hash_tables[stride];\n");
   fprintf(fd, 
@@ -813,132 +1255,23 @@ produce_gather(FILE* fd,
   fprintf(fd, 
           "}\n");
 
-  // PRODUCE REFERENCE TABLE
+  // PRODUCE REFERENCE TABLE. Each block of references is gathered into the
+  // columns of pointers and consumed by the parent straight away (see
+  // consume_gather)
   fcc_operator_t* ref_table = &subplan->m_nodes[gather->m_gather.m_ref_table];
   produce(fd, ref_table, parallel_stream);
 
-  // DEFININT ITERATORS TO TEMPORAL TABLES
-  for(uint32_t i = 0; i < ncolumns; ++i)
-  {
-    fcc_column_t* column = &child_columns[i];
-    char ctype[FCC_MAX_TYPE_NAME];
-    fcc_type_name(column->m_component_type,
-                  ctype,
-                  FCC_MAX_TYPE_NAME);
-
-
-    char tablename[FCC_MAX_TABLE_VARNAME];
-    generate_temp_table_name(ctype, 
-                             tablename, 
-                             FCC_MAX_TABLE_VARNAME, 
-                             gather);
-
-    char itername[FCC_MAX_ITER_VARNAME];
-    generate_table_iter_name(tablename, 
-                             itername,
-                             FCC_MAX_ITER_VARNAME);
-
-    if(parallel_stream)
-    {
-      fprintf(fd, "fdb_table_iter_t %s;\n", 
-              itername);
-
-      fprintf(fd, "fdb_table_iter_init(&%s, %s, chunk_size, offset, stride);\n", 
-              itername, 
-              tablename);
-    }
-    else
-    {
-      fprintf(fd, "fdb_table_iter_t %s;\n", 
-              itername);
-
-      fprintf(fd, "fdb_table_iter_init(&%s, %s, 1, 0, 1);\n", 
-              itername, 
-              tablename);
-    }
-  }
-
-  fcc_column_t* column = &child_columns[0];
-
-  char ctype[FCC_MAX_TYPE_NAME];
-  fcc_type_name(column->m_component_type,
-                ctype,
-                FCC_MAX_TYPE_NAME); 
-
-  char tablename[FCC_MAX_TABLE_VARNAME];
-  generate_temp_table_name(ctype, 
-                           tablename,
-                           FCC_MAX_TABLE_VARNAME,
-                           gather);
-
-
-  char itername[FCC_MAX_ITER_VARNAME];
-  generate_table_iter_name(tablename,
-                           itername,
-                           FCC_MAX_ITER_VARNAME);
-
-  // ITERATE OVER TEMPORAL TABLES AND PRODUCE CLUSTERS FOR CALLER OPERATORS
-  fprintf(fd, "while(fdb_table_iter_has_next(&%s))\n{\n", itername);
-
-  char clustername[FCC_MAX_CLUSTER_VARNAME];
-  generate_cluster_name(gather,
-                        clustername,
-                        FCC_MAX_CLUSTER_VARNAME);
-
-  fprintf(fd, "fdb_bcluster_t %s;\n", clustername);
-  fprintf(fd, "fdb_bcluster_init(&%s, &task_allocator.m_super);\n", clustername);
-
-  for(uint32_t i = 0; i < ncolumns; ++i)
-  {
-    fcc_column_t* column = &child_columns[i];
-
-    char ctype[FCC_MAX_TYPE_NAME];
-    fcc_type_name(column->m_component_type,
-                  ctype,
-                  FCC_MAX_TYPE_NAME); 
-
-    char tablename[FCC_MAX_TABLE_VARNAME];
-    generate_temp_table_name(ctype, 
-                             tablename,
-                             FCC_MAX_TABLE_VARNAME,
-                             gather);
-
-    char itername[FCC_MAX_ITER_VARNAME];
-    generate_table_iter_name(tablename,
-                             itername,
-                             FCC_MAX_ITER_VARNAME);
-
-    fprintf(fd, "fdb_bcluster_append_block(&%s, fdb_table_iter_next(&%s));\n", 
-            clustername, 
-            itername);
-  }
-
-  fdb_str_builder_t str_builder;
-  fdb_str_builder_init(&str_builder);
-  fdb_str_builder_append(&str_builder, "(&%s)", clustername);
-  consume(fd,
-          &subplan->m_nodes[gather->m_parent],
-          str_builder.p_buffer,
-          gather);
-  fdb_str_builder_release(&str_builder);
-
-  fprintf(fd, "fdb_bcluster_release(&%s, &task_allocator.m_super);\n", clustername);
-
-  fprintf(fd,"}\n\n");
-  fprintf(fd, 
-          "fdb_table_iter_release(&%s);\n", 
-          itername);
-  
-
-  // SYNCHRONIZING THREADS TO MAKE SURE HASHTABLES ARE AVAILABLE
   fprintf(fd,
-          "if(stride > 1)\n{\n");
-  fprintf(fd,
-          "last_barrier += stride;\n");
+          "for(uint32_t i = 0; i < %u; ++i)\n{\n",
+          ncolumns);
   fprintf(fd,
-          "barrier->p_wait(barrier->p_state,  last_barrier);\n");
+          "gather_column_release(&gather_columns_%u[i], &task_allocator.m_super);\n",
+          gather->m_id);
   fprintf(fd,
-          "}\n");
+          "}\n\n");
+
+  // SYNCHRONIZING THREADS TO MAKE SURE HASHTABLES ARE AVAILABLE
+  produce_barrier(fd);
 
   fprintf(fd,
           "fdb_btree_iter_t it_%s;\n", 
@@ -973,14 +1306,10 @@ produce_cascading_gather(FILE* fd,
                          const fcc_operator_t* casc_gather, 
                          bool parallel_stream)
 {
-  fprintf(fd, "FDB_PERMA_ASSERT(stride == 1 || (stride > 1 && barrier != nullptr));\n");
-  fprintf(fd,
-          "int32_t last_barrier = 0;");
-
   fcc_subplan_t* subplan = casc_gather->p_subplan;
 
-  // This is a temporal buffer needed for generating temporal table names from
-  // threading parameters to make them unique
+  // This is a temporal buffer needed for generating the names registered in
+  // the hashtable registry from threading parameters to make them unique
   fprintf(fd,
           "char tmp_buffer_%d_%d[256];\n", 
           casc_gather->p_subplan->m_id,
@@ -1037,15 +1366,9 @@ produce_cascading_gather(FILE* fd,
           "fdb_bittable_init(&partial_blacklist_%u, &task_allocator.m_super);\n", 
           casc_gather->m_id);
 
+  // VALIDATING GATHERED COLUMNS
   fcc_column_t* child_columns = child->m_columns;
   uint32_t ncolumns = child->m_num_columns;
-  char** temp_table_names = new char*[ncolumns];
-  for(uint32_t i = 0; i < ncolumns; ++i)
-  {
-    temp_table_names[i] = new char[FCC_MAX_TABLE_VARNAME];
-  }
-
-  // init TEMPORAL TABLES
   for(uint32_t i = 0; i < ncolumns; ++i)
   {
     fcc_column_t* column = &child_columns[i];
@@ -1070,48 +1393,10 @@ produce_cascading_gather(FILE* fd,
                                            must have access mode READ: \"%s\"",
                                            ctype);
     }
-
-    generate_temp_table_name(ctype, 
-                             temp_table_names[i],
-                             FCC_MAX_TABLE_VARNAME,
-                             casc_gather);
-
-  }
-
-  for(uint32_t i = 0; i < ncolumns; ++i)
-  {
-    fcc_column_t* column = &child_columns[i];
-    char ctype[FCC_MAX_TYPE_NAME];
-    fcc_type_name(column->m_component_type,
-                  ctype,
-                  FCC_MAX_TYPE_NAME);
-
-    fprintf(fd,"snprintf(tmp_buffer_%d_%d, 256-1, \"%s_%d_%d_%%d_%%d_%%d\", chunk_size, offset, stride);\n", 
-            casc_gather->p_subplan->m_id,
-            casc_gather->m_id,
-            temp_table_names[i],
-            casc_gather->p_subplan->m_id,
-            casc_gather->m_id);
-
-    fprintf(fd,"fdb_table_t* %s = FDB_CREATE_TEMP_TABLE(database, %s*, tmp_buffer_%d_%d, nullptr);\n", 
-            temp_table_names[i],
-            ctype,
-            casc_gather->p_subplan->m_id,
-            casc_gather->m_id);
-
-    fprintf(fd,"fdb_table_clear(%s);\n", 
-            temp_table_names[i]);
   }
 
   // SYNCHRONIZING THREADS TO MAKE SURE HASHTABLES ARE AVAILABLE
-  fprintf(fd,
-          "if(stride > 1)\n{\n");
-  fprintf(fd,
-          "last_barrier += stride;\n");
-  fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
-  fprintf(fd,
-          "}\n");
+  produce_barrier(fd);
 
   fprintf(fd, 
           "FDB_RESTRICT(fdb_btree_t*) hash_tables[stride];\n");
@@ -1143,6 +1428,29 @@ produce_cascading_gather(FILE* fd,
   fcc_operator_t* ref_table = &subplan->m_nodes[casc_gather->m_gather.m_ref_table];
   produce(fd, ref_table, parallel_stream);
 
+  // When the reference table maintains a hierarchy index, the levels are
+  // taken from it instead of computing roots and frontiers: level d expands
+  // the references whose tails are at depth d+1. The index groups the tails
+  // of each level in a bittable, but the references are not stored in depth
+  // order, so each level visits the blocks of its bittable and looks up their
+  // gather blocks instead of scanning every reference block
+  char reftable[FCC_MAX_REF_TABLE_VARNAME];
+  generate_ref_table_name(ref_table->m_columns[0].m_ref_name,
+                          reftable,
+                          FCC_MAX_REF_TABLE_VARNAME);
+  fprintf(fd,
+          "bool hierarchy_%u = fdb_reftable_has_hierarchy(%s);\n",
+          casc_gather->m_id,
+          reftable);
+  fprintf(fd,
+          "uint32_t level_%u = 0;\n",
+          casc_gather->m_id);
+  fprintf(fd,
+          "const fdb_bittable_t* next_level_%u = hierarchy_%u ? fdb_reftable_get_level(%s, 1) : NULL;\n",
+          casc_gather->m_id,
+          casc_gather->m_id,
+          reftable);
+
   // REGISTERING PARTIAL BLACKLIST AND NEXT FRONTIERS
   fprintf(fd,"snprintf(tmp_buffer_%d_%d, 256-1, \"blacklist_%d_%d_%%d_%%d_%%d\", chunk_size, offset, stride);\n", 
           casc_gather->p_subplan->m_id,
@@ -1167,15 +1475,19 @@ produce_cascading_gather(FILE* fd,
           casc_gather->m_id,
           casc_gather->m_id);
 
-  // SYNCHRONIZING THREADS TO MAKE SURE PARTIAL BLACKLISTS ARE AVAILABLE
-  fprintf(fd,
-          "if(stride > 1)\n{\n");
-  fprintf(fd,
-          "last_barrier += stride;\n");
-  fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
+  fprintf(fd,"snprintf(tmp_buffer_%d_%d, 256-1, \"current_frontier_%d_%d_%%d_%%d_%%d\", chunk_size, offset, stride);\n", 
+          casc_gather->p_subplan->m_id,
+          casc_gather->m_id,
+          casc_gather->p_subplan->m_id,
+          casc_gather->m_id);
   fprintf(fd,
-          "}\n");
+          "fdb_htregistry_insert(&ht_registry, tmp_buffer_%d_%d, &current_frontier_%u);\n",
+          casc_gather->p_subplan->m_id, 
+          casc_gather->m_id,
+          casc_gather->m_id);
+
+  // SYNCHRONIZING THREADS TO MAKE SURE PARTIAL BLACKLISTS ARE AVAILABLE
+  produce_barrier(fd);
 
   // BROADCASTING NEXT FRONTIERS TO CURRENT FRONTIER
   
@@ -1186,6 +1498,10 @@ produce_cascading_gather(FILE* fd,
   fprintf(fd, 
           "FDB_RESTRICT(fdb_bittable_t*) next_frontiers_%u[stride];\n",
           casc_gather->m_id);
+
+  fprintf(fd, 
+          "FDB_RESTRICT(fdb_bittable_t*) current_frontiers_%u[stride];\n",
+          casc_gather->m_id);
   fprintf(fd,
           "for(uint32_t i = 0; i < stride; ++i)\n{\n");
 
@@ -1221,40 +1537,50 @@ produce_cascading_gather(FILE* fd,
           "next_frontiers_%u[i] = other_frontier;\n", 
           casc_gather->m_id);
 
-  fprintf(fd,
-          "}\n");
+  fprintf(fd,"snprintf(tmp_buffer_%d_%d, 256-1, \"current_frontier_%d_%d_%%d_%%d_%%d\", chunk_size, i, stride);\n", 
+          casc_gather->p_subplan->m_id,
+          casc_gather->m_id,
+          casc_gather->p_subplan->m_id,
+          casc_gather->m_id);
 
   fprintf(fd,
-          "if(stride > 1)\n{\n");
-  fprintf(fd,
-          "last_barrier += stride;\n");
-  fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
+          "current_frontiers_%u[i] = (fdb_bittable_t*)fdb_htregistry_get(&ht_registry, tmp_buffer_%d_%d);\n",
+          casc_gather->m_id,
+          casc_gather->p_subplan->m_id, 
+          casc_gather->m_id);
+
   fprintf(fd,
           "}\n");
 
+  produce_barrier(fd);
+
+  // The traversal is a level-synchronous BFS. The current frontier is split
+  // among the threads by fdb_bittable_partition: each thread merges and
+  // filters only its partition of the next frontiers, and looks up the
+  // partitions of the other threads when expanding its references. Barriers
+  // separate the expansion of a level from the merge of the next one 
   fprintf(fd,
-          "frontiers_union(next_frontiers_%u, stride, &current_frontier_%u);\n", 
-          casc_gather->m_id,
+          "if(!hierarchy_%u)\n{\n",
           casc_gather->m_id);
   fprintf(fd,
-          "filter_blacklists(blacklists_%u, stride, &current_frontier_%u);\n", 
+          "frontiers_union(next_frontiers_%u, stride, &current_frontier_%u, offset, stride);\n", 
           casc_gather->m_id,
           casc_gather->m_id);
-
   fprintf(fd,
-          "if(stride > 1)\n{\n");
-  fprintf(fd,
-          "last_barrier += stride;\n");
-  fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
+          "filter_blacklists(blacklists_%u, stride, &current_frontier_%u, offset, stride);\n", 
+          casc_gather->m_id,
+          casc_gather->m_id);
   fprintf(fd,
           "}\n");
 
+  produce_barrier(fd);
+
 
 
   fprintf(fd,
-          "while(fdb_bittable_size(&current_frontier_%u) > 0)\n{\n", 
+          "while(hierarchy_%u ? next_level_%u != NULL : frontiers_size(current_frontiers_%u, stride) > 0)\n{\n", 
+          casc_gather->m_id,
+          casc_gather->m_id,
           casc_gather->m_id);
 
   fprintf(fd,
@@ -1263,33 +1589,45 @@ produce_cascading_gather(FILE* fd,
   
 
 
-  fcc_column_t* column = &child_columns[0];
-  char ctype[FCC_MAX_TYPE_NAME];
-  fcc_type_name(column->m_component_type,
-                ctype,
-                FCC_MAX_TYPE_NAME); 
-
-
-  char tablename[FCC_MAX_TABLE_VARNAME];
-  generate_temp_table_name(ctype,
-                           tablename,
-                           FCC_MAX_TABLE_VARNAME,
-                           casc_gather);
-
-
-  char itername[FCC_MAX_ITER_VARNAME];
-  generate_table_iter_name(tablename,
-                           itername,
-                           FCC_MAX_ITER_VARNAME);
-
+  fprintf(fd, "fdb_bittable_block_iter_t iter_level_%d;\n", 
+          casc_gather->m_id);
   fprintf(fd, "fdb_btree_iter_t iter_ref_hashtable_%d;\n", 
           casc_gather->m_id);
 
+  fprintf(fd, "if(next_level_%u != NULL)\n{\n", 
+          casc_gather->m_id);
+  fprintf(fd, "fdb_bittable_block_iter_init(&iter_level_%d, next_level_%u);\n", 
+          casc_gather->m_id, 
+          casc_gather->m_id);
+  fprintf(fd, "}\n");
+  fprintf(fd, "else\n{\n");
   fprintf(fd, "fdb_btree_iter_init(&iter_ref_hashtable_%d,  &ref_%s);\n", 
           casc_gather->m_id, 
           hashtable);
+  fprintf(fd, "}\n");
 
-  fprintf(fd, "while(fdb_btree_iter_has_next(&iter_ref_hashtable_%d))\n{\n", casc_gather->m_id);
+  fprintf(fd, 
+          "while(next_level_%u != NULL ? fdb_bittable_block_iter_has_next(&iter_level_%d) : fdb_btree_iter_has_next(&iter_ref_hashtable_%d))\n{\n", 
+          casc_gather->m_id,
+          casc_gather->m_id,
+          casc_gather->m_id);
+
+  fprintf(fd, 
+          "fdb_gather_block_t* gblock_%u = next_level_%u != NULL ? "
+          "(fdb_gather_block_t*)fdb_btree_get(&ref_%s, fdb_bittable_block_iter_next(&iter_level_%d) / FDB_TABLE_BLOCK_SIZE) : "
+          "(fdb_gather_block_t*)fdb_btree_iter_next(&iter_ref_hashtable_%d).p_value;\n",
+          casc_gather->m_id,
+          casc_gather->m_id,
+          hashtable,
+          casc_gather->m_id,
+          casc_gather->m_id);
+  fprintf(fd,
+          "if(gblock_%u == NULL)\n{\n",
+          casc_gather->m_id);
+  fprintf(fd,
+          "continue;\n");
+  fprintf(fd,
+          "}\n");
 
   char clustername[FCC_MAX_CLUSTER_VARNAME];
   generate_cluster_name(casc_gather,
@@ -1299,29 +1637,36 @@ produce_cascading_gather(FILE* fd,
   fprintf(fd, "fdb_bcluster_t %s;\n", clustername);
   fprintf(fd, "fdb_bcluster_init(&%s, &task_allocator.m_super);\n", clustername);
 
-    fprintf(fd,
-            "fdb_table_t* temp_tables[] = {");
-    for(uint32_t i = 0; i < ncolumns; ++i)
-    {
-      fprintf(fd, 
-              "%s,", 
-              temp_table_names[i]);
-    }
-      fprintf(fd, 
-              "nullptr};\n");
+  fprintf(fd,
+          "if(next_level_%u != NULL)\n{\n",
+          casc_gather->m_id);
+  fprintf(fd, 
+          "build_fdb_bcluster_from_level(gblock_%u,"
+          "next_level_%u,"
+          "&%s);\n",
+          casc_gather->m_id, 
+          casc_gather->m_id,
+          clustername);
+  fprintf(fd,
+          "}\n");
+  fprintf(fd,
+          "else\n{\n");
   fprintf(fd, 
-          "build_fdb_bcluster_from_refs((fdb_bcluster_t*)fdb_btree_iter_next(&iter_ref_hashtable_%d).p_value,"
-          "&current_frontier_%u,"
+          "build_fdb_bcluster_from_refs(gblock_%u,"
+          "current_frontiers_%u,"
+          "stride,"
           "&next_frontier_%u,"
-          "&%s," 
-          "temp_tables," 
-          "%d);\n",
+          "&%s);\n",
           casc_gather->m_id, 
           casc_gather->m_id,
           casc_gather->m_id,
-          clustername, 
-          ncolumns);
+          clustername);
+  fprintf(fd,
+          "}\n");
 
+  fprintf(fd,
+          "if(%s.m_enabled.m_num_set != 0)\n{\n",
+          clustername); 
 
   fdb_str_builder_t fdb_str_builder_cluster;
   fdb_str_builder_init(&fdb_str_builder_cluster);
@@ -1331,40 +1676,51 @@ produce_cascading_gather(FILE* fd,
           fdb_str_builder_cluster.p_buffer,
           casc_gather);
   fdb_str_builder_release(&fdb_str_builder_cluster);
+  fprintf(fd, "}\n");
 
   fprintf(fd, "fdb_bcluster_release(&%s, &task_allocator.m_super);\n", 
           clustername);
   fprintf(fd,"}\n");
 
+  fprintf(fd, "if(next_level_%u != NULL)\n{\n", 
+          casc_gather->m_id);
+  fprintf(fd, "fdb_bittable_block_iter_release(&iter_level_%d);\n", 
+          casc_gather->m_id);
+  fprintf(fd, "}\n");
+  fprintf(fd, "else\n{\n");
   fprintf(fd, "fdb_btree_iter_release(&iter_ref_hashtable_%d);\n", 
           casc_gather->m_id);
+  fprintf(fd, "}\n");
+
+  produce_barrier(fd);
 
   fprintf(fd,
-          "if(stride > 1)\n{\n");
+          "if(hierarchy_%u)\n{\n",
+          casc_gather->m_id);
   fprintf(fd,
-          "last_barrier += stride;\n");
+          "level_%u++;\n",
+          casc_gather->m_id);
   fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
+          "next_level_%u = fdb_reftable_get_level(%s, level_%u + 1);\n",
+          casc_gather->m_id,
+          reftable,
+          casc_gather->m_id);
   fprintf(fd,
           "}\n");
-
+  fprintf(fd,
+          "else\n{\n");
   fprintf(fd,
           "fdb_bittable_clear(&current_frontier_%u);\n",
           casc_gather->m_id);
   fprintf(fd,
-          "frontiers_union(next_frontiers_%u, stride, &current_frontier_%u);\n", 
+          "frontiers_union(next_frontiers_%u, stride, &current_frontier_%u, offset, stride);\n", 
           casc_gather->m_id,
           casc_gather->m_id);
-
-  fprintf(fd,
-          "if(stride > 1)\n{\n");
-  fprintf(fd,
-          "last_barrier += stride;\n");
-  fprintf(fd,
-          "barrier->p_wait(barrier->p_state, last_barrier);\n");
   fprintf(fd,
           "}\n");
 
+  produce_barrier(fd);
+
 
   fprintf(fd,
           "}\n\n");
@@ -1402,10 +1758,10 @@ produce_cascading_gather(FILE* fd,
   fprintf(fd,
           "while(fdb_btree_iter_has_next(&it_ref_%s))\n{\n", hashtable);
   fprintf(fd,
-          "fdb_bcluster_t* next = (fdb_bcluster_t*)fdb_btree_iter_next(&it_ref_%s).p_value;\n", 
+          "fdb_gather_block_t* next = (fdb_gather_block_t*)fdb_btree_iter_next(&it_ref_%s).p_value;\n", 
           hashtable);
   fprintf(fd,
-          "fdb_bcluster_release(next, &task_allocator.m_super);\n");
+          "gather_block_release(next, &task_allocator.m_super);\n");
   fprintf(fd,
           "mem_free(&task_allocator.m_super,next);\n");
   fprintf(fd,
@@ -1422,30 +1778,4 @@ produce_cascading_gather(FILE* fd,
   fprintf(fd,"fdb_bittable_release(&partial_blacklist_%u);\n", 
           casc_gather->m_id);
 
-  // CLEARING TEMPORAL TABLES
-  for(uint32_t i = 0; i < ncolumns; ++i)
-  {
-    fcc_column_t* column = &child_columns[i];
-    char ctype[FCC_MAX_TYPE_NAME];
-    fcc_type_name(column->m_component_type,
-                  ctype,
-                  FCC_MAX_TYPE_NAME); 
-
-
-    char tablename[FCC_MAX_TABLE_VARNAME];
-    generate_temp_table_name(ctype, 
-                             tablename, 
-                             FCC_MAX_TABLE_VARNAME,
-                             casc_gather);
-
-    fprintf(fd,"fdb_table_clear(%s);\n", 
-            tablename);
-  }
-
-  for(uint32_t i = 0; i < ncolumns; ++i)
-  {
-    delete [] temp_table_names[i];
-  }
-  delete [] temp_table_names;
-
 }  
@@ -68,6 +68,13 @@ bool FuriousExprVisitor::VisitCallExpr(CallExpr* call)
                                       call);
       }
 
+      if(func_name == "set_pure") 
+      {
+        return process_set_pure(p_ast_context,
+                                p_fcc_stmt,
+                                call);
+      }
+
       if(func_name == "has_tag" ) 
       {
         return process_has_tag(p_ast_context,
@@ -96,6 +103,13 @@ bool FuriousExprVisitor::VisitCallExpr(CallExpr* call)
                                          call);
       }
 
+      if(func_name == "changed" ) 
+      {
+        return process_changed(p_ast_context,
+                               p_fcc_stmt,
+                               call);
+      }
+
       if(func_name == "filter" ) 
       {
         return process_filter(p_ast_context,
@@ -111,6 +125,20 @@ bool FuriousExprVisitor::VisitCallExpr(CallExpr* call)
         return res;
       }
 
+      if(func_name == "match_added" ) 
+      {
+        return process_match_added(p_ast_context,
+                                   p_fcc_stmt,
+                                   call);
+      }
+
+      if(func_name == "match_removed" ) 
+      {
+        return process_match_removed(p_ast_context,
+                                     p_fcc_stmt,
+                                     call);
+      }
+
       if(func_name == "expand" ) 
       {
         bool res = process_expand(p_ast_context,
@@ -169,6 +197,15 @@ bool FccASTVisitor::VisitFunctionDecl(FunctionDecl *func)
             // after checking it is well-formed.
             fcc_validate(stmt);
           }
+          else if(expr_type->isStructureOrClassType() &&
+                  expr_type->getAsCXXRecordDecl()->getNameAsString() == "SoALayoutInfo" &&
+                  isa<ClassTemplateSpecializationDecl>(ret_decl))
+          {
+            if(!process_set_soa_layout(p_ast_context, expr))
+            {
+              return false;
+            }
+          }
           else 
           {
             SourceLocation location = expr->getSourceRange().getBegin();
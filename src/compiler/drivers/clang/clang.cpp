@@ -26,6 +26,7 @@ using namespace llvm;
 static cl::OptionCategory fccToolCategory("fcc options");
 static cl::opt<std::string> output_file("o", cl::cat(fccToolCategory));
 static cl::opt<std::string> include_file("i", cl::cat(fccToolCategory));
+static cl::opt<std::string> stats_file("s", cl::cat(fccToolCategory));
 
 static DynArray<std::unique_ptr<ASTUnit>> casts;
 
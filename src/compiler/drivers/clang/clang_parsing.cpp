@@ -2,8 +2,10 @@
 
 #include "clang.h"
 #include "../common/types.h"
+#include "../runtime/data/reflection.h"
 #include "drivers/clang/clang_parsing.h"
 #include "drivers/clang/clang_tools.h"
+#include "driver.h"
 #include "fcc_context.h"
 #include <string.h>
 
@@ -163,6 +165,79 @@ process_match(ASTContext* ast_context,
   return true;
 }
 
+bool 
+process_match_added(ASTContext* ast_context,
+                    fcc_stmt_t*   stmt,
+                    const CallExpr* call)
+{
+  fcc_entity_match_t* entity_match = stmt->m_ematches.m_data[stmt->m_ematches.m_count-1];
+  entity_match->m_event = fcc_event_type_t::E_ADDED;
+  return process_match(ast_context,
+                       stmt,
+                       call);
+}
+
+bool 
+process_match_removed(ASTContext* ast_context,
+                      fcc_stmt_t*   stmt,
+                      const CallExpr* call)
+{
+  fcc_entity_match_t* entity_match = stmt->m_ematches.m_data[stmt->m_ematches.m_count-1];
+  entity_match->m_event = fcc_event_type_t::E_REMOVED;
+  return process_match(ast_context,
+                       stmt,
+                       call);
+}
+
+bool 
+process_set_soa_layout(ASTContext* ast_context,
+                       const Expr* expr)
+{
+#ifndef NDEBUG
+  SourceLocation location = expr->getSourceRange().getBegin();
+  print_debug_info(ast_context,
+                   "Found set_soa_layout",
+                   location);
+#endif
+
+  const ClassTemplateSpecializationDecl* tmplt_decl = cast<ClassTemplateSpecializationDecl>(expr->getType()->getAsCXXRecordDecl());
+  DynArray<QualType> tmplt_types = get_tmplt_types(tmplt_decl->getTemplateArgs());
+  Decl* decl = get_type_decl(tmplt_types[0]);
+  if(decl == nullptr || !isa<CXXRecordDecl>(decl))
+  {
+    report_parsing_error(ast_context->getSourceManager(),
+                         expr->getSourceRange().getBegin(),
+                         fcc_parsing_error_type_t::E_UNSUPPORTED_STATEMENT,
+                         "set_soa_layout requires a struct component");
+    return false;
+  }
+
+  fcc_decl_t fcc_decl = (void*)decl;
+  fdb_mregistry_t reg;
+  fdb_mregistry_init(&reg, NULL);
+  bool compatible = fdb_mstruct_is_soa_compatible(get_reflection_data(fcc_decl, &reg));
+  fdb_mregistry_release(&reg);
+  if(!compatible)
+  {
+    report_parsing_error(ast_context->getSourceManager(),
+                         expr->getSourceRange().getBegin(),
+                         fcc_parsing_error_type_t::E_UNSUPPORTED_STATEMENT,
+                         "The component of set_soa_layout cannot be stored as SoA");
+    return false;
+  }
+
+  const uint32_t ndecls = p_fcc_context->m_soa_decls.m_count;
+  for(uint32_t i = 0; i < ndecls; ++i)
+  {
+    if(fcc_decl_is_same(p_fcc_context->m_soa_decls.m_data[i], fcc_decl))
+    {
+      return true;
+    }
+  }
+  fcc_decl_array_append(&p_fcc_context->m_soa_decls, &fcc_decl);
+  return true;
+}
+
 bool 
 process_expand(ASTContext* ast_context,
                 fcc_stmt_t*   stmt,
@@ -232,7 +307,26 @@ process_foreach(ASTContext* ast_context,
   fcc_system_t* system = new fcc_system_t();
   *system = {};
   system->m_id = system_id;
+  // Calls such as set_pure wrap the foreach call, so they have already been
+  // visited
+  system->m_pure = stmt->m_pure;
   system->m_system_type = push_type(tmplt_types[0]);
+
+  // Systems implementing run_block are called once per block instead of once
+  // per entity (see __register_foreach in lang.h)
+  const CXXRecordDecl* system_decl = tmplt_types[0]->getAsCXXRecordDecl();
+  if(system_decl != nullptr)
+  {
+    for(const CXXMethodDecl* method : system_decl->methods())
+    {
+      if(method->getNameAsString() == "run_block")
+      {
+        system->m_block = true;
+        break;
+      }
+    }
+  }
+
   for (size_t i = 1; i < tmplt_types.size(); ++i) 
   {
     QualType type = tmplt_types[i]->getPointeeType();
@@ -290,6 +384,21 @@ process_set_post_frame(ASTContext* ast_context,
   return true;
 }
 
+bool 
+process_set_pure(ASTContext* ast_context,
+                 fcc_stmt_t*   stmt,
+                 const CallExpr* call)
+{
+  uint32_t num_args = call->getNumArgs();
+  if(num_args != 0)
+  {
+    return false;
+  }
+
+  stmt->m_pure = true;
+  return true;
+}
+
 /**
  * \brief Finds and returns the first occurrence of the stmt of type T in a depth first
  * search way.
@@ -488,3 +597,28 @@ process_has_not_component(ASTContext* ast_context,
   }
   return true;
 }
+
+bool 
+process_changed(ASTContext* ast_context,
+                fcc_stmt_t*   stmt,
+                const CallExpr* call)
+{
+
+#ifndef NDEBUG
+  SourceLocation location = call->getSourceRange().getBegin();
+  print_debug_info(ast_context,
+                   "Found changed",
+                   location);
+#endif
+
+  fcc_entity_match_t* entity_match = stmt->m_ematches.m_data[stmt->m_ematches.m_count-1];
+  const FunctionDecl* func_decl = call->getDirectCallee();
+  const TemplateArgumentList* arg_list = func_decl->getTemplateSpecializationArgs();
+  for (uint32_t i = 0; i < arg_list->size(); ++i) 
+  {
+    const TemplateArgument& arg = arg_list->get(i); 
+    fcc_type_t type =  push_type(arg.getAsType());
+    fcc_entity_match_add_changed_comp(entity_match, type);
+  }
+  return true;
+}
@@ -26,6 +26,47 @@ process_match(ASTContext* ast_context,
               fcc_stmt_t* fcc_match,
               const CallExpr* call);
 
+/**
+ * \brief Process a match_added call
+ *
+ * \param ast_context The ast context of the match_added call
+ * \param fcc_match The fcc_match of the match_added call
+ * \param call The call expression to process
+ *
+ * \return True of the parsing was correct. False otherwise.
+ */
+bool 
+process_match_added(ASTContext* ast_context,
+                    fcc_stmt_t* fcc_match,
+                    const CallExpr* call);
+
+/**
+ * \brief Process a match_removed call
+ *
+ * \param ast_context The ast context of the match_removed call
+ * \param fcc_match The fcc_match of the match_removed call
+ * \param call The call expression to process
+ *
+ * \return True of the parsing was correct. False otherwise.
+ */
+bool 
+process_match_removed(ASTContext* ast_context,
+                      fcc_stmt_t* fcc_match,
+                      const CallExpr* call);
+
+/**
+ * \brief Process a set_soa_layout statement
+ *
+ * \param ast_context The ast context of the set_soa_layout statement
+ * \param expr The expression of the statement, which evaluates into a
+ * SoALayoutInfo
+ *
+ * \return True of the parsing was correct. False otherwise.
+ */
+bool 
+process_set_soa_layout(ASTContext* ast_context,
+                       const Expr* expr);
+
 /**
  * \brief Process an expand call
  *
@@ -83,6 +124,20 @@ process_set_post_frame(ASTContext* ast_context,
                        fcc_stmt_t*   fcc_match,
                        const CallExpr* call);
 
+/**
+ * \brief Processes a set_pure call
+ *
+ * \param ast_context The ast context of the call to process
+ * \param fcc_match The match 
+ * \param call The call expression
+ *
+ * \return  True if the parsing was corret. False otherwise.
+ */
+bool 
+process_set_pure(ASTContext* ast_context,
+                 fcc_stmt_t*   fcc_match,
+                 const CallExpr* call);
+
 /**
  * \brief Process a with_tag call
  *
@@ -139,6 +194,20 @@ process_has_not_component(ASTContext* ast_context,
                           fcc_stmt_t* fcc_match,
                           const CallExpr* call);
 
+/**
+ * \brief Process a changed call
+ *
+ * \param ast_context The ast context of the changed call
+ * \param fcc_match The exec info where the result is going to be stored
+ * \param call The AST call expression to process
+ *
+ * \return True of the parsing was correct. False otherwise.
+ */
+bool 
+process_changed(ASTContext* ast_context,
+                fcc_stmt_t* fcc_match,
+                const CallExpr* call);
+
 /**
  * \brief Process a filter call
  *
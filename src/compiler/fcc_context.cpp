@@ -4,6 +4,7 @@
 #include "fcc_context.h"
 #include "frontend/exec_plan.h"
 #include "frontend/exec_plan_printer.h"
+#include "frontend/transforms.h"
 
 #include <stdlib.h>
 #include <stdarg.h>
@@ -83,6 +84,15 @@ fcc_entity_match_add_has_not_comp(fcc_entity_match_t* ematch,
   ematch->m_has_not_components[ematch->m_nhas_not_components++] = comp;
 }
 
+void
+fcc_entity_match_add_changed_comp(fcc_entity_match_t* ematch, 
+                                  fcc_type_t comp)
+{
+  FDB_PERMA_ASSERT(ematch->m_nchanged_components < FCC_MAX_CHANGED_COMPONENTS &&
+                       "Maximum number of changed components in match exceeded");
+  ematch->m_changed_components[ematch->m_nchanged_components++] = comp;
+}
+
 void
 fcc_entity_match_add_has_tag(fcc_entity_match_t* ematch, 
                              const char* tag)
@@ -126,6 +136,7 @@ fcc_stmt_init()
   fcc_stmt.p_system = nullptr;
   fcc_stmt.m_place = fcc_stmt_place_t::E_FRAME;
   fcc_stmt.m_priority = 1;
+  fcc_stmt.m_pure = false;
   return fcc_stmt;
 }
 
@@ -243,6 +254,8 @@ fcc_context_init()
   p_fcc_context->p_cecallback = nullptr;
   p_fcc_context->m_stmts = fcc_stmt_ptr_array_init();
   p_fcc_context->m_using_decls = fcc_decl_array_init();
+  p_fcc_context->m_soa_decls = fcc_decl_array_init();
+  p_fcc_context->p_stats = nullptr;
   fcc_context_set_parsing_error_callback(handle_parsing_error);
   fcc_context_set_compilation_error_callback(handle_compilation_error);
 }
@@ -259,9 +272,31 @@ fcc_context_release()
   }
   fcc_stmt_ptr_array_release(&p_fcc_context->m_stmts);
   fcc_decl_array_release(&p_fcc_context->m_using_decls);
+  fcc_decl_array_release(&p_fcc_context->m_soa_decls);
   delete p_fcc_context;
 }
 
+bool
+fcc_context_is_soa_component(fcc_type_t type)
+{
+  fcc_decl_t decl;
+  if(!fcc_type_decl(type, &decl))
+  {
+    return false;
+  }
+
+  const uint32_t ndecls = p_fcc_context->m_soa_decls.m_count;
+  fcc_decl_t* decls = p_fcc_context->m_soa_decls.m_data;
+  for(uint32_t i = 0; i < ndecls; ++i)
+  {
+    if(fcc_decl_is_same(decls[i], decl))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 void 
 fcc_context_set_parsing_error_callback(FCC_PARSING_ERROR_CALLBACK callback)
 {
@@ -331,6 +366,7 @@ fcc_run(int argc,
 
   const char* output_file = "furious_generated.cpp"; 
   const char* include_file = "furious/furious.h"; 
+  const char* stats_file = nullptr; 
 
   for (int32_t i = 0; i < argc; ++i) 
   {
@@ -349,9 +385,31 @@ fcc_run(int argc,
         include_file = argv[i+1];
       }
     }
+
+    if(strcmp("-s", argv[i]) == 0)
+    {
+      if(i+1 < argc)
+      {
+        stats_file = argv[i+1];
+      }
+    }
     
   }
 
+  fcc_stats_t stats;
+  fcc_stats_init(&stats);
+  if(stats_file != nullptr)
+  {
+    if(fcc_stats_load(&stats, stats_file))
+    {
+      p_fcc_context->p_stats = &stats;
+    }
+    else
+    {
+      printf("Unable to read table statistics from %s\n", stats_file);
+    }
+  }
+
   fcc_driver_init();
 
   // Parsing scripts
@@ -453,6 +511,7 @@ fcc_run(int argc,
   fcc_exec_plan_release(&post_exec_plan);
   fcc_driver_release();
   fcc_context_release();
+  fcc_stats_release(&stats);
   return result;
 }
 
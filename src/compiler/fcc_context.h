@@ -10,6 +10,7 @@
 #include "autogen/fcc_decl_array.h"
 
 struct fcc_context_t;
+struct fcc_stats_t;
 extern fcc_context_t* p_fcc_context;
 
 typedef void* fcc_type_t;
@@ -28,6 +29,17 @@ enum class fcc_access_mode_t
   E_READ_WRITE,
 };
 
+/**
+ * \brief The events of a table a match iterates instead of its components
+ * (see fdb_table_event_iter_t)
+ */
+enum class fcc_event_type_t
+{
+  E_NONE = 0,   //< The match iterates the components of the table
+  E_ADDED,      //< The match iterates the components added in the previous frame
+  E_REMOVED,    //< The match iterates the components removed in the previous frame
+};
+
 struct fcc_component_match_t 
 {
   fcc_type_t  m_type;
@@ -46,6 +58,8 @@ struct fcc_system_t
   fcc_component_match_t           m_cmatches[FCC_MAX_SYSTEM_COMPONENTS];        // The types of the components of the system
   uint32_t                        m_ncmatches;                                  // Number of component types
   int32_t                         m_id;                                         // The id of the system  
+  bool                            m_block;                                      // Whether the system processes whole blocks through run_block
+  bool                            m_pure;                                       // Whether the system only writes the components of the row it runs on (see set_pure)
 };
 
 void
@@ -65,6 +79,7 @@ struct fcc_entity_match_t
   fcc_component_match_t         m_cmatches[FCC_MAX_SYSTEM_COMPONENTS];              // The types this match is matching against
   fcc_type_t                    m_has_components[FCC_MAX_HAS_COMPONENTS];               // The types of the "has" components
   fcc_type_t                    m_has_not_components[FCC_MAX_HAS_NOT_COMPONENTS];           // The types of the "has_not" components
+  fcc_type_t                    m_changed_components[FCC_MAX_CHANGED_COMPONENTS];           // The types of the "changed" components
   const char*                   m_has_tags[FCC_MAX_HAS_TAGS];                     // The "with" tags  
   const char*                   m_has_not_tags[FCC_MAX_HAS_NOT_TAGS];                 // The "has_not" tags
   fcc_decl_t                    m_filter_func[FCC_MAX_FILTER_FUNC];                  // The filter function
@@ -72,9 +87,11 @@ struct fcc_entity_match_t
   uint32_t                      m_ncmatches; 
   uint32_t                      m_nhas_components;
   uint32_t                      m_nhas_not_components;
+  uint32_t                      m_nchanged_components;
   uint32_t                      m_nhas_tags;
   uint32_t                      m_nhas_not_tags;
   bool                          m_from_expand;                  // True if this comes from an expand
+  fcc_event_type_t              m_event;                        // The events iterated instead of the components, if any
   char                          m_ref_name[FCC_MAX_REF_NAME];       // The reference name if comes form an expand
 };
 
@@ -102,6 +119,10 @@ void
 fcc_entity_match_add_has_not_comp(fcc_entity_match_t* ematch, 
                                   fcc_type_t comp);
 
+void
+fcc_entity_match_add_changed_comp(fcc_entity_match_t* ematch, 
+                                  fcc_type_t comp);
+
 void
 fcc_entity_match_add_has_tag(fcc_entity_match_t* ematch, 
                              const char* tag);
@@ -135,6 +156,7 @@ struct fcc_stmt_t
   fcc_expr_t                      m_expr;           // The expression of this match
   uint32_t                        m_priority;       // The execution priority of this match
   fcc_stmt_place_t               m_place;          // Where this match code should be output
+  bool                            m_pure;           // Whether the system of this match was declared pure
 };
 
 /**
@@ -197,6 +219,8 @@ struct fcc_context_t
 
   fcc_stmt_ptr_array_t        m_stmts;          // The furious stmts extracted from the input code
   fcc_decl_array_t            m_using_decls;
+  fcc_decl_array_t            m_soa_decls;      // The components whose tables were declared SoA (see set_soa_layout)
+  const fcc_stats_t*          p_stats;          // The table statistics used to optimize the execution plans (nullptr if none)
 };
 
 /**
@@ -269,6 +293,17 @@ fcc_context_init();
 void 
 fcc_context_release();
 
+/**
+ * \brief Checks if the table of the given component was declared SoA in the
+ * scripts (see set_soa_layout)
+ *
+ * \param type The component type
+ *
+ * \return True if the table of the component is stored as SoA
+ */
+bool
+fcc_context_is_soa_component(fcc_type_t type);
+
 
 /**
  * \brief Runs the FCC compiler within the provided context and with the given
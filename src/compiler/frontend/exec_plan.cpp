@@ -93,6 +93,12 @@ fcc_exec_plan_insert(fcc_exec_plan_t* exec_plan,
   subplan_init(added_node_match, 
                exec_plan->m_subplans[id]);
   exec_plan->m_subplans[id]->m_id = id;
+  fcc_subplan_push_down_filters(exec_plan->m_subplans[id]);
+  if(p_fcc_context->p_stats != nullptr)
+  {
+    fcc_subplan_reorder_joins(exec_plan->m_subplans[id], 
+                              p_fcc_context->p_stats);
+  }
 
   for(uint32_t i = 0; 
       i < num_nodes - 1; 
@@ -274,6 +280,258 @@ fcc_exec_plan_get_valid_exec_sequence(const fcc_exec_plan_t* exec_plan,
   }
 }
 
+static bool
+contains(const uint32_array_t* array, 
+         uint32_t value)
+{
+  for(uint32_t i = 0; i < array->m_count; ++i)
+  {
+    if(array->m_data[i] == value)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void
+remove_value(uint32_array_t* array, 
+             uint32_t value)
+{
+  uint32_t count = 0;
+  for(uint32_t i = 0; i < array->m_count; ++i)
+  {
+    if(array->m_data[i] != value)
+    {
+      array->m_data[count++] = array->m_data[i];
+    }
+  }
+  array->m_count = count;
+}
+
+static bool
+is_reachable(const fcc_exec_plan_t* exec_plan, 
+             uint32_t from, 
+             uint32_t to, 
+             bool* visited)
+{
+  if(from == to)
+  {
+    return true;
+  }
+  visited[from] = true;
+  const fcc_exec_plan_node_t* node = &exec_plan->m_nodes[from];
+  for(uint32_t i = 0; i < node->m_children.m_count; ++i)
+  {
+    const uint32_t child_id = node->m_children.m_data[i];
+    if(!visited[child_id] && is_reachable(exec_plan, child_id, to, visited))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Checks if node_b depends on node_a through some other node. If so,
+ * the two nodes cannot be merged, since the other node must run in between
+ */
+static bool
+is_indirectly_dependent(const fcc_exec_plan_t* exec_plan, 
+                        uint32_t node_a, 
+                        uint32_t node_b)
+{
+  bool* visited = new bool[exec_plan->m_nnodes]();
+  visited[node_a] = true;
+  bool dependent = false;
+  const fcc_exec_plan_node_t* node = &exec_plan->m_nodes[node_a];
+  for(uint32_t i = 0; i < node->m_children.m_count && !dependent; ++i)
+  {
+    const uint32_t child_id = node->m_children.m_data[i];
+    dependent = child_id != node_b && 
+                !visited[child_id] &&
+                is_reachable(exec_plan, child_id, node_b, visited);
+  }
+  delete [] visited;
+  return dependent;
+}
+
+static bool
+has_globals(const fcc_subplan_t* subplan)
+{
+  const fcc_operator_t* root = &subplan->m_nodes[subplan->m_root];
+  for(uint32_t i = 0; i < root->m_num_columns; ++i)
+  {
+    if(root->m_columns[i].m_type == fcc_column_type_t::E_GLOBAL)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Checks if the subplans of two nodes can be merged into a single one
+ * that runs the systems of both in one pass over their common input
+ */
+static bool
+can_merge(const fcc_exec_plan_t* exec_plan, 
+          uint32_t node_a, 
+          uint32_t node_b)
+{
+  if(!can_merge_foreach(exec_plan->m_subplans[node_a], 
+                        exec_plan->m_subplans[node_b]))
+  {
+    return false;
+  }
+
+  if(is_indirectly_dependent(exec_plan, node_a, node_b) ||
+     is_indirectly_dependent(exec_plan, node_b, node_a))
+  {
+    return false;
+  }
+
+  bool dependent = contains(&exec_plan->m_nodes[node_a].m_children, node_b) ||
+                   contains(&exec_plan->m_nodes[node_b].m_children, node_a);
+  if(!dependent)
+  {
+    return true;
+  }
+
+  // A dependent system must see the globals once the other system has run on
+  // all rows, not only on the rows processed so far
+  return !has_globals(exec_plan->m_subplans[node_a]) && 
+         can_merge_dependent_foreach(exec_plan->m_subplans[node_a], 
+                                     exec_plan->m_subplans[node_b]);
+}
+
+/**
+ * \brief Merges the subplan of node_b into that of node_a and removes node_b
+ * from the execution plan. The ids of the nodes after node_b are decreased by
+ * one
+ */
+static void
+merge_nodes(fcc_exec_plan_t* exec_plan, 
+            uint32_t node_a, 
+            uint32_t node_b)
+{
+  fcc_exec_plan_node_t* a = &exec_plan->m_nodes[node_a];
+  fcc_exec_plan_node_t* b = &exec_plan->m_nodes[node_b];
+
+  // The systems of the node depended on must run first
+  if(contains(&a->m_parents, node_b))
+  {
+    fcc_subplan_t* tmp_subplan = exec_plan->m_subplans[node_a];
+    exec_plan->m_subplans[node_a] = exec_plan->m_subplans[node_b];
+    exec_plan->m_subplans[node_b] = tmp_subplan;
+    const fcc_stmt_t* tmp_stmt = exec_plan->p_stmts[node_a];
+    exec_plan->p_stmts[node_a] = exec_plan->p_stmts[node_b];
+    exec_plan->p_stmts[node_b] = tmp_stmt;
+  }
+  merge_foreach(exec_plan->m_subplans[node_a], 
+                exec_plan->m_subplans[node_b]);
+  subplan_release(exec_plan->m_subplans[node_b]);
+  delete exec_plan->m_subplans[node_b];
+
+  remove_value(&a->m_parents, node_b);
+  remove_value(&a->m_children, node_b);
+  for(uint32_t i = 0; i < b->m_parents.m_count; ++i)
+  {
+    uint32_t parent_id = b->m_parents.m_data[i];
+    fcc_exec_plan_node_t* parent = &exec_plan->m_nodes[parent_id];
+    remove_value(&parent->m_children, node_b);
+    if(parent_id != node_a && !contains(&a->m_parents, parent_id))
+    {
+      uint32_array_append(&a->m_parents, &parent_id);
+      uint32_array_append(&parent->m_children, &node_a);
+    }
+  }
+
+  for(uint32_t i = 0; i < b->m_children.m_count; ++i)
+  {
+    uint32_t child_id = b->m_children.m_data[i];
+    fcc_exec_plan_node_t* child = &exec_plan->m_nodes[child_id];
+    remove_value(&child->m_parents, node_b);
+    if(child_id != node_a && !contains(&a->m_children, child_id))
+    {
+      uint32_array_append(&a->m_children, &child_id);
+      uint32_array_append(&child->m_parents, &node_a);
+    }
+  }
+
+  // Removing node_b
+  uint32_array_release(&b->m_parents);
+  uint32_array_release(&b->m_children);
+  const uint32_t num_nodes = exec_plan->m_nnodes;
+  for(uint32_t i = node_b; i < num_nodes - 1; ++i)
+  {
+    exec_plan->m_nodes[i] = exec_plan->m_nodes[i+1];
+    exec_plan->p_stmts[i] = exec_plan->p_stmts[i+1];
+    exec_plan->m_subplans[i] = exec_plan->m_subplans[i+1];
+  }
+  exec_plan->m_nodes[num_nodes-1].m_parents = uint32_array_init();
+  exec_plan->m_nodes[num_nodes-1].m_children = uint32_array_init();
+  exec_plan->p_stmts[num_nodes-1] = nullptr;
+  exec_plan->m_subplans[num_nodes-1] = nullptr;
+  exec_plan->m_nnodes--;
+
+  for(uint32_t i = 0; i < exec_plan->m_nnodes; ++i)
+  {
+    fcc_exec_plan_node_t* node = &exec_plan->m_nodes[i];
+    for(uint32_t j = 0; j < node->m_parents.m_count; ++j)
+    {
+      if(node->m_parents.m_data[j] > node_b)
+      {
+        node->m_parents.m_data[j]--;
+      }
+    }
+    for(uint32_t j = 0; j < node->m_children.m_count; ++j)
+    {
+      if(node->m_children.m_data[j] > node_b)
+      {
+        node->m_children.m_data[j]--;
+      }
+    }
+    exec_plan->m_subplans[i]->m_id = i;
+  }
+}
+
+/**
+ * \brief Merges the subplans of the nodes whose systems run on the same input
+ * (e.g. the same join of two tables) and whose dependencies allow running them
+ * together, so their input is computed and their data is touched once per
+ * frame instead of once per system
+ */
+static void
+merge_common_subplans(fcc_exec_plan_t* exec_plan)
+{
+  bool merged = true;
+  while(merged)
+  {
+    merged = false;
+    for(uint32_t i = 0; i < exec_plan->m_nnodes && !merged; ++i)
+    {
+      for(uint32_t j = i + 1; j < exec_plan->m_nnodes && !merged; ++j)
+      {
+        if(can_merge(exec_plan, i, j))
+        {
+          merge_nodes(exec_plan, i, j);
+          merged = true;
+        }
+      }
+    }
+  }
+
+  exec_plan->m_nroots = 0;
+  for(uint32_t i = 0; i < exec_plan->m_nnodes; ++i)
+  {
+    if(exec_plan->m_nodes[i].m_parents.m_count == 0)
+    {
+      exec_plan->m_roots[exec_plan->m_nroots++] = i;
+    }
+  }
+}
+
 fcc_compilation_error_type_t
 fcc_exec_plan_init(fcc_exec_plan_t* exec_plan, 
                      const fcc_stmt_t* stmts[], 
@@ -309,6 +567,8 @@ fcc_exec_plan_init(fcc_exec_plan_t* exec_plan,
     return fcc_compilation_error_type_t::E_CYCLIC_DEPENDENCY_GRAPH;
   }
 
+  merge_common_subplans(exec_plan);
+
   return fcc_compilation_error_type_t::E_NO_ERROR;
 }
 
@@ -324,7 +584,7 @@ fcc_exec_plan_release(fcc_exec_plan_t* exec_plan)
     delete exec_plan->m_subplans[i];
   }
 
-  for(uint32_t i = 0; i < exec_plan->m_nnodes; ++i)
+  for(uint32_t i = 0; i < exec_plan->m_maxnodes; ++i)
   {
     uint32_array_release(&exec_plan->m_nodes[i].m_parents);
     uint32_array_release(&exec_plan->m_nodes[i].m_children);
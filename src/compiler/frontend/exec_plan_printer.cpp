@@ -28,6 +28,9 @@ static void
 fcc_subplan_printer_print_foreach(fcc_subplan_printer_t* printer,
                           const fcc_operator_t* foreach);
 static void
+fcc_subplan_printer_print_multi_join(fcc_subplan_printer_t* printer,
+                          const fcc_operator_t* multi_join);
+static void
 fcc_subplan_printer_print_fetch(fcc_subplan_printer_t* printer,
                           const fcc_operator_t* fetch);
 static void
@@ -151,10 +154,14 @@ static void
 fcc_subplan_printer_print_foreach(fcc_subplan_printer_t* printer,
                                   const fcc_operator_t* foreach) 
 {
-  const fcc_system_t* info = foreach->m_foreach.p_system;
+  std::string systems = to_string(foreach->m_foreach.p_systems[0]);
+  for(uint32_t i = 1; i < foreach->m_foreach.m_num_systems; ++i)
+  {
+    systems += ", " + to_string(foreach->m_foreach.p_systems[i]);
+  }
   snprintf(buffer, buffer_length, "foreach (%u) - %s",
            foreach->m_id, 
-           to_string(info).c_str());
+           systems.c_str());
 
   fcc_subplan_printer_print(printer, 
                             buffer);
@@ -178,11 +185,25 @@ fcc_subplan_printer_print_scan(fcc_subplan_printer_t* printer,
                   ctype,
                   FCC_MAX_TYPE_NAME);
 
+    const char* event = "";
+    switch(scan->m_scan.m_event)
+    {
+      case fcc_event_type_t::E_ADDED:
+        event = " - added";
+        break;
+      case fcc_event_type_t::E_REMOVED:
+        event = " - removed";
+        break;
+      default:
+        break;
+    }
+
     snprintf(buffer, 
              buffer_length,
-             "scan (%u) - %s",
+             "scan (%u) - %s%s",
              scan->m_id, 
-             ctype);
+             ctype,
+             event);
 
   }
   else
@@ -205,7 +226,8 @@ fcc_subplan_printer_print_join(fcc_subplan_printer_t* printer,
 {
   snprintf(buffer, 
            buffer_length,
-           "join(%u)", join->m_id);
+           join->m_join.m_swapped ? "join(%u) - swapped" : "join(%u)", 
+           join->m_id);
 
   fcc_subplan_printer_print(printer, 
                             buffer);
@@ -246,6 +268,29 @@ fcc_subplan_printer_print_left_filter_join(fcc_subplan_printer_t* printer,
   fcc_subplan_printer_decr_level(printer);
 }
 
+static void
+fcc_subplan_printer_print_multi_join(fcc_subplan_printer_t* printer, 
+                                     const fcc_operator_t* multi_join) 
+{
+  snprintf(buffer, 
+           buffer_length,
+           "multi_join(%u)", 
+           multi_join->m_id);
+
+  fcc_subplan_printer_print(printer,
+                            buffer);
+  fcc_subplan_printer_incr_level(printer,
+                                 true);
+  fcc_subplan_t* subplan = multi_join->p_subplan;
+  for(uint32_t i = 0; i < multi_join->m_multi_join.m_num_inputs; ++i)
+  {
+    fcc_subplan_printer_print(printer,
+                              &subplan->m_nodes[multi_join->m_multi_join.m_inputs[i]]);
+  }
+
+  fcc_subplan_printer_decr_level(printer);
+}
+
 static void
 fcc_subplan_printer_print_cross_join(fcc_subplan_printer_t* printer, 
                                      const fcc_operator_t* cross_join) 
@@ -346,10 +391,15 @@ fcc_subplan_printer_print_component_filter(fcc_subplan_printer_t* printer,
   char* type;
   char has_type[] ="has";
   char has_not_type[] ="has not";
+  char changed_type[] ="changed";
   if(component_filter->m_component_filter.m_op_type == fcc_filter_op_type_t::E_HAS) 
   {
     type = has_type;
   }
+  else if(component_filter->m_component_filter.m_op_type == fcc_filter_op_type_t::E_CHANGED) 
+  {
+    type = changed_type;
+  }
   else
   {
     type = has_not_type;
@@ -497,6 +547,9 @@ fcc_subplan_printer_print(fcc_subplan_printer_t* printer,
     case fcc_operator_type_t::E_CROSS_JOIN:
       fcc_subplan_printer_print_cross_join(printer, fcc_operator);
       break;
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      fcc_subplan_printer_print_multi_join(printer, fcc_operator);
+      break;
     case fcc_operator_type_t::E_FETCH:
       fcc_subplan_printer_print_fetch(printer, fcc_operator);
       break;
@@ -43,6 +43,7 @@ create_scan(fcc_subplan_t* subplan,
                                 "Scan");
 
   fcc_operator_t* op = &subplan->m_nodes[id];
+  op->m_scan.m_event = fcc_event_type_t::E_NONE;
   fcc_column_t column;
   column.m_type = fcc_column_type_t::E_COMPONENT;
   column.m_component_type = component;
@@ -62,6 +63,7 @@ create_scan(fcc_subplan_t* subplan,
                                 "Scan");
 
   fcc_operator_t* op = &subplan->m_nodes[id];
+  op->m_scan.m_event = fcc_event_type_t::E_NONE;
   fcc_column_t column;
   column.m_type = fcc_column_type_t::E_ID;
   FDB_COPY_AND_CHECK_STR(column.m_ref_name, ref_name, FCC_MAX_REF_NAME);
@@ -107,6 +109,7 @@ create_join(fcc_subplan_t* subplan,
   copy_columns(op, &subplan->m_nodes[right]);
   op->m_join.m_left = left;
   op->m_join.m_right = right;
+  op->m_join.m_swapped = false;
   return id;
 }
 
@@ -149,6 +152,27 @@ create_cross_join(fcc_subplan_t* subplan,
   return id;
 }
 
+uint32_t 
+create_multi_join(fcc_subplan_t* subplan,
+                  const uint32_t* inputs,
+                  uint32_t num_inputs)
+{
+  FDB_ASSERT(num_inputs <= FCC_MAX_MULTI_JOIN_INPUTS && "Maximum number of multi join inputs exceeded");
+  uint32_t id = create_operator(subplan, 
+                                fcc_operator_type_t::E_MULTI_JOIN, 
+                                "MultiJoin");
+
+  fcc_operator_t* op = &subplan->m_nodes[id];
+  for(uint32_t i = 0; i < num_inputs; ++i)
+  {
+    subplan->m_nodes[inputs[i]].m_parent = id;
+    copy_columns(op, &subplan->m_nodes[inputs[i]]);
+    op->m_multi_join.m_inputs[i] = inputs[i];
+  }
+  op->m_multi_join.m_num_inputs = num_inputs;
+  return id;
+}
+
 uint32_t 
 create_predicate_filter(fcc_subplan_t* subplan,
                         uint32_t child,
@@ -215,7 +239,8 @@ create_foreach(fcc_subplan_t* subplan,
                                 fcc_operator_type_t::E_FOREACH, 
                                 "Foreach");
   fcc_operator_t* op = &subplan->m_nodes[id];
-  op->m_foreach.p_system = system;
+  op->m_foreach.p_systems[0] = system;
+  op->m_foreach.m_num_systems = 1;
   if(child != FCC_INVALID_ID)
   {
     op->m_foreach.m_child = child;
@@ -335,6 +360,15 @@ apply_filters(fcc_subplan_t* subplan,
                                          fcc_filter_op_type_t::E_HAS);
   }
 
+  // Create changed components filters
+  for(uint32_t i = 0; i < entity_match->m_nchanged_components; ++i)
+  {
+    local_root = create_component_filter(subplan,
+                                         local_root, 
+                                         entity_match->m_changed_components[i],
+                                         fcc_filter_op_type_t::E_CHANGED);
+  }
+
   return local_root;
 }
 
@@ -387,6 +421,16 @@ apply_filters_reference(fcc_subplan_t* subplan,
                                          true);
   }
 
+  // Create changed components filters
+  for(uint32_t i = 0; i < entity_match->m_nchanged_components; ++i)
+  {
+    local_root = create_component_filter(subplan,
+                                         local_root, 
+                                         entity_match->m_changed_components[i],
+                                         fcc_filter_op_type_t::E_CHANGED, 
+                                         true);
+  }
+
   return local_root;
 }
 void 
@@ -404,7 +448,32 @@ subplan_init(const fcc_stmt_t* match,
     fcc_entity_match_t* entity_match = ematches[i];
     uint32_t num_components = entity_match->m_ncmatches;
     uint32_t local_root = FCC_INVALID_ID;
-    for(uint32_t j = 0; j < num_components; ++j)
+
+    // Matches of several components without globals are joined at once
+    // instead of through a tree of binary joins
+    bool multi_join = num_components >= FCC_MIN_MULTI_JOIN_INPUTS;
+    for(uint32_t j = 0; j < num_components && multi_join; ++j)
+    {
+      multi_join = !entity_match->m_cmatches[j].m_is_global;
+    }
+
+    if(multi_join)
+    {
+      uint32_t inputs[FCC_MAX_MULTI_JOIN_INPUTS];
+      for(uint32_t j = 0; j < num_components; ++j)
+      {
+        fcc_component_match_t* match_type = &entity_match->m_cmatches[j];
+        fcc_access_mode_t access_mode = match_type->m_is_read_only ? fcc_access_mode_t::E_READ : fcc_access_mode_t::E_READ_WRITE;
+        inputs[j] = create_scan(subplan,
+                                match_type->m_type, 
+                                access_mode);
+      }
+      local_root = create_multi_join(subplan, 
+                                     inputs, 
+                                     num_components);
+    }
+
+    for(uint32_t j = 0; j < num_components && !multi_join; ++j)
     {
       fcc_component_match_t* match_type = &entity_match->m_cmatches[j];
 
@@ -422,6 +491,8 @@ subplan_init(const fcc_stmt_t* match,
           local_root = create_scan(subplan,
                                    entity_match->m_cmatches[j].m_type, 
                                    access_mode);
+          // Matches of events (e.g. match_added) have a single component
+          subplan->m_nodes[local_root].m_scan.m_event = entity_match->m_event;
         }
       }
       else 
@@ -14,6 +14,7 @@ enum class fcc_operator_type_t
   E_JOIN,
   E_LEFT_FILTER_JOIN,
   E_CROSS_JOIN,
+  E_MULTI_JOIN,
   E_FETCH,
   E_TAG_FILTER,
   E_PREDICATE_FILTER,
@@ -34,7 +35,8 @@ enum class fcc_column_type_t
 enum class fcc_filter_op_type_t
 {
   E_HAS,
-  E_HAS_NOT
+  E_HAS_NOT,
+  E_CHANGED       //< Only for component filters. Keeps the rows whose component changed recently 
 };
 
 struct fcc_column_t 
@@ -47,12 +49,14 @@ struct fcc_column_t
 
 struct fcc_scan_t
 {
+  fcc_event_type_t m_event;   //< The events of the table to scan instead of its blocks 
 };
 
 struct fcc_join_t
 {
   uint32_t m_left;
   uint32_t m_right;
+  bool     m_swapped;   //< True if the inputs were swapped by the optimizer. The columns are still those of the original left input followed by those of the original right input
 };
 
 struct fcc_cross_join_t
@@ -67,6 +71,16 @@ struct fcc_leftfilter_join_t
   uint32_t m_right;
 };
 
+/**
+ * \brief Joins the block streams of several scans at once. The columns of the
+ * join are those of its inputs, in order
+ */
+struct fcc_multi_join_t
+{
+  uint32_t m_inputs[FCC_MAX_MULTI_JOIN_INPUTS];
+  uint32_t m_num_inputs;
+};
+
 struct fcc_fetch_t
 {
   fcc_type_t m_global_type;
@@ -94,9 +108,15 @@ struct fcc_component_filter_t
   fcc_filter_op_type_t      m_op_type;
 };
 
+/**
+ * \brief Runs one or more systems on the rows of its child. When several
+ * systems share the same input (see merge_foreach), they run one after the
+ * other on each row, in order
+ */
 struct fcc_foreach_t
 {
-  const fcc_system_t*   p_system;
+  const fcc_system_t*   p_systems[FCC_MAX_FOREACH_SYSTEMS];
+  uint32_t              m_num_systems;
   uint32_t              m_child;
 };
 
@@ -128,6 +148,7 @@ struct fcc_operator_t
     fcc_join_t              m_join;
     fcc_leftfilter_join_t   m_leftfilter_join;
     fcc_cross_join_t        m_cross_join;
+    fcc_multi_join_t        m_multi_join;
     fcc_tag_filter_t        m_tag_filter;
     fcc_predicate_filter_t  m_predicate_filter;
     fcc_component_filter_t  m_component_filter;
@@ -165,6 +186,11 @@ create_cross_join(fcc_subplan_t* subplan,
                        uint32_t left,
                        uint32_t right);
 
+uint32_t 
+create_multi_join(fcc_subplan_t* subplan,
+                  const uint32_t* inputs,
+                  uint32_t num_inputs);
+
 uint32_t 
 create_predicate_filter(fcc_subplan_t* subplan,
                         uint32_t child,
@@ -3,9 +3,747 @@
 #include "transforms.h"
 #include "exec_plan.h"
 #include "fcc_context.h"
+#include "operator.h"
+#include "../driver.h"
 
-Foreach* 
-merge_foreach(const Foreach* foreach1, 
-              const Foreach* foreach2) {
+#include <stdio.h>
+#include <string.h>
+
+static bool
+same_type(fcc_type_t type1, 
+          fcc_type_t type2)
+{
+  char name1[FCC_MAX_TYPE_NAME];
+  fcc_type_name(type1, name1, FCC_MAX_TYPE_NAME);
+  char name2[FCC_MAX_TYPE_NAME];
+  fcc_type_name(type2, name2, FCC_MAX_TYPE_NAME);
+  return strcmp(name1, name2) == 0;
+}
+
+/**
+ * @brief Checks if two operators produce the same rows. Access modes are not
+ * compared, since merge_foreach widens them
+ */
+static bool
+same_subtree(const fcc_subplan_t* subplan1, 
+             uint32_t id1,
+             const fcc_subplan_t* subplan2, 
+             uint32_t id2)
+{
+  const fcc_operator_t* op1 = &subplan1->m_nodes[id1];
+  const fcc_operator_t* op2 = &subplan2->m_nodes[id2];
+  if(op1->m_type != op2->m_type || 
+     op1->m_num_columns != op2->m_num_columns)
+  {
+    return false;
+  }
+
+  for(uint32_t i = 0; i < op1->m_num_columns; ++i)
+  {
+    const fcc_column_t* column1 = &op1->m_columns[i];
+    const fcc_column_t* column2 = &op2->m_columns[i];
+    if(column1->m_type != column2->m_type)
+    {
+      return false;
+    }
+
+    if(column1->m_type == fcc_column_type_t::E_ID ||
+       column1->m_type == fcc_column_type_t::E_REFERENCE)
+    {
+      if(strcmp(column1->m_ref_name, column2->m_ref_name) != 0)
+      {
+        return false;
+      }
+    }
+    else if(!same_type(column1->m_component_type, column2->m_component_type))
+    {
+      return false;
+    }
+  }
+
+  switch(op1->m_type)
+  {
+    case fcc_operator_type_t::E_SCAN:
+      return op1->m_scan.m_event == op2->m_scan.m_event;
+    case fcc_operator_type_t::E_FETCH:
+      return same_type(op1->m_fetch.m_global_type, op2->m_fetch.m_global_type);
+    case fcc_operator_type_t::E_JOIN:
+      return same_subtree(subplan1, op1->m_join.m_left, subplan2, op2->m_join.m_left) && 
+             same_subtree(subplan1, op1->m_join.m_right, subplan2, op2->m_join.m_right);
+    case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      return same_subtree(subplan1, op1->m_leftfilter_join.m_left, subplan2, op2->m_leftfilter_join.m_left) && 
+             same_subtree(subplan1, op1->m_leftfilter_join.m_right, subplan2, op2->m_leftfilter_join.m_right);
+    case fcc_operator_type_t::E_CROSS_JOIN:
+      return same_subtree(subplan1, op1->m_cross_join.m_left, subplan2, op2->m_cross_join.m_left) && 
+             same_subtree(subplan1, op1->m_cross_join.m_right, subplan2, op2->m_cross_join.m_right);
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      if(op1->m_multi_join.m_num_inputs != op2->m_multi_join.m_num_inputs)
+      {
+        return false;
+      }
+      for(uint32_t i = 0; i < op1->m_multi_join.m_num_inputs; ++i)
+      {
+        if(!same_subtree(subplan1, op1->m_multi_join.m_inputs[i], subplan2, op2->m_multi_join.m_inputs[i]))
+        {
+          return false;
+        }
+      }
+      return true;
+    case fcc_operator_type_t::E_TAG_FILTER:
+      return strcmp(op1->m_tag_filter.m_tag, op2->m_tag_filter.m_tag) == 0 &&
+             op1->m_tag_filter.m_on_column == op2->m_tag_filter.m_on_column &&
+             op1->m_tag_filter.m_op_type == op2->m_tag_filter.m_op_type &&
+             same_subtree(subplan1, op1->m_tag_filter.m_child, subplan2, op2->m_tag_filter.m_child);
+    case fcc_operator_type_t::E_PREDICATE_FILTER:
+      return op1->m_predicate_filter.m_func_decl == op2->m_predicate_filter.m_func_decl &&
+             same_subtree(subplan1, op1->m_predicate_filter.m_child, subplan2, op2->m_predicate_filter.m_child);
+    case fcc_operator_type_t::E_COMPONENT_FILTER:
+      return same_type(op1->m_component_filter.m_filter_type, op2->m_component_filter.m_filter_type) &&
+             op1->m_component_filter.m_on_column == op2->m_component_filter.m_on_column &&
+             op1->m_component_filter.m_op_type == op2->m_component_filter.m_op_type &&
+             same_subtree(subplan1, op1->m_component_filter.m_child, subplan2, op2->m_component_filter.m_child);
+    // Gathers expose the data of other rows to the systems, so these could
+    // observe the partial results of the merged systems
+    case fcc_operator_type_t::E_GATHER:
+    case fcc_operator_type_t::E_CASCADING_GATHER:
+    case fcc_operator_type_t::E_FOREACH:
+      return false;
+  };
+  return false;
+}
+
+/**
+ * @brief Gets pointers to the members of an operator holding the ids of its
+ * children, so these can be rewired
+ *
+ * @return The number of children
+ */
+static uint32_t
+get_child_refs(fcc_operator_t* op, 
+               uint32_t** refs)
+{
+  switch(op->m_type)
+  {
+    case fcc_operator_type_t::E_SCAN:
+    case fcc_operator_type_t::E_FETCH:
+      return 0;
+    case fcc_operator_type_t::E_JOIN:
+      refs[0] = &op->m_join.m_left;
+      refs[1] = &op->m_join.m_right;
+      return 2;
+    case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      refs[0] = &op->m_leftfilter_join.m_left;
+      refs[1] = &op->m_leftfilter_join.m_right;
+      return 2;
+    case fcc_operator_type_t::E_CROSS_JOIN:
+      refs[0] = &op->m_cross_join.m_left;
+      refs[1] = &op->m_cross_join.m_right;
+      return 2;
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      for(uint32_t i = 0; i < op->m_multi_join.m_num_inputs; ++i)
+      {
+        refs[i] = &op->m_multi_join.m_inputs[i];
+      }
+      return op->m_multi_join.m_num_inputs;
+    case fcc_operator_type_t::E_TAG_FILTER:
+      refs[0] = &op->m_tag_filter.m_child;
+      return 1;
+    case fcc_operator_type_t::E_PREDICATE_FILTER:
+      refs[0] = &op->m_predicate_filter.m_child;
+      return 1;
+    case fcc_operator_type_t::E_COMPONENT_FILTER:
+      refs[0] = &op->m_component_filter.m_child;
+      return 1;
+    case fcc_operator_type_t::E_FOREACH:
+      refs[0] = &op->m_foreach.m_child;
+      return 1;
+    case fcc_operator_type_t::E_GATHER:
+      refs[0] = &op->m_gather.m_child;
+      refs[1] = &op->m_gather.m_ref_table;
+      return 2;
+    case fcc_operator_type_t::E_CASCADING_GATHER:
+      refs[0] = &op->m_cascading_gather.m_child;
+      refs[1] = &op->m_cascading_gather.m_ref_table;
+      return 2;
+  };
+  return 0;
+}
+
+/**
+ * @brief Gets the ids of the children of an operator
+ *
+ * @return The number of children
+ */
+static uint32_t
+get_children(const fcc_operator_t* op, 
+             uint32_t* children)
+{
+  uint32_t* refs[FCC_MAX_MULTI_JOIN_INPUTS];
+  const uint32_t num_children = get_child_refs((fcc_operator_t*)op, refs);
+  for(uint32_t i = 0; i < num_children; ++i)
+  {
+    children[i] = *refs[i];
+  }
+  return num_children;
+}
+
+/**
+ * @brief Widens the access modes of the columns of a subtree with those of an
+ * identical subtree
+ */
+static void
+merge_access_modes(fcc_subplan_t* dst, 
+                   uint32_t dst_id,
+                   const fcc_subplan_t* src,
+                   uint32_t src_id)
+{
+  fcc_operator_t* dst_op = &dst->m_nodes[dst_id];
+  const fcc_operator_t* src_op = &src->m_nodes[src_id];
+  for(uint32_t i = 0; i < dst_op->m_num_columns; ++i)
+  {
+    if(src_op->m_columns[i].m_access_mode != fcc_access_mode_t::E_READ)
+    {
+      dst_op->m_columns[i].m_access_mode = src_op->m_columns[i].m_access_mode;
+    }
+  }
+
+  uint32_t dst_children[FCC_MAX_MULTI_JOIN_INPUTS];
+  uint32_t src_children[FCC_MAX_MULTI_JOIN_INPUTS];
+  const uint32_t num_children = get_children(dst_op, dst_children);
+  get_children(src_op, src_children);
+  for(uint32_t i = 0; i < num_children; ++i)
+  {
+    merge_access_modes(dst, dst_children[i], src, src_children[i]);
+  }
+}
+
+bool
+can_merge_foreach(const fcc_subplan_t* subplan1, 
+                  const fcc_subplan_t* subplan2)
+{
+  const fcc_operator_t* foreach1 = &subplan1->m_nodes[subplan1->m_root];
+  const fcc_operator_t* foreach2 = &subplan2->m_nodes[subplan2->m_root];
+  if(foreach1->m_type != fcc_operator_type_t::E_FOREACH ||
+     foreach2->m_type != fcc_operator_type_t::E_FOREACH ||
+     subplan1->m_requires_sync ||
+     subplan2->m_requires_sync ||
+     foreach1->m_foreach.m_num_systems + 
+     foreach2->m_foreach.m_num_systems > FCC_MAX_FOREACH_SYSTEMS ||
+     foreach1->m_foreach.p_systems[0]->m_block != foreach2->m_foreach.p_systems[0]->m_block)
+  {
+    return false;
+  }
+
+  return same_subtree(subplan1, 
+                      foreach1->m_foreach.m_child, 
+                      subplan2, 
+                      foreach2->m_foreach.m_child);
+}
+
+/**
+ * @brief Checks if a foreach operator writes a component of the given type
+ */
+static bool
+writes_component(const fcc_operator_t* foreach, 
+                 fcc_type_t type)
+{
+  for(uint32_t i = 0; i < foreach->m_num_columns; ++i)
+  {
+    const fcc_column_t* column = &foreach->m_columns[i];
+    if(column->m_type == fcc_column_type_t::E_COMPONENT &&
+       column->m_access_mode != fcc_access_mode_t::E_READ &&
+       same_type(column->m_component_type, type))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Checks if a subtree contains a predicate filter or a changed filter
+ * over a component written by a foreach operator
+ */
+static bool
+filters_written_components(const fcc_subplan_t* subplan, 
+                           uint32_t id,
+                           const fcc_operator_t* foreach)
+{
+  const fcc_operator_t* op = &subplan->m_nodes[id];
+  if(op->m_type == fcc_operator_type_t::E_PREDICATE_FILTER)
+  {
+    for(uint32_t i = 0; i < op->m_num_columns; ++i)
+    {
+      if(op->m_columns[i].m_type == fcc_column_type_t::E_COMPONENT &&
+         writes_component(foreach, op->m_columns[i].m_component_type))
+      {
+        return true;
+      }
+    }
+  }
+
+  if(op->m_type == fcc_operator_type_t::E_COMPONENT_FILTER &&
+     op->m_component_filter.m_op_type == fcc_filter_op_type_t::E_CHANGED &&
+     writes_component(foreach, op->m_component_filter.m_filter_type))
+  {
+    return true;
+  }
+
+  uint32_t children[FCC_MAX_MULTI_JOIN_INPUTS];
+  const uint32_t num_children = get_children(op, children);
+  for(uint32_t i = 0; i < num_children; ++i)
+  {
+    if(filters_written_components(subplan, children[i], foreach))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+can_merge_dependent_foreach(const fcc_subplan_t* subplan1, 
+                            const fcc_subplan_t* subplan2)
+{
+  if(!can_merge_foreach(subplan1, subplan2))
+  {
+    return false;
+  }
+
+  const fcc_operator_t* foreach1 = &subplan1->m_nodes[subplan1->m_root];
+  const fcc_operator_t* foreach2 = &subplan2->m_nodes[subplan2->m_root];
+  return !filters_written_components(subplan1, foreach1->m_foreach.m_child, foreach1) &&
+         !filters_written_components(subplan1, foreach1->m_foreach.m_child, foreach2);
+}
+
+void
+merge_foreach(fcc_subplan_t* dst,
+              const fcc_subplan_t* src)
+{
+  FDB_ASSERT(can_merge_foreach(dst, src) && "Cannot merge the foreach operators of the subplans");
+
+  merge_access_modes(dst, dst->m_root, src, src->m_root);
+
+  fcc_operator_t* dst_foreach = &dst->m_nodes[dst->m_root];
+  const fcc_operator_t* src_foreach = &src->m_nodes[src->m_root];
+  for(uint32_t i = 0; i < src_foreach->m_foreach.m_num_systems; ++i)
+  {
+    dst_foreach->m_foreach.p_systems[dst_foreach->m_foreach.m_num_systems++] = src_foreach->m_foreach.p_systems[i];
+  }
+}
+
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+
+#define FCC_UNKNOWN_CARDINALITY UINT64_MAX
+
+void
+fcc_stats_init(fcc_stats_t* stats)
+{
+  stats->m_tables = fcc_table_stats_array_init();
+}
+
+void
+fcc_stats_release(fcc_stats_t* stats)
+{
+  fcc_table_stats_array_release(&stats->m_tables);
+}
+
+bool
+fcc_stats_load(fcc_stats_t* stats, 
+               const char* path)
+{
+  FILE* fd = fopen(path, "r");
+  if(fd == nullptr)
+  {
+    return false;
+  }
+
+  char line[FCC_MAX_TYPE_NAME*2];
+  char format[64];
+  snprintf(format, 64, "%%%us %%lu %%lu", FCC_MAX_TYPE_NAME-1);
+  while(fgets(line, sizeof(line), fd) != nullptr)
+  {
+    if(line[0] == '#' || line[0] == '\n')
+    {
+      continue;
+    }
+
+    fcc_table_stats_t table_stats;
+    unsigned long num_components = 0;
+    unsigned long num_blocks = 0;
+    if(sscanf(line, 
+              format, 
+              table_stats.m_name, 
+              &num_components, 
+              &num_blocks) != 3)
+    {
+      continue;
+    }
+    table_stats.m_num_components = num_components;
+    table_stats.m_num_blocks = num_blocks;
+    fcc_table_stats_array_append(&stats->m_tables, &table_stats);
+  }
+  fclose(fd);
+  return true;
+}
+
+const fcc_table_stats_t*
+fcc_stats_find(const fcc_stats_t* stats, 
+               const char* table_name)
+{
+  for(uint32_t i = 0; i < stats->m_tables.m_count; ++i)
+  {
+    const fcc_table_stats_t* table_stats = &stats->m_tables.m_data[i];
+    if(strncmp(table_stats->m_name, table_name, FCC_MAX_TYPE_NAME) == 0)
+    {
+      return table_stats;
+    }
+  }
   return nullptr;
 }
+
+/**
+ * \brief Estimates the number of blocks produced by an operator, as an upper
+ * bound derived from the number of blocks of the tables it reads from
+ *
+ * \return The estimated number of blocks, or FCC_UNKNOWN_CARDINALITY if it
+ * cannot be estimated
+ */
+static uint64_t
+estimate_num_blocks(const fcc_subplan_t* subplan, 
+                    uint32_t id,
+                    const fcc_stats_t* stats)
+{
+  const fcc_operator_t* op = &subplan->m_nodes[id];
+  switch(op->m_type)
+  {
+    case fcc_operator_type_t::E_SCAN:
+      {
+        if(op->m_columns[0].m_type != fcc_column_type_t::E_COMPONENT)
+        {
+          return FCC_UNKNOWN_CARDINALITY;
+        }
+        char type_name[FCC_MAX_TYPE_NAME];
+        fcc_type_name(op->m_columns[0].m_component_type, 
+                      type_name, 
+                      FCC_MAX_TYPE_NAME);
+        const fcc_table_stats_t* table_stats = fcc_stats_find(stats, type_name);
+        return table_stats != nullptr ? table_stats->m_num_blocks : FCC_UNKNOWN_CARDINALITY;
+      }
+    case fcc_operator_type_t::E_FETCH:
+      return 1;
+    case fcc_operator_type_t::E_JOIN:
+      {
+        uint64_t left = estimate_num_blocks(subplan, op->m_join.m_left, stats);
+        uint64_t right = estimate_num_blocks(subplan, op->m_join.m_right, stats);
+        return left < right ? left : right;
+      }
+    case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      {
+        uint64_t left = estimate_num_blocks(subplan, op->m_leftfilter_join.m_left, stats);
+        uint64_t right = estimate_num_blocks(subplan, op->m_leftfilter_join.m_right, stats);
+        return left < right ? left : right;
+      }
+    case fcc_operator_type_t::E_CROSS_JOIN:
+      {
+        uint64_t left = estimate_num_blocks(subplan, op->m_cross_join.m_left, stats);
+        uint64_t right = estimate_num_blocks(subplan, op->m_cross_join.m_right, stats);
+        return left > right ? left : right;
+      }
+    case fcc_operator_type_t::E_MULTI_JOIN:
+      {
+        uint64_t min = FCC_UNKNOWN_CARDINALITY;
+        for(uint32_t i = 0; i < op->m_multi_join.m_num_inputs; ++i)
+        {
+          uint64_t input = estimate_num_blocks(subplan, op->m_multi_join.m_inputs[i], stats);
+          min = input < min ? input : min;
+        }
+        return min;
+      }
+    case fcc_operator_type_t::E_TAG_FILTER:
+      return estimate_num_blocks(subplan, op->m_tag_filter.m_child, stats);
+    case fcc_operator_type_t::E_PREDICATE_FILTER:
+      return estimate_num_blocks(subplan, op->m_predicate_filter.m_child, stats);
+    case fcc_operator_type_t::E_COMPONENT_FILTER:
+      return estimate_num_blocks(subplan, op->m_component_filter.m_child, stats);
+    case fcc_operator_type_t::E_FOREACH:
+      return estimate_num_blocks(subplan, op->m_foreach.m_child, stats);
+    case fcc_operator_type_t::E_GATHER:
+      return estimate_num_blocks(subplan, op->m_gather.m_child, stats);
+    case fcc_operator_type_t::E_CASCADING_GATHER:
+      return estimate_num_blocks(subplan, op->m_cascading_gather.m_child, stats);
+  };
+  return FCC_UNKNOWN_CARDINALITY;
+}
+
+void
+fcc_subplan_reorder_joins(fcc_subplan_t* subplan, 
+                          const fcc_stats_t* stats)
+{
+  for(uint32_t i = 0; i < subplan->m_num_nodes; ++i)
+  {
+    fcc_operator_t* op = &subplan->m_nodes[i];
+    if(op->m_type != fcc_operator_type_t::E_JOIN)
+    {
+      continue;
+    }
+
+    uint64_t left = estimate_num_blocks(subplan, op->m_join.m_left, stats);
+    uint64_t right = estimate_num_blocks(subplan, op->m_join.m_right, stats);
+    if(left == FCC_UNKNOWN_CARDINALITY || 
+       right == FCC_UNKNOWN_CARDINALITY || 
+       left <= right)
+    {
+      continue;
+    }
+
+    uint32_t tmp = op->m_join.m_left;
+    op->m_join.m_left = op->m_join.m_right;
+    op->m_join.m_right = tmp;
+    op->m_join.m_swapped = !op->m_join.m_swapped;
+  }
+}
+
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+
+/**
+ * @brief Gets the name of the component type pointed by a predicate parameter,
+ * without qualifiers, pointers nor references
+ */
+static void
+get_param_component_name(fcc_type_t type, 
+                         char* buffer, 
+                         uint32_t buffer_length)
+{
+  char tmp[FCC_MAX_TYPE_NAME];
+  fcc_type_name(type, tmp, FCC_MAX_TYPE_NAME);
+  const char* start = tmp;
+  if(strncmp(start, "const ", 6) == 0)
+  {
+    start += 6;
+  }
+  uint32_t length = 0;
+  for(const char* c = start; *c != '\0' && length < buffer_length - 1; ++c)
+  {
+    if(*c != '*' && *c != '&' && *c != ' ')
+    {
+      buffer[length++] = *c;
+    }
+  }
+  buffer[length] = '\0';
+}
+
+/**
+ * @brief Checks if a predicate can be evaluated on the rows of an operator,
+ * that is, if its parameters are the columns of the operator
+ */
+static bool
+is_predicate_on(fcc_decl_t func_decl, 
+                const fcc_operator_t* op)
+{
+  if(fcc_decl_function_num_params(func_decl) != op->m_num_columns)
+  {
+    return false;
+  }
+
+  for(uint32_t i = 0; i < op->m_num_columns; ++i)
+  {
+    const fcc_column_t* column = &op->m_columns[i];
+    fcc_type_t param_type;
+    if(column->m_type == fcc_column_type_t::E_ID || 
+       !fcc_decl_function_param_type(func_decl, i, &param_type))
+    {
+      return false;
+    }
+
+    char param_name[FCC_MAX_TYPE_NAME];
+    get_param_component_name(param_type, param_name, FCC_MAX_TYPE_NAME);
+    char column_name[FCC_MAX_TYPE_NAME];
+    fcc_type_name(column->m_component_type, column_name, FCC_MAX_TYPE_NAME);
+    if(strcmp(param_name, column_name) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Checks if an operator has a component column of the given type
+ */
+static bool
+has_component_column(const fcc_operator_t* op, 
+                     fcc_type_t type)
+{
+  for(uint32_t i = 0; i < op->m_num_columns; ++i)
+  {
+    if(op->m_columns[i].m_type == fcc_column_type_t::E_COMPONENT &&
+       same_type(op->m_columns[i].m_component_type, type))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Gets the member of a join holding the input a filter can be pushed
+ * to. Filters on the entities (tags and components) go to the input streamed
+ * into the join, which keeps merge joins possible, or to the non-global input
+ * of cross joins. Predicates and changed filters go to the input whose
+ * columns they read.
+ *
+ * @return The member holding the input to push the filter to, or nullptr if
+ * the filter cannot be pushed below the join
+ */
+static uint32_t*
+get_push_down_ref(fcc_subplan_t* subplan, 
+                  const fcc_operator_t* filter, 
+                  fcc_operator_t* join)
+{
+  uint32_t* left = nullptr;
+  uint32_t* right = nullptr;
+  switch(join->m_type)
+  {
+    case fcc_operator_type_t::E_JOIN:
+      left = &join->m_join.m_left;
+      right = &join->m_join.m_right;
+      break;
+    case fcc_operator_type_t::E_CROSS_JOIN:
+      left = &join->m_cross_join.m_left;
+      right = &join->m_cross_join.m_right;
+      break;
+    case fcc_operator_type_t::E_LEFT_FILTER_JOIN:
+      // The right input only filters the rows of the left one 
+      left = &join->m_leftfilter_join.m_left;
+      break;
+    default:
+      return nullptr;
+  };
+
+  if(filter->m_type == fcc_operator_type_t::E_PREDICATE_FILTER)
+  {
+    fcc_decl_t func_decl = filter->m_predicate_filter.m_func_decl;
+    if(right != nullptr && is_predicate_on(func_decl, &subplan->m_nodes[*right]))
+    {
+      return right;
+    }
+    if(is_predicate_on(func_decl, &subplan->m_nodes[*left]))
+    {
+      return left;
+    }
+    return nullptr;
+  }
+
+  if(filter->m_type == fcc_operator_type_t::E_COMPONENT_FILTER &&
+     filter->m_component_filter.m_op_type == fcc_filter_op_type_t::E_CHANGED)
+  {
+    fcc_type_t type = filter->m_component_filter.m_filter_type;
+    if(right != nullptr && has_component_column(&subplan->m_nodes[*right], type))
+    {
+      return right;
+    }
+    if(has_component_column(&subplan->m_nodes[*left], type))
+    {
+      return left;
+    }
+    return nullptr;
+  }
+
+  if(right == nullptr || 
+     subplan->m_nodes[*right].m_type == fcc_operator_type_t::E_FETCH)
+  {
+    return subplan->m_nodes[*left].m_type != fcc_operator_type_t::E_FETCH ? left : nullptr;
+  }
+  return right;
+}
+
+static bool
+is_pushable_filter(const fcc_operator_t* op)
+{
+  switch(op->m_type)
+  {
+    case fcc_operator_type_t::E_TAG_FILTER:
+      return !op->m_tag_filter.m_on_column;
+    case fcc_operator_type_t::E_COMPONENT_FILTER:
+      return !op->m_component_filter.m_on_column;
+    case fcc_operator_type_t::E_PREDICATE_FILTER:
+      return true;
+    default:
+      return false;
+  };
+}
+
+/**
+ * @brief Moves a filter below the join it is applied to, if possible
+ *
+ * @return True if the filter was moved
+ */
+static bool
+push_down_filter(fcc_subplan_t* subplan, 
+                 uint32_t filter_id)
+{
+  fcc_operator_t* filter = &subplan->m_nodes[filter_id];
+  uint32_t* child_ref[1];
+  get_child_refs(filter, child_ref);
+  const uint32_t join_id = *child_ref[0];
+  fcc_operator_t* join = &subplan->m_nodes[join_id];
+  uint32_t* input_ref = get_push_down_ref(subplan, filter, join);
+  if(input_ref == nullptr)
+  {
+    return false;
+  }
+
+  // The parent of the filter takes the join as its child
+  const uint32_t parent_id = filter->m_parent;
+  if(parent_id == FCC_INVALID_ID)
+  {
+    subplan->m_root = join_id;
+  }
+  else
+  {
+    uint32_t* refs[FCC_MAX_MULTI_JOIN_INPUTS];
+    const uint32_t num_children = get_child_refs(&subplan->m_nodes[parent_id], refs);
+    for(uint32_t i = 0; i < num_children; ++i)
+    {
+      if(*refs[i] == filter_id)
+      {
+        *refs[i] = join_id;
+      }
+    }
+  }
+  join->m_parent = parent_id;
+
+  // The filter is placed between the join and the input
+  const uint32_t input_id = *input_ref;
+  *input_ref = filter_id;
+  filter->m_parent = join_id;
+  *child_ref[0] = input_id;
+  subplan->m_nodes[input_id].m_parent = filter_id;
+
+  const fcc_operator_t* input = &subplan->m_nodes[input_id];
+  filter->m_num_columns = input->m_num_columns;
+  memcpy(filter->m_columns, input->m_columns, sizeof(fcc_column_t)*input->m_num_columns);
+  return true;
+}
+
+void
+fcc_subplan_push_down_filters(fcc_subplan_t* subplan)
+{
+  bool pushed = true;
+  while(pushed)
+  {
+    pushed = false;
+    for(uint32_t i = 0; i < subplan->m_num_nodes; ++i)
+    {
+      if(is_pushable_filter(&subplan->m_nodes[i]))
+      {
+        pushed = push_down_filter(subplan, i) || pushed;
+      }
+    }
+  }
+}
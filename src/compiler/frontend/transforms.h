@@ -3,29 +3,142 @@
 #ifndef _FURIOUS_COMPILER_TRANSFORMS_H_
 #define _FURIOUS_COMPILER_TRANSFORMS_H_
 
+#include "../../common/platform.h"
 
-struct Foreach;
-struct FccContext;
-struct FccMatch;
-struct FccOperator;
+// autogen includes
+#include "autogen/fcc_table_stats_array.h"
+
+struct fcc_subplan_t;
+
+/**
+ * @brief Checks if the Foreach operators at the root of two subplans can be
+ * merged with merge_foreach. This is the case when their children are
+ * identical subtrees (the same scans, joins and filters over the same tables)
+ * that do not gather data from other rows, and their systems are either all
+ * per-entity or all per-block (run_block) systems.
+ *
+ * @param subplan1 The first subplan
+ * @param subplan2 The second subplan
+ *
+ * @return True if the Foreach operators can be merged
+ */
+bool
+can_merge_foreach(const fcc_subplan_t* subplan1, 
+                  const fcc_subplan_t* subplan2);
+
+/**
+ * @brief Checks if the Foreach operators at the root of two subplans can be
+ * merged when the systems of one depend on those of the other. Besides
+ * satisfying can_merge_foreach, their common input must not be filtered by a
+ * predicate or a changed filter over a component written by any of the
+ * systems, since the filter is evaluated once per row, before the first system
+ * writes it.
+ *
+ * @param subplan1 The first subplan
+ * @param subplan2 The second subplan
+ *
+ * @return True if the Foreach operators can be merged
+ */
+bool
+can_merge_dependent_foreach(const fcc_subplan_t* subplan1, 
+                            const fcc_subplan_t* subplan2);
+
+/**
+ * @brief  Merges the Foreach operator at the root of a subplan into the Foreach
+ * operator at the root of another one, so the systems of both run in a single
+ * pass over their common input. The systems of src run after those of dst on
+ * each row. The subplans must satisfy can_merge_foreach.
+ *
+ * @param dst The subplan to merge the Foreach to
+ * @param src The subplan with the Foreach to merge
+ */
+void
+merge_foreach(fcc_subplan_t* dst,
+              const fcc_subplan_t* src);
+
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+
+/**
+ * \brief The statistics of a table, as exported by fdb_database_export_stats
+ */
+struct fcc_table_stats_t
+{
+  char      m_name[FCC_MAX_TYPE_NAME];
+  uint64_t  m_num_components;
+  uint64_t  m_num_blocks;
+};
 
 /**
- * @brief  Merges two Foreach operators into a new one. The new Foreach operator
- * executes the functions of the two original foreach over the children table.
+ * \brief The table statistics used by the optimizer to estimate the cost of the
+ * execution plans
+ */
+struct fcc_stats_t
+{
+  fcc_table_stats_array_t m_tables;
+};
+
+void
+fcc_stats_init(fcc_stats_t* stats);
+
+void
+fcc_stats_release(fcc_stats_t* stats);
+
+/**
+ * \brief Loads the table statistics from a file exported with
+ * fdb_database_export_stats
  *
- * @param context  The Fcc compilation context
- * @param foreach1 The first Foreach to merge
- * @param foreach2 The secont Foreach to merge
+ * \param stats The stats to load the statistics to
+ * \param path The path to the statistics file
  *
- * @return A newly created Foreach resulting of merging the two input Foreach.
+ * \return True if the file could be read
  */
-Foreach* 
-merge_foreach(FccContext* context,
-              const Foreach* foreach1, 
-              const Foreach* foreach2);
+bool
+fcc_stats_load(fcc_stats_t* stats, 
+               const char* path);
 
+/**
+ * \brief Finds the statistics of a table
+ *
+ * \param stats The statistics to look into
+ * \param table_name The name of the table
+ *
+ * \return The statistics of the table, or nullptr if there are none
+ */
+const fcc_table_stats_t*
+fcc_stats_find(const fcc_stats_t* stats, 
+               const char* table_name);
 
+/**
+ * \brief Reorders the inputs of the joins of a subplan so the input with the
+ * fewest estimated blocks is the one materialized (or iterated as a whole, for
+ * merge joins), while the largest one is streamed and partitioned among
+ * threads. The order of the columns produced by the joins is preserved. Inputs
+ * without statistics are never reordered.
+ *
+ * \param subplan The subplan to optimize
+ * \param stats The table statistics
+ */
+void
+fcc_subplan_reorder_joins(fcc_subplan_t* subplan, 
+                          const fcc_stats_t* stats);
 
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+////////////////////////////////////////////////
 
+/**
+ * \brief Pushes the filters of a subplan below the joins they are applied to,
+ * so blocks emptied by a filter are discarded before being joined. Tag and
+ * component filters on the entities are pushed to the input streamed into the
+ * join, and predicate filters to the input whose columns are their parameters.
+ * Filters are never pushed below multi joins, which must read their inputs
+ * from the tables directly.
+ *
+ * \param subplan The subplan to optimize
+ */
+void
+fcc_subplan_push_down_filters(fcc_subplan_t* subplan);
 
 #endif /* ifndef _FURIOUS_COMPILER_TRANSFORMS_H_ */
@@ -5,6 +5,7 @@
 
 #include "macros.h"
 #include "../common/common.h"
+#include "../common/bitmap.h"
 #include "../runtime/data/context.h"
 
 #include <type_traits>
@@ -60,6 +61,21 @@ struct RegisterSystemInfo
   {
     return RegisterSystemInfo();
   }
+
+  /**
+   * \brief Declares that the system is pure: it has no side effects besides
+   * writing the components of the entity it runs on, and it does not depend
+   * on the values of the components it reads to be valid. This lets fcc run
+   * the system on all the entities of mostly dense blocks, including disabled
+   * ones whose results are discarded, to keep the loop branch-free.
+   *
+   * \return This RegisterSystemInfo
+   */
+  RegisterSystemInfo
+  set_pure()
+  {
+    return RegisterSystemInfo();
+  }
 };
 
 /**
@@ -84,6 +100,42 @@ __register_foreach(T *system,
   return RegisterSystemInfo<T, TComponents ...>();
 }
 
+/**
+ * \brief Overload for systems that process whole blocks through a run_block
+ * method. The system receives the id of the first entity of the block, the
+ * bitmap of the enabled entities, the number of entities of the block, and
+ * the aligned arrays of the components of the block (globals are passed as a
+ * single pointer). Entities whose bit is not set in the mask must be left
+ * untouched.
+ *
+ * \tparam T The type of the system object
+ * \tparam typename...Components The component types of the run_block method
+ * \param system A pointer to the system object
+ * \param T::* The function of the system object, which will always be "run_block".
+ *
+ * \return 
+ */
+template <typename T, typename ... TComponents>
+typename std::enable_if<(std::is_pointer<TComponents>::value && ...), RegisterSystemInfo<T, TComponents ...> >::type
+__register_foreach(T *system,
+      void (T::*)(fdb_context_t *, uint32_t start, const fdb_bitmap_t* mask, size_t n, TComponents...))
+{
+  return RegisterSystemInfo<T, TComponents ...>();
+}
+
+/**
+ * \brief Trait telling whether a system implements the run_block method
+ */
+template <typename T, typename = void>
+struct __has_run_block : std::false_type
+{
+};
+
+template <typename T>
+struct __has_run_block<T, std::void_t<decltype(&T::run_block)>> : std::true_type
+{
+};
+
 template<typename...TComponents>
 struct MatchQueryBuilder
 {
@@ -155,6 +207,23 @@ struct MatchQueryBuilder
     return *this;
   }
 
+  /**
+   * \brief Executes the system on those entities whose given component was
+   * changed by a system since the previous run of the query, up to the start
+   * of the current frame. Each change is thus seen once. The component must
+   * be one of the matched components
+   *
+   * \tparam TComponent The component to check for changes
+   *
+   * \return This MatchQueryBuilder
+   */
+  template<typename TComponent>
+  MatchQueryBuilder<TComponents...>
+  changed()
+  {
+    return *this;
+  }
+
   template<typename...QComponents>
   MatchQueryBuilder<TComponents..., QComponents...>
   expand(const std::string& str)
@@ -176,7 +245,14 @@ struct MatchQueryBuilder
   foreach(TArgs&&...args)
   {
     TSystem *system_object = new TSystem(std::forward<TArgs>(args)...);
-    return __register_foreach(system_object, &TSystem::run);
+    if constexpr (__has_run_block<TSystem>::value)
+    {
+      return __register_foreach(system_object, &TSystem::run_block);
+    }
+    else
+    {
+      return __register_foreach(system_object, &TSystem::run);
+    }
   }
   
 };
@@ -195,5 +271,60 @@ MatchQueryBuilder<TComponents...> match()
   return MatchQueryBuilder<TComponents...>();
 }
 
+/**
+ * \brief Method use to start a query in a furious script by selecting the
+ * components of the given type created in the previous frame, instead of
+ * scanning the whole table
+ *
+ * \tparam TComponent The component to select
+ *
+ * \return Returns a MatchQueryBuilder 
+ */
+template<typename TComponent>
+MatchQueryBuilder<TComponent> match_added() 
+{
+  return MatchQueryBuilder<TComponent>();
+}
+
+/**
+ * \brief Method use to start a query in a furious script by selecting the
+ * components of the given type destroyed in the previous frame. The systems
+ * receive a copy of the components taken when they were destroyed, so
+ * changes to them are discarded
+ *
+ * \tparam TComponent The component to select
+ *
+ * \return Returns a MatchQueryBuilder 
+ */
+template<typename TComponent>
+MatchQueryBuilder<TComponent> match_removed() 
+{
+  return MatchQueryBuilder<TComponent>();
+}
+
+template<typename TComponent>
+struct SoALayoutInfo
+{
+};
+
+/**
+ * \brief Declares that the table of the given component stores its blocks as
+ * SoA (see fdb_table_set_layout). The layout is set by furious_init, so the
+ * table must still be empty by then, and the code generated for the systems
+ * accessing the component only handles this layout. The component must be a
+ * struct whose fields can be copied bytewise. Systems receive a copy of the
+ * component loaded field by field from the columns of the block, which is
+ * stored back after they run, so run_block systems cannot access it
+ *
+ * \tparam TComponent The component whose table is stored as SoA
+ *
+ * \return Returns a SoALayoutInfo
+ */
+template<typename TComponent>
+SoALayoutInfo<TComponent> set_soa_layout() 
+{
+  return SoALayoutInfo<TComponent>();
+}
+
 
 #endif /* ifndef _FURIOUS_LANG_H_ */
@@ -2,82 +2,407 @@
 #include "../../common/memory/pool_allocator.h"
 #include "bittable.h"
 
+#include <string.h>
 
-fdb_bitmap_t*
-fdb_bittable_get_bitset(const fdb_bittable_t* bt, 
-                        uint32_t bitset_id)
+#define FDB_BITTABLE_CONTAINER_WORDS      FDB_BITMAP_NUM_WORDS(FDB_BITTABLE_CONTAINER_BITS)
+#define FDB_BITTABLE_CHUNK_SIZE           FDB_BITMAP_DATA_SIZE(FDB_BITTABLE_CONTAINER_BITS)
+#define FDB_BITTABLE_INLINE_RUNS          (FDB_BITTABLE_INLINE_CAPACITY / 2)
+#define FDB_BITTABLE_BLOCK_WORDS          FDB_BITMAP_NUM_WORDS(FDB_TABLE_BLOCK_SIZE)
+#define FDB_BITTABLE_BLOCKS_PER_CONTAINER (FDB_BITTABLE_CONTAINER_BITS / FDB_TABLE_BLOCK_SIZE)
+#define FDB_BITTABLE_VIEWS_SIZE           (sizeof(fdb_bitmap_t)*FDB_BITTABLE_BLOCKS_PER_CONTAINER)
+
+/**
+ * @brief Finds the position of the first offset of an array container not
+ * smaller than the given one
+ */
+static uint32_t
+fdb_bittable_array_lower_bound(const uint16_t* values,
+                               uint32_t count,
+                               uint32_t offset)
 {
-  return (fdb_bitmap_t*)fdb_btree_get(&bt->m_bitmaps,bitset_id);
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  while(lo < hi)
+  {
+    uint32_t mid = (lo + hi) / 2;
+    if(values[mid] < offset)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo;
 }
 
-void
-fdb_bittable_apply_bitset(fdb_bittable_t* bt, 
-                          uint32_t id,
-                          FDB_RESTRICT(const fdb_bitmap_t*) bitmap,
-                          fdb_bittable_op_t op)
+/**
+ * @brief Finds the position of the first run of a run container whose last
+ * offset is not smaller than the given one
+ */
+static uint32_t
+fdb_bittable_run_lower_bound(const uint16_t* runs,
+                             uint32_t count,
+                             uint32_t offset)
+{
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  while(lo < hi)
+  {
+    uint32_t mid = (lo + hi) / 2;
+    if(runs[2*mid+1] < offset)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * @brief Sets the bits in the range [first, last] of an array of words
+ */
+static void
+fdb_bittable_words_set_range(uint64_t* words,
+                             uint32_t first,
+                             uint32_t last)
+{
+  uint32_t first_word = first >> 6;
+  uint32_t last_word = last >> 6;
+  uint64_t first_mask = ~0ULL << (first & 63);
+  uint64_t last_mask = ~0ULL >> (63 - (last & 63));
+  if(first_word == last_word)
+  {
+    words[first_word] |= first_mask & last_mask;
+    return;
+  }
+  words[first_word] |= first_mask;
+  for(uint32_t i = first_word + 1; i < last_word; ++i)
+  {
+    words[i] = ~0ULL;
+  }
+  words[last_word] |= last_mask;
+}
+
+/**
+ * @brief Tests if an offset is set in a container
+ */
+static bool
+fdb_bittable_container_contains(const fdb_bittable_container_t* c,
+                                uint32_t offset)
 {
-  FDB_RESTRICT(fdb_bitmap_t*) bm = fdb_bittable_get_bitset(bt, id);
-  switch(op)
+  switch(c->m_type)
   {
-    case E_AND:
-      if(bm != NULL)
+    case E_FDB_BITTABLE_CONTAINER_ARRAY:
       {
-        bt->m_size -= bm->m_num_set;
-        fdb_bitmap_set_and(bm, bitmap);
-        bt->m_size += bm->m_num_set;
+        uint32_t pos = fdb_bittable_array_lower_bound(c->m_data.m_values, c->m_count, offset);
+        return pos < c->m_count && c->m_data.m_values[pos] == offset;
       }
-      break;
-    case E_OR:
-      if(bm != NULL)
+    case E_FDB_BITTABLE_CONTAINER_RUN:
       {
-        bt->m_size -= bm->m_num_set;
-        fdb_bitmap_set_or(bm, bitmap);
-        bt->m_size += bm->m_num_set;
+        uint32_t pos = fdb_bittable_run_lower_bound(c->m_data.m_values, c->m_count, offset);
+        return pos < c->m_count && c->m_data.m_values[2*pos] <= offset;
       }
-      else
+    default:
+      return (c->m_data.m_bitset.p_words[offset >> 6] >> (offset & 63)) & 1ULL;
+  };
+}
+
+/**
+ * @brief Ors the bits of a container into an array of
+ * FDB_BITTABLE_CONTAINER_WORDS words
+ */
+static void
+fdb_bittable_container_or_words(const fdb_bittable_container_t* c,
+                                uint64_t* words)
+{
+  switch(c->m_type)
+  {
+    case E_FDB_BITTABLE_CONTAINER_ARRAY:
+      for(uint32_t i = 0; i < c->m_count; ++i)
       {
-        FDB_RESTRICT(fdb_bitmap_t*) nbitmap = (fdb_bitmap_t*)fdb_pool_alloc_alloc(&bt->m_bitmap_allocator, 
-                                                                                  FDB_BITMAP_ALIGNMENT, 
-                                                                                  sizeof(fdb_bitmap_t), 
-                                                                                  FDB_NO_HINT);
-        fdb_bitmap_init(nbitmap, FDB_TABLE_BLOCK_SIZE, &bt->m_bitmap_data_allocator.m_super);
-        fdb_btree_insert(&bt->m_bitmaps, id, nbitmap);
-        fdb_bitmap_set_or(nbitmap,bitmap);
-        bt->m_size += nbitmap->m_num_set;
+        uint32_t offset = c->m_data.m_values[i];
+        words[offset >> 6] |= 1ULL << (offset & 63);
       }
       break;
-    case E_DIFF:
-      if(bm != NULL)
+    case E_FDB_BITTABLE_CONTAINER_RUN:
+      for(uint32_t i = 0; i < c->m_count; ++i)
       {
-        bt->m_size -= bm->m_num_set;
-        fdb_bitmap_set_diff(bm, bitmap);
-        bt->m_size += bm->m_num_set;
+        fdb_bittable_words_set_range(words,
+                                     c->m_data.m_values[2*i],
+                                     c->m_data.m_values[2*i+1]);
+      }
+      break;
+    default:
+      for(uint32_t i = 0; i < FDB_BITTABLE_CONTAINER_WORDS; ++i)
+      {
+        words[i] |= c->m_data.m_bitset.p_words[i];
       }
       break;
   };
 }
 
+/**
+ * @brief Gets the FDB_BITTABLE_BLOCK_WORDS words of a container for the
+ * given table block of the container
+ */
+static void
+fdb_bittable_container_block_words(const fdb_bittable_container_t* c,
+                                   uint32_t block,
+                                   uint64_t* words)
+{
+  uint32_t first = block * FDB_TABLE_BLOCK_SIZE;
+  uint32_t end = first + FDB_TABLE_BLOCK_SIZE;
+  if(c->m_type == E_FDB_BITTABLE_CONTAINER_BITSET)
+  {
+    memcpy(words,
+           &c->m_data.m_bitset.p_words[block*FDB_BITTABLE_BLOCK_WORDS],
+           sizeof(uint64_t)*FDB_BITTABLE_BLOCK_WORDS);
+    return;
+  }
+
+  memset(words, 0, sizeof(uint64_t)*FDB_BITTABLE_BLOCK_WORDS);
+  if(c->m_type == E_FDB_BITTABLE_CONTAINER_ARRAY)
+  {
+    for(uint32_t i = fdb_bittable_array_lower_bound(c->m_data.m_values, c->m_count, first);
+        i < c->m_count && c->m_data.m_values[i] < end;
+        ++i)
+    {
+      uint32_t offset = c->m_data.m_values[i] - first;
+      words[offset >> 6] |= 1ULL << (offset & 63);
+    }
+    return;
+  }
+
+  for(uint32_t i = fdb_bittable_run_lower_bound(c->m_data.m_values, c->m_count, first);
+      i < c->m_count && c->m_data.m_values[2*i] < end;
+      ++i)
+  {
+    uint32_t run_first = c->m_data.m_values[2*i];
+    uint32_t run_last = c->m_data.m_values[2*i+1];
+    fdb_bittable_words_set_range(words,
+                                 (run_first > first ? run_first : first) - first,
+                                 (run_last < end - 1 ? run_last : end - 1) - first);
+  }
+}
+
+/**
+ * @brief Releases the chunks of a bitset container
+ */
+static void
+fdb_bittable_container_release_bitset(fdb_bittable_t* bt,
+                                      fdb_bittable_container_t* c)
+{
+  FDB_ASSERT(c->m_type == E_FDB_BITTABLE_CONTAINER_BITSET && "Container is not a bitset");
+  if(c->m_data.m_bitset.p_views != NULL)
+  {
+    fdb_pool_alloc_free(&bt->m_view_allocator,
+                        c->m_data.m_bitset.p_views);
+  }
+  fdb_pool_alloc_free(&bt->m_chunk_allocator,
+                      c->m_data.m_bitset.p_words);
+  c->m_data.m_bitset.p_words = NULL;
+  c->m_data.m_bitset.p_views = NULL;
+}
+
+/**
+ * @brief Converts a container to a bitset holding the given words
+ */
+static void
+fdb_bittable_container_set_bitset(fdb_bittable_t* bt,
+                                  fdb_bittable_container_t* c,
+                                  const uint64_t* words)
+{
+  if(c->m_type != E_FDB_BITTABLE_CONTAINER_BITSET)
+  {
+    c->m_type = E_FDB_BITTABLE_CONTAINER_BITSET;
+    c->m_data.m_bitset.p_words = (uint64_t*)fdb_pool_alloc_alloc(&bt->m_chunk_allocator,
+                                                                 FDB_BITTABLE_CHUNK_ALIGNMENT,
+                                                                 FDB_BITTABLE_CHUNK_SIZE,
+                                                                 FDB_NO_HINT);
+    c->m_data.m_bitset.p_views = NULL;
+  }
+  memcpy(c->m_data.m_bitset.p_words, words, FDB_BITTABLE_CHUNK_SIZE);
+  c->m_count = 0;
+}
+
+/**
+ * @brief Sets the contents of a container to the given words, choosing the
+ * cheapest encoding for them
+ */
+static void
+fdb_bittable_container_pack(fdb_bittable_t* bt,
+                            fdb_bittable_container_t* c,
+                            const uint64_t* words)
+{
+  uint32_t cardinality = 0;
+  uint32_t num_runs = 0;
+  uint64_t carry = 0;
+  for(uint32_t i = 0; i < FDB_BITTABLE_CONTAINER_WORDS; ++i)
+  {
+    uint64_t word = words[i];
+    cardinality += __builtin_popcountll(word);
+    num_runs += __builtin_popcountll(word & ~((word << 1) | carry));
+    carry = word >> 63;
+  }
+  bt->m_size = bt->m_size - c->m_cardinality + cardinality;
+  c->m_cardinality = cardinality;
+
+  bool use_runs = num_runs <= FDB_BITTABLE_INLINE_RUNS && 2*num_runs < cardinality;
+  if(!use_runs && cardinality > FDB_BITTABLE_INLINE_CAPACITY)
+  {
+    fdb_bittable_container_set_bitset(bt, c, words);
+    return;
+  }
+
+  if(c->m_type == E_FDB_BITTABLE_CONTAINER_BITSET)
+  {
+    fdb_bittable_container_release_bitset(bt, c);
+  }
+  c->m_type = use_runs ? E_FDB_BITTABLE_CONTAINER_RUN : E_FDB_BITTABLE_CONTAINER_ARRAY;
+  c->m_count = 0;
+  uint16_t* values = c->m_data.m_values;
+  for(uint32_t i = 0; i < FDB_BITTABLE_CONTAINER_WORDS; ++i)
+  {
+    uint64_t word = words[i];
+    while(word != 0)
+    {
+      uint32_t offset = (i << 6) + __builtin_ctzll(word);
+      word &= word - 1;
+      if(!use_runs)
+      {
+        values[c->m_count++] = offset;
+      }
+      else if(c->m_count > 0 && values[2*c->m_count-1] + 1 == offset)
+      {
+        values[2*c->m_count-1] = offset;
+      }
+      else
+      {
+        values[2*c->m_count] = offset;
+        values[2*c->m_count+1] = offset;
+        c->m_count++;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Repacks a container after setting or unsetting one of its offsets,
+ * for when its current encoding cannot hold the change
+ */
+static void
+fdb_bittable_container_repack(fdb_bittable_t* bt,
+                              fdb_bittable_container_t* c,
+                              uint32_t offset,
+                              bool set)
+{
+  uint64_t words[FDB_BITTABLE_CONTAINER_WORDS] = {0};
+  fdb_bittable_container_or_words(c, words);
+  if(set)
+  {
+    words[offset >> 6] |= 1ULL << (offset & 63);
+  }
+  else
+  {
+    words[offset >> 6] &= ~(1ULL << (offset & 63));
+  }
+  fdb_bittable_container_pack(bt, c, words);
+}
+
+/**
+ * @brief Gets the container holding the given id. NULL if it does not exist
+ */
+static fdb_bittable_container_t*
+fdb_bittable_get_container(const fdb_bittable_t* bt,
+                           entity_id_t id)
+{
+  return (fdb_bittable_container_t*)fdb_btree_get(&bt->m_containers,
+                                                  id / FDB_BITTABLE_CONTAINER_BITS);
+}
+
+/**
+ * @brief Gets the container holding the given id, creating an empty one if it
+ * does not exist
+ */
+static fdb_bittable_container_t*
+fdb_bittable_get_or_create_container(fdb_bittable_t* bt,
+                                     uint32_t key)
+{
+  fdb_bittable_container_t* c = (fdb_bittable_container_t*)fdb_btree_get(&bt->m_containers, key);
+  if(c == NULL)
+  {
+    c = (fdb_bittable_container_t*)fdb_pool_alloc_alloc(&bt->m_container_allocator,
+                                                        FDB_BITTABLE_CONTAINER_ALIGNMENT,
+                                                        sizeof(fdb_bittable_container_t),
+                                                        FDB_NO_HINT);
+    memset(c, 0, sizeof(fdb_bittable_container_t));
+    c->m_type = E_FDB_BITTABLE_CONTAINER_ARRAY;
+    fdb_btree_insert(&bt->m_containers, key, c);
+  }
+  return c;
+}
+
+/**
+ * @brief Applies a container of another bittable onto a container of this
+ * bittable
+ */
+static void
+fdb_bittable_apply_container(fdb_bittable_t* bt,
+                             fdb_bittable_container_t* dst,
+                             FDB_RESTRICT(const fdb_bittable_container_t*) src,
+                             fdb_bittable_op_t op)
+{
+  uint64_t words[FDB_BITTABLE_CONTAINER_WORDS] = {0};
+  fdb_bittable_container_or_words(dst, words);
+  if(op == E_OR)
+  {
+    fdb_bittable_container_or_words(src, words);
+  }
+  else
+  {
+    uint64_t src_words[FDB_BITTABLE_CONTAINER_WORDS] = {0};
+    fdb_bittable_container_or_words(src, src_words);
+    for(uint32_t i = 0; i < FDB_BITTABLE_CONTAINER_WORDS; ++i)
+    {
+      words[i] = op == E_AND ? words[i] & src_words[i] : words[i] & ~src_words[i];
+    }
+  }
+  fdb_bittable_container_pack(bt, dst, words);
+}
 
 void
-fdb_bittable_init(fdb_bittable_t* bt, 
-                  fdb_mem_allocator_t* allocator) 
+fdb_bittable_init(fdb_bittable_t* bt,
+                  fdb_mem_allocator_t* allocator)
 {
   FDB_ASSERT(((allocator == NULL) ||
               (allocator->p_mem_alloc != NULL && allocator->p_mem_free != NULL)) &&
              "Provided allocator is ill-formed.")
+  FDB_ASSERT(FDB_BITTABLE_VIEWS_SIZE*2 <= FDB_BITTABLE_CHUNK_PAGE_SIZE &&
+             "Block views do not fit in a bittable page");
   bt->m_size = 0;
-  fdb_btree_init(&bt->m_bitmaps, allocator);
+  fdb_btree_init(&bt->m_containers, allocator);
+
+  fdb_pool_alloc_init(&bt->m_container_allocator,
+                      FDB_BITTABLE_CONTAINER_ALIGNMENT,
+                      sizeof(fdb_bittable_container_t),
+                      FDB_BITTABLE_CONTAINER_PAGE_SIZE,
+                      allocator);
 
-  fdb_pool_alloc_init(&bt->m_bitmap_allocator, 
-                      FDB_BITMAP_ALIGNMENT, 
-                      sizeof(fdb_bitmap_t), 
-                      FDB_BITMAP_PAGE_SIZE, 
+  fdb_pool_alloc_init(&bt->m_chunk_allocator,
+                      FDB_BITTABLE_CHUNK_ALIGNMENT,
+                      FDB_BITTABLE_CHUNK_SIZE,
+                      FDB_BITTABLE_CHUNK_PAGE_SIZE,
                       allocator);
 
-  fdb_pool_alloc_init(&bt->m_bitmap_data_allocator, 
-                      FDB_BITMAP_ALIGNMENT, 
-                      FDB_BITMAP_NUM_CHUNKS(FDB_TABLE_BLOCK_SIZE), 
-                      FDB_BITMAP_DATA_PAGE_SIZE, 
+  fdb_pool_alloc_init(&bt->m_view_allocator,
+                      FDB_BITTABLE_CHUNK_ALIGNMENT,
+                      FDB_BITTABLE_VIEWS_SIZE,
+                      FDB_BITTABLE_CHUNK_PAGE_SIZE,
                       allocator);
 }
 
@@ -85,87 +410,389 @@ void
 fdb_bittable_release(fdb_bittable_t* bt)
 {
   fdb_btree_iter_t it;
-  fdb_btree_iter_init(&it, &bt->m_bitmaps);
+  fdb_btree_iter_init(&it, &bt->m_containers);
   while(fdb_btree_iter_has_next(&it))
   {
     fdb_btree_entry_t entry = fdb_btree_iter_next(&it);
-    fdb_bitmap_release((fdb_bitmap_t*)entry.p_value, 
-                       &bt->m_bitmap_data_allocator.m_super);
-    mem_free(&bt->m_bitmap_allocator.m_super, 
-             entry.p_value);
+    fdb_bittable_container_t* c = (fdb_bittable_container_t*)entry.p_value;
+    if(c->m_type == E_FDB_BITTABLE_CONTAINER_BITSET)
+    {
+      fdb_bittable_container_release_bitset(bt, c);
+    }
+    fdb_pool_alloc_free(&bt->m_container_allocator, c);
   }
   fdb_btree_iter_release(&it);
   bt->m_size = 0;
-  fdb_btree_release(&bt->m_bitmaps);
-  fdb_pool_alloc_release(&bt->m_bitmap_data_allocator);
-  fdb_pool_alloc_release(&bt->m_bitmap_allocator);
+  fdb_btree_release(&bt->m_containers);
+  fdb_pool_alloc_release(&bt->m_chunk_allocator);
+  fdb_pool_alloc_release(&bt->m_view_allocator);
+  fdb_pool_alloc_release(&bt->m_container_allocator);
+}
+
+bool
+fdb_bittable_exists(const fdb_bittable_t* bt,
+                    entity_id_t id)
+{
+  const fdb_bittable_container_t* c = fdb_bittable_get_container(bt, id);
+  if(c == NULL)
+  {
+    return false;
+  }
+  return fdb_bittable_container_contains(c, id % FDB_BITTABLE_CONTAINER_BITS);
+}
+
+void
+fdb_bittable_cursor_init(fdb_bittable_cursor_t* cursor)
+{
+  cursor->m_key = FDB_INVALID_ID;
+  cursor->p_container = NULL;
 }
 
 bool
-fdb_bittable_exists(const fdb_bittable_t* bt, 
-                    entity_id_t id) 
+fdb_bittable_exists_cursor(const fdb_bittable_t* bt,
+                           entity_id_t id,
+                           fdb_bittable_cursor_t* cursor)
 {
-  uint32_t bitset_id = id / FDB_TABLE_BLOCK_SIZE;
-  fdb_bitmap_t* bitmap = (fdb_bitmap_t*)fdb_btree_get(&bt->m_bitmaps, bitset_id);
-  if(bitmap == NULL) 
+  uint32_t key = id / FDB_BITTABLE_CONTAINER_BITS;
+  if(key != cursor->m_key)
+  {
+    cursor->m_key = key;
+    cursor->p_container = fdb_bittable_get_container(bt, id);
+  }
+  if(cursor->p_container == NULL)
   {
     return false;
   }
-  return fdb_bitmap_is_set(bitmap, id % FDB_TABLE_BLOCK_SIZE);
+  return fdb_bittable_container_contains(cursor->p_container, id % FDB_BITTABLE_CONTAINER_BITS);
 }
 
 void
-fdb_bittable_add(fdb_bittable_t* bt, 
+fdb_bittable_add(fdb_bittable_t* bt,
                  entity_id_t id)
 {
-  uint32_t bitset_id = id / FDB_TABLE_BLOCK_SIZE;
-  fdb_bitmap_t* bitmap = (fdb_bitmap_t*)fdb_btree_get(&bt->m_bitmaps, bitset_id);
-  if(bitmap == NULL) 
+  fdb_bittable_container_t* c = fdb_bittable_get_or_create_container(bt, id / FDB_BITTABLE_CONTAINER_BITS);
+  uint32_t offset = id % FDB_BITTABLE_CONTAINER_BITS;
+  uint16_t* values = c->m_data.m_values;
+  switch(c->m_type)
+  {
+    case E_FDB_BITTABLE_CONTAINER_ARRAY:
+      {
+        uint32_t pos = fdb_bittable_array_lower_bound(values, c->m_count, offset);
+        if(pos < c->m_count && values[pos] == offset)
+        {
+          return;
+        }
+        if(c->m_count == FDB_BITTABLE_INLINE_CAPACITY)
+        {
+          fdb_bittable_container_repack(bt, c, offset, true);
+          return;
+        }
+        memmove(&values[pos+1], &values[pos], sizeof(uint16_t)*(c->m_count - pos));
+        values[pos] = offset;
+        c->m_count++;
+        break;
+      }
+    case E_FDB_BITTABLE_CONTAINER_RUN:
+      {
+        uint32_t pos = fdb_bittable_run_lower_bound(values, c->m_count, offset);
+        if(pos < c->m_count && values[2*pos] <= offset)
+        {
+          return;
+        }
+        bool extends_prev = pos > 0 && values[2*pos-1] + 1 == offset;
+        bool extends_next = pos < c->m_count && values[2*pos] == offset + 1;
+        if(extends_prev && extends_next)
+        {
+          values[2*pos-1] = values[2*pos+1];
+          memmove(&values[2*pos], &values[2*pos+2], sizeof(uint16_t)*2*(c->m_count - pos - 1));
+          c->m_count--;
+        }
+        else if(extends_prev)
+        {
+          values[2*pos-1] = offset;
+        }
+        else if(extends_next)
+        {
+          values[2*pos] = offset;
+        }
+        else if(c->m_count == FDB_BITTABLE_INLINE_RUNS)
+        {
+          fdb_bittable_container_repack(bt, c, offset, true);
+          return;
+        }
+        else
+        {
+          memmove(&values[2*pos+2], &values[2*pos], sizeof(uint16_t)*2*(c->m_count - pos));
+          values[2*pos] = offset;
+          values[2*pos+1] = offset;
+          c->m_count++;
+        }
+        break;
+      }
+    default:
+      {
+        uint64_t mask = 1ULL << (offset & 63);
+        if(c->m_data.m_bitset.p_words[offset >> 6] & mask)
+        {
+          return;
+        }
+        c->m_data.m_bitset.p_words[offset >> 6] |= mask;
+        break;
+      }
+  };
+  c->m_cardinality++;
+  bt->m_size++;
+}
+
+void
+fdb_bittable_remove(fdb_bittable_t* bt,
+                    entity_id_t id)
+{
+  fdb_bittable_container_t* c = fdb_bittable_get_container(bt, id);
+  if(c == NULL)
+  {
+    return;
+  }
+  uint32_t offset = id % FDB_BITTABLE_CONTAINER_BITS;
+  uint16_t* values = c->m_data.m_values;
+  switch(c->m_type)
+  {
+    case E_FDB_BITTABLE_CONTAINER_ARRAY:
+      {
+        uint32_t pos = fdb_bittable_array_lower_bound(values, c->m_count, offset);
+        if(pos == c->m_count || values[pos] != offset)
+        {
+          return;
+        }
+        memmove(&values[pos], &values[pos+1], sizeof(uint16_t)*(c->m_count - pos - 1));
+        c->m_count--;
+        break;
+      }
+    case E_FDB_BITTABLE_CONTAINER_RUN:
+      {
+        uint32_t pos = fdb_bittable_run_lower_bound(values, c->m_count, offset);
+        if(pos == c->m_count || values[2*pos] > offset)
+        {
+          return;
+        }
+        if(values[2*pos] == values[2*pos+1])
+        {
+          memmove(&values[2*pos], &values[2*pos+2], sizeof(uint16_t)*2*(c->m_count - pos - 1));
+          c->m_count--;
+        }
+        else if(values[2*pos] == offset)
+        {
+          values[2*pos]++;
+        }
+        else if(values[2*pos+1] == offset)
+        {
+          values[2*pos+1]--;
+        }
+        else if(c->m_count == FDB_BITTABLE_INLINE_RUNS)
+        {
+          fdb_bittable_container_repack(bt, c, offset, false);
+          return;
+        }
+        else
+        {
+          memmove(&values[2*pos+2], &values[2*pos], sizeof(uint16_t)*2*(c->m_count - pos));
+          values[2*pos+1] = offset - 1;
+          values[2*pos+2] = offset + 1;
+          c->m_count++;
+        }
+        break;
+      }
+    default:
+      {
+        uint64_t mask = 1ULL << (offset & 63);
+        if(!(c->m_data.m_bitset.p_words[offset >> 6] & mask))
+        {
+          return;
+        }
+        // Bitsets are packed again once they are well below the inline
+        // capacity, so adding and removing around it does not convert back and forth
+        if(c->m_cardinality - 1 <= FDB_BITTABLE_INLINE_CAPACITY / 2)
+        {
+          fdb_bittable_container_repack(bt, c, offset, false);
+          return;
+        }
+        c->m_data.m_bitset.p_words[offset >> 6] &= ~mask;
+        break;
+      }
+  };
+  c->m_cardinality--;
+  bt->m_size--;
+}
+
+const fdb_bitmap_t*
+fdb_bittable_get_bitmap(fdb_bittable_t* bt,
+                        entity_id_t id)
+{
+  fdb_bittable_container_t* c = fdb_bittable_get_container(bt, id);
+  if(c == NULL)
   {
-    bitmap = (fdb_bitmap_t*)mem_alloc(&bt->m_bitmap_allocator.m_super, 
-                                      FDB_BITMAP_ALIGNMENT, 
-                                      sizeof(fdb_bitmap_t), 
-                                      FDB_NO_HINT);
+    return NULL;
+  }
 
-    fdb_bitmap_init(bitmap, FDB_TABLE_BLOCK_SIZE, &bt->m_bitmap_data_allocator.m_super);
-    fdb_btree_insert(&bt->m_bitmaps, bitset_id, bitmap);
+  if(c->m_type != E_FDB_BITTABLE_CONTAINER_BITSET)
+  {
+    uint64_t words[FDB_BITTABLE_CONTAINER_WORDS] = {0};
+    fdb_bittable_container_or_words(c, words);
+    fdb_bittable_container_set_bitset(bt, c, words);
   }
-  FDB_ASSERT(bitmap->m_num_set <= FDB_TABLE_BLOCK_SIZE 
-             && "Bitmap num set out of bounds");
 
-  uint32_t offset = id % FDB_TABLE_BLOCK_SIZE;
-  if(!fdb_bitmap_is_set(bitmap,offset))
+  if(c->m_data.m_bitset.p_views == NULL)
   {
-    ++bt->m_size;
-    fdb_bitmap_set(bitmap,offset);
+    c->m_data.m_bitset.p_views = (fdb_bitmap_t*)fdb_pool_alloc_alloc(&bt->m_view_allocator,
+                                                                     FDB_BITTABLE_CHUNK_ALIGNMENT,
+                                                                     FDB_BITTABLE_VIEWS_SIZE,
+                                                                     FDB_NO_HINT);
+    for(uint32_t i = 0; i < FDB_BITTABLE_BLOCKS_PER_CONTAINER; ++i)
+    {
+      fdb_bitmap_t* view = &c->m_data.m_bitset.p_views[i];
+      view->m_max_bits = FDB_TABLE_BLOCK_SIZE;
+      view->p_data = &c->m_data.m_bitset.p_words[i*FDB_BITTABLE_BLOCK_WORDS];
+    }
   }
+
+  uint32_t block = (id % FDB_BITTABLE_CONTAINER_BITS) / FDB_TABLE_BLOCK_SIZE;
+  fdb_bitmap_t* view = &c->m_data.m_bitset.p_views[block];
+  fdb_bitmap_refresh_num_set(view);
+  return view;
 }
 
 void
-fdb_bittable_remove(fdb_bittable_t* bt, 
-                    entity_id_t id)
+fdb_bittable_block_and(const fdb_bittable_t* bt,
+                       entity_id_t start,
+                       fdb_bitmap_t* bitmap)
+{
+  FDB_ASSERT(bitmap->m_max_bits == FDB_TABLE_BLOCK_SIZE && "Bitmap is not a table block bitmap");
+  const fdb_bittable_container_t* c = fdb_bittable_get_container(bt, start);
+  if(c == NULL || c->m_cardinality == 0)
+  {
+    fdb_bitmap_nullify(bitmap);
+    return;
+  }
+  FDB_ALIGNED(uint64_t, words[FDB_BITTABLE_BLOCK_WORDS], FDB_BITMAP_ALIGNMENT);
+  fdb_bittable_container_block_words(c,
+                                     (start % FDB_BITTABLE_CONTAINER_BITS) / FDB_TABLE_BLOCK_SIZE,
+                                     words);
+  fdb_bitmap_t filter;
+  filter.m_max_bits = FDB_TABLE_BLOCK_SIZE;
+  filter.m_num_set = 0;
+  filter.p_data = words;
+  fdb_bitmap_set_and(bitmap, &filter);
+}
+
+void
+fdb_bittable_block_diff(const fdb_bittable_t* bt,
+                        entity_id_t start,
+                        fdb_bitmap_t* bitmap)
 {
-  uint32_t bitset_id = id / FDB_TABLE_BLOCK_SIZE;
-  fdb_bitmap_t* bitmap = fdb_bittable_get_bitset(bt, bitset_id);
-  if(bitmap == NULL) 
+  FDB_ASSERT(bitmap->m_max_bits == FDB_TABLE_BLOCK_SIZE && "Bitmap is not a table block bitmap");
+  const fdb_bittable_container_t* c = fdb_bittable_get_container(bt, start);
+  if(c == NULL || c->m_cardinality == 0)
   {
     return;
   }
-  uint32_t offset = id % FDB_TABLE_BLOCK_SIZE;
-  if(fdb_bitmap_is_set(bitmap,offset))
+  FDB_ALIGNED(uint64_t, words[FDB_BITTABLE_BLOCK_WORDS], FDB_BITMAP_ALIGNMENT);
+  fdb_bittable_container_block_words(c,
+                                     (start % FDB_BITTABLE_CONTAINER_BITS) / FDB_TABLE_BLOCK_SIZE,
+                                     words);
+  fdb_bitmap_t filter;
+  filter.m_max_bits = FDB_TABLE_BLOCK_SIZE;
+  filter.m_num_set = 0;
+  filter.p_data = words;
+  fdb_bitmap_set_diff(bitmap, &filter);
+}
+
+/**
+ * @brief Checks if any id of the given table block of a container is set
+ */
+static bool
+fdb_bittable_container_block_any(const fdb_bittable_container_t* c,
+                                 uint32_t block)
+{
+  if(c->m_cardinality == 0)
+  {
+    return false;
+  }
+  uint64_t words[FDB_BITTABLE_BLOCK_WORDS];
+  fdb_bittable_container_block_words(c,
+                                     block,
+                                     words);
+  uint64_t any = 0;
+  for(uint32_t i = 0; i < FDB_BITTABLE_BLOCK_WORDS; ++i)
   {
-    bt->m_size--;
-    fdb_bitmap_unset(bitmap,id % FDB_TABLE_BLOCK_SIZE);
+    any |= words[i];
   }
+  return any != 0;
 }
 
-const fdb_bitmap_t* 
-fdb_bittable_get_bitmap(const fdb_bittable_t* bt, 
-                        entity_id_t id)
+bool
+fdb_bittable_block_any(const fdb_bittable_t* bt,
+                       entity_id_t start)
+{
+  const fdb_bittable_container_t* c = fdb_bittable_get_container(bt, start);
+  return c != NULL && 
+         fdb_bittable_container_block_any(c, (start % FDB_BITTABLE_CONTAINER_BITS) / FDB_TABLE_BLOCK_SIZE);
+}
+
+void
+fdb_bittable_block_iter_init(fdb_bittable_block_iter_t* iter,
+                             const fdb_bittable_t* bt)
+{
+  fdb_btree_iter_init(&iter->m_it, &bt->m_containers);
+  iter->p_container = NULL;
+  iter->m_key = 0;
+  iter->m_block = 0;
+  iter->m_next = FDB_INVALID_ID;
+}
+
+void
+fdb_bittable_block_iter_release(fdb_bittable_block_iter_t* iter)
+{
+  fdb_btree_iter_release(&iter->m_it);
+}
+
+bool
+fdb_bittable_block_iter_has_next(fdb_bittable_block_iter_t* iter)
+{
+  const uint32_t num_blocks = FDB_BITTABLE_CONTAINER_BITS / FDB_TABLE_BLOCK_SIZE;
+  while(iter->m_next == FDB_INVALID_ID)
+  {
+    if(iter->p_container == NULL || 
+       iter->m_block == num_blocks)
+    {
+      if(!fdb_btree_iter_has_next(&iter->m_it))
+      {
+        break;
+      }
+      fdb_btree_entry_t entry = fdb_btree_iter_next(&iter->m_it);
+      iter->p_container = (const fdb_bittable_container_t*)entry.p_value;
+      iter->m_key = entry.m_key;
+      iter->m_block = 0;
+    }
+
+    if(fdb_bittable_container_block_any(iter->p_container, iter->m_block))
+    {
+      iter->m_next = iter->m_key*FDB_BITTABLE_CONTAINER_BITS + iter->m_block*FDB_TABLE_BLOCK_SIZE;
+    }
+    iter->m_block++;
+  }
+  return iter->m_next != FDB_INVALID_ID;
+}
+
+entity_id_t
+fdb_bittable_block_iter_next(fdb_bittable_block_iter_t* iter)
 {
-  uint32_t bitset_id = id / FDB_TABLE_BLOCK_SIZE;
-  fdb_bitmap_t* bitmap = fdb_bittable_get_bitset(bt, bitset_id);
-  return bitmap;
+  entity_id_t next = FDB_INVALID_ID;
+  if(fdb_bittable_block_iter_has_next(iter))
+  {
+    next = iter->m_next;
+    iter->m_next = FDB_INVALID_ID;
+  }
+  return next;
 }
 
 uint32_t
@@ -178,50 +805,92 @@ void
 fdb_bittable_clear(fdb_bittable_t* bt)
 {
   fdb_btree_iter_t it;
-  fdb_btree_iter_init(&it, &bt->m_bitmaps);
+  fdb_btree_iter_init(&it, &bt->m_containers);
   while(fdb_btree_iter_has_next(&it))
   {
     fdb_btree_entry_t entry = fdb_btree_iter_next(&it);
-    fdb_bitmap_nullify((fdb_bitmap_t*)entry.p_value);
+    fdb_bittable_container_t* c = (fdb_bittable_container_t*)entry.p_value;
+    if(c->m_type == E_FDB_BITTABLE_CONTAINER_BITSET)
+    {
+      fdb_bittable_container_release_bitset(bt, c);
+    }
+    c->m_type = E_FDB_BITTABLE_CONTAINER_ARRAY;
+    c->m_count = 0;
+    c->m_cardinality = 0;
   }
   fdb_btree_iter_release(&it);
   bt->m_size = 0;
 }
 
+void
+fdb_bittable_union(FDB_RESTRICT(fdb_bittable_t*) fst,
+                   FDB_RESTRICT(const fdb_bittable_t*) snd)
+{
+  fdb_bittable_union_partition(fst, snd, 0, 1);
+}
+
+void
+fdb_bittable_difference(FDB_RESTRICT(fdb_bittable_t*) fst, FDB_RESTRICT(const fdb_bittable_t*) snd)
+{
+  fdb_bittable_difference_partition(fst, snd, 0, 1);
+}
 
+uint32_t
+fdb_bittable_partition(entity_id_t id, 
+                       uint32_t num_partitions)
+{
+  return (id / FDB_BITTABLE_CONTAINER_BITS) % num_partitions;
+}
 
 void
-fdb_bittable_union(FDB_RESTRICT(fdb_bittable_t*) fst, 
-                   FDB_RESTRICT(const fdb_bittable_t*) snd)
+fdb_bittable_union_partition(FDB_RESTRICT(fdb_bittable_t*) fst,
+                             FDB_RESTRICT(const fdb_bittable_t*) snd,
+                             uint32_t partition,
+                             uint32_t num_partitions)
 {
   FDB_ASSERT( fst != snd && "Cannot call union the same BitTable");
   fdb_btree_iter_t it;
-  fdb_btree_iter_init(&it, &snd->m_bitmaps);
+  fdb_btree_iter_init(&it, &snd->m_containers);
   while(fdb_btree_iter_has_next(&it))
   {
     fdb_btree_entry_t entry = fdb_btree_iter_next(&it);
-    fdb_bittable_apply_bitset(fst, 
-                              entry.m_key, 
-                              (fdb_bitmap_t*)entry.p_value, 
-                              E_OR);
+    const fdb_bittable_container_t* src = (const fdb_bittable_container_t*)entry.p_value;
+    if(src->m_cardinality == 0 || entry.m_key % num_partitions != partition)
+    {
+      continue;
+    }
+    fdb_bittable_apply_container(fst,
+                                 fdb_bittable_get_or_create_container(fst, entry.m_key),
+                                 src,
+                                 E_OR);
   }
   fdb_btree_iter_release(&it);
 }
 
 void
-fdb_bittable_difference(FDB_RESTRICT(fdb_bittable_t*) fst, FDB_RESTRICT(const fdb_bittable_t*) snd)
+fdb_bittable_difference_partition(FDB_RESTRICT(fdb_bittable_t*) fst, 
+                                  FDB_RESTRICT(const fdb_bittable_t*) snd,
+                                  uint32_t partition,
+                                  uint32_t num_partitions)
 {
   FDB_ASSERT( fst != snd && "Cannot call difference the same BitTable");
   fdb_btree_iter_t it;
-  fdb_btree_iter_init(&it,&snd->m_bitmaps);
+  fdb_btree_iter_init(&it,&snd->m_containers);
   while(fdb_btree_iter_has_next(&it))
   {
     fdb_btree_entry_t entry = fdb_btree_iter_next(&it);
-    fdb_bittable_apply_bitset(fst, 
-                              entry.m_key, 
-                              (fdb_bitmap_t*)entry.p_value, 
-                              E_DIFF);
+    const fdb_bittable_container_t* src = (const fdb_bittable_container_t*)entry.p_value;
+    if(src->m_cardinality == 0 || entry.m_key % num_partitions != partition)
+    {
+      continue;
+    }
+    fdb_bittable_container_t* dst = (fdb_bittable_container_t*)fdb_btree_get(&fst->m_containers,
+                                                                             entry.m_key);
+    if(dst == NULL || dst->m_cardinality == 0)
+    {
+      continue;
+    }
+    fdb_bittable_apply_container(fst, dst, src, E_DIFF);
   }
   fdb_btree_iter_release(&it);
 }
-
@@ -20,14 +20,71 @@ typedef enum fdb_bittable_op_t
   E_DIFF
 } fdb_bittable_op_t;
 
+/**
+ * \brief The encodings of a bittable container. Each container covers
+ * FDB_BITTABLE_CONTAINER_BITS consecutive ids and picks the cheapest encoding
+ * for its contents: a sorted array of offsets when it is sparse, a list of
+ * [first,last] runs when it holds a few contiguous ranges, and a bitset
+ * otherwise. Arrays and runs are stored inline, so only bitsets need a chunk
+ * besides the container itself.
+ */
+typedef enum fdb_bittable_container_type_t
+{
+  E_FDB_BITTABLE_CONTAINER_ARRAY = 0,
+  E_FDB_BITTABLE_CONTAINER_RUN,
+  E_FDB_BITTABLE_CONTAINER_BITSET
+} fdb_bittable_container_type_t;
+
+typedef struct fdb_bittable_container_t
+{
+  uint16_t        m_type;         //< The fdb_bittable_container_type_t of the container
+  uint16_t        m_count;        //< Number of offsets (array) or runs (run) stored
+  uint32_t        m_cardinality;  //< Number of bits set in the container
+  union
+  {
+    uint16_t      m_values[FDB_BITTABLE_INLINE_CAPACITY]; //< Sorted offsets or [first,last] run pairs
+    struct
+    {
+      uint64_t*     p_words;      //< The words of the bitset
+      fdb_bitmap_t* p_views;      //< Per-block bitmaps over p_words, created by fdb_bittable_get_bitmap 
+    } m_bitset;
+  } m_data;
+} fdb_bittable_container_t;
+
 typedef struct fdb_bittable_t 
 {
-  fdb_btree_t           m_bitmaps;
-  uint32_t              m_size;
-  fdb_pool_alloc_t      m_bitmap_allocator;
-  fdb_pool_alloc_t      m_bitmap_data_allocator;
+  fdb_btree_t           m_containers;           //< btree with the containers, indexed by id / FDB_BITTABLE_CONTAINER_BITS
+  uint32_t              m_size;                 //< The number of bits set in the bittable
+  fdb_pool_alloc_t      m_container_allocator;  //< The allocator for the containers
+  fdb_pool_alloc_t      m_chunk_allocator;      //< The allocator for bitset words
+  fdb_pool_alloc_t      m_view_allocator;       //< The allocator for the block views of bitsets
 } fdb_bittable_t;
 
+/**
+ * \brief Cursor used to test many ids against a bittable. It remembers the
+ * last container looked up, so consecutive ids falling in the same container
+ * do not traverse the btree again.
+ */
+typedef struct fdb_bittable_cursor_t
+{
+  uint32_t                        m_key;          //< The key of the cached container
+  const fdb_bittable_container_t* p_container;    //< The cached container. NULL if it does not exist
+} fdb_bittable_cursor_t;
+
+/**
+ * \brief Iterator over the table blocks of a bittable with any id set. Blocks
+ * are returned in increasing order, and empty containers and blocks are
+ * skipped without touching the btree again.
+ */
+typedef struct fdb_bittable_block_iter_t
+{
+  fdb_btree_iter_t                m_it;           //< The iterator over the containers
+  const fdb_bittable_container_t* p_container;    //< The current container. NULL before the first one
+  uint32_t                        m_key;          //< The key of the current container
+  uint32_t                        m_block;        //< The next block of the current container to check
+  entity_id_t                     m_next;         //< The first id of the next block. FDB_INVALID_ID if not found yet
+} fdb_bittable_block_iter_t;
+
 /**
  * \brief inits a bittable
  *
@@ -61,6 +118,29 @@ bool
 fdb_bittable_exists(const fdb_bittable_t* bittable, 
                 entity_id_t id);
 
+/**
+ * \brief Initializes a cursor to test ids against a bittable 
+ *
+ * \param cursor The cursor to initialize
+ */
+void
+fdb_bittable_cursor_init(fdb_bittable_cursor_t* cursor);
+
+/**
+ * \brief Tests if an element exists in the bit table, reusing the container
+ * looked up by the previous call with the same cursor 
+ *
+ * \param bittable The bittable to check the existence of the entity
+ * \param id The id of the element to test
+ * \param cursor The cursor to use. It must not be shared between bittables
+ *
+ * \return Returns true if the element exists. false otherwise.
+ */
+bool
+fdb_bittable_exists_cursor(const fdb_bittable_t* bittable, 
+                           entity_id_t id,
+                           fdb_bittable_cursor_t* cursor);
+
 /**
  * \brief Adds an element to the bit table 
  *
@@ -81,18 +161,99 @@ void
 fdb_bittable_remove(fdb_bittable_t* bittable, entity_id_t id);
 
 /**
- * \brief Gets the bitmap of the bit table for a specific entity id.
+ * \brief Gets the bitmap of the bit table for the table block containing a
+ * specific entity id. The container of the block is converted to a bitset, so
+ * this modifies the bittable and cannot run concurrently with other
+ * operations on it. Filters should use fdb_bittable_block_and and
+ * fdb_bittable_block_diff instead.
  *
  * \param bittable The bittable to get the bitmap from
  * \param id The id of the entity to get the bitmap of 
  *
- * \return Returns a pointer to the bitmap. Returns nullptr if the bitmap does
- * not exist.
+ * \return Returns a pointer to the bitmap, valid until the bittable is
+ * modified. Returns nullptr if the bitmap does not exist.
  */
 const fdb_bitmap_t* 
-fdb_bittable_get_bitmap(const fdb_bittable_t* bittable,
+fdb_bittable_get_bitmap(fdb_bittable_t* bittable,
                     entity_id_t id) ;
 
+/**
+ * \brief Ands a table block bitmap with the bits of the bittable for the ids
+ * of that block
+ *
+ * \param bittable The bittable to and the bitmap with
+ * \param start The first id of the table block
+ * \param bitmap The bitmap of FDB_TABLE_BLOCK_SIZE bits to and
+ */
+void
+fdb_bittable_block_and(const fdb_bittable_t* bittable, 
+                       entity_id_t start,
+                       fdb_bitmap_t* bitmap);
+
+/**
+ * \brief Unsets from a table block bitmap the bits set in the bittable for the
+ * ids of that block
+ *
+ * \param bittable The bittable to diff the bitmap with
+ * \param start The first id of the table block
+ * \param bitmap The bitmap of FDB_TABLE_BLOCK_SIZE bits to diff
+ */
+void
+fdb_bittable_block_diff(const fdb_bittable_t* bittable, 
+                        entity_id_t start,
+                        fdb_bitmap_t* bitmap);
+
+/**
+ * \brief Tests if any id of a table block exists in the bittable 
+ *
+ * \param bittable The bittable to test
+ * \param start The first id of the table block
+ *
+ * \return True if any id in [start, start + FDB_TABLE_BLOCK_SIZE) exists
+ */
+bool
+fdb_bittable_block_any(const fdb_bittable_t* bittable, 
+                       entity_id_t start);
+
+/**
+ * \brief Inits an iterator over the table blocks of a bittable with any id
+ * set. The bittable must not be modified while it is iterated
+ *
+ * \param iter The iterator to init
+ * \param bittable The bittable to iterate
+ */
+void
+fdb_bittable_block_iter_init(fdb_bittable_block_iter_t* iter,
+                             const fdb_bittable_t* bittable);
+
+/**
+ * \brief Releases a block iterator of a bittable
+ *
+ * \param iter The iterator to release
+ */
+void
+fdb_bittable_block_iter_release(fdb_bittable_block_iter_t* iter);
+
+/**
+ * \brief Checks if there are more blocks to iterate
+ *
+ * \param iter The iterator to check
+ *
+ * \return True if there are more blocks with ids set
+ */
+bool
+fdb_bittable_block_iter_has_next(fdb_bittable_block_iter_t* iter);
+
+/**
+ * \brief Gets the next block with ids set
+ *
+ * \param iter The iterator to get the block from
+ *
+ * \return The first id of the next block. FDB_INVALID_ID if there are none
+ */
+entity_id_t
+fdb_bittable_block_iter_next(fdb_bittable_block_iter_t* iter);
+
 /**
  * \brief Gets the size of the bittable (number of bits set to 1)
  *
@@ -115,6 +276,50 @@ fdb_bittable_union(FDB_RESTRICT(fdb_bittable_t*) first, FDB_RESTRICT(const fdb_b
 void
 fdb_bittable_difference(FDB_RESTRICT(fdb_bittable_t*) first, FDB_RESTRICT(const fdb_bittable_t*) second);
 
+/**
+ * \brief Gets the partition an id belongs to when the ids of a set are split
+ * among num_partitions bittables. Ids are partitioned by container, so each
+ * partition can be merged without touching the containers of the others.
+ *
+ * \param id The id to get the partition of
+ * \param num_partitions The number of partitions
+ *
+ * \return The partition of the id, in [0, num_partitions)
+ */
+uint32_t
+fdb_bittable_partition(entity_id_t id, 
+                       uint32_t num_partitions);
+
+/**
+ * \brief Performs the union of the ids of the given partition of the second
+ * bittable into the first
+ *
+ * \param first The bittable to store the union to
+ * \param second The bittable to union with
+ * \param partition The partition to union
+ * \param num_partitions The number of partitions
+ */
+void
+fdb_bittable_union_partition(FDB_RESTRICT(fdb_bittable_t*) first, 
+                             FDB_RESTRICT(const fdb_bittable_t*) second,
+                             uint32_t partition,
+                             uint32_t num_partitions);
+
+/**
+ * \brief Removes from the first bittable the ids of the given partition of
+ * the second
+ *
+ * \param first The bittable to remove the ids from 
+ * \param second The bittable with the ids to remove
+ * \param partition The partition to remove
+ * \param num_partitions The number of partitions
+ */
+void
+fdb_bittable_difference_partition(FDB_RESTRICT(fdb_bittable_t*) first, 
+                                  FDB_RESTRICT(const fdb_bittable_t*) second,
+                                  uint32_t partition,
+                                  uint32_t num_partitions);
+
 #ifdef __cplusplus
 }
 #endif
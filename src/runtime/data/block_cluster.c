@@ -55,6 +55,45 @@ fdb_bcluster_append_block(fdb_bcluster_t* bc,
   fdb_bitmap_set_and(&bc->m_enabled, &block->m_enabled);
 }
 
+void 
+fdb_bcluster_append_blocks(fdb_bcluster_t* bc, 
+                           fdb_table_block_t** blocks, 
+                           uint32_t num_blocks)
+{
+  FDB_ASSERT(bc->m_num_columns + num_blocks <= FDB_MAX_CLUSTER_SIZE && "Cannot append blocks to full cluster");
+  if(num_blocks == 0)
+  {
+    return;
+  }
+
+  uint32_t first = 0;
+  if(bc->m_start == FDB_INVALID_BLOCK_START)
+  {
+    bc->m_start = blocks[0]->m_start;
+    first = 1;
+  }
+
+  for(uint32_t i = 0; i < num_blocks; ++i)
+  {
+    FDB_ASSERT(bc->m_start == blocks[i]->m_start && "Unaligned block cluster");
+    bc->p_blocks[bc->m_num_columns] = blocks[i];
+    bc->m_num_columns++;
+  }
+
+  uint64_t* dst_data = bc->m_enabled.p_data;
+  const uint32_t nwords = FDB_BITMAP_NUM_WORDS(bc->m_enabled.m_max_bits);
+  for(uint32_t w = 0; w < nwords; ++w)
+  {
+    uint64_t word = first == 0 ? dst_data[w] : blocks[0]->m_enabled.p_data[w];
+    for(uint32_t i = first; i < num_blocks; ++i)
+    {
+      word &= blocks[i]->m_enabled.p_data[w];
+    }
+    dst_data[w] = word;
+  }
+  fdb_bitmap_refresh_num_set(&bc->m_enabled);
+}
+
 void 
 fdb_bcluster_append_global(fdb_bcluster_t* bc, 
                            void* global)
@@ -58,6 +58,20 @@ void
 fdb_bcluster_append_block(fdb_bcluster_t* bc, 
                           fdb_table_block_t* block);
 
+/**
+ * \brief Appends a set of aligned table blocks to the block cluster. The
+ * enabled bitmaps of all the blocks are intersected in a single pass, instead of
+ * once per appended block
+ *
+ * \param bc The block cluster
+ * \param blocks The blocks to append, in column order
+ * \param num_blocks The number of blocks to append
+ */
+void 
+fdb_bcluster_append_blocks(fdb_bcluster_t* bc, 
+                           fdb_table_block_t** blocks, 
+                           uint32_t num_blocks);
+
 /**
  * \brief Appends a global to the block cluster
  *
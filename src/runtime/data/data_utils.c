@@ -5,14 +5,69 @@
 #include "../../common/platform.h"
 
 
+void
+gather_column_init(fdb_table_block_t* column, 
+                   fdb_mem_allocator_t* allocator)
+{
+  void* data = mem_alloc(allocator, 
+                         FDB_TABLE_BLOCK_DATA_ALIGNMENT, 
+                         sizeof(void*)*FDB_TABLE_BLOCK_SIZE, 
+                         FDB_NO_HINT);
+  fdb_table_block_init(column, 
+                       0, 
+                       sizeof(void*), 
+                       data, 
+                       allocator);
+}
+
+void
+gather_column_release(fdb_table_block_t* column, 
+                      fdb_mem_allocator_t* allocator)
+{
+  void* data = column->p_data;
+  fdb_table_block_release(column, allocator);
+  mem_free(allocator, data);
+}
+
+void
+gather_block_init(fdb_gather_block_t* gblock, 
+                  fdb_bcluster_t* ref_cluster,
+                  uint32_t num_columns,
+                  fdb_mem_allocator_t* allocator)
+{
+  fdb_bcluster_init(&gblock->m_refs, allocator);
+  fdb_bcluster_append_cluster(&gblock->m_refs, ref_cluster);
+  gblock->m_num_columns = num_columns;
+  gblock->p_columns = (fdb_table_block_t*)mem_alloc(allocator, 
+                                                    FDB_MIN_ALIGNMENT, 
+                                                    sizeof(fdb_table_block_t)*num_columns, 
+                                                    FDB_NO_HINT);
+  for(uint32_t i = 0; i < num_columns; ++i)
+  {
+    gather_column_init(&gblock->p_columns[i], allocator);
+  }
+}
+
+void
+gather_block_release(fdb_gather_block_t* gblock, 
+                     fdb_mem_allocator_t* allocator)
+{
+  for(uint32_t i = 0; i < gblock->m_num_columns; ++i)
+  {
+    gather_column_release(&gblock->p_columns[i], allocator);
+  }
+  mem_free(allocator, gblock->p_columns);
+  fdb_bcluster_release(&gblock->m_refs, allocator);
+}
+
 void
 copy_component_ptr(uint32_t chunk_size, 
                    uint32_t stride,
                    entity_id_t source,
                    entity_id_t target,
                    FDB_RESTRICT(fdb_btree_t*)* hash_tables, 
-                   FDB_RESTRICT(fdb_table_t*)* tables,
-                   uint32_t num_tables)
+                   FDB_RESTRICT(fdb_table_block_t*) columns,
+                   uint32_t num_columns)
 {
   uint32_t other_block_id = (target / FDB_TABLE_BLOCK_SIZE);
   uint32_t other_hash_table_index = block_get_offset(other_block_id, chunk_size, stride );
@@ -22,14 +77,20 @@ copy_component_ptr(uint32_t chunk_size,
   {
     if(fdb_bitmap_is_set(&cluster->m_enabled, target % FDB_TABLE_BLOCK_SIZE))
     {
-      for(uint32_t i = 0; i < num_tables; ++i)
+      uint32_t row = source % FDB_TABLE_BLOCK_SIZE;
+      for(uint32_t i = 0; i < num_columns; ++i)
       {
-        fdb_table_t* table_ptr = tables[i];
-        void* ptr = fdb_table_create_component(table_ptr, source);
+        fdb_table_block_t* column = &columns[i];
+        FDB_ASSERT(column->m_start == source - row && "Column of pointers is not aligned with the source block");
+        FDB_PERMA_ASSERT(fdb_bcluster_get_tblock(cluster,i)->p_soa == NULL && "Components of SoA tables cannot be referenced");
         size_t esize = fdb_bcluster_get_tblock(cluster,i)->m_esize;
         void* object = &(((char*)fdb_bcluster_get_tblock(cluster,i)->p_data)[(target%FDB_TABLE_BLOCK_SIZE)*esize]);
         FDB_ASSERT(object != NULL && "Pointer to component cannot be null");
-        *(size_t*)ptr = (size_t)object;
+        ((void**)column->p_data)[row] = object;
+        fdb_bitmap_set(&column->m_exists, row);
+        fdb_bitmap_set(&column->m_enabled, row);
+        column->m_num_components++;
+        column->m_num_enabled_components++;
       }
     }
   }
@@ -64,25 +125,47 @@ find_roots_and_blacklist(fdb_bcluster_t*  block_cluster,
 void
 filter_blacklists(FDB_RESTRICT(fdb_bittable_t*) partial_lists[],
                   uint32_t cpartial_lists,
-                  FDB_RESTRICT(fdb_bittable_t*) current_frontier)
+                  FDB_RESTRICT(fdb_bittable_t*) current_frontier,
+                  uint32_t partition,
+                  uint32_t num_partitions)
 {
   for(uint32_t i = 0; i < cpartial_lists; ++i)
   {
     FDB_RESTRICT(fdb_bittable_t*) partial_list = partial_lists[i];
-    fdb_bittable_difference(current_frontier, partial_list);
+    fdb_bittable_difference_partition(current_frontier, 
+                                      partial_list, 
+                                      partition, 
+                                      num_partitions);
   }
 }
 
 void
 frontiers_union(FDB_RESTRICT(fdb_bittable_t*) next_frontiers[],
                 uint32_t num_frontiers,
-                FDB_RESTRICT(fdb_bittable_t*) current_frontier)
+                FDB_RESTRICT(fdb_bittable_t*) current_frontier,
+                uint32_t partition,
+                uint32_t num_partitions)
 {
   for(uint32_t i = 0; i < num_frontiers; ++i)
   {
     FDB_RESTRICT(fdb_bittable_t*) partial_frontier = next_frontiers[i];
-    fdb_bittable_union(current_frontier, partial_frontier);
+    fdb_bittable_union_partition(current_frontier, 
+                                 partial_frontier, 
+                                 partition, 
+                                 num_partitions);
+  }
+}
+
+uint32_t
+frontiers_size(FDB_RESTRICT(fdb_bittable_t*) frontiers[],
+               uint32_t num_frontiers)
+{
+  uint32_t size = 0;
+  for(uint32_t i = 0; i < num_frontiers; ++i)
+  {
+    size += fdb_bittable_size(frontiers[i]);
   }
+  return size;
 }
 
 void
@@ -90,15 +173,17 @@ filter_bittable_exists(const fdb_bittable_t* bittable,
                        fdb_bcluster_t* block_cluster,
                        uint32_t column)
 {
-  for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+  const entity_id_t* ids = (const entity_id_t*)fdb_bcluster_get_tblock(block_cluster, column)->p_data;
+  fdb_bittable_cursor_t cursor;
+  fdb_bittable_cursor_init(&cursor);
+  fdb_bitmap_iter_t iter;
+  fdb_bitmap_iter_init(&iter, &block_cluster->m_enabled);
+  uint32_t i;
+  while(fdb_bitmap_iter_next(&iter, &i))
   {
-    if(fdb_bitmap_is_set(&block_cluster->m_enabled, i))
+    if(!fdb_bittable_exists_cursor(bittable, ids[i], &cursor))
     {
-      entity_id_t id = ((entity_id_t*)fdb_bcluster_get_tblock(block_cluster, column)->p_data)[i];
-      if(!fdb_bittable_exists(bittable, id))
-      {
-        fdb_bitmap_unset(&block_cluster->m_enabled, i);
-      }
+      fdb_bitmap_unset(&block_cluster->m_enabled, i);
     }
   }
 }
@@ -108,15 +193,17 @@ filter_bittable_not_exists(const fdb_bittable_t* bittable,
                            fdb_bcluster_t* block_cluster,
                            uint32_t column)
 {
-  for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+  const entity_id_t* ids = (const entity_id_t*)fdb_bcluster_get_tblock(block_cluster, column)->p_data;
+  fdb_bittable_cursor_t cursor;
+  fdb_bittable_cursor_init(&cursor);
+  fdb_bitmap_iter_t iter;
+  fdb_bitmap_iter_init(&iter, &block_cluster->m_enabled);
+  uint32_t i;
+  while(fdb_bitmap_iter_next(&iter, &i))
   {
-    if(fdb_bitmap_is_set(&block_cluster->m_enabled, i))
+    if(fdb_bittable_exists_cursor(bittable, ids[i], &cursor))
     {
-      entity_id_t id = ((entity_id_t*)fdb_bcluster_get_tblock(block_cluster, column)->p_data)[i];
-      if(fdb_bittable_exists(bittable, id))
-      {
-        fdb_bitmap_unset(&block_cluster->m_enabled, i);
-      }
+      fdb_bitmap_unset(&block_cluster->m_enabled, i);
     }
   }
 }
@@ -126,11 +213,21 @@ gather(fdb_bcluster_t* cluster,
        FDB_RESTRICT(fdb_btree_t*) hash_tables[],
        uint32_t   chunk_size, 
        uint32_t   stride,
-       FDB_RESTRICT(fdb_table_t*)*  tables, 
-       uint32_t   num_tables)
+       FDB_RESTRICT(fdb_table_block_t*) columns, 
+       uint32_t   num_columns)
 {
   FDB_ASSERT(cluster->m_num_columns == 1 && "Cluster passed to gather must have a single column of references");
 
+  for(uint32_t i = 0; i < num_columns; ++i)
+  {
+    fdb_table_block_t* column = &columns[i];
+    column->m_start = cluster->m_start;
+    column->m_num_components = 0;
+    column->m_num_enabled_components = 0;
+    fdb_bitmap_nullify(&column->m_exists);
+    fdb_bitmap_nullify(&column->m_enabled);
+  }
+
   const fdb_bitmap_t* enabled = &cluster->m_enabled;
   const entity_id_t* ref_data = (entity_id_t*)fdb_bcluster_get_tblock(cluster,0)->p_data;
   for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
@@ -144,51 +241,68 @@ gather(fdb_bcluster_t* cluster,
                          id, 
                          target, 
                          hash_tables, 
-                         tables,
-                         num_tables);
+                         columns,
+                         num_columns);
     }
   }
 }
 
 void
-build_fdb_bcluster_from_refs(FDB_RESTRICT(fdb_bcluster_t*) ref_cluster,  
-                              FDB_RESTRICT(const fdb_bittable_t*) current_frontier,
+build_fdb_bcluster_from_refs(FDB_RESTRICT(fdb_gather_block_t*) gblock,  
+                              FDB_RESTRICT(fdb_bittable_t*) current_frontiers[],
+                              uint32_t num_frontiers,
                               FDB_RESTRICT(fdb_bittable_t*) next_frontier,
-                              FDB_RESTRICT(fdb_bcluster_t*) cluster, 
-                              FDB_RESTRICT(fdb_table_t*)*  tables, 
-                              uint32_t   num_tables)
+                              FDB_RESTRICT(fdb_bcluster_t*) cluster)
 {
+  fdb_bcluster_t* ref_cluster = &gblock->m_refs;
   FDB_ASSERT(ref_cluster->m_num_columns == 1 && "The ref_cluster should contain a single column");
 
-  uint32_t block_id = ref_cluster->m_start / FDB_TABLE_BLOCK_SIZE;
-  for(uint32_t i = 0; i < num_tables; ++i)
+  for(uint32_t i = 0; i < gblock->m_num_columns; ++i)
   {
-    FDB_RESTRICT(fdb_table_block_t*) table_block_t = fdb_table_get_block(tables[i], block_id);
-    if(table_block_t != NULL)
-    {
-      fdb_bcluster_append_block(cluster, table_block_t);
-    }
+    fdb_bcluster_append_block(cluster, &gblock->p_columns[i]);
   }
-  FDB_ASSERT((cluster->m_num_columns == 0 || cluster->m_num_columns == num_tables) && "The block should eexist in all or in no tables");
 
-  if(cluster->m_num_columns > 0)
+  // The enabled rows of the cluster are those with gathered pointers, which
+  // are a subset of the enabled references. Every reference whose target is
+  // in the current frontier moves its tail to the next frontier, even if no
+  // pointers were gathered for it, so the traversal reaches its descendants
+  entity_id_t* data = (entity_id_t*)fdb_bcluster_get_tblock(ref_cluster,0)->p_data;
+  fdb_bitmap_iter_t iter;
+  fdb_bitmap_iter_init(&iter, &ref_cluster->m_enabled);
+  uint32_t i;
+  while(fdb_bitmap_iter_next(&iter, &i))
   {
-    entity_id_t* data = (entity_id_t*)fdb_bcluster_get_tblock(ref_cluster,0)->p_data;
-    fdb_bitmap_nullify(&cluster->m_enabled);
-    for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+    uint32_t source = i + ref_cluster->m_start;
+    entity_id_t target = data[i];
+    const fdb_bittable_t* current_frontier = current_frontiers[fdb_bittable_partition(target, num_frontiers)];
+    if(fdb_bittable_exists(current_frontier, target))
     {
-      uint32_t source = i + ref_cluster->m_start;
-      if(fdb_bitmap_is_set(&ref_cluster->m_enabled,i))
-      {
-        entity_id_t target = data[i];
-        if(fdb_bittable_exists(current_frontier, target))
-        {
-          fdb_bitmap_set(&cluster->m_enabled,i);
-          FDB_ASSERT(!fdb_bittable_exists(next_frontier, source) && "Source should not exist");
-          fdb_bittable_add(next_frontier, source);
-        }
-      }
+      FDB_ASSERT(!fdb_bittable_exists(next_frontier, source) && "Source should not exist");
+      fdb_bittable_add(next_frontier, source);
     }
+    else if(gblock->m_num_columns > 0)
+    {
+      fdb_bitmap_unset(&cluster->m_enabled,i);
+    }
+  }
+  return;
+}
+
+void
+build_fdb_bcluster_from_level(FDB_RESTRICT(fdb_gather_block_t*) gblock,  
+                              FDB_RESTRICT(const fdb_bittable_t*) level,
+                              FDB_RESTRICT(fdb_bcluster_t*) cluster)
+{
+  FDB_ASSERT(gblock->m_refs.m_num_columns == 1 && "The ref_cluster should contain a single column");
+
+  for(uint32_t i = 0; i < gblock->m_num_columns; ++i)
+  {
+    fdb_bcluster_append_block(cluster, &gblock->p_columns[i]);
+  }
+
+  if(gblock->m_num_columns > 0)
+  {
+    fdb_bittable_block_and(level, gblock->m_refs.m_start, &cluster->m_enabled);
   }
   return;
 }
@@ -5,22 +5,88 @@
 
 #include "../../common/btree.h"
 #include "table.h"
+#include "block_cluster.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef struct fdb_bcluster_t fdb_bcluster_t;
 typedef struct fdb_bittable_t fdb_bittable_t;
 
 /**
- * \brief Copies the ptr to the given component to the table at the given
- * id.
+ * \brief A block of references together with the columns of pointers to the
+ * components gathered through them. Used by the cascading gather to keep the
+ * gathered pointers of a block across levels
+ */
+typedef struct fdb_gather_block_t
+{
+  fdb_bcluster_t      m_refs;           //< The cluster with the column of references
+  fdb_table_block_t*  p_columns;        //< The columns of pointers to the referenced components
+  uint32_t            m_num_columns;    //< The number of columns of pointers
+} fdb_gather_block_t;
+
+/**
+ * \brief Initializes a table block to be used as a column of pointers to
+ * gathered components. Both the pointers and the bitmaps of the column are
+ * taken from the given allocator, which is meant to be the task's stack
+ * allocator, so the column lives until the end of the task and is not
+ * backed by any table
+ *
+ * \param column The column to initialize
+ * \param allocator The allocator to take the memory of the column from
+ */
+void
+gather_column_init(fdb_table_block_t* column, 
+                   fdb_mem_allocator_t* allocator);
+
+/**
+ * \brief Releases a column of pointers to gathered components
+ *
+ * \param column The column to release
+ * \param allocator The allocator the column was initialized with
+ */
+void
+gather_column_release(fdb_table_block_t* column, 
+                      fdb_mem_allocator_t* allocator);
+
+/**
+ * \brief Initializes a gather block with a copy of the given cluster of
+ * references and num_columns empty columns of pointers
+ *
+ * \param gblock The gather block to initialize
+ * \param ref_cluster The cluster with the column of references
+ * \param num_columns The number of columns of pointers
+ * \param allocator The allocator to take the memory of the block from
+ */
+void
+gather_block_init(fdb_gather_block_t* gblock, 
+                  fdb_bcluster_t* ref_cluster,
+                  uint32_t num_columns,
+                  fdb_mem_allocator_t* allocator);
+
+/**
+ * \brief Releases a gather block
  *
- * @tparam TComponent
- * \param table_view The view of the temporal table
- * \param id The id of the element to copy the component to
- * \param component The component to be copied
+ * \param gblock The gather block to release
+ * \param allocator The allocator the block was initialized with
+ */
+void
+gather_block_release(fdb_gather_block_t* gblock, 
+                     fdb_mem_allocator_t* allocator);
+
+/**
+ * \brief Copies the pointers to the components of the target entity to the row
+ * of the source entity in the given columns. Nothing is copied if the target
+ * is not found in the hash tables
+ *
+ * \param chunk_size The chunk_size (used to compute which hash_table to
+ * reference)
+ * \param stride The stride (used to compute which hash_table to reference)
+ * \param source The entity to copy the pointers to
+ * \param target The entity whose components are pointed to
+ * \param hash_tables An array with the different hash_tables
+ * \param columns The columns of pointers, aligned to the block of the source
+ * \param num_columns The number of columns
  */
 void
 copy_component_ptr(uint32_t chunk_size, 
@@ -28,8 +94,8 @@ copy_component_ptr(uint32_t chunk_size,
                    entity_id_t source,
                    entity_id_t target,
                    FDB_RESTRICT(fdb_btree_t*)* hash_tables, 
-                   FDB_RESTRICT(fdb_table_t*)* tables,
-                   uint32_t num_tables);
+                   FDB_RESTRICT(fdb_table_block_t*) columns,
+                   uint32_t num_columns);
 
 
 /**
@@ -47,67 +113,104 @@ find_roots_and_blacklist(fdb_bcluster_t* block_cluster,
 
 /**
  * \brief Filters the contents of a frontier by the partial black lists in the
- * array
+ * array. Only the ids in the given partition of the black lists are filtered 
  *
  * \param partial_lists The array of partial blacklists
  * \param current_frontier The current frontier
+ * \param partition The partition of the ids (see fdb_bittable_partition) to filter
+ * \param num_partitions The number of partitions 
  */
 void
 filter_blacklists(FDB_RESTRICT(fdb_bittable_t*) partial_lists[],
                   uint32_t cpartial_lists,
-                  FDB_RESTRICT(fdb_bittable_t*) current_frontier);
+                  FDB_RESTRICT(fdb_bittable_t*) current_frontier,
+                  uint32_t partition,
+                  uint32_t num_partitions);
 
 /**
- * \brief Performs the union of a set of frontiers into a destinaion one
+ * \brief Performs the union of a set of frontiers into a destinaion one. Only
+ * the ids in the given partition of the frontiers are merged, so that each
+ * thread merges its own share of the next frontier
  *
  * \param partial_lists The array of next frontiers 
  * \param current_frontier The destination frontier
+ * \param partition The partition of the ids (see fdb_bittable_partition) to merge
+ * \param num_partitions The number of partitions 
  */
 void
 frontiers_union(FDB_RESTRICT(fdb_bittable_t*) next_frontiers[],
                 uint32_t num_frontiers,
-                FDB_RESTRICT(fdb_bittable_t*) current_frontier);
+                FDB_RESTRICT(fdb_bittable_t*) current_frontier,
+                uint32_t partition,
+                uint32_t num_partitions);
+
+/**
+ * \brief Gets the number of entities in a frontier split in partitions
+ *
+ * \param frontiers The array with the partitions of the frontier
+ * \param num_frontiers The number of partitions
+ *
+ * \return The number of entities in the frontier
+ */
+uint32_t
+frontiers_size(FDB_RESTRICT(fdb_bittable_t*) frontiers[],
+               uint32_t num_frontiers);
 
 
 /**
- * \brief Given a set of reference groups and a components block, performs the
- * gather operation of this block into the given table view. This operation
- * assumes that the given cluster contains a single column of references
+ * \brief Given a cluster with a single column of references, gathers the
+ * pointers to the components referenced by each of its rows into the given
+ * columns. The columns are reset and aligned to the block of the cluster, and
+ * only the rows whose target was found are enabled
  *
- * \tparam TComponent The componnet type to gather
  * \param cluster The cluster with the references  
  * \param hash_tables An array with the different hash_tables
  * \param chunk_size The chunk_size (used to compute which hash_table to
  * reference)
  * \param stride The stride (used to compute which hash_table to reference)
- * \param table_view The temporal tables to store the references to the components
+ * \param columns The columns of pointers to gather to (see gather_column_init)
+ * \param num_columns The number of columns 
  */
 void
 gather(fdb_bcluster_t* cluster,
        FDB_RESTRICT(fdb_btree_t*) hash_tables[],
        uint32_t   chunk_size, 
        uint32_t   stride,
-       FDB_RESTRICT(fdb_table_t*)*  tables, 
-       uint32_t   num_tables);
+       FDB_RESTRICT(fdb_table_block_t*) columns, 
+       uint32_t   num_columns);
 
 /**
- * \brief Builds a block cluster by fetching the blocks with the given start id 
- * from the given tables
+ * \brief Builds a block cluster with the gathered columns of a gather block,
+ * enabling only those rows whose reference target is in the current frontier.
+ * The tails of those references are added to the next frontier
  *
- * @tparam typename...TComponents The components of the tables
- * \param ref_cluster The cluster of references 
- * \param current_frontier The current frontier
+ * \param gblock The gather block with the references and gathered columns
+ * \param current_frontiers The partitions of the current frontier, indexed by
+ * fdb_bittable_partition
+ * \param num_frontiers The number of partitions of the current frontier
  * \param next_frontier The next frontier
  * \param cluster The cluster to append to blocks to
- * \param ...table_views The tables to fetch the blocks from
  */
 void
-build_fdb_bcluster_from_refs(FDB_RESTRICT(fdb_bcluster_t*) ref_cluster,  
-                              FDB_RESTRICT(const fdb_bittable_t*) current_frontier,
+build_fdb_bcluster_from_refs(FDB_RESTRICT(fdb_gather_block_t*) gblock,  
+                              FDB_RESTRICT(fdb_bittable_t*) current_frontiers[],
+                              uint32_t num_frontiers,
                               FDB_RESTRICT(fdb_bittable_t*) next_frontier,
-                              FDB_RESTRICT(fdb_bcluster_t*) cluster, 
-                              FDB_RESTRICT(fdb_table_t*)*  tables, 
-                              uint32_t   num_tables);
+                              FDB_RESTRICT(fdb_bcluster_t*) cluster);
+
+/**
+ * \brief Builds a block cluster with the gathered columns of a gather block,
+ * enabling only those rows whose reference tail is in the given level of the
+ * hierarchy index of the reference table
+ *
+ * \param gblock The gather block with the references and gathered columns
+ * \param level The level of the hierarchy index to expand
+ * \param cluster The cluster to append to blocks to
+ */
+void
+build_fdb_bcluster_from_level(FDB_RESTRICT(fdb_gather_block_t*) gblock,  
+                              FDB_RESTRICT(const fdb_bittable_t*) level,
+                              FDB_RESTRICT(fdb_bcluster_t*) cluster);
 
 /**
  * \brief This operation assumes that the "column" column in the block cluster
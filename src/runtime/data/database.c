@@ -8,6 +8,7 @@
 #include "database.h"
 #include "webserver/webserver.h"
 
+#include <stdio.h>
 #include <string.h>
 
 void
@@ -26,6 +27,8 @@ fdb_database_init(fdb_database_t* db, fdb_mem_allocator_t* allocator)
     db->p_page_allocator = fdb_get_global_mem_allocator();
   }
 
+  db->m_frame = 0;
+
   // Initializing allocators
   fdb_pool_alloc_init(&db->m_table_allocator, 
                       FDB_DATABASE_TABLE_ALIGNMENT, 
@@ -33,6 +36,12 @@ fdb_database_init(fdb_database_t* db, fdb_mem_allocator_t* allocator)
                       FDB_DATABASE_TABLE_PAGE_SIZE, 
                       db->p_page_allocator);
 
+  fdb_pool_alloc_init(&db->m_reftable_allocator, 
+                      FDB_DATABASE_TABLE_ALIGNMENT, 
+                      sizeof(fdb_reftable_t), 
+                      FDB_DATABASE_REFTABLE_PAGE_SIZE, 
+                      db->p_page_allocator);
+
   fdb_pool_alloc_init(&db->m_bittable_allocator, 
                         FDB_DATABASE_BITTABLE_ALIGNMENT, 
                         sizeof(fdb_bittable_t), 
@@ -71,6 +80,7 @@ fdb_database_release(fdb_database_t* db)
   // releaseing allocators
   fdb_stack_alloc_release(&db->m_global_allocator);
   fdb_pool_alloc_release(&db->m_bittable_allocator);
+  fdb_pool_alloc_release(&db->m_reftable_allocator);
   fdb_pool_alloc_release(&db->m_table_allocator);
 }
 
@@ -114,7 +124,7 @@ void fdb_database_clear(fdb_database_t* db)
     fdb_btree_entry_t entry = fdb_btree_iter_next(&it_references);
     fdb_reftable_t* table =  (fdb_reftable_t*)entry.p_value;
     fdb_reftable_release(table);
-    fdb_pool_alloc_free(&db->m_table_allocator, table);
+    fdb_pool_alloc_free(&db->m_reftable_allocator, table);
   }
   fdb_btree_iter_release(&it_references);
   fdb_btree_clear(&db->m_references);
@@ -332,7 +342,7 @@ fdb_database_find_or_create_reftable(fdb_database_t* db,
   if (table_ptr == NULL) 
   {
 
-    table_ptr = (fdb_reftable_t*)fdb_pool_alloc_alloc(&db->m_table_allocator, 
+    table_ptr = (fdb_reftable_t*)fdb_pool_alloc_alloc(&db->m_reftable_allocator, 
                                                       FDB_DATABASE_TABLE_ALIGNMENT, 
                                                       sizeof(fdb_reftable_t), 
                                                       FDB_NO_HINT);;
@@ -369,7 +379,7 @@ fdb_database_create_reftable(fdb_database_t* db,
   fdb_reftable_t* table_ptr = (fdb_reftable_t*)fdb_btree_get(&db->m_references, hash_value);
   if (table_ptr == NULL) 
   {
-    table_ptr = (fdb_reftable_t*)fdb_pool_alloc_alloc(&db->m_table_allocator, 
+    table_ptr = (fdb_reftable_t*)fdb_pool_alloc_alloc(&db->m_reftable_allocator, 
                                                       FDB_DATABASE_TABLE_ALIGNMENT, 
                                                       sizeof(fdb_reftable_t), 
                                                       FDB_NO_HINT);;
@@ -402,6 +412,13 @@ fdb_database_stop_webserver(fdb_database_t* db)
   fdb_webserver_stop(&db->m_webserver);
 }
 
+void
+fdb_database_set_webserver_profiler(fdb_database_t* db, 
+                                    struct fdb_profiler_t* profiler)
+{
+  fdb_webserver_set_profiler(&db->m_webserver, profiler);
+}
+
 size_t
 fdb_database_num_tables(fdb_database_t* db)
 {
@@ -424,14 +441,45 @@ fdb_database_metadata(fdb_database_t* db,
   {
     fdb_btree_entry_t entry = fdb_btree_iter_next(&it_tables);
     fdb_table_t* table = (fdb_table_t*)entry.p_value;
-    memcpy(&data[0], &table->m_name[0], sizeof(char)*FDB_MAX_TABLE_NAME);
+    memcpy(&data[count].m_name[0], &table->m_name[0], sizeof(char)*FDB_MAX_TABLE_NAME);
     data[count].m_size = fdb_table_size(table);
+    data[count].m_num_blocks = fdb_table_num_blocks(table);
     count++;
   }
+  fdb_btree_iter_release(&it_tables);
   fdb_database_unlock(db);
   return count;
 }
 
+bool
+fdb_database_export_stats(fdb_database_t* db, 
+                          const char* path)
+{
+  FILE* fd = fopen(path, "w");
+  if(fd == NULL)
+  {
+    return false;
+  }
+
+  fprintf(fd, "# table num_components num_blocks\n");
+  fdb_database_lock(db);
+  fdb_btree_iter_t it_tables;
+  fdb_btree_iter_init(&it_tables, &db->m_tables);
+  while(fdb_btree_iter_has_next(&it_tables))
+  {
+    fdb_btree_entry_t entry = fdb_btree_iter_next(&it_tables);
+    fdb_table_t* table = (fdb_table_t*)entry.p_value;
+    fprintf(fd, 
+            "%s %zu %zu\n", 
+            table->m_name, 
+            fdb_table_size(table), 
+            fdb_table_num_blocks(table));
+  }
+  fdb_btree_iter_release(&it_tables);
+  fdb_database_unlock(db);
+  return fclose(fd) == 0;
+}
+
 void
 fdb_database_lock(fdb_database_t* db) 
 {
@@ -560,3 +608,16 @@ fdb_database_get_mregistry(fdb_database_t* fdb_database)
   return &fdb_database->m_mregistry;
 }
 
+bool
+fdb_database_set_table_layout(fdb_database_t* db, 
+                              const char* name, 
+                              fdb_table_layout_t layout)
+{
+  fdb_database_lock(db);
+  fdb_table_t* table = (fdb_table_t*)fdb_btree_get(&db->m_tables, get_table_id(name));
+  fdb_mstruct_t* mstruct = fdb_mregistry_get_mstruct(&db->m_mregistry, name);
+  bool res = table != NULL && fdb_table_set_layout(table, layout, mstruct);
+  fdb_database_unlock(db);
+  return res;
+}
+
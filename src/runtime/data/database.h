@@ -10,6 +10,7 @@
 #include "../../common/memory/stack_allocator.h"
 #include "../../common/memory/pool_allocator.h"
 #include "reflection.h"
+#include "table.h"
 #include "webserver/webserver.h"
 
 #include <assert.h>
@@ -27,6 +28,7 @@ typedef struct fdb_table_info_t
 {
   char        m_name[FDB_MAX_TABLE_NAME];
   uint32_t    m_size;
+  uint32_t    m_num_blocks;
 } fdb_table_info_t;
 
 typedef void (*frs_dstr_t)(void*) ;
@@ -58,9 +60,11 @@ typedef struct fdb_database_t
   fdb_webserver_t               m_webserver;          //< The db web server
   fdb_mregistry_t               m_mregistry;          //< The metadata registry
   fdb_mutex_t                   m_mutex;              //< The mutex to exclusive access to the db
+  uint32_t                      m_frame;              //< The current frame, starting at 1. Used to timestamp the changes of the components
 
   fdb_mem_allocator_t*          p_page_allocator;     //< Allocator used to allocate pages for the rest of allocators
-  fdb_pool_alloc_t              m_table_allocator;    //< Allocator for tables, temporal tables and reference tables
+  fdb_pool_alloc_t              m_table_allocator;    //< Allocator for tables and temporal tables
+  fdb_pool_alloc_t              m_reftable_allocator; //< Allocator for reference tables
   fdb_pool_alloc_t              m_bittable_allocator; //< Allocator for bittables
   fdb_stack_alloc_t             m_global_allocator;   //< Allocator for globals
 } fdb_database_t;
@@ -240,6 +244,13 @@ fdb_database_start_webserver(fdb_database_t* db,
 void
 fdb_database_stop_webserver(fdb_database_t* db);
 
+/**
+ * \brief Sets the profiler whose trace is served by the web server at /trace
+ */
+void
+fdb_database_set_webserver_profiler(fdb_database_t* db, 
+                                    struct fdb_profiler_t* profiler);
+
 /**
  * \brief locks the db for insertions and removal of tables
  */
@@ -265,6 +276,21 @@ fdb_database_metadata(fdb_database_t* db,
                       fdb_table_info_t* data, 
                       uint32_t capacity);
 
+/**
+ * \brief Exports the statistics of the tables in the db to a file, which fcc
+ * can use to optimize the execution plans (see fcc's -s option). Each line of
+ * the file contains the name of a table, its number of components and its
+ * number of blocks
+ *
+ * \param db The db to export the statistics of
+ * \param path The path of the file to write the statistics to
+ *
+ * \return True if the statistics were successfully written
+ */
+bool
+fdb_database_export_stats(fdb_database_t* db, 
+                          const char* path);
+
 /**
  * \brief Returns the number of tables in the db
  *
@@ -353,6 +379,23 @@ fdb_database_find_or_create_global(fdb_database_t* db,
 fdb_mregistry_t*
 fdb_database_get_mregistry(fdb_database_t* db);
 
+/**
+ * \brief Sets the layout of the given table, using the reflection data
+ * registered in the db for the component with the same name. The table must
+ * be empty.
+ *
+ * \param db The db containing the table
+ * \param name The name of the table
+ * \param layout The layout to set
+ *
+ * \return True if the layout was set. False if the table does not exist or
+ * its components cannot be stored with the given layout
+ */
+bool
+fdb_database_set_table_layout(fdb_database_t* db, 
+                              const char* name, 
+                              fdb_table_layout_t layout);
+
 
 uint32_t
 get_table_id(const char* table_name);
@@ -46,6 +46,11 @@ struct Component \
                                 sizeof(component),\
                                 dstr)
 
+#define FDB_SET_TABLE_LAYOUT(database, component, layout)\
+  fdb_database_set_table_layout(database,\
+                                #component,\
+                                layout)
+
 #define FDB_CREATE_GLOBAL(database, component, dstr) \
   (component*)fdb_database_create_global(database,\
                                      #component,\
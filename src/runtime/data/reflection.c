@@ -113,3 +113,23 @@ fdb_mregistry_get_mstruct(fdb_mregistry_t* reg,
   return mstruct;
 }
 
+bool
+fdb_mstruct_is_soa_compatible(const fdb_mstruct_t* mstruct)
+{
+  if(mstruct->m_is_union || mstruct->m_nfields == 0)
+  {
+    return false;
+  }
+
+  for(uint32_t i = 0; i < mstruct->m_nfields; ++i)
+  {
+    const fdb_mfield_t* field = mstruct->p_fields[i];
+    if(field->m_anonymous || 
+       field->m_type == E_STD_STRING || 
+       field->m_type == E_UNKNOWN)
+    {
+      return false;
+    }
+  }
+  return true;
+}
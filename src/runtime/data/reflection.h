@@ -142,6 +142,18 @@ fdb_mstruct_t*
 fdb_mregistry_get_mstruct(fdb_mregistry_t* reg, 
                           const char* name);
 
+/**
+ * \brief Checks if the components described by an mstruct can be stored in
+ * a structure-of-arrays table. This requires a struct (not a union) whose
+ * top-level fields are all named and can be copied bytewise.
+ *
+ * \param mstruct The mstruct to check
+ *
+ * \return True if the mstruct is compatible with a SoA layout. False otherwise
+ */
+bool
+fdb_mstruct_is_soa_compatible(const fdb_mstruct_t* mstruct);
+
 #ifdef __cplusplus
 }
 #endif
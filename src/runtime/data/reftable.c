@@ -1,19 +1,202 @@
 
 
 #include "reftable.h"
+#include "../../common/memory/pool_allocator.h"
 
+/**
+ * @brief Gets the bittable of a level of the hierarchy, creating it if it
+ * does not exist
+ */
+static fdb_bittable_t*
+fdb_reftable_hierarchy_level(fdb_reftable_t* rt,
+                             uint32_t depth)
+{
+  fdb_reftable_hierarchy_t* hierarchy = &rt->m_hierarchy;
+  fdb_bittable_t* level = (fdb_bittable_t*)fdb_btree_get(&hierarchy->m_levels, depth);
+  if(level == NULL)
+  {
+    level = (fdb_bittable_t*)fdb_pool_alloc_alloc(&hierarchy->m_level_allocator,
+                                                  FDB_REFTABLE_LEVEL_ALIGNMENT,
+                                                  sizeof(fdb_bittable_t),
+                                                  FDB_NO_HINT);
+    fdb_bittable_init(level, rt->p_allocator);
+    fdb_btree_insert(&hierarchy->m_levels, depth, level);
+  }
+  return level;
+}
+
+/**
+ * @brief Gets the node of an entity in the hierarchy, creating it as a root
+ * if it does not exist
+ */
+static fdb_reftable_node_t*
+fdb_reftable_hierarchy_node(fdb_reftable_t* rt,
+                            entity_id_t id)
+{
+  fdb_reftable_node_t* node = (fdb_reftable_node_t*)fdb_table_get_component(&rt->m_hierarchy.m_nodes, id);
+  if(node == NULL)
+  {
+    node = (fdb_reftable_node_t*)fdb_table_create_component(&rt->m_hierarchy.m_nodes, id);
+    node->m_parent = FDB_INVALID_ID;
+    node->m_first_child = FDB_INVALID_ID;
+    node->m_next_sibling = FDB_INVALID_ID;
+    node->m_prev_sibling = FDB_INVALID_ID;
+    node->m_depth = 0;
+    fdb_bittable_add(fdb_reftable_hierarchy_level(rt, 0), id);
+  }
+  return node;
+}
+
+/**
+ * @brief Removes an entity from the hierarchy if it no longer takes part in
+ * any reference
+ */
+static void
+fdb_reftable_hierarchy_prune(fdb_reftable_t* rt,
+                             entity_id_t id)
+{
+  fdb_reftable_node_t* node = (fdb_reftable_node_t*)fdb_table_get_component(&rt->m_hierarchy.m_nodes, id);
+  if(node->m_parent != FDB_INVALID_ID || node->m_first_child != FDB_INVALID_ID)
+  {
+    return;
+  }
+  fdb_bittable_remove(fdb_reftable_hierarchy_level(rt, node->m_depth), id);
+  fdb_table_destroy_component(&rt->m_hierarchy.m_nodes, id);
+}
 
+/**
+ * @brief Checks if an entity is an ancestor of another in the hierarchy, or
+ * the entity itself. Linking an entity under one of its descendants would
+ * close a cycle
+ */
+static bool
+fdb_reftable_hierarchy_is_ancestor(fdb_reftable_t* rt,
+                                   entity_id_t ancestor,
+                                   entity_id_t id)
+{
+  fdb_table_t* nodes = &rt->m_hierarchy.m_nodes;
+  while(id != FDB_INVALID_ID)
+  {
+    if(id == ancestor)
+    {
+      return true;
+    }
+    const fdb_reftable_node_t* node = (const fdb_reftable_node_t*)fdb_table_get_component(nodes, id);
+    id = node != NULL ? node->m_parent : FDB_INVALID_ID;
+  }
+  return false;
+}
+
+/**
+ * @brief Sets the depth of an entity and updates the depths of its subtree.
+ * The subtree is walked through the parent and sibling links, so no stack is
+ * needed regardless of its depth
+ */
+static void
+fdb_reftable_hierarchy_set_depth(fdb_reftable_t* rt,
+                                 entity_id_t root,
+                                 uint32_t depth)
+{
+  fdb_table_t* nodes = &rt->m_hierarchy.m_nodes;
+  entity_id_t next = root;
+  while(next != FDB_INVALID_ID)
+  {
+    fdb_reftable_node_t* node = (fdb_reftable_node_t*)fdb_table_get_component(nodes, next);
+    if(node->m_depth != depth)
+    {
+      fdb_bittable_remove(fdb_reftable_hierarchy_level(rt, node->m_depth), next);
+      fdb_bittable_add(fdb_reftable_hierarchy_level(rt, depth), next);
+      node->m_depth = depth;
+    }
+
+    if(node->m_first_child != FDB_INVALID_ID)
+    {
+      // A subtree deeper than the number of nodes can only be a cycle, which
+      // would be walked forever
+      FDB_PERMA_ASSERT(depth < nodes->m_num_components && "The references of a hierarchy must form a forest");
+      next = node->m_first_child;
+      depth++;
+      continue;
+    }
+
+    while(next != root && node->m_next_sibling == FDB_INVALID_ID)
+    {
+      next = node->m_parent;
+      node = (fdb_reftable_node_t*)fdb_table_get_component(nodes, next);
+      depth--;
+    }
+    next = next == root ? FDB_INVALID_ID : node->m_next_sibling;
+  }
+}
+
+/**
+ * @brief Unlinks an entity from its parent in the hierarchy, making it the
+ * root of its subtree
+ */
+static void
+fdb_reftable_hierarchy_unlink(fdb_reftable_t* rt,
+                              entity_id_t tail)
+{
+  fdb_table_t* nodes = &rt->m_hierarchy.m_nodes;
+  fdb_reftable_node_t* node = (fdb_reftable_node_t*)fdb_table_get_component(nodes, tail);
+  entity_id_t head = node->m_parent;
+  if(node->m_prev_sibling != FDB_INVALID_ID)
+  {
+    ((fdb_reftable_node_t*)fdb_table_get_component(nodes, node->m_prev_sibling))->m_next_sibling = node->m_next_sibling;
+  }
+  else
+  {
+    ((fdb_reftable_node_t*)fdb_table_get_component(nodes, head))->m_first_child = node->m_next_sibling;
+  }
+  if(node->m_next_sibling != FDB_INVALID_ID)
+  {
+    ((fdb_reftable_node_t*)fdb_table_get_component(nodes, node->m_next_sibling))->m_prev_sibling = node->m_prev_sibling;
+  }
+  node->m_parent = FDB_INVALID_ID;
+  node->m_next_sibling = FDB_INVALID_ID;
+  node->m_prev_sibling = FDB_INVALID_ID;
+  fdb_reftable_hierarchy_set_depth(rt, tail, 0);
+  fdb_reftable_hierarchy_prune(rt, head);
+  fdb_reftable_hierarchy_prune(rt, tail);
+}
+
+/**
+ * @brief Links an entity as a child of another in the hierarchy. The link
+ * must not close a cycle (see fdb_reftable_hierarchy_is_ancestor)
+ */
+static void
+fdb_reftable_hierarchy_link(fdb_reftable_t* rt,
+                            entity_id_t tail,
+                            entity_id_t head)
+{
+  fdb_table_t* nodes = &rt->m_hierarchy.m_nodes;
+  fdb_reftable_node_t* head_node = fdb_reftable_hierarchy_node(rt, head);
+  fdb_reftable_node_t* tail_node = fdb_reftable_hierarchy_node(rt, tail);
+  FDB_ASSERT(tail_node->m_parent == FDB_INVALID_ID && "The tail is already linked");
+
+  tail_node->m_parent = head;
+  tail_node->m_prev_sibling = FDB_INVALID_ID;
+  tail_node->m_next_sibling = head_node->m_first_child;
+  if(head_node->m_first_child != FDB_INVALID_ID)
+  {
+    ((fdb_reftable_node_t*)fdb_table_get_component(nodes, head_node->m_first_child))->m_prev_sibling = tail;
+  }
+  head_node->m_first_child = tail;
+  fdb_reftable_hierarchy_set_depth(rt, tail, head_node->m_depth + 1);
+}
 
 void
-fdb_reftable_init(fdb_reftable_t* rt, 
-                  const char* rname, 
-                  uint32_t id, 
+fdb_reftable_init(fdb_reftable_t* rt,
+                  const char* rname,
+                  uint32_t id,
                   fdb_mem_allocator_t* allocator)
 {
-  fdb_table_init(&rt->m_table, 
-                 rname, 
-                 id, 
+  fdb_table_init(&rt->m_table,
+                 rname,
+                 id,
                  sizeof(entity_id_t), NULL, allocator);
+  rt->m_track_hierarchy = false;
+  rt->p_allocator = allocator;
 }
 
 /**
@@ -24,43 +207,158 @@ fdb_reftable_init(fdb_reftable_t* rt,
 void
 fdb_reftable_release(fdb_reftable_t* rt)
 {
+  if(rt->m_track_hierarchy)
+  {
+    fdb_reftable_hierarchy_t* hierarchy = &rt->m_hierarchy;
+    fdb_btree_iter_t it;
+    fdb_btree_iter_init(&it, &hierarchy->m_levels);
+    while(fdb_btree_iter_has_next(&it))
+    {
+      fdb_btree_entry_t entry = fdb_btree_iter_next(&it);
+      fdb_bittable_release((fdb_bittable_t*)entry.p_value);
+      fdb_pool_alloc_free(&hierarchy->m_level_allocator, entry.p_value);
+    }
+    fdb_btree_iter_release(&it);
+    fdb_btree_release(&hierarchy->m_levels);
+    fdb_pool_alloc_release(&hierarchy->m_level_allocator);
+    fdb_table_release(&hierarchy->m_nodes);
+    rt->m_track_hierarchy = false;
+  }
   fdb_table_release(&rt->m_table);
 }
-  
-void
-fdb_reftable_add(fdb_reftable_t* rt, 
-              entity_id_t tail, 
+
+bool
+fdb_reftable_add(fdb_reftable_t* rt,
+              entity_id_t tail,
               entity_id_t head)
 {
-  entity_id_t* phead = (entity_id_t*)fdb_table_create_component(&rt->m_table, 
+  if(rt->m_track_hierarchy && 
+     fdb_reftable_hierarchy_is_ancestor(rt, tail, head))
+  {
+    return false;
+  }
+
+  entity_id_t* phead = (entity_id_t*)fdb_table_get_component(&rt->m_table,
+                                                             tail);
+  if(rt->m_track_hierarchy && phead != NULL)
+  {
+    fdb_reftable_hierarchy_unlink(rt, tail);
+  }
+  phead = (entity_id_t*)fdb_table_create_component(&rt->m_table,
                                                            tail);
   *phead = head;
+  if(rt->m_track_hierarchy)
+  {
+    fdb_reftable_hierarchy_link(rt, tail, head);
+  }
+  return true;
 }
 
 entity_id_t*
-fdb_reftable_get(fdb_reftable_t* rt, 
+fdb_reftable_get(fdb_reftable_t* rt,
               entity_id_t tail)
 {
   return (entity_id_t*) (entity_id_t*)fdb_table_get_component(&rt->m_table,
-                                                          tail); 
+                                                          tail);
 }
 
 void
-fdb_reftable_remove(fdb_reftable_t* rt, 
-                 entity_id_t tail, 
+fdb_reftable_remove(fdb_reftable_t* rt,
+                 entity_id_t tail,
                  entity_id_t head)
 {
-  fdb_table_destroy_component(&rt->m_table, 
+  if(rt->m_track_hierarchy &&
+     fdb_table_get_component(&rt->m_table, tail) != NULL)
+  {
+    fdb_reftable_hierarchy_unlink(rt, tail);
+  }
+  fdb_table_destroy_component(&rt->m_table,
                           tail);
 }
 
 bool
-fdb_reftable_exists(fdb_reftable_t* rt, 
-                 entity_id_t tail, 
+fdb_reftable_exists(fdb_reftable_t* rt,
+                 entity_id_t tail,
                  entity_id_t head)
 {
-  entity_id_t* phead = (entity_id_t*)fdb_table_get_component(&rt->m_table, 
+  entity_id_t* phead = (entity_id_t*)fdb_table_get_component(&rt->m_table,
                                                          tail);
   return phead != NULL && *phead == head;
 }
 
+void
+fdb_reftable_track_hierarchy(fdb_reftable_t* rt)
+{
+  if(rt->m_track_hierarchy)
+  {
+    return;
+  }
+
+  fdb_reftable_hierarchy_t* hierarchy = &rt->m_hierarchy;
+  fdb_table_init(&hierarchy->m_nodes,
+                 rt->m_table.m_name,
+                 rt->m_table.m_id,
+                 sizeof(fdb_reftable_node_t),
+                 NULL,
+                 rt->p_allocator);
+  fdb_btree_init(&hierarchy->m_levels, rt->p_allocator);
+  fdb_pool_alloc_init(&hierarchy->m_level_allocator,
+                      FDB_REFTABLE_LEVEL_ALIGNMENT,
+                      sizeof(fdb_bittable_t),
+                      FDB_REFTABLE_LEVEL_PAGE_SIZE,
+                      rt->p_allocator);
+  rt->m_track_hierarchy = true;
+
+  fdb_table_iter_t iter;
+  fdb_table_iter_init(&iter, &rt->m_table, 1, 0, 1);
+  while(fdb_table_iter_has_next(&iter))
+  {
+    fdb_table_block_t* block = fdb_table_iter_next(&iter);
+    const entity_id_t* heads = (const entity_id_t*)block->p_data;
+    fdb_bitmap_iter_t bit_iter;
+    fdb_bitmap_iter_init(&bit_iter, &block->m_enabled);
+    uint32_t i;
+    while(fdb_bitmap_iter_next(&bit_iter, &i))
+    {
+      // References closing a cycle are left out of the index, so their tails
+      // stay as roots
+      if(!fdb_reftable_hierarchy_is_ancestor(rt, block->m_start + i, heads[i]))
+      {
+        fdb_reftable_hierarchy_link(rt, block->m_start + i, heads[i]);
+      }
+    }
+  }
+  fdb_table_iter_release(&iter);
+}
+
+bool
+fdb_reftable_has_hierarchy(const fdb_reftable_t* rt)
+{
+  return rt->m_track_hierarchy;
+}
+
+const fdb_bittable_t*
+fdb_reftable_get_level(const fdb_reftable_t* rt,
+                       uint32_t depth)
+{
+  FDB_ASSERT(rt->m_track_hierarchy && "The reference table does not maintain a hierarchy index");
+  const fdb_bittable_t* level = (const fdb_bittable_t*)fdb_btree_get(&rt->m_hierarchy.m_levels, depth);
+  if(level == NULL || fdb_bittable_size(level) == 0)
+  {
+    return NULL;
+  }
+  return level;
+}
+
+uint32_t
+fdb_reftable_get_depth(fdb_reftable_t* rt,
+                       entity_id_t id)
+{
+  FDB_ASSERT(rt->m_track_hierarchy && "The reference table does not maintain a hierarchy index");
+  const fdb_reftable_node_t* node = (const fdb_reftable_node_t*)fdb_table_get_component(&rt->m_hierarchy.m_nodes, id);
+  if(node == NULL)
+  {
+    return FDB_INVALID_ID;
+  }
+  return node->m_depth;
+}
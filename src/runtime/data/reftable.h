@@ -5,14 +5,50 @@
 
 #include "../../common/types.h"
 #include "table.h"
+#include "bittable.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * \brief Node of an entity in the hierarchy index of a reference table. The
+ * children of an entity are linked through their sibling ids.
+ */
+typedef struct fdb_reftable_node_t
+{
+  entity_id_t m_parent;         //< The head of the reference of the entity. FDB_INVALID_ID for roots
+  entity_id_t m_first_child;    //< The first tail referencing the entity. FDB_INVALID_ID if none
+  entity_id_t m_next_sibling;   //< The next tail referencing the parent. FDB_INVALID_ID if none
+  entity_id_t m_prev_sibling;   //< The previous tail referencing the parent. FDB_INVALID_ID if none
+  uint32_t    m_depth;          //< The distance from the entity to its root
+} fdb_reftable_node_t;
+
+/**
+ * \brief Hierarchy index of a reference table. It holds the entities taking
+ * part in references (either as tail or as head) grouped by depth: level 0
+ * holds the roots, and level d holds the tails whose heads are at level d-1.
+ * Traversals can then visit the hierarchy level by level, without computing
+ * roots and frontiers.
+ *
+ * Levels are kept as sets of ids rather than as a copy of the references in
+ * breadth-first order, so moving a subtree only updates the levels of its
+ * entities. Traversals find the blocks of a level through its bittable and
+ * still read the references from the blocks of the reference table.
+ */
+typedef struct fdb_reftable_hierarchy_t
+{
+  fdb_table_t       m_nodes;            //< The nodes of the entities in the hierarchy
+  fdb_btree_t       m_levels;           //< btree with the bittable of each level, indexed by depth
+  fdb_pool_alloc_t  m_level_allocator;  //< The allocator for the level bittables
+} fdb_reftable_hierarchy_t;
+
 typedef struct fdb_reftable_t
 {
-  fdb_table_t m_table;
+  fdb_table_t               m_table;
+  bool                      m_track_hierarchy;  //< Whether the hierarchy index is maintained
+  fdb_reftable_hierarchy_t  m_hierarchy;        //< The hierarchy index. Only valid if m_track_hierarchy
+  fdb_mem_allocator_t*      p_allocator;        //< The allocator of the reference table
 } fdb_reftable_t;
 
 
@@ -39,13 +75,16 @@ void
 fdb_reftable_release(fdb_reftable_t* rt);
 
 /**
- * \brief Adds a reference to reftable
+ * \brief Adds a reference to reftable. If the reference table maintains a
+ * hierarchy index, references that would close a cycle are rejected
  *
  * \param rt The reference table 
  * \param tail The tail of the reference
  * \param head The head of the reference
+ *
+ * \return True if the reference was added. False if it was rejected
  */
-void
+bool
 fdb_reftable_add(fdb_reftable_t* rt,
                  entity_id_t tail, 
                  entity_id_t head);
@@ -85,6 +124,53 @@ bool
 fdb_reftable_exists(fdb_reftable_t* rt, 
                     entity_id_t tail, 
                     entity_id_t head);
+
+/**
+ * \brief Starts maintaining the hierarchy index of the reference table. The
+ * index is built from the current references and updated on every add and
+ * remove afterwards. References must form a forest: existing references that
+ * close a cycle are left out of the index, and new ones are rejected.
+ *
+ * \param rt The reference table 
+ */
+void
+fdb_reftable_track_hierarchy(fdb_reftable_t* rt);
+
+/**
+ * \brief Checks if the reference table maintains a hierarchy index 
+ *
+ * \param rt The reference table 
+ *
+ * \return True if the hierarchy index is maintained
+ */
+bool
+fdb_reftable_has_hierarchy(const fdb_reftable_t* rt);
+
+/**
+ * \brief Gets the entities at the given depth of the hierarchy index
+ *
+ * \param rt The reference table. It must maintain a hierarchy index
+ * \param depth The depth of the level
+ *
+ * \return The bittable with the entities of the level. NULL if there are no
+ * entities at that depth
+ */
+const fdb_bittable_t*
+fdb_reftable_get_level(const fdb_reftable_t* rt, 
+                       uint32_t depth);
+
+/**
+ * \brief Gets the depth of an entity in the hierarchy index
+ *
+ * \param rt The reference table. It must maintain a hierarchy index
+ * \param id The entity
+ *
+ * \return The depth of the entity. FDB_INVALID_ID if the entity is not part of
+ * any reference
+ */
+uint32_t
+fdb_reftable_get_depth(fdb_reftable_t* rt, 
+                       entity_id_t id);
 #ifdef __cplusplus
 }
 #endif
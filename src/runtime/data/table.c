@@ -5,6 +5,7 @@
 #include "../../common/memory/pool_allocator.h"
 #include "../../common/platform.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -36,6 +37,142 @@ decode_id(entity_id_t id)
   return did;
 }
 
+/**
+ * @brief Finds the block with the given id in the segments of a table, even
+ * if it does not contain components 
+ *
+ * @param table The table to find the block in
+ * @param block_id The id of the block
+ *
+ * @return The block, or NULL if its segment does not exist
+ */
+static fdb_table_block_t*
+fdb_table_find_block(fdb_table_t* table, 
+                     uint32_t block_id)
+{
+  uint32_t segment_id = block_id >> table->m_segment_shift;
+  fdb_table_block_t* segment = NULL;
+  if(segment_id < FDB_TABLE_DIRECTORY_FANOUT*FDB_TABLE_DIRECTORY_FANOUT)
+  {
+    if(table->p_directory == NULL)
+    {
+      return NULL;
+    }
+    fdb_table_block_t** node = table->p_directory[segment_id / FDB_TABLE_DIRECTORY_FANOUT];
+    if(node == NULL)
+    {
+      return NULL;
+    }
+    segment = node[segment_id % FDB_TABLE_DIRECTORY_FANOUT];
+  }
+  else
+  {
+    segment = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, segment_id);
+  }
+
+  if(segment == NULL)
+  {
+    return NULL;
+  }
+  return &segment[block_id & (table->m_segment_size - 1)];
+}
+
+/**
+ * @brief Allocates a zeroed node of the segment directory
+ */
+static void*
+fdb_table_directory_node_alloc(fdb_table_t* table)
+{
+  void* node = fdb_pool_alloc_alloc(&table->m_directory_allocator, 
+                                    FDB_TABLE_DIRECTORY_ALIGNMENT, 
+                                    sizeof(void*)*FDB_TABLE_DIRECTORY_FANOUT, 
+                                    FDB_NO_HINT);
+  memset(node, 0, sizeof(void*)*FDB_TABLE_DIRECTORY_FANOUT);
+  return node;
+}
+
+/**
+ * @brief Inserts a segment into the table, indexing it in the directory if its
+ * id falls into the directory range
+ *
+ * @param table The table to insert the segment to
+ * @param segment_id The id of the segment
+ * @param segment The segment to insert
+ */
+static void
+fdb_table_insert_segment(fdb_table_t* table, 
+                         uint32_t segment_id, 
+                         fdb_table_block_t* segment)
+{
+  fdb_btree_insert(&table->m_blocks, 
+                   segment_id,
+                   segment);
+
+  if(segment_id >= FDB_TABLE_DIRECTORY_FANOUT*FDB_TABLE_DIRECTORY_FANOUT)
+  {
+    return;
+  }
+
+  if(table->p_directory == NULL)
+  {
+    table->p_directory = (fdb_table_block_t***)fdb_table_directory_node_alloc(table);
+  }
+
+  fdb_table_block_t*** node = &table->p_directory[segment_id / FDB_TABLE_DIRECTORY_FANOUT];
+  if(*node == NULL)
+  {
+    *node = (fdb_table_block_t**)fdb_table_directory_node_alloc(table);
+  }
+  (*node)[segment_id % FDB_TABLE_DIRECTORY_FANOUT] = segment;
+}
+
+/**
+ * @brief Computes the page size of a pool allocator for the given element
+ * size, so that at most a quarter of each page is lost to the pool header 
+ */
+static uint32_t
+fdb_table_pool_page_size(size_t element_size, 
+                         uint32_t min_page_size)
+{
+  uint32_t page_size = min_page_size;
+  while(page_size < 4*element_size)
+  {
+    page_size *= 2;
+  }
+  return page_size;
+}
+
+/**
+ * @brief Copies a component of a block into the given buffer, gathering its
+ * fields from the columns of SoA blocks
+ *
+ * @param block The block of the component
+ * @param offset The offset of the component in the block
+ * @param data The buffer to copy the component to, of m_esize bytes
+ */
+static void
+fdb_table_block_copy_component(const fdb_table_block_t* block, 
+                               uint32_t offset, 
+                               void* data)
+{
+  if(block->p_soa == NULL)
+  {
+    memcpy(data, 
+           &(((const char*)block->p_data)[offset*block->m_esize]), 
+           block->m_esize);
+    return;
+  }
+
+  const fdb_table_soa_t* soa = block->p_soa;
+  for(uint32_t i = 0; i < soa->m_num_columns; ++i)
+  {
+    const char* column = &((const char*)block->p_data)[soa->m_offsets[i]*FDB_TABLE_BLOCK_SIZE];
+    memcpy(&((char*)data)[soa->m_offsets[i]], 
+           &column[offset*soa->m_sizes[i]], 
+           soa->m_sizes[i]);
+  }
+}
+
 /**
  * @brief Tests if a given block contains the given component enabled
  *
@@ -49,30 +186,29 @@ fdb_table_block_has_component(const fdb_table_block_t* block,
                  entity_id_t id) 
 {
   assert(id != FDB_INVALID_ID);
-  bool res =  fdb_table_block_get_component(block, id).p_data != NULL;
-  return res;
+  assert(block->m_start == (id / FDB_TABLE_BLOCK_SIZE) * FDB_TABLE_BLOCK_SIZE) ;
+  return fdb_bitmap_is_set(&block->m_enabled, id % FDB_TABLE_BLOCK_SIZE);
 }
 
 void
 fdb_table_block_init(fdb_table_block_t* tblock, 
                      entity_id_t start, 
                      size_t esize, 
-                     fdb_mem_allocator_t* data_allocator, 
+                     void* data, 
                      fdb_mem_allocator_t* bitmap_allocator)
 {
-  FDB_ASSERT(data_allocator != NULL && "Allocator cannot be null");
-  FDB_ASSERT((data_allocator->p_mem_alloc != NULL && data_allocator->p_mem_free != NULL) &&
-                 "Provided allocator is ill-formed.")
-
   FDB_ASSERT(bitmap_allocator != NULL && "Allocator cannot be null");
   FDB_ASSERT((bitmap_allocator->p_mem_alloc != NULL && bitmap_allocator->p_mem_free != NULL) &&
                  "Provided allocator is ill-formed.")
 
-  tblock->p_data = mem_alloc(data_allocator, 64, esize*FDB_TABLE_BLOCK_SIZE, start / FDB_TABLE_BLOCK_SIZE);
+  tblock->p_data = data;
   tblock->m_start = start;
   tblock->m_num_components = 0;
   tblock->m_num_enabled_components = 0;
   tblock->m_esize = esize;
+  tblock->p_soa = NULL;
+  tblock->p_changed = NULL;
+  tblock->m_changed_frame = 0;
   fdb_bitmap_init(&tblock->m_exists, 
                   FDB_TABLE_BLOCK_SIZE, bitmap_allocator);
   fdb_bitmap_init(&tblock->m_enabled, 
@@ -82,22 +218,64 @@ fdb_table_block_init(fdb_table_block_t* tblock,
 
 void
 fdb_table_block_release(fdb_table_block_t* tblock, 
-                    fdb_mem_allocator_t* data_allocator, 
                     fdb_mem_allocator_t* bitmap_allocator)
 {
-
-  FDB_ASSERT(data_allocator != NULL && "Allocator cannot be null");
-  FDB_ASSERT((data_allocator->p_mem_alloc != NULL && data_allocator->p_mem_free != NULL) &&
-                 "Provided allocator is ill-formed.")
-
   FDB_ASSERT(bitmap_allocator != NULL && "Allocator cannot be null");
   FDB_ASSERT((bitmap_allocator->p_mem_alloc != NULL && bitmap_allocator->p_mem_free != NULL) &&
                  "Provided allocator is ill-formed.")
 
   fdb_bitmap_release(&tblock->m_enabled, bitmap_allocator);
   fdb_bitmap_release(&tblock->m_exists, bitmap_allocator);
-  mem_free(data_allocator, 
-           tblock->p_data);
+  tblock->p_data = NULL;
+}
+
+void
+fdb_table_block_filter_changed(const fdb_table_block_t* block, 
+                               fdb_bitmap_t* enabled,
+                               uint32_t since,
+                               uint32_t frame)
+{
+  if(!fdb_table_block_has_changes(block, since))
+  {
+    fdb_bitmap_nullify(enabled);
+    return;
+  }
+
+  // Changes of the current frame are left for the next run, since the
+  // writers running after the filter in this frame have not made theirs yet
+  fdb_bitmap_iter_t iter;
+  fdb_bitmap_iter_init(&iter, enabled);
+  uint32_t i;
+  while(fdb_bitmap_iter_next(&iter, &i))
+  {
+    if(block->p_changed[i] < since || block->p_changed[i] >= frame)
+    {
+      fdb_bitmap_unset(enabled, i);
+    }
+  }
+}
+
+void
+fdb_table_changed_filter_init(fdb_table_changed_filter_t* filter)
+{
+  filter->m_runs = 0;
+}
+
+uint32_t
+fdb_table_changed_filter_begin(fdb_table_changed_filter_t* filter, 
+                               uint32_t frame)
+{
+  // The first thread of a run moves the frame of the last run to the previous
+  // one. The others find the current frame already set
+  uint64_t runs = filter->m_runs;
+  while((uint32_t)(runs >> 32) != frame)
+  {
+    const uint64_t next = ((uint64_t)frame << 32) | (runs >> 32);
+    const uint64_t old = __sync_val_compare_and_swap(&filter->m_runs, runs, next);
+    runs = old == runs ? next : old;
+  }
+  const uint32_t since = (uint32_t)runs;
+  return since > 0 ? since : 1;
 }
 
 /**
@@ -120,7 +298,7 @@ fdb_table_block_get_component(const fdb_table_block_t* block,
   if(fdb_bitmap_is_set(&block->m_enabled, decoded_id.m_block_offset)) 
   {
     entry.m_id = block->m_start + decoded_id.m_block_offset;
-    entry.p_data = &(((char*)block->p_data)[decoded_id.m_block_offset*block->m_esize]);
+    entry.p_data = block->p_soa == NULL ? &(((char*)block->p_data)[decoded_id.m_block_offset*block->m_esize]) : NULL;
     entry.m_enabled = fdb_bitmap_is_set(&block->m_enabled, decoded_id.m_block_offset);
   }
   else
@@ -138,12 +316,7 @@ fdb_tblock_iter_init(fdb_tblock_iter_t* tblock_iter,
   tblock_iter->p_block = tblock;
   tblock_iter->m_next_position = 0;
   if(tblock_iter->p_block != NULL) {
-    while(tblock_iter->m_next_position < FDB_TABLE_BLOCK_SIZE && 
-          !fdb_table_block_has_component(tblock_iter->p_block, 
-                                         tblock_iter->p_block->m_start+tblock_iter->m_next_position) ) 
-    {
-      tblock_iter->m_next_position++;
-    }
+    tblock_iter->m_next_position = fdb_bitmap_next_set(&tblock_iter->p_block->m_enabled, 0);
   }
 }
 
@@ -165,13 +338,8 @@ fdb_tblock_iter_next(fdb_tblock_iter_t* tblock_iter)
   fdb_table_entry_t fdb_table_entry = fdb_table_block_get_component(tblock_iter->p_block, 
                                                         tblock_iter->p_block->m_start + 
                                                         tblock_iter->m_next_position);
-  tblock_iter->m_next_position++; 
-  while(tblock_iter->m_next_position < FDB_TABLE_BLOCK_SIZE && 
-        !fdb_table_block_has_component(tblock_iter->p_block, 
-                       tblock_iter->p_block->m_start+tblock_iter->m_next_position)) 
-  {
-    tblock_iter->m_next_position++;
-  }
+  tblock_iter->m_next_position = fdb_bitmap_next_set(&tblock_iter->p_block->m_enabled, 
+                                                     tblock_iter->m_next_position + 1);
   return fdb_table_entry;
 }
 
@@ -194,15 +362,48 @@ fdb_table_iter_init(fdb_table_iter_t* iter,
 {
   iter->p_blocks = &table->m_blocks;
   fdb_btree_iter_init(&iter->m_it, iter->p_blocks);
+  iter->m_segment_size = table->m_segment_size;
+  iter->p_segment = NULL;
+  iter->m_segment_id = 0;
+  iter->m_segment_next = 0;
   iter->m_chunk_size = chunk_size;
   iter->m_offset = offset;
   iter->m_stride = stride;
   iter->m_next = NULL;
+  iter->p_morsel = NULL;
+  iter->m_morsel_size = 0;
+  iter->m_position = 0;
+  iter->m_claim_begin = 0;
+  iter->m_claim_end = 0;
+}
+
+void
+fdb_table_iter_init_morsel(fdb_table_iter_t* iter, 
+                           fdb_table_t* table,
+                           fdb_table_morsel_t* morsel,
+                           uint32_t morsel_size,
+                           uint32_t stride)
+{
+  FDB_ASSERT(morsel_size > 0 && "Morsel size must be greater than zero");
+  fdb_table_iter_init(iter, table, 1, 0, stride);
+  iter->p_morsel = morsel;
+  iter->m_morsel_size = morsel_size;
 }
 
 void
 fdb_table_iter_release(fdb_table_iter_t* iter)
 {
+  fdb_btree_iter_release(&iter->m_it);
+  if(iter->p_morsel != NULL)
+  {
+    // The last iterator of the stream resets the shared cursor
+    if(__sync_add_and_fetch(&iter->p_morsel->m_num_done, 1) == iter->m_stride)
+    {
+      iter->p_morsel->m_next = 0;
+      fdb_mem_barrier();
+      iter->p_morsel->m_num_done = 0;
+    }
+  }
 }
 
 static bool
@@ -215,55 +416,441 @@ is_selected(uint32_t chunk_id,
   return ((((chunk_id / chunk_size) + (stride - offset))) % stride) == 0;
 }
 
+static bool
+is_claimed(fdb_table_iter_t* iter, 
+           uint32_t position)
+{
+  if(position >= iter->m_claim_end)
+  {
+    // Claims are monotonically increasing, so positions between our last
+    // claim and the new one have been taken by other iterators
+    iter->m_claim_begin = __sync_fetch_and_add(&iter->p_morsel->m_next, 
+                                               iter->m_morsel_size);
+    iter->m_claim_end = iter->m_claim_begin + iter->m_morsel_size;
+  }
+  return position >= iter->m_claim_begin;
+}
+
 bool 
 fdb_table_iter_has_next(fdb_table_iter_t* iter) 
 { 
-  while(fdb_btree_iter_has_next(&iter->m_it) && 
-       (iter->m_next == NULL))
-  {
-    fdb_btree_entry_t entry = fdb_btree_iter_next(&iter->m_it);
-    bool is_next = is_selected(entry.m_key, 
-                               iter->m_chunk_size, 
-                               iter->m_offset, 
-                               iter->m_stride);
-    if(is_next)
+  while(iter->m_next == NULL)
+  {
+    if(iter->p_segment == NULL || 
+       iter->m_segment_next == iter->m_segment_size)
     {
-      iter->m_next = (fdb_table_block_t*)entry.p_value;
-      break;
+      if(!fdb_btree_iter_has_next(&iter->m_it))
+      {
+        break;
+      }
+      fdb_btree_entry_t entry = fdb_btree_iter_next(&iter->m_it);
+      iter->p_segment = (fdb_table_block_t*)entry.p_value;
+      iter->m_segment_id = entry.m_key;
+      iter->m_segment_next = 0;
+    }
+
+    uint32_t block_id = iter->m_segment_id*iter->m_segment_size + iter->m_segment_next;
+    fdb_table_block_t* block = &iter->p_segment[iter->m_segment_next];
+    iter->m_segment_next++;
+
+    bool is_next = false;
+    if(iter->p_morsel != NULL)
+    {
+      is_next = is_claimed(iter, iter->m_position++);
+    }
+    else
+    {
+      is_next = is_selected(block_id, 
+                            iter->m_chunk_size, 
+                            iter->m_offset, 
+                            iter->m_stride);
+    }
+
+    if(is_next && block->m_num_components > 0)
+    {
+      iter->m_next = block;
     }
-    iter->m_next = NULL;
   } 
-  return iter->m_next != NULL;;
+  return iter->m_next != NULL;
 }
 
 fdb_table_block_t* 
 fdb_table_iter_next(fdb_table_iter_t* iter) 
 {
   fdb_table_block_t* next = NULL;
-  if(iter->m_next)
+  if(fdb_table_iter_has_next(iter))
   {
     next = iter->m_next;
     iter->m_next = NULL;
   }
-  else
+  return next;
+}
+
+/**
+ * @brief Computes the size of the chunks of the event logs of the given type.
+ * Chunks of removed events also hold a copy of the destroyed components
+ */
+static size_t
+fdb_table_event_chunk_size(const fdb_table_t* table, 
+                           fdb_table_event_type_t type)
+{
+  size_t entry_size = sizeof(entity_id_t);
+  if(type == E_FDB_TABLE_EVENT_REMOVED)
+  {
+    entry_size += table->m_esize;
+  }
+  return entry_size*FDB_TABLE_EVENT_LOG_CHUNK_SIZE;
+}
+
+/**
+ * @brief Frees the chunks of an event log and empties it
+ */
+static void
+fdb_table_event_log_clear(fdb_table_t* table, 
+                          fdb_table_event_type_t type,
+                          fdb_table_event_log_t* log)
+{
+  for(uint32_t i = 0; i < FDB_TABLE_DIRECTORY_FANOUT && log->p_chunks[i] != NULL; ++i)
   {
-    bool found = false;
-    do 
+    char* volatile* node = log->p_chunks[i];
+    for(uint32_t j = 0; j < FDB_TABLE_DIRECTORY_FANOUT && node[j] != NULL; ++j)
     {
-      next = (fdb_table_block_t*)fdb_btree_iter_next(&iter->m_it).p_value;
-      if(next != NULL)
+      fdb_pool_alloc_free(&table->m_event_allocators[type], node[j]);
+    }
+    fdb_pool_alloc_free(&table->m_directory_allocator, (void*)node);
+    log->p_chunks[i] = NULL;
+  }
+
+  if(log->p_index != NULL)
+  {
+    mem_free(fdb_get_global_mem_allocator(), log->p_index);
+    log->p_index = NULL;
+  }
+  log->m_count = 0;
+}
+
+/**
+ * @brief Gets the chunk of an event log holding the given entry
+ */
+static char*
+fdb_table_event_log_chunk(const fdb_table_event_log_t* log, 
+                          uint32_t position)
+{
+  const uint32_t chunk_id = position / FDB_TABLE_EVENT_LOG_CHUNK_SIZE;
+  return log->p_chunks[chunk_id / FDB_TABLE_DIRECTORY_FANOUT][chunk_id % FDB_TABLE_DIRECTORY_FANOUT];
+}
+
+static int
+fdb_table_event_index_cmp(const void* a, 
+                          const void* b)
+{
+  const uint64_t ea = *(const uint64_t*)a;
+  const uint64_t eb = *(const uint64_t*)b;
+  return ea < eb ? -1 : (ea > eb ? 1 : 0);
+}
+
+/**
+ * @brief Builds the index of an event log whose frame has finished, with its
+ * entries sorted by id and thus grouped by block
+ */
+static void
+fdb_table_event_log_index(fdb_table_event_log_t* log)
+{
+  const uint32_t count = log->m_count;
+  if(count == 0)
+  {
+    return;
+  }
+
+  log->p_index = (uint64_t*)mem_alloc(fdb_get_global_mem_allocator(), 
+                                      FDB_TABLE_EVENT_LOG_ALIGNMENT, 
+                                      sizeof(uint64_t)*count, 
+                                      FDB_NO_HINT);
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    const char* chunk = fdb_table_event_log_chunk(log, i);
+    const entity_id_t id = ((const entity_id_t*)chunk)[i % FDB_TABLE_EVENT_LOG_CHUNK_SIZE];
+    log->p_index[i] = ((uint64_t)id << 32) | i;
+  }
+  qsort(log->p_index, count, sizeof(uint64_t), fdb_table_event_index_cmp);
+}
+
+/**
+ * @brief Finds the first entry of an event log index at or after the given
+ * block
+ *
+ * @param index The index of the event log
+ * @param begin The first entry to consider
+ * @param end The end of the index
+ * @param block_id The block to look for
+ *
+ * @return The position of the first entry of the block or of a later one. end
+ * if there is none
+ */
+static uint32_t
+fdb_table_event_index_seek(const uint64_t* index, 
+                           uint32_t begin, 
+                           uint32_t end, 
+                           uint64_t block_id)
+{
+  if(block_id*FDB_TABLE_BLOCK_SIZE > UINT32_MAX)
+  {
+    return end;
+  }
+
+  const uint64_t key = (block_id*FDB_TABLE_BLOCK_SIZE) << 32;
+  while(begin < end)
+  {
+    const uint32_t mid = begin + (end - begin) / 2;
+    if(index[mid] < key)
+    {
+      begin = mid + 1;
+    }
+    else
+    {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+/**
+ * @brief Appends an event to the event log of the current frame, if the table
+ * tracks events. Removed events also copy the component, so it must not have
+ * been destructed yet
+ *
+ * @param table The table to log the event to
+ * @param type The type of the event
+ * @param id The id of the component
+ * @param block The block of the component
+ * @param offset The offset of the component in the block
+ */
+static void
+fdb_table_log_event(fdb_table_t* table, 
+                    fdb_table_event_type_t type,
+                    entity_id_t id,
+                    const fdb_table_block_t* block,
+                    uint32_t offset)
+{
+  if(!table->m_track_events)
+  {
+    return;
+  }
+
+  fdb_table_event_log_t* log = &table->m_events[type][table->m_event_log];
+  uint32_t position = __sync_fetch_and_add(&log->m_count, 1);
+  uint32_t chunk_id = position / FDB_TABLE_EVENT_LOG_CHUNK_SIZE;
+  uint32_t entry = position % FDB_TABLE_EVENT_LOG_CHUNK_SIZE;
+  FDB_PERMA_ASSERT(chunk_id < FDB_TABLE_DIRECTORY_FANOUT*FDB_TABLE_DIRECTORY_FANOUT && "Maximum number of events per frame exceeded");
+
+  char* volatile* node = log->p_chunks[chunk_id / FDB_TABLE_DIRECTORY_FANOUT];
+  char* chunk = node != NULL ? node[chunk_id % FDB_TABLE_DIRECTORY_FANOUT] : NULL;
+  if(chunk == NULL)
+  {
+    // The first writer to reach a chunk allocates it, and its directory node
+    // if needed. Both are published after being allocated, so writers not
+    // taking the lock never see them partially initialized
+    fdb_mutex_lock(&table->m_event_mutex);
+    node = log->p_chunks[chunk_id / FDB_TABLE_DIRECTORY_FANOUT];
+    if(node == NULL)
+    {
+      node = (char* volatile*)fdb_table_directory_node_alloc(table);
+      fdb_mem_barrier();
+      log->p_chunks[chunk_id / FDB_TABLE_DIRECTORY_FANOUT] = node;
+    }
+    chunk = node[chunk_id % FDB_TABLE_DIRECTORY_FANOUT];
+    if(chunk == NULL)
+    {
+      chunk = (char*)fdb_pool_alloc_alloc(&table->m_event_allocators[type], 
+                                          FDB_TABLE_EVENT_LOG_ALIGNMENT, 
+                                          fdb_table_event_chunk_size(table, type), 
+                                          FDB_NO_HINT);
+      fdb_mem_barrier();
+      node[chunk_id % FDB_TABLE_DIRECTORY_FANOUT] = chunk;
+    }
+    fdb_mutex_unlock(&table->m_event_mutex);
+  }
+
+  ((entity_id_t*)chunk)[entry] = id;
+  if(type == E_FDB_TABLE_EVENT_REMOVED)
+  {
+    char* data = &chunk[sizeof(entity_id_t)*FDB_TABLE_EVENT_LOG_CHUNK_SIZE];
+    fdb_table_block_copy_component(block, 
+                                   offset, 
+                                   &data[entry*table->m_esize]);
+  }
+}
+
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+
+void
+fdb_table_event_iter_init(fdb_table_event_iter_t* iter, 
+                          fdb_table_t* table,
+                          fdb_table_event_type_t type,
+                          uint32_t chunk_size,
+                          uint32_t offset, 
+                          uint32_t stride)
+{
+  const size_t block_data_size = table->m_esize*FDB_TABLE_BLOCK_SIZE;
+  fdb_btree_init(&iter->m_blocks, NULL);
+  fdb_pool_alloc_init(&iter->m_block_allocator, 
+                      FDB_TABLE_BLOCK_ALIGNMENT,
+                      sizeof(fdb_table_block_t), 
+                      FDB_TABLE_BLOCK_PAGE_SIZE, 
+                      NULL);
+  fdb_pool_alloc_init(&iter->m_data_allocator, 
+                      FDB_TABLE_BLOCK_DATA_ALIGNMENT, 
+                      block_data_size, 
+                      fdb_table_pool_page_size(block_data_size, FDB_TABLE_BLOCK_DATA_PAGE_SIZE), 
+                      NULL);
+  fdb_pool_alloc_init(&iter->m_bitmap_allocator, 
+                      FDB_BITMAP_DATA_ALIGNMENT, 
+                      FDB_BITMAP_DATA_SIZE(FDB_TABLE_BLOCK_SIZE), 
+                      FDB_BITMAP_DATA_PAGE_SIZE, 
+                      NULL);
+  iter->m_next = NULL;
+
+  if(table->m_track_events)
+  {
+    // The index has the entries sorted by id, so each block is returned once
+    // and in order even if its events are spread over the log. Entries of
+    // blocks of other iterators are skipped by seeking the next chunk of
+    // blocks of this one
+    const fdb_table_event_log_t* log = &table->m_events[type][table->m_event_log ^ 1];
+    const uint64_t* index = log->p_index;
+    const uint32_t count = index != NULL ? log->m_count : 0;
+    uint32_t i = 0;
+    while(i < count)
+    {
+      const uint32_t position = (uint32_t)index[i];
+      fdb_decoded_id_t decoded_id = decode_id((entity_id_t)(index[i] >> 32));
+      if(!is_selected(decoded_id.m_block_id, chunk_size, offset, stride))
       {
-        uint32_t chunk_id = next->m_start / (FDB_TABLE_BLOCK_SIZE);
-        found = is_selected(chunk_id, 
-                            iter->m_chunk_size, 
-                            iter->m_offset, 
-                            iter->m_stride);
+        const uint64_t block_chunk = decoded_id.m_block_id / chunk_size;
+        const uint64_t next_chunk = block_chunk + (offset + stride - (block_chunk % stride)) % stride;
+        i = fdb_table_event_index_seek(index, i, count, next_chunk*chunk_size);
+        continue;
       }
-    } while (next != NULL && !found);
+      ++i;
+
+      const char* chunk = fdb_table_event_log_chunk(log, position);
+      const uint32_t entry = position % FDB_TABLE_EVENT_LOG_CHUNK_SIZE;
+
+      fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&iter->m_blocks, decoded_id.m_block_id);
+      if(block == NULL)
+      {
+        block = (fdb_table_block_t*)fdb_pool_alloc_alloc(&iter->m_block_allocator, 
+                                                         FDB_TABLE_BLOCK_ALIGNMENT, 
+                                                         sizeof(fdb_table_block_t), 
+                                                         FDB_NO_HINT);
+        void* data = NULL;
+        if(type == E_FDB_TABLE_EVENT_REMOVED)
+        {
+          data = fdb_pool_alloc_alloc(&iter->m_data_allocator, 
+                                      FDB_TABLE_BLOCK_DATA_ALIGNMENT, 
+                                      block_data_size, 
+                                      FDB_NO_HINT);
+        }
+        fdb_table_block_init(block, 
+                             decoded_id.m_block_id*FDB_TABLE_BLOCK_SIZE, 
+                             table->m_esize, 
+                             data, 
+                             &iter->m_bitmap_allocator.m_super);
+        fdb_btree_insert(&iter->m_blocks, decoded_id.m_block_id, block);
+      }
+
+      fdb_bitmap_set(&block->m_enabled, decoded_id.m_block_offset);
+      if(type == E_FDB_TABLE_EVENT_REMOVED)
+      {
+        const char* data = &chunk[sizeof(entity_id_t)*FDB_TABLE_EVENT_LOG_CHUNK_SIZE];
+        memcpy(&((char*)block->p_data)[decoded_id.m_block_offset*table->m_esize], 
+               &data[entry*table->m_esize], 
+               table->m_esize);
+      }
+    }
+  }
+
+  fdb_btree_iter_t it;
+  fdb_btree_iter_init(&it, &iter->m_blocks);
+  if(type == E_FDB_TABLE_EVENT_ADDED)
+  {
+    fdb_table_lock(table);
+  }
+  while(fdb_btree_iter_has_next(&it))
+  {
+    fdb_btree_entry_t entry = fdb_btree_iter_next(&it);
+    fdb_table_block_t* block = (fdb_table_block_t*)entry.p_value;
+    if(type == E_FDB_TABLE_EVENT_ADDED)
+    {
+      // Added components that have been destroyed or disabled since are
+      // discarded
+      const fdb_table_block_t* tblock = fdb_table_find_block(table, entry.m_key);
+      if(tblock == NULL)
+      {
+        fdb_bitmap_nullify(&block->m_enabled);
+      }
+      else
+      {
+        fdb_bitmap_set_and(&block->m_enabled, &tblock->m_enabled);
+        block->p_data = tblock->p_data;
+        block->p_soa = tblock->p_soa;
+      }
+    }
+    fdb_bitmap_set_bitmap(&block->m_exists, &block->m_enabled);
+    block->m_num_components = block->m_enabled.m_num_set;
+    block->m_num_enabled_components = block->m_enabled.m_num_set;
+  }
+  if(type == E_FDB_TABLE_EVENT_ADDED)
+  {
+    fdb_table_unlock(table);
+  }
+  fdb_btree_iter_release(&it);
+
+  fdb_btree_iter_init(&iter->m_it, &iter->m_blocks);
+}
+
+void
+fdb_table_event_iter_release(fdb_table_event_iter_t* iter)
+{
+  fdb_btree_iter_release(&iter->m_it);
+  fdb_btree_release(&iter->m_blocks);
+  fdb_pool_alloc_release(&iter->m_bitmap_allocator);
+  fdb_pool_alloc_release(&iter->m_data_allocator);
+  fdb_pool_alloc_release(&iter->m_block_allocator);
+}
+
+bool
+fdb_table_event_iter_has_next(fdb_table_event_iter_t* iter)
+{
+  while(iter->m_next == NULL && fdb_btree_iter_has_next(&iter->m_it))
+  {
+    fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_iter_next(&iter->m_it).p_value;
+    if(block->m_num_enabled_components > 0)
+    {
+      iter->m_next = block;
+    }
+  }
+  return iter->m_next != NULL;
+}
+
+fdb_table_block_t*
+fdb_table_event_iter_next(fdb_table_event_iter_t* iter)
+{
+  fdb_table_block_t* next = NULL;
+  if(fdb_table_event_iter_has_next(iter))
+  {
+    next = iter->m_next;
+    iter->m_next = NULL;
   }
   return next;
 }
 
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+////////////////////////////////////////////////
+
 void
 fdb_table_init(fdb_table_t* table, 
                const char* name, 
@@ -275,6 +862,21 @@ fdb_table_init(fdb_table_t* table,
   table->m_id = id;
   table->m_esize = esize;
   table->m_num_components = 0;
+  table->m_segment_size = 1;
+  table->m_segment_shift = 0;
+  while(table->m_segment_size < FDB_TABLE_MAX_SEGMENT_SIZE && 
+        2*table->m_segment_size*esize*FDB_TABLE_BLOCK_SIZE <= FDB_TABLE_SEGMENT_TARGET_SIZE)
+  {
+    table->m_segment_size *= 2;
+    table->m_segment_shift++;
+  }
+  table->p_directory = NULL;
+  table->m_layout = E_FDB_TABLE_LAYOUT_AOS;
+  table->m_soa.m_num_columns = 0;
+  table->m_track_changes = false;
+  table->m_track_events = false;
+  table->m_event_log = 0;
+  memset(table->m_events, 0, sizeof(table->m_events));
   table->m_destructor = destructor;
   FDB_COPY_AND_CHECK_STR(&table->m_name[0], name, FDB_MAX_TABLE_NAME);
 
@@ -282,27 +884,52 @@ fdb_table_init(fdb_table_t* table,
   fdb_mem_allocator_t* mallocator = allocator != NULL ? allocator : fdb_get_global_mem_allocator();
 
 
+  size_t segment_tblocks_size = sizeof(fdb_table_block_t)*table->m_segment_size;
   fdb_pool_alloc_init(&table->m_tblock_allocator, 
                       FDB_TABLE_BLOCK_ALIGNMENT,
-                      sizeof(fdb_table_block_t), 
-                      FDB_TABLE_BLOCK_PAGE_SIZE, 
+                      segment_tblocks_size, 
+                      fdb_table_pool_page_size(segment_tblocks_size, FDB_TABLE_BLOCK_PAGE_SIZE), 
                       mallocator);
 
+  size_t segment_data_size = esize*FDB_TABLE_BLOCK_SIZE*table->m_segment_size;
   fdb_pool_alloc_init(&table->m_data_allocator, 
                       FDB_TABLE_BLOCK_DATA_ALIGNMENT, 
-                      esize*FDB_TABLE_BLOCK_SIZE, 
-                      FDB_TABLE_BLOCK_DATA_PAGE_SIZE, 
+                      segment_data_size, 
+                      fdb_table_pool_page_size(segment_data_size, FDB_TABLE_BLOCK_DATA_PAGE_SIZE), 
                       mallocator);
 
   fdb_pool_alloc_init(&table->m_bitmap_data_allocator, 
                       FDB_BITMAP_DATA_ALIGNMENT, 
-                      FDB_BITMAP_NUM_CHUNKS(FDB_TABLE_BLOCK_SIZE), 
+                      FDB_BITMAP_DATA_SIZE(FDB_TABLE_BLOCK_SIZE), 
                       FDB_BITMAP_DATA_PAGE_SIZE, 
                       mallocator);
 
 
+  fdb_pool_alloc_init(&table->m_directory_allocator, 
+                      FDB_TABLE_DIRECTORY_ALIGNMENT, 
+                      sizeof(void*)*FDB_TABLE_DIRECTORY_FANOUT, 
+                      FDB_TABLE_DIRECTORY_PAGE_SIZE, 
+                      mallocator);
+
+  fdb_pool_alloc_init(&table->m_changed_allocator, 
+                      FDB_TABLE_BLOCK_CHANGED_ALIGNMENT, 
+                      sizeof(uint32_t)*FDB_TABLE_BLOCK_SIZE, 
+                      FDB_TABLE_BLOCK_CHANGED_PAGE_SIZE, 
+                      mallocator);
+
+  for(uint32_t i = 0; i < E_FDB_TABLE_EVENT_NUM_TYPES; ++i)
+  {
+    size_t chunk_size = fdb_table_event_chunk_size(table, (fdb_table_event_type_t)i);
+    fdb_pool_alloc_init(&table->m_event_allocators[i], 
+                        FDB_TABLE_EVENT_LOG_ALIGNMENT, 
+                        chunk_size, 
+                        fdb_table_pool_page_size(chunk_size, FDB_TABLE_EVENT_LOG_PAGE_SIZE), 
+                        mallocator);
+  }
+
   fdb_btree_init(&table->m_blocks, mallocator);
   fdb_mutex_init(&table->m_mutex);
+  fdb_mutex_init(&table->m_event_mutex);
 }
 
 
@@ -310,9 +937,26 @@ void
 fdb_table_release(fdb_table_t* table)
 {
   fdb_table_clear(table);
+  for(uint32_t i = 0; i < E_FDB_TABLE_EVENT_NUM_TYPES && table->m_track_events; ++i)
+  {
+    for(uint32_t j = 0; j < 2; ++j)
+    {
+      fdb_table_event_log_t* log = &table->m_events[i][j];
+      fdb_table_event_log_clear(table, (fdb_table_event_type_t)i, log);
+      fdb_pool_alloc_free(&table->m_directory_allocator, (void*)log->p_chunks);
+      log->p_chunks = NULL;
+    }
+  }
+  fdb_mutex_release(&table->m_event_mutex);
   fdb_mutex_release(&table->m_mutex);
   fdb_btree_release(&table->m_blocks);
 
+  for(uint32_t i = 0; i < E_FDB_TABLE_EVENT_NUM_TYPES; ++i)
+  {
+    fdb_pool_alloc_release(&table->m_event_allocators[i]);
+  }
+  fdb_pool_alloc_release(&table->m_changed_allocator);
+  fdb_pool_alloc_release(&table->m_directory_allocator);
   fdb_pool_alloc_release(&table->m_bitmap_data_allocator);
   fdb_pool_alloc_release(&table->m_data_allocator);
   fdb_pool_alloc_release(&table->m_tblock_allocator);
@@ -327,34 +971,72 @@ fdb_table_size(fdb_table_t* table)
   return size;
 }
 
+size_t
+fdb_table_num_blocks(fdb_table_t* table)
+{
+  size_t num_blocks = 0;
+  fdb_table_iter_t iter;
+  fdb_table_iter_init(&iter, table, 1, 0, 1);
+  while(fdb_table_iter_has_next(&iter))
+  {
+    fdb_table_iter_next(&iter);
+    num_blocks++;
+  }
+  fdb_table_iter_release(&iter);
+  return num_blocks;
+}
+
 void 
 fdb_table_clear(fdb_table_t* table) 
 {
   fdb_table_lock(table);
-  fdb_table_iter_t titer;
-  fdb_table_iter_init(&titer,table, 1, 0, 1);
-  while(fdb_table_iter_has_next(&titer)) 
+  fdb_btree_iter_t it;
+  fdb_btree_iter_init(&it, &table->m_blocks);
+  while(fdb_btree_iter_has_next(&it)) 
   {
-    fdb_table_block_t* block = fdb_table_iter_next(&titer);
-    if(table->m_destructor)
+    fdb_table_block_t* segment = (fdb_table_block_t*)fdb_btree_iter_next(&it).p_value;
+    void* segment_data = segment[0].p_data;
+    for(uint32_t i = 0; i < table->m_segment_size; ++i)
     {
-      fdb_tblock_iter_t b_iterator;
-      fdb_tblock_iter_init(&b_iterator, block);
-      while(fdb_tblock_iter_has_next(&b_iterator)) 
+      fdb_table_block_t* block = &segment[i];
+      if(table->m_destructor)
       {
-        table->m_destructor(fdb_tblock_iter_next(&b_iterator).p_data);
+        fdb_tblock_iter_t b_iterator;
+        fdb_tblock_iter_init(&b_iterator, block);
+        while(fdb_tblock_iter_has_next(&b_iterator)) 
+        {
+          table->m_destructor(fdb_tblock_iter_next(&b_iterator).p_data);
+        }
+        fdb_tblock_iter_release(&b_iterator);
       }
-      fdb_tblock_iter_release(&b_iterator);
+      if(block->p_changed != NULL)
+      {
+        fdb_pool_alloc_free(&table->m_changed_allocator, 
+                            block->p_changed);
+      }
+      fdb_table_block_release(block, 
+                              &table->m_bitmap_data_allocator.m_super);
     }
-    fdb_table_block_release(block, 
-                            &table->m_data_allocator.m_super, 
-                            &table->m_bitmap_data_allocator.m_super);
 
+    fdb_pool_alloc_free(&table->m_data_allocator, 
+                        segment_data);
     fdb_pool_alloc_free(&table->m_tblock_allocator, 
-                        block);
+                        segment);
   }
-  fdb_table_iter_release(&titer);
+  fdb_btree_iter_release(&it);
   fdb_btree_clear(&table->m_blocks);
+  if(table->p_directory != NULL)
+  {
+    for(uint32_t i = 0; i < FDB_TABLE_DIRECTORY_FANOUT; ++i)
+    {
+      if(table->p_directory[i] != NULL)
+      {
+        fdb_pool_alloc_free(&table->m_directory_allocator, table->p_directory[i]);
+      }
+    }
+    fdb_pool_alloc_free(&table->m_directory_allocator, table->p_directory);
+    table->p_directory = NULL;
+  }
   table->m_num_components = 0;
   fdb_table_unlock(table);
 }
@@ -364,17 +1046,16 @@ void*
 fdb_table_get_component(fdb_table_t* table, 
                     entity_id_t id) 
 {
+  FDB_PERMA_ASSERT(table->m_layout == E_FDB_TABLE_LAYOUT_AOS && "Components of SoA tables cannot be addressed");
   fdb_table_lock(table);
   assert(id != FDB_INVALID_ID);
   fdb_decoded_id_t decoded_id = decode_id(id);
-  void* component = fdb_btree_get(&table->m_blocks, 
-                              decoded_id.m_block_id);
-  if(component == NULL) 
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
+  if(block == NULL) 
   {
     fdb_table_unlock(table);
     return NULL;
   }
-  fdb_table_block_t* block = (fdb_table_block_t*)component;
   if(fdb_bitmap_is_set(&block->m_exists, decoded_id.m_block_offset))
   {
     fdb_table_unlock(table);
@@ -384,41 +1065,265 @@ fdb_table_get_component(fdb_table_t* table,
   return NULL;
 }
 
-void* 
-fdb_table_create_component(fdb_table_t* table, 
-                      entity_id_t id) 
+/**
+ * \brief Allocates the change frames of a block, with all the components
+ * marked as never changed
+ *
+ * \param table The table of the block
+ * \param block The block to allocate the change frames for
+ */
+static void
+fdb_table_block_alloc_changed(fdb_table_t* table, 
+                              fdb_table_block_t* block)
+{
+  block->p_changed = (uint32_t*)fdb_pool_alloc_alloc(&table->m_changed_allocator, 
+                                                     FDB_TABLE_BLOCK_CHANGED_ALIGNMENT, 
+                                                     sizeof(uint32_t)*FDB_TABLE_BLOCK_SIZE, 
+                                                     FDB_NO_HINT);
+  memset(block->p_changed, 0, sizeof(uint32_t)*FDB_TABLE_BLOCK_SIZE);
+  block->m_changed_frame = 0;
+}
+
+/**
+ * \brief Marks the component of the given entity as existing and enabled,
+ * creating the block that holds it if needed
+ *
+ * \param table The table to reserve the component in
+ * \param id The id of the entity to reserve the component for
+ *
+ * \return The block holding the component
+ */
+static fdb_table_block_t*
+fdb_table_reserve_component(fdb_table_t* table, 
+                            entity_id_t id)
 {
   fdb_decoded_id_t decoded_id = decode_id(id);
-  fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, decoded_id.m_block_id);
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
   if (block == NULL) 
   {
-    block = (fdb_table_block_t*)fdb_pool_alloc_alloc(&table->m_tblock_allocator, 
-                                                     FDB_TABLE_BLOCK_ALIGNMENT, 
-                                                     sizeof(fdb_table_block_t), 
-                                                     decoded_id.m_block_id);
+    uint32_t segment_id = decoded_id.m_block_id >> table->m_segment_shift;
+    fdb_table_block_t* segment = (fdb_table_block_t*)fdb_pool_alloc_alloc(&table->m_tblock_allocator, 
+                                                                          FDB_TABLE_BLOCK_ALIGNMENT, 
+                                                                          sizeof(fdb_table_block_t)*table->m_segment_size, 
+                                                                          segment_id);
+    size_t block_data_size = table->m_esize*FDB_TABLE_BLOCK_SIZE;
+    char* segment_data = (char*)fdb_pool_alloc_alloc(&table->m_data_allocator, 
+                                                     FDB_TABLE_BLOCK_DATA_ALIGNMENT, 
+                                                     block_data_size*table->m_segment_size, 
+                                                     segment_id);
 
-    fdb_table_block_init(block, 
-                         decoded_id.m_block_id*FDB_TABLE_BLOCK_SIZE,
-                         table->m_esize, 
-                         &table->m_data_allocator.m_super, 
-                         &table->m_bitmap_data_allocator.m_super);
+    for(uint32_t i = 0; i < table->m_segment_size; ++i)
+    {
+      fdb_table_block_init(&segment[i], 
+                           (segment_id*table->m_segment_size + i)*FDB_TABLE_BLOCK_SIZE,
+                           table->m_esize, 
+                           &segment_data[i*block_data_size], 
+                           &table->m_bitmap_data_allocator.m_super);
+      if(table->m_layout == E_FDB_TABLE_LAYOUT_SOA)
+      {
+        segment[i].p_soa = &table->m_soa;
+      }
+      if(table->m_track_changes)
+      {
+        fdb_table_block_alloc_changed(table, &segment[i]);
+      }
+    }
 
-    fdb_btree_insert(&table->m_blocks, 
-                 decoded_id.m_block_id,
-                 block);
+    fdb_table_insert_segment(table, segment_id, segment);
+    block = &segment[decoded_id.m_block_id & (table->m_segment_size - 1)];
   }
 
   if(!fdb_bitmap_is_set(&block->m_exists, decoded_id.m_block_offset)) 
   {
     table->m_num_components++;
     block->m_num_components++;
+    if(block->p_changed != NULL)
+    {
+      block->p_changed[decoded_id.m_block_offset] = 0;
+    }
+    fdb_table_log_event(table, 
+                        E_FDB_TABLE_EVENT_ADDED, 
+                        id, 
+                        block, 
+                        decoded_id.m_block_offset);
+  }
+  if(!fdb_bitmap_is_set(&block->m_enabled, decoded_id.m_block_offset)) 
+  {
     block->m_num_enabled_components++;
   }
   fdb_bitmap_set(&block->m_exists, decoded_id.m_block_offset);
   fdb_bitmap_set(&block->m_enabled, decoded_id.m_block_offset);
+  return block;
+}
+
+void* 
+fdb_table_create_component(fdb_table_t* table, 
+                      entity_id_t id) 
+{
+  FDB_PERMA_ASSERT(table->m_layout == E_FDB_TABLE_LAYOUT_AOS && "Components of SoA tables cannot be addressed");
+  fdb_table_block_t* block = fdb_table_reserve_component(table, id);
+  fdb_decoded_id_t decoded_id = decode_id(id);
   return &(((char*)block->p_data)[decoded_id.m_block_offset*table->m_esize]);
 }
 
+bool
+fdb_table_set_layout(fdb_table_t* table, 
+                     fdb_table_layout_t layout, 
+                     const fdb_mstruct_t* mstruct)
+{
+  FDB_ASSERT(table->m_num_components == 0 && "The layout of a non-empty table cannot be changed");
+  FDB_ASSERT(table->m_blocks.m_size == 0 && "The layout of a table with blocks cannot be changed");
+
+  if(layout == E_FDB_TABLE_LAYOUT_AOS)
+  {
+    table->m_layout = layout;
+    table->m_soa.m_num_columns = 0;
+    return true;
+  }
+
+  if(mstruct == NULL || 
+     table->m_destructor != NULL ||
+     !fdb_mstruct_is_soa_compatible(mstruct))
+  {
+    return false;
+  }
+
+  // Fields must be in memory order and within the component, so that each
+  // column covers a field and the padding up to the next one 
+  for(uint32_t i = 0; i < mstruct->m_nfields; ++i)
+  {
+    size_t offset = mstruct->p_fields[i]->m_offset;
+    size_t next_offset = i+1 < mstruct->m_nfields ? mstruct->p_fields[i+1]->m_offset : table->m_esize;
+    if(next_offset <= offset || next_offset > table->m_esize)
+    {
+      return false;
+    }
+  }
+
+  table->m_soa.m_num_columns = mstruct->m_nfields;
+  for(uint32_t i = 0; i < mstruct->m_nfields; ++i)
+  {
+    size_t offset = mstruct->p_fields[i]->m_offset;
+    size_t next_offset = i+1 < mstruct->m_nfields ? mstruct->p_fields[i+1]->m_offset : table->m_esize;
+    table->m_soa.m_offsets[i] = offset;
+    table->m_soa.m_sizes[i] = next_offset - offset;
+  }
+  table->m_layout = layout;
+  return true;
+}
+
+void
+fdb_table_track_changes(fdb_table_t* table)
+{
+  fdb_table_lock(table);
+  if(!table->m_track_changes)
+  {
+    table->m_track_changes = true;
+    fdb_btree_iter_t it;
+    fdb_btree_iter_init(&it, &table->m_blocks);
+    while(fdb_btree_iter_has_next(&it)) 
+    {
+      fdb_table_block_t* segment = (fdb_table_block_t*)fdb_btree_iter_next(&it).p_value;
+      for(uint32_t i = 0; i < table->m_segment_size; ++i)
+      {
+        fdb_table_block_alloc_changed(table, &segment[i]);
+      }
+    }
+    fdb_btree_iter_release(&it);
+  }
+  fdb_table_unlock(table);
+}
+
+void
+fdb_table_track_events(fdb_table_t* table)
+{
+  fdb_table_lock(table);
+  if(!table->m_track_events)
+  {
+    for(uint32_t i = 0; i < E_FDB_TABLE_EVENT_NUM_TYPES; ++i)
+    {
+      for(uint32_t j = 0; j < 2; ++j)
+      {
+        table->m_events[i][j].p_chunks = (char* volatile* volatile*)fdb_table_directory_node_alloc(table);
+        table->m_events[i][j].p_index = NULL;
+        table->m_events[i][j].m_count = 0;
+      }
+    }
+    fdb_mem_barrier();
+    table->m_track_events = true;
+  }
+  fdb_table_unlock(table);
+}
+
+void
+fdb_table_swap_events(fdb_table_t* table)
+{
+  if(!table->m_track_events)
+  {
+    return;
+  }
+
+  fdb_mutex_lock(&table->m_event_mutex);
+  uint32_t previous = table->m_event_log ^ 1;
+  for(uint32_t i = 0; i < E_FDB_TABLE_EVENT_NUM_TYPES; ++i)
+  {
+    fdb_table_event_log_clear(table, 
+                              (fdb_table_event_type_t)i, 
+                              &table->m_events[i][previous]);
+    fdb_table_event_log_index(&table->m_events[i][table->m_event_log]);
+  }
+  fdb_mem_barrier();
+  table->m_event_log = previous;
+  fdb_mutex_unlock(&table->m_event_mutex);
+}
+
+void
+fdb_table_set_component(fdb_table_t* table, 
+                        entity_id_t id, 
+                        const void* data)
+{
+  fdb_table_block_t* block = fdb_table_reserve_component(table, id);
+  fdb_decoded_id_t decoded_id = decode_id(id);
+  if(block->p_soa == NULL)
+  {
+    memcpy(&(((char*)block->p_data)[decoded_id.m_block_offset*table->m_esize]), 
+           data, 
+           table->m_esize);
+    return;
+  }
+
+  const fdb_table_soa_t* soa = block->p_soa;
+  for(uint32_t i = 0; i < soa->m_num_columns; ++i)
+  {
+    char* column = &((char*)block->p_data)[soa->m_offsets[i]*FDB_TABLE_BLOCK_SIZE];
+    memcpy(&column[decoded_id.m_block_offset*soa->m_sizes[i]], 
+           &((const char*)data)[soa->m_offsets[i]], 
+           soa->m_sizes[i]);
+  }
+}
+
+bool
+fdb_table_read_component(fdb_table_t* table, 
+                         entity_id_t id, 
+                         void* data)
+{
+  fdb_table_lock(table);
+  fdb_decoded_id_t decoded_id = decode_id(id);
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
+  if(block == NULL || 
+     !fdb_bitmap_is_set(&block->m_exists, decoded_id.m_block_offset))
+  {
+    fdb_table_unlock(table);
+    return false;
+  }
+
+  fdb_table_block_copy_component(block, 
+                                 decoded_id.m_block_offset, 
+                                 data);
+  fdb_table_unlock(table);
+  return true;
+}
+
 void  
 fdb_table_destroy_component(fdb_table_t* table, 
                             entity_id_t id) 
@@ -428,22 +1333,43 @@ fdb_table_destroy_component(fdb_table_t* table,
   fdb_table_lock(table);
   assert(id != FDB_INVALID_ID);
   fdb_decoded_id_t decoded_id = decode_id(id);
-  fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, 
-                                                               decoded_id.m_block_id);
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
   if(block == NULL) {
     fdb_table_unlock(table);
     return;
   }
 
-  if(fdb_bitmap_is_set(&block->m_exists, decoded_id.m_block_offset)) 
+  bool existed = fdb_bitmap_is_set(&block->m_exists, decoded_id.m_block_offset);
+  if(existed) 
   {
     table->m_num_components--;
     block->m_num_components--;
+  }
+  if(fdb_bitmap_is_set(&block->m_enabled, decoded_id.m_block_offset)) 
+  {
     block->m_num_enabled_components--;
   }
   fdb_bitmap_unset(&block->m_exists, decoded_id.m_block_offset);
   fdb_bitmap_unset(&block->m_enabled, decoded_id.m_block_offset);
   fdb_table_unlock(table);
+  if(existed)
+  {
+    fdb_table_log_event(table, 
+                        E_FDB_TABLE_EVENT_REMOVED, 
+                        id, 
+                        block, 
+                        decoded_id.m_block_offset);
+  }
+  if(block->p_soa != NULL)
+  {
+    const fdb_table_soa_t* soa = block->p_soa;
+    for(uint32_t i = 0; i < soa->m_num_columns; ++i)
+    {
+      char* column = &((char*)block->p_data)[soa->m_offsets[i]*FDB_TABLE_BLOCK_SIZE];
+      memset(&column[decoded_id.m_block_offset*soa->m_sizes[i]], 0, soa->m_sizes[i]);
+    }
+    return;
+  }
   void* ptr =  &(((char*)block->p_data)[decoded_id.m_block_offset*table->m_esize]);
   if(table->m_destructor)
   {
@@ -459,15 +1385,18 @@ fdb_table_enable_component(fdb_table_t* table,
   assert(id != FDB_INVALID_ID);
   fdb_table_lock(table);
   fdb_decoded_id_t decoded_id = decode_id(id);
-  fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, 
-                                                               decoded_id.m_block_id);
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
   if(block == NULL)
   {
     fdb_table_unlock(table);
     return;
   }
-  fdb_bitmap_set(&block->m_enabled, decoded_id.m_block_offset);
-  block->m_num_enabled_components++;
+  if(fdb_bitmap_is_set(&block->m_exists, decoded_id.m_block_offset) && 
+     !fdb_bitmap_is_set(&block->m_enabled, decoded_id.m_block_offset))
+  {
+    fdb_bitmap_set(&block->m_enabled, decoded_id.m_block_offset);
+    block->m_num_enabled_components++;
+  }
   fdb_table_unlock(table);
 }
 
@@ -479,15 +1408,17 @@ fdb_table_disable_component(fdb_table_t* table,
   fdb_table_lock(table);
 
   fdb_decoded_id_t decoded_id = decode_id(id);
-  fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, 
-                                                   decoded_id.m_block_id);
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
   if(block == NULL)
   {
     fdb_table_unlock(table);
     return;
   }
-  fdb_bitmap_unset(&block->m_enabled, decoded_id.m_block_offset);
-  block->m_num_enabled_components--;
+  if(fdb_bitmap_is_set(&block->m_enabled, decoded_id.m_block_offset))
+  {
+    fdb_bitmap_unset(&block->m_enabled, decoded_id.m_block_offset);
+    block->m_num_enabled_components--;
+  }
   fdb_table_unlock(table);
 }
 
@@ -499,8 +1430,7 @@ fdb_table_is_enabled(fdb_table_t* table,
   fdb_table_lock(table);
 
   fdb_decoded_id_t decoded_id = decode_id(id);
-  fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, 
-                                                   decoded_id.m_block_id);
+  fdb_table_block_t* block = fdb_table_find_block(table, decoded_id.m_block_id);
   if(block == NULL) 
   {
     fdb_table_unlock(table);
@@ -518,12 +1448,50 @@ fdb_table_get_block(fdb_table_t* table,
                 entity_id_t block_id) 
 {
   fdb_table_lock(table);
-  FDB_ASSERT(block_id != FDB_INVALID_ID);
-  fdb_table_block_t* block = (fdb_table_block_t*)fdb_btree_get(&table->m_blocks, block_id);
+  fdb_table_block_t* block = fdb_table_lookup_block(table, block_id);
   fdb_table_unlock(table);
   return block;
 }
 
+fdb_table_block_t*
+fdb_table_lookup_block(fdb_table_t* table, 
+                       uint32_t block_id)
+{
+  FDB_ASSERT(block_id != FDB_INVALID_ID);
+  fdb_table_block_t* block = fdb_table_find_block(table, block_id);
+  if(block != NULL && block->m_num_components == 0)
+  {
+    block = NULL;
+  }
+  return block;
+}
+
+uint32_t
+fdb_table_choose_driver(fdb_table_driver_t* driver, 
+                        fdb_table_t** tables, 
+                        uint32_t num_tables,
+                        uint32_t frame)
+{
+  uint64_t choice = driver->m_choice;
+  if((uint32_t)(choice >> 32) != frame)
+  {
+    uint32_t smallest = 0;
+    for(uint32_t i = 1; i < num_tables; ++i)
+    {
+      if(tables[i]->m_num_components < tables[smallest]->m_num_components)
+      {
+        smallest = i;
+      }
+    }
+    // Threads choosing concurrently keep the choice of the first one to
+    // publish it
+    const uint64_t next = ((uint64_t)frame << 32) | smallest;
+    const uint64_t old = __sync_val_compare_and_swap(&driver->m_choice, choice, next);
+    choice = old == choice ? next : old;
+  }
+  return (uint32_t)choice;
+}
+
 void
 fdb_table_set_component_destructor(fdb_table_t* table, void (*destr)(void *ptr))
 {
@@ -6,6 +6,7 @@
 #include "../../common/bitmap.h"
 #include "../../common/btree.h"
 #include "../../common/mutex.h"
+#include "reflection.h"
 
 #include <stdbool.h>
 
@@ -26,6 +27,33 @@ extern "C" {
   } fdb_table_entry_t;
 
 
+  ////////////////////////////////////////////////
+  ////////////////////////////////////////////////
+  ////////////////////////////////////////////////
+
+  /**
+   * \brief The layout of the components data in the blocks of a table
+   */
+  typedef enum fdb_table_layout_t
+  {
+    E_FDB_TABLE_LAYOUT_AOS = 0,   //< Components are stored one after the other (array of structures)
+    E_FDB_TABLE_LAYOUT_SOA,       //< Each field of the components is stored in its own column (structure of arrays)
+  } fdb_table_layout_t;
+
+  /**
+   * \brief Describes the columns of a SoA table. Column i holds the bytes
+   * [m_offsets[i], m_offsets[i] + m_sizes[i]) of each component, that is, the
+   * ith field followed by its padding. The column starts at byte
+   * m_offsets[i]*FDB_TABLE_BLOCK_SIZE of the block data, so a SoA block has
+   * the same size as an AoS block.
+   */
+  typedef struct fdb_table_soa_t
+  {
+    uint32_t m_num_columns;                           //< The number of columns
+    uint32_t m_offsets[FDB_MAX_COMPONENT_FIELDS];     //< The offset of the field of each column in the component
+    uint32_t m_sizes[FDB_MAX_COMPONENT_FIELDS];       //< The size of the elements of each column
+  } fdb_table_soa_t;
+
   ////////////////////////////////////////////////
   ////////////////////////////////////////////////
   ////////////////////////////////////////////////
@@ -43,18 +71,30 @@ extern "C" {
     size_t m_esize;                                                   // The size of the components contained in the block
     fdb_bitmap_t m_exists;                                                // A bitmap used to test whether an component is in the block or not
     fdb_bitmap_t m_enabled;                                               // A bitmap used to mark components that are enabled/disabled
+    const fdb_table_soa_t* p_soa;                                     // The columns of the block if it is stored as SoA. NULL if stored as AoS
+    uint32_t* p_changed;                                              // The frame each component was last changed in by a system (0 if never). NULL if the table does not track changes
+    uint32_t m_changed_frame;                                         // The last frame any component of the block was changed in
   } fdb_table_block_t;
 
+  /**
+   * \brief Initializes a table block
+   *
+   * \param tb The block to initialize
+   * \param start The id of the first component of the block
+   * \param esize The size of the components of the block
+   * \param data The buffer of esize*FDB_TABLE_BLOCK_SIZE bytes holding the
+   * components data, which is owned by the segment of the block
+   * \param fdb_bitmap_allocator The allocator for the block bitmaps
+   */
   void 
   fdb_table_block_init(fdb_table_block_t* tb, 
                        entity_id_t start, 
                        size_t esize, 
-                       fdb_mem_allocator_t* data_allocator, 
+                       void* data, 
                        fdb_mem_allocator_t* fdb_bitmap_allocator);
 
   void
   fdb_table_block_release(fdb_table_block_t* tblock, 
-                          fdb_mem_allocator_t* data_allocator, 
                           fdb_mem_allocator_t* fdb_bitmap_allocator);
 
 
@@ -79,12 +119,103 @@ extern "C" {
    * \param block The block to get the component from
    *
    * \return Returns a pointer to the component. Returns nullptr if the component does
-   * not exist in the block
+   * not exist in the block. Components of SoA blocks cannot be addressed, so
+   * p_data is always nullptr for them
    */
   fdb_table_entry_t 
   fdb_table_block_get_component(const fdb_table_block_t *block, 
                                 entity_id_t id);
 
+  /**
+   * \brief Records that a component of the block was changed in the given
+   * frame. Does nothing if the table of the block does not track changes
+   *
+   * \param block The block of the component
+   * \param offset The offset of the component in the block
+   * \param frame The frame the component was changed in
+   */
+  static inline void
+  fdb_table_block_set_changed(fdb_table_block_t* block, 
+                              uint32_t offset, 
+                              uint32_t frame)
+  {
+    if(block->p_changed != NULL)
+    {
+      block->p_changed[offset] = frame;
+      block->m_changed_frame = frame;
+    }
+  }
+
+  /**
+   * \brief Tells if any component of the block was changed in the given frame
+   * or later
+   *
+   * \param block The block to check
+   * \param since The first frame to consider
+   *
+   * \return True if the block has changed components
+   */
+  static inline bool
+  fdb_table_block_has_changes(const fdb_table_block_t* block, 
+                              uint32_t since)
+  {
+    return block->p_changed != NULL && 
+           block->m_changed_frame != 0 && 
+           block->m_changed_frame >= since;
+  }
+
+  /**
+   * \brief Unsets from the given bitmap the components of the block that were
+   * not last changed in [since, frame). Changed filters pass the frame of
+   * their previous run as since (see fdb_table_changed_filter_begin), so each
+   * change is seen exactly once, by the first run after the frame it
+   * happened in.
+   *
+   * \param block The block whose changes are used to filter
+   * \param enabled The bitmap to filter
+   * \param since The first frame whose changes are kept
+   * \param frame The current frame
+   */
+  void
+  fdb_table_block_filter_changed(const fdb_table_block_t* block, 
+                                 fdb_bitmap_t* enabled,
+                                 uint32_t since,
+                                 uint32_t frame);
+
+  /**
+   * \brief State of a changed filter, shared by the threads running it. It
+   * remembers the frames of the current and the previous runs of the filter.
+   * Zero initialized filters have never run.
+   */
+  typedef struct fdb_table_changed_filter_t
+  {
+    volatile uint64_t m_runs;   //< The frame of the current run in the high 32 bits, and of the previous run in the low ones
+  } fdb_table_changed_filter_t;
+
+  /**
+   * \brief Initializes the state of a changed filter, as if it had never run.
+   * Filters must be initialized again when used with a new database, since its
+   * frames start again
+   *
+   * \param filter The state of the filter
+   */
+  void
+  fdb_table_changed_filter_init(fdb_table_changed_filter_t* filter);
+
+  /**
+   * \brief Starts a run of a changed filter in the given frame. All the threads
+   * running the filter in a frame get the same result
+   *
+   * \param filter The state of the filter
+   * \param frame The current frame
+   *
+   * \return The first frame whose changes the run must see: the frame of the
+   * previous run, or 1 if the filter has never run
+   */
+  uint32_t
+  fdb_table_changed_filter_begin(fdb_table_changed_filter_t* filter, 
+                                 uint32_t frame);
+
   ////////////////////////////////////////////////
   ////////////////////////////////////////////////
   ////////////////////////////////////////////////
@@ -146,21 +277,82 @@ extern "C" {
   ////////////////////////////////////////////////
   ////////////////////////////////////////////////
 
+  /**
+   * \brief The types of the events recorded by tables that track events (see
+   * fdb_table_track_events)
+   */
+  typedef enum fdb_table_event_type_t
+  {
+    E_FDB_TABLE_EVENT_ADDED = 0,    //< A component was created
+    E_FDB_TABLE_EVENT_REMOVED,      //< A component was destroyed
+    E_FDB_TABLE_EVENT_NUM_TYPES
+  } fdb_table_event_type_t;
 
+  /**
+   * \brief Append-only log with the ids of the components created or destroyed
+   * in a table during a frame. Entries are stored in chunks of
+   * FDB_TABLE_EVENT_LOG_CHUNK_SIZE ids, which in logs of removed events are
+   * followed by a copy of each destroyed component. Writers claim their entry
+   * with an atomic increment, so appending only locks when a new chunk must be
+   * allocated. Chunks are found through a two-level directory of
+   * FDB_TABLE_DIRECTORY_FANOUT wide nodes allocated on demand.
+   *
+   * When a frame finishes, its entries are indexed sorted by id, so readers
+   * of the previous frame only visit the entries of the blocks they iterate.
+   */
+  typedef struct fdb_table_event_log_t
+  {
+    char* volatile* volatile* p_chunks;   //< The directory with the chunks of the log. NULL if the table does not track events
+    uint64_t*             p_index;        //< The entries sorted by id, as (id << 32 | position). NULL until the frame of the log finishes
+    volatile uint32_t     m_count;        //< The number of entries in the log
+  } fdb_table_event_log_t;
+
+  ////////////////////////////////////////////////
+  ////////////////////////////////////////////////
+  ////////////////////////////////////////////////
+
+
+  /**
+   * \brief Tables store their blocks in segments of m_segment_size consecutive
+   * blocks, which share a single data allocation and btree entry. The segment
+   * size is chosen per table from the component size, so that small components
+   * do not pay a btree entry and allocation per block. Blocks are still
+   * FDB_TABLE_BLOCK_SIZE components long, so blocks of tables with different
+   * segment sizes keep aligning by block id in joins.
+   *
+   * Segments are looked up through a two-level radix directory indexed by the
+   * segment id, which gives constant time lookups for the dense range of ids
+   * below FDB_TABLE_DIRECTORY_FANOUT^2 segments. Segments beyond that range
+   * are only found through the btree, which also keeps the segments sorted
+   * for iteration.
+   */
   typedef struct fdb_table_t 
   {
     char                  m_name[FDB_MAX_TABLE_NAME]; //< The name of the table
     uint64_t              m_id;                           //< The id of the table
     size_t                m_esize;                        //< The size of each component in bytes
-    fdb_btree_t           m_blocks;                       //< The btree with the table blocks
+    fdb_btree_t           m_blocks;                       //< The btree with the table segments
+    uint32_t              m_segment_size;                 //< The number of blocks of each segment. A power of two
+    uint32_t              m_segment_shift;                //< log2 of m_segment_size
+    fdb_table_block_t***  p_directory;                    //< The radix directory with the segments. NULL until the first segment is created
     size_t                m_num_components;               //< The number of components in this table
+    fdb_table_layout_t    m_layout;                       //< The layout of the components in the blocks
+    fdb_table_soa_t       m_soa;                          //< The columns of the table when the layout is SoA
+    bool                  m_track_changes;                //< Whether the blocks record the frame their components are changed in
+    bool                  m_track_events;                 //< Whether the creation and destruction of components is logged
+    uint32_t              m_event_log;                    //< The index of the event logs of the current frame. The other ones hold the events of the previous frame
+    fdb_table_event_log_t m_events[E_FDB_TABLE_EVENT_NUM_TYPES][2]; //< The event logs of the current and previous frames
+    fdb_mutex_t           m_event_mutex;                  //< The mutex protecting the allocation of event log chunks
     void (*m_destructor)(void *ptr);                      //< The pointer to the destructor for the components
     fdb_mutex_t           m_mutex;                        //< The able mutex
 
     // fixed block memory allocators for the different parts
-    fdb_pool_alloc_t       m_tblock_allocator;      //< The allocator for the table blocks structure
-    fdb_pool_alloc_t       m_data_allocator;        //< The allocator for the actual components data in table blocks
+    fdb_pool_alloc_t       m_tblock_allocator;      //< The allocator for the arrays of table blocks of the segments
+    fdb_pool_alloc_t       m_data_allocator;        //< The allocator for the actual components data of the segments
     fdb_pool_alloc_t       m_bitmap_data_allocator; //< The allocator for the bitmaps (this is forwarded to bitmap allocation in table blocks)
+    fdb_pool_alloc_t       m_directory_allocator;   //< The allocator for the nodes of the segment directory
+    fdb_pool_alloc_t       m_changed_allocator;     //< The allocator for the change frames of the blocks
+    fdb_pool_alloc_t       m_event_allocators[E_FDB_TABLE_EVENT_NUM_TYPES]; //< The allocators for the chunks of the event logs 
   } fdb_table_t;
 
 
@@ -205,12 +397,91 @@ extern "C" {
    * \param id The id of the component to get
    *
    * \return Returns a pointer to the component. Returns nullptr if the component
-   * does not exist in the table
+   * does not exist in the table. Only valid for AoS tables
    */
   void* 
   fdb_table_get_component(fdb_table_t* table, 
                           entity_id_t id);
 
+  /**
+   * \brief Sets the layout of the table. The layout can only be changed while
+   * the table is empty. SoA tables cannot have a destructor and their
+   * components cannot be addressed, so they must be accessed through
+   * fdb_table_set_component and fdb_table_read_component.
+   *
+   * \param table The table to set the layout for
+   * \param layout The layout to set
+   * \param mstruct The reflection data of the components. Only required for
+   * the SoA layout
+   *
+   * \return True if the layout was set. False if the components described by
+   * mstruct cannot be stored with the given layout
+   */
+  bool
+  fdb_table_set_layout(fdb_table_t* table, 
+                       fdb_table_layout_t layout, 
+                       const fdb_mstruct_t* mstruct);
+
+  /**
+   * \brief Makes the blocks of the table record the frame in which their
+   * components are changed by the systems (see fdb_table_block_set_changed),
+   * so that readers can select only the changed components. 
+   *
+   * \param table The table to track the changes of
+   */
+  void
+  fdb_table_track_changes(fdb_table_t* table);
+
+  /**
+   * \brief Makes the table log the ids of the components created and destroyed
+   * in each frame, so that they can be iterated in the next one through a
+   * fdb_table_event_iter_t. Logs of destroyed components also keep a copy of
+   * them, taken before calling the destructor.
+   *
+   * \param table The table to track the events of
+   */
+  void
+  fdb_table_track_events(fdb_table_t* table);
+
+  /**
+   * \brief Starts a new frame in the event logs of a table. The events of the
+   * frame that just finished become readable, and the events of the frame
+   * before it are discarded. Must not be called while components are being
+   * created, destroyed or iterated.
+   *
+   * \param table The table to swap the event logs of
+   */
+  void
+  fdb_table_swap_events(fdb_table_t* table);
+
+  /**
+   * \brief Creates the component of the given entity, if it does not exist,
+   * and copies the given data into it. Valid for any layout
+   *
+   * \param table The table to set the component to
+   * \param id The id of the entity to set the component for
+   * \param data The component data to copy, of m_esize bytes
+   */
+  void
+  fdb_table_set_component(fdb_table_t* table, 
+                          entity_id_t id, 
+                          const void* data);
+
+  /**
+   * \brief Copies the component of the given entity into the given buffer.
+   * Valid for any layout
+   *
+   * \param table The table to read the component from
+   * \param id The id of the entity to read the component of
+   * \param data The buffer to copy the component to, of m_esize bytes
+   *
+   * \return True if the component exists. False otherwise
+   */
+  bool
+  fdb_table_read_component(fdb_table_t* table, 
+                           entity_id_t id, 
+                           void* data);
+
   /**
    * \brief Enables an component of the table, only it it exists 
    *
@@ -249,11 +520,55 @@ extern "C" {
    * \param table The table to get the block from
    * \param block_id The id of the block to retrieve
    *
-   * \return A pointer to the block
+   * \return A pointer to the block, or NULL if the block contains no
+   * components
    */
   fdb_table_block_t* 
   fdb_table_get_block(fdb_table_t* table, uint32_t block_id);
 
+  /**
+   * \brief Gets the given block without locking the table, through the
+   * segment directory. Like table iterators, it must only be used while no
+   * components are being created or destroyed in the table, e.g. when probing
+   * the inputs of joins from the systems of a task
+   *
+   * \param table The table to get the block from
+   * \param block_id The id of the block to retrieve
+   *
+   * \return A pointer to the block, or NULL if the block contains no
+   * components
+   */
+  fdb_table_block_t* 
+  fdb_table_lookup_block(fdb_table_t* table, uint32_t block_id);
+
+  /**
+   * \brief Choice of the table driving a multi-table stream, shared by the
+   * threads running it. Zero initialized choices have never been made.
+   */
+  typedef struct fdb_table_driver_t
+  {
+    volatile uint64_t m_choice;   //< The frame of the choice in the high 32 bits, and the chosen table in the low ones
+  } fdb_table_driver_t;
+
+  /**
+   * \brief Chooses the table with the fewest components to drive a stream
+   * over several tables. The first thread running the stream in a frame makes
+   * the choice, and the rest of threads of the frame get the same table even
+   * if the sizes of the tables change meanwhile
+   *
+   * \param driver The choice shared by the threads running the stream
+   * \param tables The tables of the stream
+   * \param num_tables The number of tables
+   * \param frame The current frame
+   *
+   * \return The index of the driving table in tables
+   */
+  uint32_t
+  fdb_table_choose_driver(fdb_table_driver_t* driver, 
+                          fdb_table_t** tables, 
+                          uint32_t num_tables,
+                          uint32_t frame);
+
   /**
    * \brief Locks the table
    *
@@ -279,6 +594,7 @@ extern "C" {
    * \param table The table to allocate the component for
    * \param id The id of the entity to remove the component for
    *
+   * \return A pointer to the component. Only valid for AoS tables
    */
   void* 
   fdb_table_create_component(fdb_table_t* table, 
@@ -303,6 +619,14 @@ extern "C" {
   size_t
   fdb_table_size(fdb_table_t* table);
 
+  /**
+   * \brief Gets the number of blocks of the table with at least one component
+   *
+   * \param table The table to get the number of blocks for
+   */
+  size_t
+  fdb_table_num_blocks(fdb_table_t* table);
+
 
   void
   fdb_table_set_component_destructor(fdb_table_t* table, void (*destr)(void *ptr));
@@ -313,16 +637,38 @@ extern "C" {
 
 
   /**
-   * \brief Iterator of a table, used to iterate over the table blocks of a table
+   * \brief Shared cursor used by a set of morsel-driven table iterators to
+   * dynamically distribute the blocks of a table among threads. Must be
+   * zero-initialized. The last iterator to be released resets the cursor, so it
+   * can be reused by the next run of the same stream.
+   */
+  typedef struct fdb_table_morsel_t
+  {
+    volatile uint32_t                     m_next;         //< The position of the next morsel to claim
+    volatile uint32_t                     m_num_done;     //< The number of iterators that finished with this cursor
+  } fdb_table_morsel_t;
+
+  /**
+   * \brief Iterator of a table, used to iterate over the table blocks of a table.
+   * Blocks without components are skipped
    */
   typedef struct fdb_table_iter_t 
   {
-    fdb_btree_t*                          p_blocks;       //< The table btree with the blocks
+    fdb_btree_t*                          p_blocks;       //< The table btree with the segments
     fdb_btree_iter_t                      m_it;           //< The btree iterator
+    uint32_t                              m_segment_size; //< The number of blocks of each segment of the table
+    fdb_table_block_t*                    p_segment;      //< The blocks of the segment being iterated
+    uint32_t                              m_segment_id;   //< The id of the segment being iterated
+    uint32_t                              m_segment_next; //< The next block of the segment to iterate
     uint32_t                              m_chunk_size;   //< The size of consecutive blocks (chunks) to iterate
     uint32_t                              m_offset;       //< The offset in chunk size to start iterate from
     uint32_t                              m_stride;       //< The amount of blocks to skip (in chunk size) after a chunk has been consumed
     fdb_table_block_t*                    m_next;         //< The next table block to iterate
+    fdb_table_morsel_t*                   p_morsel;       //< The shared morsel cursor. NULL if the iterator is static
+    uint32_t                              m_morsel_size;  //< The number of blocks claimed at once from the morsel cursor
+    uint32_t                              m_position;     //< The position of the next block in the btree iteration order
+    uint32_t                              m_claim_begin;  //< The first position of the currently claimed morsel
+    uint32_t                              m_claim_end;    //< The position past the end of the currently claimed morsel
   } fdb_table_iter_t;
 
   /**
@@ -344,6 +690,26 @@ extern "C" {
                       uint32_t offset, 
                       uint32_t stride);
 
+  /**
+   * \brief inits a morsel-driven table iterator. Instead of statically
+   * partitioning the blocks by their id, the iterators sharing the same morsel
+   * cursor claim ranges of morsel_size consecutive blocks on demand, so threads
+   * finishing early keep taking work from the rest. The set of blocks returned
+   * by each iterator is thus not deterministic, and cannot be used when the
+   * blocks of different streams must be co-partitioned (e.g. joins).
+   *
+   * \param table The table to iterate
+   * \param morsel The morsel cursor shared by all the iterators of the stream
+   * \param morsel_size The number of consecutive blocks claimed at once
+   * \param stride The number of iterators sharing the morsel cursor
+   */
+  void
+  fdb_table_iter_init_morsel(fdb_table_iter_t* iter, 
+                             fdb_table_t* table,
+                             fdb_table_morsel_t* morsel,
+                             uint32_t morsel_size,
+                             uint32_t stride);
+
   /**
    * \brief releases a table iterator
    *
@@ -376,6 +742,79 @@ extern "C" {
   ////////////////////////////////////////////////
   ////////////////////////////////////////////////
 
+  /**
+   * \brief Iterator over the components created or destroyed in a table during
+   * the previous frame. Events are grouped by block when the iterator is
+   * initialized, and the blocks are returned sorted by id, so the iterator can
+   * replace a table iterator in any stream.
+   *
+   * The blocks of added events are views of the table blocks with only the
+   * added components enabled, and share their data, so systems can write the
+   * added components. Views do not track changes. The blocks of removed
+   * events are AoS copies built from the log, so writes to them are lost.
+   */
+  typedef struct fdb_table_event_iter_t
+  {
+    fdb_btree_t           m_blocks;             //< The blocks with events, by block id
+    fdb_btree_iter_t      m_it;                 //< The iterator over the blocks
+    fdb_table_block_t*    m_next;               //< The next block to iterate
+    fdb_pool_alloc_t      m_block_allocator;    //< The allocator for the blocks
+    fdb_pool_alloc_t      m_data_allocator;     //< The allocator for the data of the blocks of removed events
+    fdb_pool_alloc_t      m_bitmap_allocator;   //< The allocator for the bitmaps of the blocks
+  } fdb_table_event_iter_t;
+
+  /**
+   * \brief Inits an iterator over the events of the previous frame of a table
+   * that belong to a subset of blocks, selected as in fdb_table_iter_init
+   *
+   * \param iter The iterator to init
+   * \param table The table to iterate the events of
+   * \param type The type of the events to iterate
+   * \param chunk_size The size of consecutive blocks (chunks) to iterate
+   * \param offset The offset in chunk size to start iterate from
+   * \param stride The amount of blocks to skip (in chunk size) after a chunk has
+   * been consumed
+   */
+  void
+  fdb_table_event_iter_init(fdb_table_event_iter_t* iter, 
+                            fdb_table_t* table,
+                            fdb_table_event_type_t type,
+                            uint32_t chunk_size,
+                            uint32_t offset, 
+                            uint32_t stride);
+
+  /**
+   * \brief Releases an event iterator and the blocks it returned
+   *
+   * \param iter The iterator to release
+   */
+  void
+  fdb_table_event_iter_release(fdb_table_event_iter_t* iter);
+
+  /**
+   * \brief Checks if the iterator has blocks with events to consume
+   *
+   * \param iter The iterator to check
+   *
+   * \return Returns true if there are blocks to consume
+   */
+  bool
+  fdb_table_event_iter_has_next(fdb_table_event_iter_t* iter);
+
+  /**
+   * \brief Gets the next block with events
+   *
+   * \param iter The iterator to get the block from
+   *
+   * \return The next block, with the components of the events enabled
+   */
+  fdb_table_block_t*
+  fdb_table_event_iter_next(fdb_table_event_iter_t* iter);
+
+  ////////////////////////////////////////////////
+  ////////////////////////////////////////////////
+  ////////////////////////////////////////////////
+
   /**
    * \brief Given a block id, a chunk size and a stride, returns the offset
    * (thread id) responsible of the block start.
@@ -5,6 +5,7 @@
 
 #include "../database.h"
 #include "webserver.h"
+#include "../../task/profiler.h"
 #include "../../../common/memory/numa_alloc.h"
 
 #include <fcntl.h>
@@ -69,6 +70,18 @@ generate_json(fdb_webserver_t* webserver)
   fdb_str_builder_append(&webserver->m_builder, "]}");
 }
 
+void
+generate_trace_json(fdb_webserver_t* webserver)
+{
+  char headers[] = "HTTP/1.1 200 OK\r\nServer: CPi\r\nContent-type: application/json\r\n\r\n";
+  fdb_str_builder_clear(&webserver->m_builder);
+  fdb_str_builder_append(&webserver->m_builder,
+                         "%s",
+                         headers);
+  fdb_profiler_chrome_trace(webserver->p_profiler, 
+                            &webserver->m_builder);
+}
+
 void*
 server_thread_handler(void* param)
 {
@@ -111,7 +124,15 @@ server_thread_handler(void* param)
       read(client_fd, buffer, 2048);
       printf("%s", buffer);
       fflush(stdout);
-      generate_json(webserver);
+      if(webserver->p_profiler != NULL && 
+         strncmp(buffer, "GET /trace", 10) == 0)
+      {
+        generate_trace_json(webserver);
+      }
+      else
+      {
+        generate_json(webserver);
+      }
       write(client_fd, webserver->m_builder.p_buffer, strlen(webserver->m_builder.p_buffer));
       shutdown (client_fd, SHUT_RDWR);      
       close(client_fd);
@@ -134,6 +155,7 @@ fdb_webserver_init(fdb_webserver_t* ws)
   ws->p_database = NULL;
   ws->m_table_infos_capacity = 0;
   ws->m_table_infos = NULL;
+  ws->p_profiler = NULL;
   ws->m_running = false;
   fdb_str_builder_init(&ws->m_builder);
 }
@@ -180,3 +202,9 @@ fdb_webserver_stop(fdb_webserver_t* ws)
   }
 }
 
+void
+fdb_webserver_set_profiler(fdb_webserver_t* ws, 
+                           struct fdb_profiler_t* profiler)
+{
+  ws->p_profiler = profiler;
+}
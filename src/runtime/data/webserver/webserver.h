@@ -22,6 +22,7 @@ typedef struct fdb_webserver_t
   pthread_t                     m_thread;
   uint32_t                      m_table_infos_capacity;
   struct fdb_table_info_t*      m_table_infos;
+  struct fdb_profiler_t*        p_profiler;           //< The profiler served at /trace. NULL if none
   fdb_str_builder_t             m_builder;
   bool                          m_running;
   char                          m_port[FDB_MAX_WEBSERVER_PORT_SIZE];
@@ -44,6 +45,16 @@ fdb_webserver_start(fdb_webserver_t* ws,
 void
 fdb_webserver_stop(fdb_webserver_t* ws);
 
+/**
+ * \brief Sets the profiler whose Chrome trace is served at /trace
+ *
+ * \param ws The webserver
+ * \param profiler The profiler to serve, or NULL to stop serving traces
+ */
+void
+fdb_webserver_set_profiler(fdb_webserver_t* ws, 
+                           struct fdb_profiler_t* profiler);
+
 #ifdef __cplusplus
 }
 #endif
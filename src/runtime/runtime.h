@@ -1,4 +1,6 @@
 
 #include "data/data.h"
 #include "task/task.h"
+#include "task/executor.h"
+#include "task/profiler.h"
 #include "log/log.h"
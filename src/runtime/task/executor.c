@@ -0,0 +1,317 @@
+
+
+#include "executor.h"
+#include "task.h"
+#include "profiler.h"
+#include "../../common/memory/memory.h"
+
+#include <string.h>
+
+static void
+fdb_executor_reserve(fdb_executor_t* executor,
+                     uint32_t num_tasks)
+{
+  if(num_tasks <= executor->m_capacity)
+  {
+    return;
+  }
+
+  fdb_mem_allocator_t* allocator = fdb_get_global_mem_allocator();
+  if(executor->m_capacity > 0)
+  {
+    mem_free(allocator, executor->m_pending_parents);
+    mem_free(allocator, executor->m_pending_jobs);
+    mem_free(allocator, executor->m_deferred_sync);
+    mem_free(allocator, executor->m_queue);
+  }
+
+  executor->m_capacity = num_tasks;
+  executor->m_pending_parents = (uint32_t*)mem_alloc(allocator,
+                                                     64,
+                                                     sizeof(uint32_t)*num_tasks,
+                                                     FDB_NO_HINT);
+  executor->m_pending_jobs = (uint32_t*)mem_alloc(allocator,
+                                                  64,
+                                                  sizeof(uint32_t)*num_tasks,
+                                                  FDB_NO_HINT);
+  executor->m_deferred_sync = (uint32_t*)mem_alloc(allocator,
+                                                   64,
+                                                   sizeof(uint32_t)*num_tasks,
+                                                   FDB_NO_HINT);
+
+  // At most all the jobs of all the tasks can be ready at the same time
+  executor->m_queue_capacity = num_tasks*executor->m_num_threads;
+  executor->m_queue = (fdb_executor_job_t*)mem_alloc(allocator,
+                                                     64,
+                                                     sizeof(fdb_executor_job_t)*executor->m_queue_capacity,
+                                                     FDB_NO_HINT);
+}
+
+/**
+ * \brief Pushes the jobs of a ready task to the queue. Must be called with the
+ * executor mutex locked.
+ */
+static void
+fdb_executor_push_task(fdb_executor_t* executor,
+                       uint32_t task_id)
+{
+  const fdb_task_t* task = &executor->p_task_graph->m_tasks[task_id];
+  uint32_t num_jobs = executor->m_num_threads;
+  if(task->m_requires_sync && num_jobs > 1)
+  {
+    if(executor->m_sync_task != FDB_INVALID_ID)
+    {
+      executor->m_deferred_sync[executor->m_num_deferred_sync++] = task_id;
+      return;
+    }
+    executor->m_sync_task = task_id;
+    fdb_sync_barrier_reset(&executor->m_sync_barrier);
+  }
+
+  executor->m_pending_jobs[task_id] = num_jobs;
+  for(uint32_t i = 0; i < num_jobs; ++i)
+  {
+    FDB_ASSERT(executor->m_queue_count < executor->m_queue_capacity && "Executor queue capacity exceeded");
+    uint32_t tail = (executor->m_queue_head + executor->m_queue_count) % executor->m_queue_capacity;
+    executor->m_queue[tail].m_task_id = task_id;
+    executor->m_queue[tail].m_offset  = i;
+    executor->m_queue[tail].m_stride  = num_jobs;
+    executor->m_queue_count++;
+  }
+}
+
+/**
+ * \brief Pops a job from the queue. Must be called with the executor mutex
+ * locked and a non-empty queue
+ */
+static fdb_executor_job_t
+fdb_executor_pop_job(fdb_executor_t* executor)
+{
+  FDB_ASSERT(executor->m_queue_count > 0 && "Cannot pop from an empty executor queue");
+  fdb_executor_job_t job = executor->m_queue[executor->m_queue_head];
+  executor->m_queue_head = (executor->m_queue_head + 1) % executor->m_queue_capacity;
+  executor->m_queue_count--;
+  return job;
+}
+
+/**
+ * \brief Runs a job and updates the task graph state accordingly. Must be
+ * called with the executor mutex locked. The mutex is released while the job
+ * runs. thread_id is the id of the worker running the job, used for profiling.
+ */
+static void
+fdb_executor_run_job(fdb_executor_t* executor,
+                     fdb_executor_job_t job,
+                     uint32_t thread_id)
+{
+  fdb_task_graph_t* task_graph = executor->p_task_graph;
+  const fdb_task_t* task = &task_graph->m_tasks[job.m_task_id];
+  float delta = executor->m_delta;
+  fdb_database_t* database = executor->p_database;
+  void* user_data = executor->p_user_data;
+  fdb_profiler_t* profiler = task_graph->p_profiler;
+  fdb_mutex_unlock(&executor->m_mutex);
+
+  if(profiler != NULL)
+  {
+    fdb_profiler_begin(profiler, thread_id, job.m_task_id, task->p_info);
+  }
+  task->p_func(delta,
+               database,
+               user_data,
+               1,
+               job.m_offset,
+               job.m_stride,
+               task->m_requires_sync ? &executor->m_barrier : NULL);
+  if(profiler != NULL)
+  {
+    fdb_profiler_end();
+  }
+
+  fdb_mutex_lock(&executor->m_mutex);
+  if(--executor->m_pending_jobs[job.m_task_id] > 0)
+  {
+    return;
+  }
+
+  executor->m_num_pending_tasks--;
+  bool notify = executor->m_num_pending_tasks == 0;
+  if(executor->m_sync_task == job.m_task_id)
+  {
+    executor->m_sync_task = FDB_INVALID_ID;
+    if(executor->m_num_deferred_sync > 0)
+    {
+      uint32_t next_sync = executor->m_deferred_sync[0];
+      executor->m_num_deferred_sync--;
+      memmove(&executor->m_deferred_sync[0], 
+              &executor->m_deferred_sync[1], 
+              sizeof(uint32_t)*executor->m_num_deferred_sync);
+      fdb_executor_push_task(executor, next_sync);
+      notify = true;
+    }
+  }
+
+  for(uint32_t i = 0; i < task->m_num_children; ++i)
+  {
+    uint32_t child_id = task->m_children[i];
+    if(--executor->m_pending_parents[child_id] == 0)
+    {
+      fdb_executor_push_task(executor, child_id);
+      notify = true;
+    }
+  }
+
+  if(notify)
+  {
+    pthread_cond_broadcast(&executor->m_cond);
+  }
+}
+
+static void
+fdb_executor_barrier_wait(void* state, 
+                          int32_t num_processes)
+{
+  fdb_sync_barrier_wait((fdb_sync_barrier_t*)state, num_processes);
+}
+
+static void
+fdb_executor_barrier_reset(void* state)
+{
+  fdb_sync_barrier_reset((fdb_sync_barrier_t*)state);
+}
+
+static void
+fdb_executor_worker_loop(void* args)
+{
+  fdb_executor_worker_t* worker = (fdb_executor_worker_t*)args;
+  fdb_executor_t* executor = worker->p_executor;
+  fdb_mutex_lock(&executor->m_mutex);
+  while(!executor->m_shutdown)
+  {
+    if(executor->m_queue_count == 0)
+    {
+      pthread_cond_wait(&executor->m_cond,
+                        &executor->m_mutex.m_mutex);
+      continue;
+    }
+    fdb_executor_run_job(executor,
+                         fdb_executor_pop_job(executor),
+                         worker->m_id);
+  }
+  fdb_mutex_unlock(&executor->m_mutex);
+}
+
+void
+fdb_executor_init(fdb_executor_t* executor,
+                  uint32_t num_threads)
+{
+  FDB_PERMA_ASSERT(num_threads > 0 && num_threads <= FDB_EXECUTOR_MAX_THREADS && "Invalid number of executor threads");
+  memset(executor, 0, sizeof(fdb_executor_t));
+  executor->m_num_threads = num_threads;
+  executor->m_shutdown = false;
+  fdb_mutex_init(&executor->m_mutex);
+  pthread_cond_init(&executor->m_cond, NULL);
+  fdb_sync_barrier_init(&executor->m_sync_barrier, 
+                        FDB_SYNC_BARRIER_DEFAULT_SPIN_COUNT);
+  executor->m_barrier.p_state = &executor->m_sync_barrier;
+  executor->m_barrier.p_wait = fdb_executor_barrier_wait;
+  executor->m_barrier.p_reset = fdb_executor_barrier_reset;
+  executor->m_sync_task = FDB_INVALID_ID;
+
+  // Worker 0 is the thread calling fdb_executor_run
+  for(uint32_t i = 1; i < num_threads; ++i)
+  {
+    fdb_executor_worker_t* worker = &executor->m_workers[i];
+    worker->p_executor = executor;
+    worker->m_id = i;
+    worker->m_task.p_fp = fdb_executor_worker_loop;
+    worker->m_task.p_args = worker;
+    fdb_thread_start(&worker->m_thread,
+                     &worker->m_task);
+  }
+}
+
+void
+fdb_executor_release(fdb_executor_t* executor)
+{
+  fdb_mutex_lock(&executor->m_mutex);
+  executor->m_shutdown = true;
+  pthread_cond_broadcast(&executor->m_cond);
+  fdb_mutex_unlock(&executor->m_mutex);
+
+  for(uint32_t i = 1; i < executor->m_num_threads; ++i)
+  {
+    fdb_thread_join(&executor->m_workers[i].m_thread);
+  }
+
+  if(executor->m_capacity > 0)
+  {
+    fdb_mem_allocator_t* allocator = fdb_get_global_mem_allocator();
+    mem_free(allocator, executor->m_pending_parents);
+    mem_free(allocator, executor->m_pending_jobs);
+    mem_free(allocator, executor->m_deferred_sync);
+    mem_free(allocator, executor->m_queue);
+  }
+
+  fdb_sync_barrier_release(&executor->m_sync_barrier);
+  pthread_cond_destroy(&executor->m_cond);
+  fdb_mutex_release(&executor->m_mutex);
+}
+
+void
+fdb_executor_run(fdb_executor_t* executor,
+                 fdb_task_graph_t* task_graph,
+                 float delta,
+                 fdb_database_t* database,
+                 void* user_data)
+{
+  const uint32_t num_tasks = task_graph->m_num_tasks;
+  if(num_tasks == 0)
+  {
+    return;
+  }
+
+  fdb_mutex_lock(&executor->m_mutex);
+  FDB_ASSERT(executor->p_task_graph == NULL && "Executor is already running a task graph");
+  fdb_executor_reserve(executor, num_tasks);
+  executor->p_task_graph = task_graph;
+  executor->m_delta = delta;
+  executor->p_database = database;
+  executor->p_user_data = user_data;
+  executor->m_num_pending_tasks = num_tasks;
+  executor->m_queue_head = 0;
+  executor->m_queue_count = 0;
+  executor->m_sync_task = FDB_INVALID_ID;
+  executor->m_num_deferred_sync = 0;
+
+  for(uint32_t i = 0; i < num_tasks; ++i)
+  {
+    executor->m_pending_parents[i] = task_graph->m_tasks[i].m_num_parents;
+  }
+
+  for(uint32_t i = 0; i < num_tasks; ++i)
+  {
+    if(executor->m_pending_parents[i] == 0)
+    {
+      fdb_executor_push_task(executor, i);
+    }
+  }
+  pthread_cond_broadcast(&executor->m_cond);
+
+  // The calling thread also consumes jobs until the whole graph has finished
+  while(executor->m_num_pending_tasks > 0)
+  {
+    if(executor->m_queue_count == 0)
+    {
+      pthread_cond_wait(&executor->m_cond,
+                        &executor->m_mutex.m_mutex);
+      continue;
+    }
+    fdb_executor_run_job(executor,
+                         fdb_executor_pop_job(executor),
+                         0);
+  }
+
+  executor->p_task_graph = NULL;
+  fdb_mutex_unlock(&executor->m_mutex);
+}
@@ -0,0 +1,123 @@
+
+#ifndef _FDB_EXECUTOR_H_
+#define _FDB_EXECUTOR_H_ value
+
+#include "../../common/platform.h"
+#include "../../common/thread.h"
+#include "../../common/mutex.h"
+#include "../../common/barrier.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FDB_EXECUTOR_MAX_THREADS 64
+
+/**
+ * \brief A unit of work of the executor: one of the parts a task is split into
+ */
+typedef struct fdb_executor_job_t
+{
+  uint32_t m_task_id;       //< The task this job belongs to
+  uint32_t m_offset;        //< The part of the task this job runs
+  uint32_t m_stride;        //< The number of parts the task has been split into
+} fdb_executor_job_t;
+
+typedef struct fdb_executor_worker_t
+{
+  fdb_executor_t*     p_executor;
+  uint32_t            m_id;
+  fdb_thread_task_t   m_task;
+  fdb_thread_t        m_thread;
+} fdb_executor_worker_t;
+
+/**
+ * \brief Thread pool used to run the tasks of a task graph. Tasks are
+ * scheduled as soon as all their parents have finished, and each task is
+ * split into m_num_threads jobs, each of them receiving a different
+ * offset/stride pair.  The thread calling fdb_executor_run participates in the
+ * execution of the jobs, thus the executor only spawns m_num_threads - 1
+ * worker threads.
+ *
+ * Tasks that require synchronization (m_requires_sync) receive a barrier
+ * shared by all their jobs. Since the jobs of such a task block each other
+ * until all of them have arrived, only one of these tasks is in flight at a
+ * time. Otherwise, two of them could occupy all the threads while waiting on
+ * their barriers. The rest are deferred until the running one finishes.
+ */
+struct fdb_executor_t
+{
+  uint32_t                m_num_threads;
+  fdb_executor_worker_t   m_workers[FDB_EXECUTOR_MAX_THREADS];
+  fdb_mutex_t             m_mutex;
+  pthread_cond_t          m_cond;
+  bool                    m_shutdown;
+
+  // State of the current run
+  fdb_task_graph_t*       p_task_graph;
+  float                   m_delta;
+  fdb_database_t*         p_database;
+  void*                   p_user_data;
+  uint32_t                m_num_pending_tasks;
+
+  // Per-task bookkeeping. Grown on demand
+  uint32_t                m_capacity;
+  uint32_t*               m_pending_parents;
+  uint32_t*               m_pending_jobs;
+
+  // Synchronization of tasks requiring a barrier
+  fdb_sync_barrier_t      m_sync_barrier;
+  fdb_barrier_t           m_barrier;
+  uint32_t                m_sync_task;          //< The sync task in flight. FDB_INVALID_ID if none
+  uint32_t*               m_deferred_sync;      //< Ready sync tasks waiting for the one in flight
+  uint32_t                m_num_deferred_sync;
+
+  // Ring buffer of ready jobs
+  fdb_executor_job_t*     m_queue;
+  uint32_t                m_queue_capacity;
+  uint32_t                m_queue_head;
+  uint32_t                m_queue_count;
+};
+
+/**
+ * \brief Initializes an executor and starts its worker threads
+ *
+ * \param executor The executor to initialize
+ * \param num_threads The number of threads used to run tasks, including the
+ * thread calling fdb_executor_run.
+ */
+void
+fdb_executor_init(fdb_executor_t* executor,
+                  uint32_t num_threads);
+
+/**
+ * \brief Stops the worker threads and releases the executor
+ *
+ * \param executor The executor to release
+ */
+void
+fdb_executor_release(fdb_executor_t* executor);
+
+/**
+ * \brief Runs the given task graph in the executor. Returns once all the
+ * tasks of the graph have finished.
+ *
+ * \param executor The executor to run the task graph with
+ * \param task_graph The task graph to run
+ * \param delta The delta time of the frame
+ * \param database The database to run the task graph on
+ * \param user_data The user data passed to the tasks
+ */
+void
+fdb_executor_run(fdb_executor_t* executor,
+                 fdb_task_graph_t* task_graph,
+                 float delta,
+                 fdb_database_t* database,
+                 void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef _FDB_EXECUTOR_H_ */
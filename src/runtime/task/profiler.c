@@ -0,0 +1,323 @@
+// required for clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include "profiler.h"
+#include "../../common/memory/memory.h"
+#include "../../common/memory/numa_alloc.h"
+
+#include <string.h>
+#include <time.h>
+
+/**
+ * \brief State of the task being profiled by the calling thread. Operator
+ * counters are accumulated here and pushed to the ring when the task ends, so
+ * that FDB_PROFILER_COUNT never touches shared memory.
+ */
+typedef struct fdb_profiler_scope_t
+{
+  fdb_profiler_t*   p_profiler;
+  uint32_t          m_thread_id;
+  uint32_t          m_task_id;
+  const char*       p_name;
+  uint64_t          m_start_ns;
+  uint32_t          m_num_ops;
+  const char*       m_op_names[FDB_PROFILER_MAX_OPERATORS];
+  uint64_t          m_op_counters[FDB_PROFILER_MAX_OPERATORS][E_FDB_PROFILER_NUM_COUNTERS];
+} fdb_profiler_scope_t;
+
+static __thread fdb_profiler_scope_t m_scope;
+
+static const char* m_counter_names[E_FDB_PROFILER_NUM_COUNTERS] = {
+  "blocks_scanned",
+  "rows_filtered",
+  "rows_run",
+  "blocks_skipped"
+};
+
+static void
+fdb_profiler_push(fdb_profiler_t* profiler,
+                  fdb_profiler_ring_t* ring,
+                  const fdb_profiler_event_t* event)
+{
+  uint64_t head = ring->m_head;
+  // Readers must know the slot is being overwritten before it is written
+  ring->m_num_writes = head + 1;
+  fdb_mem_barrier();
+  ring->m_events[head & (profiler->m_capacity - 1)] = *event;
+  // The event must be visible before the head that publishes it
+  fdb_mem_barrier();
+  ring->m_head = head + 1;
+}
+
+void
+fdb_profiler_init(fdb_profiler_t* profiler,
+                  uint32_t capacity)
+{
+  FDB_PERMA_ASSERT(capacity > 0 && "Profiler capacity must be greater than zero");
+  memset(profiler, 0, sizeof(fdb_profiler_t));
+  profiler->m_capacity = 1;
+  while(profiler->m_capacity < capacity)
+  {
+    profiler->m_capacity <<= 1;
+  }
+  profiler->m_start_ns = fdb_profiler_now_ns();
+}
+
+void
+fdb_profiler_release(fdb_profiler_t* profiler)
+{
+  for(uint32_t i = 0; i < FDB_PROFILER_MAX_THREADS; ++i)
+  {
+    if(profiler->m_rings[i].m_events != NULL)
+    {
+      fdb_numa_free(NULL, profiler->m_rings[i].m_events);
+      profiler->m_rings[i].m_events = NULL;
+    }
+  }
+}
+
+void
+fdb_profiler_clear(fdb_profiler_t* profiler)
+{
+  for(uint32_t i = 0; i < FDB_PROFILER_MAX_THREADS; ++i)
+  {
+    profiler->m_rings[i].m_head = 0;
+    profiler->m_rings[i].m_num_writes = 0;
+  }
+  profiler->m_start_ns = fdb_profiler_now_ns();
+  fdb_mem_barrier();
+}
+
+uint64_t
+fdb_profiler_now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void
+fdb_profiler_begin(fdb_profiler_t* profiler,
+                   uint32_t thread_id,
+                   uint32_t task_id,
+                   const char* name)
+{
+  FDB_ASSERT(thread_id < FDB_PROFILER_MAX_THREADS && "Profiler maximum number of threads exceeded");
+  FDB_ASSERT(m_scope.p_profiler == NULL && "A task is already being profiled on this thread");
+
+  // Rings are allocated lazily by their only writer
+  fdb_profiler_ring_t* ring = &profiler->m_rings[thread_id];
+  if(ring->m_events == NULL)
+  {
+    ring->m_events = (fdb_profiler_event_t*)fdb_numa_alloc(NULL,
+                                                           64,
+                                                           sizeof(fdb_profiler_event_t)*profiler->m_capacity,
+                                                           FDB_NO_HINT);
+  }
+
+  m_scope.p_profiler = profiler;
+  m_scope.m_thread_id = thread_id;
+  m_scope.m_task_id = task_id;
+  m_scope.p_name = name;
+  m_scope.m_num_ops = 0;
+  m_scope.m_start_ns = fdb_profiler_now_ns();
+}
+
+void
+fdb_profiler_end()
+{
+  uint64_t end_ns = fdb_profiler_now_ns();
+  fdb_profiler_t* profiler = m_scope.p_profiler;
+  FDB_ASSERT(profiler != NULL && "No task is being profiled on this thread");
+  fdb_profiler_ring_t* ring = &profiler->m_rings[m_scope.m_thread_id];
+
+  fdb_profiler_event_t event;
+  memset(&event, 0, sizeof(fdb_profiler_event_t));
+  event.p_name = m_scope.p_name;
+  event.m_task_id = m_scope.m_task_id;
+  event.m_op_id = FDB_INVALID_ID;
+  event.m_thread_id = m_scope.m_thread_id;
+  event.m_start_ns = m_scope.m_start_ns;
+  event.m_end_ns = end_ns;
+  fdb_profiler_push(profiler, ring, &event);
+
+  for(uint32_t i = 0; i < m_scope.m_num_ops; ++i)
+  {
+    if(m_scope.m_op_names[i] == NULL)
+    {
+      continue;
+    }
+    event.p_name = m_scope.m_op_names[i];
+    event.m_op_id = i;
+    memcpy(event.m_counters,
+           m_scope.m_op_counters[i],
+           sizeof(uint64_t)*E_FDB_PROFILER_NUM_COUNTERS);
+    fdb_profiler_push(profiler, ring, &event);
+  }
+  m_scope.p_profiler = NULL;
+}
+
+void
+fdb_profiler_count(uint32_t op_id,
+                   const char* op_name,
+                   fdb_profiler_counter_t counter,
+                   uint64_t value)
+{
+  if(m_scope.p_profiler == NULL)
+  {
+    return;
+  }
+
+  FDB_ASSERT(op_id < FDB_PROFILER_MAX_OPERATORS && "Profiler maximum number of operators exceeded");
+  while(m_scope.m_num_ops <= op_id)
+  {
+    m_scope.m_op_names[m_scope.m_num_ops] = NULL;
+    memset(m_scope.m_op_counters[m_scope.m_num_ops],
+           0,
+           sizeof(uint64_t)*E_FDB_PROFILER_NUM_COUNTERS);
+    m_scope.m_num_ops++;
+  }
+  m_scope.m_op_names[op_id] = op_name;
+  m_scope.m_op_counters[op_id][counter] += value;
+}
+
+uint32_t
+fdb_profiler_read(fdb_profiler_t* profiler,
+                  uint32_t thread_id,
+                  fdb_profiler_event_t* events,
+                  uint32_t capacity)
+{
+  FDB_ASSERT(thread_id < FDB_PROFILER_MAX_THREADS && "Invalid profiler thread id");
+  fdb_profiler_ring_t* ring = &profiler->m_rings[thread_id];
+  uint64_t head = ring->m_head;
+  fdb_mem_barrier();
+  if(head == 0 || ring->m_events == NULL)
+  {
+    return 0;
+  }
+
+  uint64_t first = head > profiler->m_capacity ? head - profiler->m_capacity : 0;
+  if(head - first > capacity)
+  {
+    first = head - capacity;
+  }
+
+  for(uint64_t i = first; i < head; ++i)
+  {
+    events[i - first] = ring->m_events[i & (profiler->m_capacity - 1)];
+  }
+
+  // Drop the events the writer may have overwritten while copying
+  fdb_mem_barrier();
+  uint64_t num_writes = ring->m_num_writes;
+  uint64_t valid_first = num_writes > profiler->m_capacity ? num_writes - profiler->m_capacity : 0;
+  if(valid_first <= first)
+  {
+    return (uint32_t)(head - first);
+  }
+  if(valid_first >= head)
+  {
+    return 0;
+  }
+  uint32_t skip = (uint32_t)(valid_first - first);
+  memmove(&events[0], &events[skip], sizeof(fdb_profiler_event_t)*(head - valid_first));
+  return (uint32_t)(head - valid_first);
+}
+
+/**
+ * \brief Appends a string to a string builder escaped as the contents of a
+ * JSON string. Task names hold the execution plan of the task, which spans
+ * several lines and may quote names
+ */
+static void
+fdb_profiler_append_json_string(fdb_str_builder_t* str_builder,
+                                const char* str)
+{
+  const char* run = str;
+  for(const char* c = str; *c != '\0'; ++c)
+  {
+    const unsigned char value = (unsigned char)*c;
+    if(value != '"' && value != '\\' && value >= 0x20)
+    {
+      continue;
+    }
+
+    fdb_str_builder_append(str_builder, "%.*s", (int)(c - run), run);
+    switch(value)
+    {
+      case '"':
+        fdb_str_builder_append(str_builder, "\\\"");
+        break;
+      case '\\':
+        fdb_str_builder_append(str_builder, "\\\\");
+        break;
+      case '\n':
+        fdb_str_builder_append(str_builder, "\\n");
+        break;
+      case '\r':
+        fdb_str_builder_append(str_builder, "\\r");
+        break;
+      case '\t':
+        fdb_str_builder_append(str_builder, "\\t");
+        break;
+      default:
+        fdb_str_builder_append(str_builder, "\\u%04x", value);
+        break;
+    }
+    run = c + 1;
+  }
+  fdb_str_builder_append(str_builder, "%s", run);
+}
+
+void
+fdb_profiler_chrome_trace(fdb_profiler_t* profiler,
+                          fdb_str_builder_t* str_builder)
+{
+  fdb_profiler_event_t* events = (fdb_profiler_event_t*)fdb_numa_alloc(NULL,
+                                                                       64,
+                                                                       sizeof(fdb_profiler_event_t)*profiler->m_capacity,
+                                                                       FDB_NO_HINT);
+  fdb_str_builder_append(str_builder, "{\"traceEvents\":[");
+  bool first = true;
+  for(uint32_t i = 0; i < FDB_PROFILER_MAX_THREADS; ++i)
+  {
+    uint32_t num_events = fdb_profiler_read(profiler,
+                                            i,
+                                            events,
+                                            profiler->m_capacity);
+    for(uint32_t j = 0; j < num_events; ++j)
+    {
+      const fdb_profiler_event_t* event = &events[j];
+      double ts = (event->m_start_ns - profiler->m_start_ns) / 1000.0;
+      double dur = (event->m_end_ns - event->m_start_ns) / 1000.0;
+      fdb_str_builder_append(str_builder, "%s{\"name\":\"", first ? "" : ",");
+      fdb_profiler_append_json_string(str_builder, event->p_name != NULL ? event->p_name : "");
+      fdb_str_builder_append(str_builder,
+                             "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"task_id\":%u",
+                             event->m_op_id == FDB_INVALID_ID ? "task" : "operator",
+                             ts,
+                             dur,
+                             event->m_thread_id,
+                             event->m_task_id);
+      first = false;
+
+      if(event->m_op_id != FDB_INVALID_ID)
+      {
+        fdb_str_builder_append(str_builder, ",\"op_id\":%u", event->m_op_id);
+        for(uint32_t k = 0; k < E_FDB_PROFILER_NUM_COUNTERS; ++k)
+        {
+          if(event->m_counters[k] != 0)
+          {
+            fdb_str_builder_append(str_builder,
+                                   ",\"%s\":%lu",
+                                   m_counter_names[k],
+                                   (unsigned long)event->m_counters[k]);
+          }
+        }
+      }
+      fdb_str_builder_append(str_builder, "}}");
+    }
+  }
+  fdb_str_builder_append(str_builder, "]}");
+  fdb_numa_free(NULL, events);
+}
@@ -0,0 +1,184 @@
+
+#ifndef _FDB_PROFILER_H_
+#define _FDB_PROFILER_H_ value
+
+#include "../../common/platform.h"
+#include "../../common/str_builder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FDB_PROFILER_MAX_THREADS            64
+#define FDB_PROFILER_MAX_OPERATORS          FCC_MAX_SUBPLAN_NODES
+#define FDB_PROFILER_DEFAULT_CAPACITY       4096
+
+/**
+ * \brief The counters recorded for each operator of a task
+ */
+typedef enum fdb_profiler_counter_t
+{
+  E_FDB_PROFILER_BLOCKS_SCANNED = 0,    //< Blocks produced by a scan
+  E_FDB_PROFILER_ROWS_FILTERED,         //< Rows surviving a filter
+  E_FDB_PROFILER_ROWS_RUN,              //< Rows passed to the system's run
+  E_FDB_PROFILER_BLOCKS_SKIPPED,        //< Blocks discarded by a scan from their summaries
+  E_FDB_PROFILER_NUM_COUNTERS
+} fdb_profiler_counter_t;
+
+/**
+ * \brief A profiling event. Task events (m_op_id == FDB_INVALID_ID) record
+ * the wall time of a part of a task run by a thread. Operator events record
+ * the counters accumulated by an operator during that same run.
+ */
+typedef struct fdb_profiler_event_t
+{
+  const char*   p_name;                                 //< The task info or operator name
+  uint32_t      m_task_id;                              //< The task the event belongs to
+  uint32_t      m_op_id;                                //< The operator id. FDB_INVALID_ID for task events
+  uint32_t      m_thread_id;                            //< The thread that ran the task
+  uint64_t      m_start_ns;                             //< Start timestamp in nanoseconds
+  uint64_t      m_end_ns;                               //< End timestamp in nanoseconds
+  uint64_t      m_counters[E_FDB_PROFILER_NUM_COUNTERS];
+} fdb_profiler_event_t;
+
+/**
+ * \brief Ring buffer of events written by a single thread. Since there is a
+ * single writer, pushing an event is lock-free: m_num_writes announces the
+ * write, the event is written and then m_head publishes it. Once full, the
+ * oldest events are overwritten.
+ */
+typedef struct fdb_profiler_ring_t
+{
+  fdb_profiler_event_t*     m_events;
+  volatile uint64_t         m_head;         //< The number of events published
+  volatile uint64_t         m_num_writes;   //< The number of events published or being written
+} fdb_profiler_ring_t;
+
+/**
+ * \brief Opt-in frame profiler. When set on a task graph, each part of a task
+ * run is recorded in the ring of the thread running it, together with the
+ * per-operator counters reported by the generated code through
+ * FDB_PROFILER_COUNT.
+ */
+typedef struct fdb_profiler_t
+{
+  uint32_t                  m_capacity;     //< The number of events per ring. Power of two
+  uint64_t                  m_start_ns;     //< Timestamp the trace is relative to
+  fdb_profiler_ring_t       m_rings[FDB_PROFILER_MAX_THREADS];
+} fdb_profiler_t;
+
+/**
+ * \brief Reports a counter of an operator of the task currently being profiled
+ * on the calling thread. Generated code only reports counters when compiled
+ * with FDB_ENABLE_PROFILER defined.
+ */
+#ifdef FDB_ENABLE_PROFILER
+#define FDB_PROFILER_COUNT(op_id, op_name, counter, value) \
+  fdb_profiler_count(op_id, op_name, counter, value)
+#else
+#define FDB_PROFILER_COUNT(op_id, op_name, counter, value)
+#endif
+
+/**
+ * \brief Initializes a profiler
+ *
+ * \param profiler The profiler to initialize
+ * \param capacity The number of events kept per thread. Rounded up to the next
+ * power of two
+ */
+void
+fdb_profiler_init(fdb_profiler_t* profiler,
+                  uint32_t capacity);
+
+/**
+ * \brief Releases a profiler
+ *
+ * \param profiler The profiler to release
+ */
+void
+fdb_profiler_release(fdb_profiler_t* profiler);
+
+/**
+ * \brief Discards all the recorded events. Must not be called while tasks are
+ * being profiled.
+ *
+ * \param profiler The profiler to clear
+ */
+void
+fdb_profiler_clear(fdb_profiler_t* profiler);
+
+/**
+ * \brief Gets the current monotonic timestamp in nanoseconds
+ */
+uint64_t
+fdb_profiler_now_ns();
+
+/**
+ * \brief Starts profiling a part of a task on the calling thread
+ *
+ * \param profiler The profiler to record the task to
+ * \param thread_id The id of the calling thread (less than FDB_PROFILER_MAX_THREADS)
+ * \param task_id The id of the task
+ * \param name The name of the task
+ */
+void
+fdb_profiler_begin(fdb_profiler_t* profiler,
+                   uint32_t thread_id,
+                   uint32_t task_id,
+                   const char* name);
+
+/**
+ * \brief Finishes profiling the task started on the calling thread and pushes
+ * its task and operator events to the thread's ring.
+ */
+void
+fdb_profiler_end();
+
+/**
+ * \brief Adds to a counter of an operator of the task being profiled on the
+ * calling thread. Does nothing if no task is being profiled.
+ *
+ * \param op_id The id of the operator within the task's subplan
+ * \param op_name The name of the operator
+ * \param counter The counter to add to
+ * \param value The value to add
+ */
+void
+fdb_profiler_count(uint32_t op_id,
+                   const char* op_name,
+                   fdb_profiler_counter_t counter,
+                   uint64_t value);
+
+/**
+ * \brief Copies the events currently held by the ring of a thread, from oldest
+ * to newest. Events being overwritten concurrently by the writer are skipped.
+ *
+ * \param profiler The profiler to read from
+ * \param thread_id The thread whose ring to read
+ * \param events The buffer to copy the events to
+ * \param capacity The capacity of the events buffer
+ *
+ * \return The number of events copied
+ */
+uint32_t
+fdb_profiler_read(fdb_profiler_t* profiler,
+                  uint32_t thread_id,
+                  fdb_profiler_event_t* events,
+                  uint32_t capacity);
+
+/**
+ * \brief Appends the recorded events to the string builder in Chrome's
+ * trace_event JSON format, loadable from chrome://tracing or Perfetto
+ *
+ * \param profiler The profiler to dump
+ * \param str_builder The string builder to append the JSON to
+ */
+void
+fdb_profiler_chrome_trace(fdb_profiler_t* profiler,
+                          fdb_str_builder_t* str_builder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef _FDB_PROFILER_H_ */
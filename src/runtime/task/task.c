@@ -1,6 +1,8 @@
 
 
 #include "task.h"
+#include "executor.h"
+#include "profiler.h"
 #include "../../common/memory/memory.h"
 #include "../../common/memory/numa_alloc.h"
 #include <string.h>
@@ -21,6 +23,8 @@ fdb_task_graph_init(fdb_task_graph_t* task_graph,
                                                    FDB_NO_HINT);
   task_graph->m_num_tasks = num_tasks;
   task_graph->m_num_roots = num_roots;
+  task_graph->p_executor = NULL;
+  task_graph->p_profiler = NULL;
 }
 
 
@@ -55,7 +59,7 @@ fdb_task_graph_set_parent(fdb_task_graph_t* task_graph,
   fdb_task_t* p = &task_graph->m_tasks[parent_id];
 
   FDB_ASSERT(c->m_num_parents < FCC_MAX_TASK_PARENTS && "Task maximum number of parents exceeded");
-  FDB_ASSERT(p->m_num_parents < FCC_MAX_TASK_CHILDREN && "Task maximum number of children exceeded");
+  FDB_ASSERT(p->m_num_children < FCC_MAX_TASK_CHILDREN && "Task maximum number of children exceeded");
 
   c->m_parents[c->m_num_parents++] = parent_id;
   p->m_children[p->m_num_children++] = task_id;
@@ -69,6 +73,20 @@ fdb_task_graph_set_root(fdb_task_graph_t* task_graph,
   task_graph->m_roots[root_idx] = task_id;
 }
 
+void
+fdb_task_graph_set_executor(fdb_task_graph_t* task_graph,
+                            fdb_executor_t* executor)
+{
+  task_graph->p_executor = executor;
+}
+
+void
+fdb_task_graph_set_profiler(fdb_task_graph_t* task_graph,
+                            fdb_profiler_t* profiler)
+{
+  task_graph->p_profiler = profiler;
+}
+
 static bool
 all_visited_parents(const fdb_task_graph_t* task_graph, 
                     uint32_t node_id,
@@ -92,6 +110,16 @@ fdb_task_graph_run(fdb_task_graph_t* task_graph,
                fdb_database_t* database,
                void* user_data)
 {
+  if(task_graph->p_executor != NULL)
+  {
+    fdb_executor_run(task_graph->p_executor, 
+                     task_graph, 
+                     delta, 
+                     database, 
+                     user_data);
+    return;
+  }
+
   const uint32_t num_nodes = task_graph->m_num_tasks;
   bool visited_nodes[num_nodes];
   memset(visited_nodes, 0, sizeof(bool)*num_nodes);
@@ -118,7 +146,15 @@ fdb_task_graph_run(fdb_task_graph_t* task_graph,
           {
             const uint32_t next_node_id = cfrontier[ii];
             const fdb_task_t* next_node = &task_graph->m_tasks[next_node_id]; 
+            if(task_graph->p_profiler != NULL)
+            {
+              fdb_profiler_begin(task_graph->p_profiler, 0, next_node_id, next_node->p_info);
+            }
             next_node->p_func(delta, database, user_data, 1, 0, 1, NULL);
+            if(task_graph->p_profiler != NULL)
+            {
+              fdb_profiler_end();
+            }
             const uint32_t* children = next_node->m_children;
             const uint32_t num_children = next_node->m_num_children;
             for(uint32_t j = 0; j < num_children; ++j)
@@ -11,11 +11,18 @@ extern "C" {
 #endif
 
 typedef struct fdb_database_t fdb_database_t;
+typedef struct fdb_executor_t fdb_executor_t;
+typedef struct fdb_profiler_t fdb_profiler_t;
+/**
+ * \brief Barrier handed to the parts of a task that requires synchronization.
+ * p_wait blocks until the total number of arrivals reaches num_processes, so
+ * tasks pass cumulative targets at each synchronization point.
+ */
 typedef struct fdb_barrier_t
 {
   void* p_state;
   void (*p_wait) (void* state, int32_t num_processes);
-  void (*p_reset) ();
+  void (*p_reset) (void* state);
 } fdb_barrier_t;
 
 typedef void (*fdb_task_func_t) (float, // delta 
@@ -44,6 +51,8 @@ typedef struct fdb_task_graph_t
   uint32_t*             m_roots;
   uint32_t              m_num_tasks;
   uint32_t              m_num_roots;
+  fdb_executor_t*       p_executor;
+  fdb_profiler_t*       p_profiler;
 } fdb_task_graph_t;
 
 void
@@ -72,6 +81,28 @@ fdb_task_graph_set_root(fdb_task_graph_t* task_graph,
                     uint32_t root_idx,
                     uint32_t task_id);
 
+/**
+ * \brief Sets the executor used to run the task graph. If no executor is set
+ * (the default), the task graph runs serially on the calling thread.
+ *
+ * \param task_graph The task graph to set the executor for
+ * \param executor The executor to use, or NULL to run serially
+ */
+void
+fdb_task_graph_set_executor(fdb_task_graph_t* task_graph,
+                            fdb_executor_t* executor);
+
+/**
+ * \brief Sets the profiler recording the tasks run by the task graph. If no
+ * profiler is set (the default), tasks are not instrumented.
+ *
+ * \param task_graph The task graph to set the profiler for
+ * \param profiler The profiler to use, or NULL to disable profiling
+ */
+void
+fdb_task_graph_set_profiler(fdb_task_graph_t* task_graph,
+                            fdb_profiler_t* profiler);
+
 void
 fdb_task_graph_run(fdb_task_graph_t* task_graph,
                float delta,
@@ -0,0 +1,36 @@
+
+#include "block_test_header.h"
+#include "lang/lang.h"
+
+BEGIN_FDB_SCRIPT
+
+struct UpdatePositionBlock
+{
+
+  UpdatePositionBlock(float speed) : m_speed{speed} {}
+
+  void run_block(fdb_context_t* context,
+                 uint32_t start,
+                 const fdb_bitmap_t* mask,
+                 size_t n,
+                 Position* position,
+                 const Velocity* velocity)
+  {
+    for(size_t i = 0; i < n; ++i)
+    {
+      if(fdb_bitmap_is_set(mask, i))
+      {
+        position[i].m_x = position[i].m_x + velocity[i].m_x*context->m_dt*m_speed;
+        position[i].m_y = position[i].m_y + velocity[i].m_y*context->m_dt*m_speed;
+        position[i].m_z = position[i].m_z + velocity[i].m_z*context->m_dt*m_speed;
+      }
+    }
+  }
+
+  float m_speed = 1.0f;
+};
+
+match<Position,Velocity>().has_tag("affected")
+                                   .foreach<UpdatePositionBlock>(1.0f);
+
+END_FDB_SCRIPT
@@ -0,0 +1,153 @@
+
+#include "changed_test_header.h"
+#include "furious.h"
+
+#include <gtest/gtest.h>
+
+  
+
+TEST(ChangedTest, ChangedTest ) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_database_start_webserver(&database, 
+                           "localhost", 
+                           "8080");
+  furious_init(&database);
+
+  fdb_table_t* pos_table = FDB_FIND_TABLE(&database, Position);
+  fdb_table_t* vel_table = FDB_FIND_TABLE(&database, Velocity);
+  fdb_table_t* moved_table = FDB_FIND_TABLE(&database, Moved);
+
+  // Only the entities with an even id have a non-zero velocity, so the
+  // positions of the odd ones are written with the same values and must not
+  // be seen as changed 
+  entity_id_t NUM_ENTITIES = 1000;
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Position* pos = FDB_ADD_COMPONENT(pos_table, Position, i);
+    pos->m_x = 0.0f;
+    pos->m_y = 0.0f;
+    pos->m_z = 0.0f;
+
+    Velocity* vel = FDB_ADD_COMPONENT(vel_table, Velocity, i);
+    float speed = i % 2 == 0 ? 1.0f : 0.0f;
+    vel->m_x = speed;
+    vel->m_y = speed;
+    vel->m_z = speed;
+
+    Moved* moved = FDB_ADD_COMPONENT(moved_table, Moved, i);
+    moved->m_count = 0;
+  }
+
+  // The positions are written before the filter runs, so their changes are
+  // seen by the run of the next frame
+  furious_frame(0.1f, &database, nullptr);
+
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Moved* moved = FDB_GET_COMPONENT(moved_table, Moved, i);
+    ASSERT_EQ(moved->m_count, 0);
+  }
+
+  furious_frame(0.1f, &database, nullptr);
+
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Moved* moved = FDB_GET_COMPONENT(moved_table, Moved, i);
+    if(i % 2 == 0)
+    {
+      ASSERT_EQ(moved->m_count, 1);
+    }
+    else
+    {
+      ASSERT_EQ(moved->m_count, 0);
+    }
+  }
+
+  // Stopping all the entities leaves the positions unchanged, so the changes
+  // of the previous frame are seen once in the next one, and none after that
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Velocity* vel = FDB_GET_COMPONENT(vel_table, Velocity, i);
+    vel->m_x = 0.0f;
+    vel->m_y = 0.0f;
+    vel->m_z = 0.0f;
+  }
+
+  furious_frame(0.1f, &database, nullptr);
+  furious_frame(0.1f, &database, nullptr);
+
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Moved* moved = FDB_GET_COMPONENT(moved_table, Moved, i);
+    if(i % 2 == 0)
+    {
+      ASSERT_EQ(moved->m_count, 2);
+    }
+    else
+    {
+      ASSERT_EQ(moved->m_count, 0);
+    }
+  }
+
+  furious_release();
+  fdb_database_release(&database);
+}
+
+TEST(ChangedTest, NewDatabaseTest ) 
+{
+  // The frames of each database start again, so the filters must not remember
+  // the runs of the databases used before 
+  for(uint32_t run = 0; run < 2; ++run)
+  {
+    fdb_database_t database;
+    fdb_database_init(&database, nullptr);
+    furious_init(&database);
+
+    fdb_table_t* pos_table = FDB_FIND_TABLE(&database, Position);
+    fdb_table_t* vel_table = FDB_FIND_TABLE(&database, Velocity);
+    fdb_table_t* moved_table = FDB_FIND_TABLE(&database, Moved);
+
+    entity_id_t NUM_ENTITIES = 1000;
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      Position* pos = FDB_ADD_COMPONENT(pos_table, Position, i);
+      pos->m_x = 0.0f;
+      pos->m_y = 0.0f;
+      pos->m_z = 0.0f;
+
+      Velocity* vel = FDB_ADD_COMPONENT(vel_table, Velocity, i);
+      float speed = i % 2 == 0 ? 1.0f : 0.0f;
+      vel->m_x = speed;
+      vel->m_y = speed;
+      vel->m_z = speed;
+
+      Moved* moved = FDB_ADD_COMPONENT(moved_table, Moved, i);
+      moved->m_count = 0;
+    }
+
+    // The first database runs more frames than the second one
+    const uint32_t num_frames = run == 0 ? 8 : 3;
+    for(uint32_t f = 0; f < num_frames; ++f)
+    {
+      furious_frame(0.1f, &database, nullptr);
+    }
+
+    for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+      Moved* moved = FDB_GET_COMPONENT(moved_table, Moved, i);
+      ASSERT_EQ(moved->m_count, i % 2 == 0 ? num_frames - 1 : 0u);
+    }
+
+    furious_release();
+    fdb_database_release(&database);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}
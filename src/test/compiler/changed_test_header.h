@@ -0,0 +1,22 @@
+#ifndef _CHANGED_TEST_HEADER_H_
+#define _CHANGED_TEST_HEADER_H_ value
+
+#include "furious_macros.h"
+
+FDB_BEGIN_COMPONENT(Position, KILOBYTES(4))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(Velocity, KILOBYTES(4))
+  float m_x;
+  float m_y;
+  float m_z;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(Moved, KILOBYTES(4))
+  uint32_t m_count;
+FDB_END_COMPONENT
+
+#endif /* ifndef _CHANGED_TEST_HEADER_H_ */
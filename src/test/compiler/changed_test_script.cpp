@@ -0,0 +1,35 @@
+
+#include "changed_test_header.h"
+#include "lang/lang.h"
+
+BEGIN_FDB_SCRIPT
+
+struct UpdatePosition
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Position* position,
+           const Velocity* velocity)
+  {
+    position->m_x = position->m_x + velocity->m_x*context->m_dt;
+    position->m_y = position->m_y + velocity->m_y*context->m_dt;
+    position->m_z = position->m_z + velocity->m_z*context->m_dt;
+  }
+};
+
+struct CountMoved
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Moved* moved,
+           const Position* position)
+  {
+    moved->m_count++;
+  }
+};
+
+match<Position,Velocity>().foreach<UpdatePosition>();
+
+match<Moved,Position>().changed<Position>().foreach<CountMoved>();
+
+END_FDB_SCRIPT
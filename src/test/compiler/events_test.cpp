@@ -0,0 +1,66 @@
+
+#include "events_test_header.h"
+#include "furious.h"
+
+#include <gtest/gtest.h>
+
+  
+
+TEST(EventsTest, EventsTest ) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_database_start_webserver(&database, 
+                           "localhost", 
+                           "8080");
+  furious_init(&database);
+
+  fdb_table_t* body_table = FDB_FIND_TABLE(&database, Body);
+
+  // Bodies created between frames are seen as added in the next frame only
+  entity_id_t NUM_ENTITIES = 1000;
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Body* body = FDB_ADD_COMPONENT(body_table, Body, i);
+    body->m_mass = (float)i;
+    body->m_initialized = 0;
+  }
+
+  furious_frame(0.1f, &database, nullptr);
+
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Body* body = FDB_GET_COMPONENT(body_table, Body, i);
+    ASSERT_EQ(body->m_initialized, 1);
+  }
+  ASSERT_EQ(RemovedStats::m_count, 0);
+
+  // Removed bodies are seen with the values they had when removed
+  for(entity_id_t i = 0; i < 10; ++i)
+  {
+    FDB_REMOVE_COMPONENT(body_table, i);
+  }
+
+  furious_frame(0.1f, &database, nullptr);
+
+  for(entity_id_t i = 10; i < NUM_ENTITIES; ++i)
+  {
+    Body* body = FDB_GET_COMPONENT(body_table, Body, i);
+    ASSERT_EQ(body->m_initialized, 1);
+  }
+  ASSERT_EQ(RemovedStats::m_count, 10);
+  ASSERT_EQ(RemovedStats::m_mass, 45.0f);
+
+  furious_frame(0.1f, &database, nullptr);
+  ASSERT_EQ(RemovedStats::m_count, 10);
+
+  furious_release();
+  fdb_database_release(&database);
+}
+
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}
@@ -0,0 +1,17 @@
+#ifndef _EVENTS_TEST_HEADER_H_
+#define _EVENTS_TEST_HEADER_H_ value
+
+#include "furious_macros.h"
+
+FDB_BEGIN_COMPONENT(Body, KILOBYTES(4))
+  float     m_mass;
+  uint32_t  m_initialized;
+FDB_END_COMPONENT
+
+struct RemovedStats
+{
+  static inline float     m_mass = 0.0f;
+  static inline uint32_t  m_count = 0;
+};
+
+#endif /* ifndef _EVENTS_TEST_HEADER_H_ */
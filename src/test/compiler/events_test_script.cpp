@@ -0,0 +1,32 @@
+
+#include "events_test_header.h"
+#include "lang/lang.h"
+
+BEGIN_FDB_SCRIPT
+
+struct InitBody
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Body* body)
+  {
+    body->m_initialized++;
+  }
+};
+
+struct CountRemoved
+{
+  void run(fdb_context_t* context,
+           uint32_t id,
+           const Body* body)
+  {
+    RemovedStats::m_mass += body->m_mass;
+    RemovedStats::m_count++;
+  }
+};
+
+match_added<Body>().foreach<InitBody>();
+
+match_removed<Body>().foreach<CountRemoved>();
+
+END_FDB_SCRIPT
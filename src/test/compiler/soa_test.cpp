@@ -0,0 +1,68 @@
+#include "soa_test_header.h"
+#include "furious.h"
+
+#include <gtest/gtest.h>
+
+  
+
+TEST(SoATest, SoATest ) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_database_start_webserver(&database, 
+                           "localhost", 
+                           "8080");
+  furious_init(&database);
+
+  fdb_table_t* pos_table = FDB_FIND_TABLE(&database, Position);
+  fdb_table_t* vel_table = FDB_FIND_TABLE(&database, Velocity);
+  ASSERT_EQ(pos_table->m_layout, E_FDB_TABLE_LAYOUT_SOA);
+
+  // The components of SoA tables cannot be addressed, so these are copied in
+  // and out of the table
+  entity_id_t NUM_ENTITIES = 1000;
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Position pos;
+    pos.m_flag = i % 2;
+    pos.m_x = 0.0f;
+    pos.m_y = 0.0f;
+    pos.m_z = 0.0f;
+    fdb_table_set_component(pos_table, i, &pos);
+
+    Velocity* vel = FDB_ADD_COMPONENT(vel_table, Velocity, i);
+    vel->m_x = 1.0f;
+    vel->m_y = 1.0f;
+    vel->m_z = 1.0f;
+  }
+
+  furious_frame(0.1f, &database, nullptr);
+
+  for(entity_id_t i = 0; i < NUM_ENTITIES; ++i)
+  {
+    Position pos;
+    ASSERT_TRUE(fdb_table_read_component(pos_table, i, &pos));
+    ASSERT_EQ(pos.m_flag, i % 2);
+    if(i % 2 != 0)
+    {
+      ASSERT_EQ(pos.m_x, 0.1f);
+      ASSERT_EQ(pos.m_y, 0.1f);
+      ASSERT_EQ(pos.m_z, 0.1f);
+    }
+    else
+    {
+      ASSERT_EQ(pos.m_x , 0.0f);
+      ASSERT_EQ(pos.m_y , 0.0f);
+      ASSERT_EQ(pos.m_z , 0.0f);
+    }
+  }
+  furious_release();
+  fdb_database_release(&database);
+}
+
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}
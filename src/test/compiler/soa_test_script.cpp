@@ -0,0 +1,33 @@
+
+#include "soa_test_header.h"
+#include "lang/lang.h"
+
+BEGIN_FDB_SCRIPT
+
+struct UpdatePosition
+{
+
+  UpdatePosition(float speed) : m_speed{speed} {}
+
+  void run(fdb_context_t* context,
+           uint32_t id,
+           Position* position,
+           const Velocity* velocity)
+  {
+    position->m_x = position->m_x + velocity->m_x*context->m_dt*m_speed;
+    position->m_y = position->m_y + velocity->m_y*context->m_dt*m_speed;
+    position->m_z = position->m_z + velocity->m_z*context->m_dt*m_speed;
+  }
+
+  float m_speed = 1.0f;
+};
+
+set_soa_layout<Position>();
+
+match<Position,Velocity>().filter([](const Position* position, 
+                                     const Velocity* velocity)
+                                  {
+                                    return position->m_flag != 0;
+                                  }).foreach<UpdatePosition>(1.0f);
+
+END_FDB_SCRIPT
@@ -0,0 +1,119 @@
+#include "../../common/barrier.h"
+#include "../../common/thread.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+#define NUM_THREADS 4
+#define NUM_PHASES 1000
+
+struct barrier_test_args_t
+{
+  fdb_sync_barrier_t*     p_barrier;
+  std::atomic<uint32_t>*  p_phase_counters;
+  std::atomic<bool>*      p_error;
+};
+
+static void
+barrier_test_thread(void* args)
+{
+  barrier_test_args_t* targs = (barrier_test_args_t*)args;
+  int32_t last_barrier = 0;
+  for(uint32_t i = 0; i < NUM_PHASES; ++i)
+  {
+    targs->p_phase_counters[i]++;
+    last_barrier += NUM_THREADS;
+    fdb_sync_barrier_wait(targs->p_barrier, last_barrier);
+
+    // All the threads must have finished the phase before any continues
+    if(targs->p_phase_counters[i] != NUM_THREADS)
+    {
+      *targs->p_error = true;
+    }
+  }
+}
+
+TEST(BarrierTest, PhasesTest)
+{
+  fdb_sync_barrier_t barrier;
+  fdb_sync_barrier_init(&barrier,
+                        FDB_SYNC_BARRIER_DEFAULT_SPIN_COUNT);
+
+  std::atomic<uint32_t> phase_counters[NUM_PHASES];
+  for(uint32_t i = 0; i < NUM_PHASES; ++i)
+  {
+    phase_counters[i] = 0;
+  }
+  std::atomic<bool> error(false);
+
+  barrier_test_args_t args;
+  args.p_barrier = &barrier;
+  args.p_phase_counters = phase_counters;
+  args.p_error = &error;
+
+  fdb_thread_task_t tasks[NUM_THREADS];
+  fdb_thread_t threads[NUM_THREADS];
+  for(uint32_t i = 0; i < NUM_THREADS; ++i)
+  {
+    tasks[i].p_fp = barrier_test_thread;
+    tasks[i].p_args = &args;
+    fdb_thread_start(&threads[i], &tasks[i]);
+  }
+
+  for(uint32_t i = 0; i < NUM_THREADS; ++i)
+  {
+    fdb_thread_join(&threads[i]);
+  }
+
+  ASSERT_FALSE(error);
+  ASSERT_EQ(barrier.m_count, NUM_THREADS*NUM_PHASES);
+  ASSERT_EQ(barrier.m_num_sleepers, 0);
+
+  fdb_sync_barrier_reset(&barrier);
+  ASSERT_EQ(barrier.m_count, 0);
+  fdb_sync_barrier_release(&barrier);
+}
+
+TEST(BarrierTest, SleepTest)
+{
+  // No spinning, forcing threads to sleep on the futex
+  fdb_sync_barrier_t barrier;
+  fdb_sync_barrier_init(&barrier, 0);
+
+  std::atomic<uint32_t> phase_counters[NUM_PHASES];
+  for(uint32_t i = 0; i < NUM_PHASES; ++i)
+  {
+    phase_counters[i] = 0;
+  }
+  std::atomic<bool> error(false);
+
+  barrier_test_args_t args;
+  args.p_barrier = &barrier;
+  args.p_phase_counters = phase_counters;
+  args.p_error = &error;
+
+  fdb_thread_task_t tasks[NUM_THREADS];
+  fdb_thread_t threads[NUM_THREADS];
+  for(uint32_t i = 0; i < NUM_THREADS; ++i)
+  {
+    tasks[i].p_fp = barrier_test_thread;
+    tasks[i].p_args = &args;
+    fdb_thread_start(&threads[i], &tasks[i]);
+  }
+
+  for(uint32_t i = 0; i < NUM_THREADS; ++i)
+  {
+    fdb_thread_join(&threads[i]);
+  }
+
+  ASSERT_FALSE(error);
+  ASSERT_EQ(barrier.m_count, NUM_THREADS*NUM_PHASES);
+  fdb_sync_barrier_release(&barrier);
+}
+
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}
@@ -111,6 +111,95 @@ TEST(BitmapTest, BitmapTest )
   fdb_stack_alloc_release(&lallocator);
 }
 
+TEST(BitmapTest, BitmapWordOpsTest ) 
+{
+  constexpr uint32_t BITMAP_SIZE = 333;
+  fdb_stack_alloc_t lallocator;
+  fdb_stack_alloc_init(&lallocator, KILOBYTES(4), NULL);
+  fdb_bitmap_t bitmap;
+  fdb_bitmap_t bitmap2;
+  fdb_bitmap_init(&bitmap, BITMAP_SIZE, &lallocator.m_super);
+  fdb_bitmap_init(&bitmap2, BITMAP_SIZE, &lallocator.m_super);
+
+  for(uint32_t i = 0; i < BITMAP_SIZE; ++i)
+  {
+    fdb_bitmap_set_bit(&bitmap, i, i % 3 == 0);
+    fdb_bitmap_set_bit(&bitmap2, i, i % 2 == 0);
+  }
+  ASSERT_EQ(bitmap.m_num_set, (BITMAP_SIZE + 2) / 3);
+  ASSERT_EQ(bitmap2.m_num_set, (BITMAP_SIZE + 1) / 2);
+
+  fdb_bitmap_set_diff(&bitmap, &bitmap2);
+  uint32_t expected = 0;
+  for(uint32_t i = 0; i < BITMAP_SIZE; ++i)
+  {
+    bool value = (i % 3 == 0) && (i % 2 != 0);
+    expected += value;
+    ASSERT_EQ(fdb_bitmap_is_set(&bitmap, i), value);
+  }
+  ASSERT_EQ(bitmap.m_num_set, expected);
+
+  // Negation must not set the bits past the last element
+  fdb_bitmap_negate(&bitmap);
+  ASSERT_EQ(bitmap.m_num_set, BITMAP_SIZE - expected);
+  fdb_bitmap_refresh_num_set(&bitmap);
+  ASSERT_EQ(bitmap.m_num_set, BITMAP_SIZE - expected);
+
+  fdb_bitmap_nullify(&bitmap);
+  ASSERT_EQ(bitmap.m_num_set, 0);
+  fdb_bitmap_negate(&bitmap);
+  ASSERT_EQ(bitmap.m_num_set, BITMAP_SIZE);
+  fdb_bitmap_refresh_num_set(&bitmap);
+  ASSERT_EQ(bitmap.m_num_set, BITMAP_SIZE);
+
+  fdb_bitmap_release(&bitmap, &lallocator.m_super);
+  fdb_bitmap_release(&bitmap2, &lallocator.m_super);
+  fdb_stack_alloc_release(&lallocator);
+}
+
+TEST(BitmapTest, BitmapIterTest ) 
+{
+  constexpr uint32_t BITMAP_SIZE = 333;
+  fdb_stack_alloc_t lallocator;
+  fdb_stack_alloc_init(&lallocator, KILOBYTES(4), NULL);
+  fdb_bitmap_t bitmap;
+  fdb_bitmap_init(&bitmap, BITMAP_SIZE, &lallocator.m_super);
+
+  fdb_bitmap_iter_t iter;
+  uint32_t element;
+  fdb_bitmap_iter_init(&iter, &bitmap);
+  ASSERT_FALSE(fdb_bitmap_iter_next(&iter, &element));
+  ASSERT_EQ(fdb_bitmap_next_set(&bitmap, 0), BITMAP_SIZE);
+
+  std::set<uint32_t> elements = {0, 5, 63, 64, 130, 191, 192, 300, BITMAP_SIZE-1};
+  for(uint32_t e : elements)
+  {
+    fdb_bitmap_set(&bitmap, e);
+  }
+
+  std::set<uint32_t> visited;
+  uint32_t last = 0;
+  fdb_bitmap_iter_init(&iter, &bitmap);
+  while(fdb_bitmap_iter_next(&iter, &element))
+  {
+    ASSERT_TRUE(visited.empty() || element > last);
+    visited.insert(element);
+    last = element;
+  }
+  ASSERT_EQ(visited, elements);
+
+  uint32_t next = fdb_bitmap_next_set(&bitmap, 0);
+  for(uint32_t e : elements)
+  {
+    ASSERT_EQ(next, e);
+    next = fdb_bitmap_next_set(&bitmap, next + 1);
+  }
+  ASSERT_EQ(next, BITMAP_SIZE);
+
+  fdb_bitmap_release(&bitmap, &lallocator.m_super);
+  fdb_stack_alloc_release(&lallocator);
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
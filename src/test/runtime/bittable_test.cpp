@@ -2,6 +2,7 @@
 #include "furious.h"
 
 #include <gtest/gtest.h>
+#include <vector>
 
 TEST(BitTableTest, BitTableWorks) 
 {
@@ -192,6 +193,189 @@ TEST(BitTableTest, BitTableSteps)
   fdb_bittable_release(&bt);
 }
 
+TEST(BitTableTest, BitTableContainers) 
+{
+  fdb_bittable_t bt;
+  fdb_bittable_init(&bt,nullptr);
+  constexpr uint32_t MAX_ELEMENTS = 3*FDB_BITTABLE_CONTAINER_BITS;
+  std::vector<bool> expected(MAX_ELEMENTS, false);
+  uint32_t expected_size = 0;
+
+  // Sparse ids, contiguous ranges and dense random ids go through the
+  // array, run and bitset encodings and back
+  uint32_t seed = 12345;
+  for(uint32_t step = 0; step < 6; ++step)
+  {
+    for(uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      bool sparse = (seed >> 16) % 97 == 0;
+      bool range = (i / 700) % 2 == 0;
+      bool dense = (seed >> 16) % 3 != 0;
+      bool set = step % 3 == 0 ? sparse : (step % 3 == 1 ? range : dense);
+      bool add = step < 3 ? set : !set;
+      if(add && !expected[i])
+      {
+        fdb_bittable_add(&bt, i);
+        expected[i] = true;
+        expected_size++;
+      }
+      else if(!add && expected[i])
+      {
+        fdb_bittable_remove(&bt, i);
+        expected[i] = false;
+        expected_size--;
+      }
+    }
+
+    ASSERT_EQ(fdb_bittable_size(&bt), expected_size);
+    fdb_bittable_cursor_t cursor;
+    fdb_bittable_cursor_init(&cursor);
+    for(uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+    {
+      ASSERT_EQ(fdb_bittable_exists(&bt, i), expected[i]);
+      ASSERT_EQ(fdb_bittable_exists_cursor(&bt, i, &cursor), expected[i]);
+    }
+
+    fdb_bitmap_t bitmap;
+    fdb_bitmap_init(&bitmap, FDB_TABLE_BLOCK_SIZE, fdb_get_global_mem_allocator());
+    for(uint32_t start = 0; start < MAX_ELEMENTS; start += FDB_TABLE_BLOCK_SIZE)
+    {
+      bool any = false;
+      for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+      {
+        any = any || expected[start + i];
+        fdb_bitmap_set(&bitmap, i);
+      }
+      ASSERT_EQ(fdb_bittable_block_any(&bt, start), any);
+
+      fdb_bittable_block_and(&bt, start, &bitmap);
+      for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+      {
+        ASSERT_EQ(fdb_bitmap_is_set(&bitmap, i), expected[start + i]);
+      }
+
+      fdb_bitmap_negate(&bitmap);
+      fdb_bittable_block_diff(&bt, start, &bitmap);
+      for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+      {
+        ASSERT_EQ(fdb_bitmap_is_set(&bitmap, i), !expected[start + i]);
+      }
+    }
+    fdb_bitmap_release(&bitmap, fdb_get_global_mem_allocator());
+
+    // The block iterator returns the blocks with any id set, in order
+    fdb_bittable_block_iter_t block_iter;
+    fdb_bittable_block_iter_init(&block_iter, &bt);
+    for(uint32_t start = 0; start < MAX_ELEMENTS; start += FDB_TABLE_BLOCK_SIZE)
+    {
+      if(fdb_bittable_block_any(&bt, start))
+      {
+        ASSERT_TRUE(fdb_bittable_block_iter_has_next(&block_iter));
+        ASSERT_EQ(fdb_bittable_block_iter_next(&block_iter), start);
+      }
+    }
+    ASSERT_FALSE(fdb_bittable_block_iter_has_next(&block_iter));
+    fdb_bittable_block_iter_release(&block_iter);
+  }
+
+  ASSERT_FALSE(fdb_bittable_block_any(&bt, 10*FDB_BITTABLE_CONTAINER_BITS));
+  fdb_bittable_release(&bt);
+}
+
+TEST(BitTableTest, BitTableMixedUnionDifference) 
+{
+  fdb_bittable_t bt1;
+  fdb_bittable_init(&bt1, nullptr);
+  fdb_bittable_t bt2;
+  fdb_bittable_init(&bt2, nullptr);
+  constexpr uint32_t MAX_ELEMENTS = 4*FDB_BITTABLE_CONTAINER_BITS;
+
+  // bt1 holds a contiguous range and sparse ids, bt2 holds every third id
+  for(uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+  {
+    if((i >= 1000 && i < 9000) || i % 1000 == 7)
+    {
+      fdb_bittable_add(&bt1, i);
+    }
+    if(i % 3 == 0)
+    {
+      fdb_bittable_add(&bt2, i);
+    }
+  }
+
+  fdb_bittable_difference(&bt1, &bt2);
+  uint32_t expected_size = 0;
+  for(uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+  {
+    bool expected = ((i >= 1000 && i < 9000) || i % 1000 == 7) && i % 3 != 0;
+    expected_size += expected ? 1 : 0;
+    ASSERT_EQ(fdb_bittable_exists(&bt1, i), expected);
+  }
+  ASSERT_EQ(fdb_bittable_size(&bt1), expected_size);
+
+  fdb_bittable_union(&bt1, &bt2);
+  expected_size = 0;
+  for(uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+  {
+    bool expected = (i >= 1000 && i < 9000) || i % 1000 == 7 || i % 3 == 0;
+    expected_size += expected ? 1 : 0;
+    ASSERT_EQ(fdb_bittable_exists(&bt1, i), expected);
+  }
+  ASSERT_EQ(fdb_bittable_size(&bt1), expected_size);
+
+  fdb_bittable_release(&bt1);
+  fdb_bittable_release(&bt2);
+}
+
+TEST(BitTableTest, BitTablePartitions) 
+{
+  constexpr uint32_t NUM_PARTITIONS = 3;
+  constexpr uint32_t MAX_ELEMENTS = 10*FDB_BITTABLE_CONTAINER_BITS;
+  fdb_bittable_t source;
+  fdb_bittable_init(&source, nullptr);
+  fdb_bittable_t blacklist;
+  fdb_bittable_init(&blacklist, nullptr);
+  for(uint32_t i = 0; i < MAX_ELEMENTS; i+=5)
+  {
+    fdb_bittable_add(&source, i);
+    if(i % 2 == 0)
+    {
+      fdb_bittable_add(&blacklist, i);
+    }
+  }
+
+  fdb_bittable_t partitions[NUM_PARTITIONS];
+  uint32_t total_size = 0;
+  for(uint32_t p = 0; p < NUM_PARTITIONS; ++p)
+  {
+    fdb_bittable_init(&partitions[p], nullptr);
+    fdb_bittable_union_partition(&partitions[p], &source, p, NUM_PARTITIONS);
+    fdb_bittable_difference_partition(&partitions[p], &blacklist, p, NUM_PARTITIONS);
+    total_size += fdb_bittable_size(&partitions[p]);
+  }
+
+  uint32_t expected_size = 0;
+  for(uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+  {
+    bool expected = i % 5 == 0 && i % 2 != 0;
+    expected_size += expected ? 1 : 0;
+    uint32_t partition = fdb_bittable_partition(i, NUM_PARTITIONS);
+    for(uint32_t p = 0; p < NUM_PARTITIONS; ++p)
+    {
+      ASSERT_EQ(fdb_bittable_exists(&partitions[p], i), expected && p == partition);
+    }
+  }
+  ASSERT_EQ(total_size, expected_size);
+
+  for(uint32_t p = 0; p < NUM_PARTITIONS; ++p)
+  {
+    fdb_bittable_release(&partitions[p]);
+  }
+  fdb_bittable_release(&blacklist);
+  fdb_bittable_release(&source);
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -39,6 +39,53 @@ TEST(fdb_bcluster_Test, fdb_bcluster_Test)
   fdb_bcluster_release(&cluster2, fdb_get_global_mem_allocator());
 }
 
+TEST(fdb_bcluster_Test, fdb_bcluster_append_blocks) 
+{
+  const uint32_t num_blocks = 3;
+  fdb_table_block_t tblocks[num_blocks];
+  fdb_table_block_t* ptrs[num_blocks];
+  for(uint32_t i = 0; i < num_blocks; ++i)
+  {
+    fdb_table_block_init(&tblocks[i], 
+                         FDB_TABLE_BLOCK_SIZE, 
+                         sizeof(int), 
+                         nullptr,
+                         fdb_get_global_mem_allocator());
+    ptrs[i] = &tblocks[i];
+    // Each block enables the elements multiple of i+1
+    for(uint32_t j = 0; j < FDB_TABLE_BLOCK_SIZE; j+=i+1)
+    {
+      fdb_bitmap_set(&tblocks[i].m_enabled, j);
+    }
+  }
+
+  fdb_bcluster_t cluster;
+  fdb_bcluster_init(&cluster, nullptr);
+  fdb_bcluster_append_blocks(&cluster, ptrs, num_blocks);
+  ASSERT_EQ(cluster.m_num_columns, num_blocks);
+  ASSERT_EQ(cluster.m_start, (uint32_t)FDB_TABLE_BLOCK_SIZE);
+
+  fdb_bcluster_t expected;
+  fdb_bcluster_init(&expected, nullptr);
+  for(uint32_t i = 0; i < num_blocks; ++i)
+  {
+    ASSERT_EQ(fdb_bcluster_get_tblock(&cluster, i), &tblocks[i]);
+    fdb_bcluster_append_block(&expected, &tblocks[i]);
+  }
+  ASSERT_EQ(cluster.m_enabled.m_num_set, expected.m_enabled.m_num_set);
+  for(uint32_t j = 0; j < FDB_TABLE_BLOCK_SIZE; ++j)
+  {
+    ASSERT_EQ(fdb_bitmap_is_set(&cluster.m_enabled, j), j % 6 == 0);
+  }
+
+  fdb_bcluster_release(&expected, fdb_get_global_mem_allocator());
+  fdb_bcluster_release(&cluster, fdb_get_global_mem_allocator());
+  for(uint32_t i = 0; i < num_blocks; ++i)
+  {
+    fdb_table_block_release(&tblocks[i], fdb_get_global_mem_allocator());
+  }
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,6 +1,8 @@
 
 #include "furious.h"
 #include <gtest/gtest.h>
+#include <stdio.h>
+#include <unistd.h>
 
 
 FDB_BEGIN_COMPONENT(Component, KILOBYTES(4))
@@ -34,6 +36,46 @@ TEST(DatabaseTest, FindTable) {
   fdb_database_release(&database);
 }
 
+TEST(DatabaseTest, Statistics) {
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* table = FDB_CREATE_TABLE(&database, Component, nullptr);
+  const uint32_t num_entities = FDB_TABLE_BLOCK_SIZE*3 + 1;
+  for(uint32_t i = 0; i < num_entities; ++i)
+  {
+    fdb_table_create_component(table, i);
+  }
+
+  fdb_table_info_t infos[4];
+  ASSERT_EQ(fdb_database_metadata(&database, infos, 4), 1);
+  ASSERT_STREQ(infos[0].m_name, "Component");
+  ASSERT_EQ(infos[0].m_size, num_entities);
+  ASSERT_EQ(infos[0].m_num_blocks, 4);
+
+  char path[] = "/tmp/fdb_stats_XXXXXX";
+  int tmp_fd = mkstemp(path);
+  ASSERT_NE(tmp_fd, -1);
+  close(tmp_fd);
+  ASSERT_TRUE(fdb_database_export_stats(&database, path));
+
+  FILE* fd = fopen(path, "r");
+  ASSERT_NE(fd, nullptr);
+  char line[256];
+  ASSERT_NE(fgets(line, 256, fd), nullptr);
+  ASSERT_EQ(line[0], '#');
+  char name[256];
+  size_t num_components = 0;
+  size_t num_blocks = 0;
+  ASSERT_EQ(fscanf(fd, "%255s %zu %zu", name, &num_components, &num_blocks), 3);
+  ASSERT_STREQ(name, "Component");
+  ASSERT_EQ(num_components, num_entities);
+  ASSERT_EQ(num_blocks, 4);
+  fclose(fd);
+  unlink(path);
+
+  fdb_database_release(&database);
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
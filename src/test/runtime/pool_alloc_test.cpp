@@ -1,8 +1,10 @@
 
 #include "furious.h"
 #include "../../compiler/dyn_array.h"
+#include "../../common/thread.h"
 
 #include <gtest/gtest.h>
+#include <atomic>
 
 TEST(fdb_pool_alloc_test, only_allocs) 
 {
@@ -125,6 +127,163 @@ TEST(fdb_pool_alloc_test, allocs_and_frees_test)
 
 }
 
+struct pool_alloc_test_args_t
+{
+  fdb_pool_alloc_t*   p_alloc;
+  std::atomic<bool>*  p_error;
+  uint32_t            m_id;
+};
+
+static void
+pool_alloc_test_thread(void* args)
+{
+  pool_alloc_test_args_t* test_args = (pool_alloc_test_args_t*)args;
+  constexpr uint32_t num_rounds = 64;
+  constexpr uint32_t num_allocations = 256;
+  uint32_t* allocations[num_allocations];
+  for(uint32_t r = 0; r < num_rounds; ++r)
+  {
+    for(uint32_t q = 0; q < num_allocations; ++q)
+    {
+      allocations[q] = (uint32_t*)fdb_pool_alloc_alloc(test_args->p_alloc, 
+                                                       64, 
+                                                       BYTES(64), 
+                                                       FDB_NO_HINT);
+      for(uint32_t t = 0; t < BYTES(64) / sizeof(uint32_t); ++t)
+      {
+        allocations[q][t] = test_args->m_id;
+      }
+    }
+
+    for(uint32_t q = 0; q < num_allocations; ++q)
+    {
+      for(uint32_t t = 0; t < BYTES(64) / sizeof(uint32_t); ++t)
+      {
+        if(allocations[q][t] != test_args->m_id)
+        {
+          *test_args->p_error = true;
+        }
+      }
+      fdb_pool_alloc_free(test_args->p_alloc, allocations[q]);
+    }
+  }
+}
+
+TEST(fdb_pool_alloc_test, concurrent_allocs_and_frees_test) 
+{
+  fdb_pool_alloc_t alloc;
+  fdb_pool_alloc_init(&alloc, 
+                      64,
+                      BYTES(64),
+                      KILOBYTES(4), 
+                      nullptr);
+
+  void* ptr = fdb_pool_alloc_alloc(&alloc, 64, BYTES(64), FDB_NO_HINT);
+  ASSERT_GT(fdb_pool_alloc_stats(&alloc).m_used, 0);
+  fdb_pool_alloc_free(&alloc, ptr);
+  ASSERT_EQ(fdb_pool_alloc_stats(&alloc).m_used, 0);
+
+  constexpr uint32_t num_threads = 8;
+  std::atomic<bool> error(false);
+  pool_alloc_test_args_t args[num_threads];
+  fdb_thread_task_t tasks[num_threads];
+  fdb_thread_t threads[num_threads];
+  for(uint32_t i = 0; i < num_threads; ++i)
+  {
+    args[i].p_alloc = &alloc;
+    args[i].p_error = &error;
+    args[i].m_id = i;
+    tasks[i].p_fp = pool_alloc_test_thread;
+    tasks[i].p_args = &args[i];
+    fdb_thread_start(&threads[i], &tasks[i]);
+  }
+
+  for(uint32_t i = 0; i < num_threads; ++i)
+  {
+    fdb_thread_join(&threads[i]);
+  }
+
+  // Blocks cached by the per-thread magazines do not count as used
+  ASSERT_FALSE(error);
+  ASSERT_EQ(fdb_pool_alloc_stats(&alloc).m_used, 0);
+  fdb_pool_alloc_release(&alloc);
+}
+
+struct pool_alloc_cached_args_t
+{
+  fdb_pool_alloc_t*   p_alloc;
+  uint32_t            m_cached;
+};
+
+static uint32_t
+pool_alloc_cached_blocks(fdb_pool_alloc_t* alloc)
+{
+  uint32_t cached = 0;
+  for(uint32_t i = 0; i < FDB_POOL_ALLOC_MAX_THREADS; ++i)
+  {
+    cached += alloc->p_magazines[i].m_count;
+  }
+  return cached;
+}
+
+static void
+pool_alloc_cached_thread(void* args)
+{
+  pool_alloc_cached_args_t* test_args = (pool_alloc_cached_args_t*)args;
+  constexpr uint32_t num_allocations = FDB_POOL_ALLOC_MAGAZINE_SIZE;
+  void* allocations[num_allocations];
+  for(uint32_t q = 0; q < num_allocations; ++q)
+  {
+    allocations[q] = fdb_pool_alloc_alloc(test_args->p_alloc, 
+                                          64, 
+                                          BYTES(64), 
+                                          FDB_NO_HINT);
+  }
+  for(uint32_t q = 0; q < num_allocations; ++q)
+  {
+    fdb_pool_alloc_free(test_args->p_alloc, allocations[q]);
+  }
+  test_args->m_cached = pool_alloc_cached_blocks(test_args->p_alloc);
+}
+
+TEST(fdb_pool_alloc_test, short_lived_threads_test) 
+{
+  fdb_pool_alloc_t alloc;
+  fdb_pool_alloc_init(&alloc, 
+                      64,
+                      BYTES(64),
+                      KILOBYTES(4), 
+                      nullptr);
+
+  // Magazines are created once a thread finds the pool locked
+  pool_alloc_cached_args_t args;
+  args.p_alloc = &alloc;
+  fdb_thread_task_t task;
+  task.p_fp = pool_alloc_cached_thread;
+  task.p_args = &args;
+  fdb_thread_t thread;
+  fdb_mutex_lock(&alloc.m_mutex);
+  fdb_thread_start(&thread, &task);
+  while(*(fdb_pool_alloc_magazine_t* volatile*)&alloc.p_magazines == NULL)
+  {
+  }
+  fdb_mutex_unlock(&alloc.m_mutex);
+  fdb_thread_join(&thread);
+
+  // Threads started in turn, more than slots there are, keep getting
+  // magazines, and return their cached blocks when they exit
+  for(uint32_t i = 0; i < FDB_POOL_ALLOC_MAX_THREADS*2; ++i)
+  {
+    args.m_cached = 0;
+    fdb_thread_start(&thread, &task);
+    fdb_thread_join(&thread);
+    ASSERT_GT(args.m_cached, 0u);
+    ASSERT_EQ(pool_alloc_cached_blocks(&alloc), 0u);
+    ASSERT_EQ(fdb_pool_alloc_stats(&alloc).m_used, 0);
+  }
+  fdb_pool_alloc_release(&alloc);
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
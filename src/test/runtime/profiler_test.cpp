@@ -0,0 +1,195 @@
+#include "furious.h"
+#include <gtest/gtest.h>
+#include <string.h>
+
+#define NUM_TASKS 3
+
+static void
+profiled_task(float delta,
+              fdb_database_t* database,
+              void* user_data,
+              uint32_t chunk_size,
+              uint32_t offset,
+              uint32_t stride,
+              fdb_barrier_t* barrier)
+{
+  // Mimics the counters reported by a scan -> filter -> foreach pipeline
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    fdb_profiler_count(2, "Scan", E_FDB_PROFILER_BLOCKS_SCANNED, 1);
+    fdb_profiler_count(1, "TagFilter", E_FDB_PROFILER_ROWS_FILTERED, 100);
+    fdb_profiler_count(0, "Foreach", E_FDB_PROFILER_ROWS_RUN, 100);
+  }
+}
+
+static void
+build_task_graph(fdb_task_graph_t* task_graph)
+{
+  fdb_task_graph_init(task_graph, NUM_TASKS, 1);
+  fdb_task_graph_insert_task(task_graph, 0, profiled_task, false, "task_0");
+  fdb_task_graph_insert_task(task_graph, 1, profiled_task, false, "task_1");
+  fdb_task_graph_insert_task(task_graph, 2, profiled_task, false, "task_2");
+  fdb_task_graph_set_parent(task_graph, 1, 0);
+  fdb_task_graph_set_parent(task_graph, 2, 1);
+  fdb_task_graph_set_root(task_graph, 0, 0);
+}
+
+TEST(ProfilerTest, SerialRun)
+{
+  fdb_profiler_t profiler;
+  fdb_profiler_init(&profiler, FDB_PROFILER_DEFAULT_CAPACITY);
+
+  fdb_task_graph_t task_graph;
+  build_task_graph(&task_graph);
+  fdb_task_graph_set_profiler(&task_graph, &profiler);
+  fdb_task_graph_run(&task_graph, 0.0f, NULL, NULL);
+
+  // One task event followed by three operator events per task
+  fdb_profiler_event_t events[FDB_PROFILER_DEFAULT_CAPACITY];
+  uint32_t num_events = fdb_profiler_read(&profiler, 0, events, FDB_PROFILER_DEFAULT_CAPACITY);
+  ASSERT_EQ(num_events, NUM_TASKS*4);
+  for(uint32_t i = 0; i < NUM_TASKS; ++i)
+  {
+    const fdb_profiler_event_t* task_event = &events[i*4];
+    ASSERT_EQ(task_event->m_task_id, i);
+    ASSERT_EQ(task_event->m_op_id, FDB_INVALID_ID);
+    ASSERT_EQ(task_event->m_thread_id, 0);
+    ASSERT_LE(task_event->m_start_ns, task_event->m_end_ns);
+    ASSERT_STREQ(task_event->p_name, task_graph.m_tasks[i].p_info);
+
+    ASSERT_EQ(events[i*4+1].m_op_id, 0);
+    ASSERT_STREQ(events[i*4+1].p_name, "Foreach");
+    ASSERT_EQ(events[i*4+1].m_counters[E_FDB_PROFILER_ROWS_RUN], 400);
+    ASSERT_EQ(events[i*4+2].m_op_id, 1);
+    ASSERT_EQ(events[i*4+2].m_counters[E_FDB_PROFILER_ROWS_FILTERED], 400);
+    ASSERT_EQ(events[i*4+3].m_op_id, 2);
+    ASSERT_EQ(events[i*4+3].m_counters[E_FDB_PROFILER_BLOCKS_SCANNED], 4);
+    ASSERT_EQ(events[i*4+3].m_counters[E_FDB_PROFILER_ROWS_RUN], 0);
+  }
+
+  // Counters outside of a profiled task are ignored
+  fdb_profiler_count(0, "Foreach", E_FDB_PROFILER_ROWS_RUN, 1);
+  ASSERT_EQ(fdb_profiler_read(&profiler, 0, events, FDB_PROFILER_DEFAULT_CAPACITY), NUM_TASKS*4);
+
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  fdb_profiler_chrome_trace(&profiler, &str_builder);
+  ASSERT_EQ(strncmp(str_builder.p_buffer, "{\"traceEvents\":[{", 17), 0);
+  ASSERT_NE(strstr(str_builder.p_buffer, "\"name\":\"task_2\""), nullptr);
+  ASSERT_NE(strstr(str_builder.p_buffer, "\"blocks_scanned\":4"), nullptr);
+  ASSERT_EQ(str_builder.p_buffer[str_builder.m_pos-1], '}');
+  fdb_str_builder_release(&str_builder);
+
+  fdb_profiler_clear(&profiler);
+  ASSERT_EQ(fdb_profiler_read(&profiler, 0, events, FDB_PROFILER_DEFAULT_CAPACITY), 0);
+
+  fdb_task_graph_release(&task_graph);
+  fdb_profiler_release(&profiler);
+}
+
+TEST(ProfilerTest, ExecutorRun)
+{
+  constexpr uint32_t num_threads = 4;
+  fdb_executor_t executor;
+  fdb_executor_init(&executor, num_threads);
+
+  fdb_profiler_t profiler;
+  fdb_profiler_init(&profiler, FDB_PROFILER_DEFAULT_CAPACITY);
+
+  fdb_task_graph_t task_graph;
+  build_task_graph(&task_graph);
+  fdb_task_graph_set_executor(&task_graph, &executor);
+  fdb_task_graph_set_profiler(&task_graph, &profiler);
+
+  constexpr uint32_t num_frames = 10;
+  for(uint32_t frame = 0; frame < num_frames; ++frame)
+  {
+    fdb_task_graph_run(&task_graph, 0.0f, NULL, NULL);
+  }
+
+  // Each task is split into num_threads parts, each recorded once
+  fdb_profiler_event_t events[FDB_PROFILER_DEFAULT_CAPACITY];
+  uint32_t num_task_events = 0;
+  uint32_t rows_run = 0;
+  for(uint32_t i = 0; i < FDB_PROFILER_MAX_THREADS; ++i)
+  {
+    uint32_t num_events = fdb_profiler_read(&profiler, i, events, FDB_PROFILER_DEFAULT_CAPACITY);
+    if(i >= num_threads)
+    {
+      ASSERT_EQ(num_events, 0);
+    }
+    for(uint32_t j = 0; j < num_events; ++j)
+    {
+      ASSERT_EQ(events[j].m_thread_id, i);
+      if(events[j].m_op_id == FDB_INVALID_ID)
+      {
+        num_task_events++;
+      }
+      rows_run += events[j].m_counters[E_FDB_PROFILER_ROWS_RUN];
+    }
+  }
+  ASSERT_EQ(num_task_events, num_frames*NUM_TASKS*num_threads);
+  ASSERT_EQ(rows_run, num_frames*NUM_TASKS*num_threads*400);
+
+  fdb_task_graph_release(&task_graph);
+  fdb_profiler_release(&profiler);
+  fdb_executor_release(&executor);
+}
+
+TEST(ProfilerTest, RingOverwrite)
+{
+  fdb_profiler_t profiler;
+  fdb_profiler_init(&profiler, 6);
+  ASSERT_EQ(profiler.m_capacity, 8);
+
+  for(uint32_t i = 0; i < 20; ++i)
+  {
+    fdb_profiler_begin(&profiler, 1, i, "task");
+    fdb_profiler_end();
+  }
+
+  // Only the newest events are kept, from oldest to newest
+  fdb_profiler_event_t events[8];
+  uint32_t num_events = fdb_profiler_read(&profiler, 1, events, 8);
+  ASSERT_EQ(num_events, 8);
+  for(uint32_t i = 0; i < num_events; ++i)
+  {
+    ASSERT_EQ(events[i].m_task_id, 12 + i);
+  }
+
+  // Reading into a smaller buffer returns the newest events
+  num_events = fdb_profiler_read(&profiler, 1, events, 3);
+  ASSERT_EQ(num_events, 3);
+  ASSERT_EQ(events[0].m_task_id, 17);
+  ASSERT_EQ(events[2].m_task_id, 19);
+
+  fdb_profiler_release(&profiler);
+}
+
+TEST(ProfilerTest, ChromeTraceEscaping)
+{
+  fdb_profiler_t profiler;
+  fdb_profiler_init(&profiler, 8);
+
+  // Task names are execution plans, with several lines and quoted names
+  fdb_profiler_begin(&profiler, 0, 0, "Foreach (\"Move\")\n\tScan C:\\x\x01");
+  fdb_profiler_end();
+
+  fdb_str_builder_t str_builder;
+  fdb_str_builder_init(&str_builder);
+  fdb_profiler_chrome_trace(&profiler, &str_builder);
+  ASSERT_NE(strstr(str_builder.p_buffer, 
+                   "\"name\":\"Foreach (\\\"Move\\\")\\n\\tScan C:\\\\x\\u0001\",\"cat\":\"task\""), 
+            nullptr);
+  ASSERT_EQ(strchr(str_builder.p_buffer, '\n'), nullptr);
+  fdb_str_builder_release(&str_builder);
+
+  fdb_profiler_release(&profiler);
+}
+
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}
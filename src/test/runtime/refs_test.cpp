@@ -37,6 +37,81 @@ TEST(RefsTest,TagWorks)
   fdb_database_release(&database);
 }
 
+TEST(RefsTest,HierarchyIndex) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+
+  fdb_reftable_t* rt = fdb_database_find_or_create_reftable(&database, "parent");
+
+  // 0 <- 1 <- 2 <- 3, added before the index is built
+  fdb_reftable_add(rt, 1, 0);
+  fdb_reftable_add(rt, 2, 1);
+  fdb_reftable_add(rt, 3, 2);
+  fdb_reftable_track_hierarchy(rt);
+  ASSERT_TRUE(fdb_reftable_has_hierarchy(rt));
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    ASSERT_EQ(fdb_reftable_get_depth(rt, i), i);
+    ASSERT_TRUE(fdb_bittable_exists(fdb_reftable_get_level(rt, i), i));
+  }
+  ASSERT_EQ(fdb_reftable_get_level(rt, 4), nullptr);
+
+  // 1000 <- 4, 1000 <- 5, then 1000 under 3 moves the whole subtree
+  fdb_reftable_add(rt, 4, 1000);
+  fdb_reftable_add(rt, 5, 1000);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 1000), 0u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 5), 1u);
+  fdb_reftable_add(rt, 1000, 3);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 1000), 4u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 4), 5u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 5), 5u);
+  ASSERT_EQ(fdb_bittable_size(fdb_reftable_get_level(rt, 0)), 1u);
+  ASSERT_EQ(fdb_bittable_size(fdb_reftable_get_level(rt, 5)), 2u);
+
+  // References closing a cycle are rejected and leave the index untouched
+  ASSERT_FALSE(fdb_reftable_add(rt, 1, 4));
+  ASSERT_FALSE(fdb_reftable_add(rt, 7, 7));
+  ASSERT_TRUE(fdb_reftable_exists(rt, 1, 0));
+  ASSERT_FALSE(fdb_reftable_exists(rt, 7, 7));
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 1), 1u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 4), 5u);
+
+  // Reparenting 2 under 0 lifts its subtree one level
+  fdb_reftable_add(rt, 2, 0);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 2), 1u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 3), 2u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 4), 4u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 1), 1u);
+  ASSERT_EQ(fdb_reftable_get_level(rt, 5), nullptr);
+
+  // Removing a reference makes the tail a root, and entities without
+  // references leave the index
+  fdb_reftable_remove(rt, 1, 0);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 1), FDB_INVALID_ID);
+  fdb_reftable_remove(rt, 3, 2);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 3), 0u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 1000), 1u);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 2), 1u);
+  ASSERT_EQ(fdb_bittable_size(fdb_reftable_get_level(rt, 0)), 2u);
+  fdb_reftable_remove(rt, 4, 1000);
+  fdb_reftable_remove(rt, 5, 1000);
+  fdb_reftable_remove(rt, 1000, 3);
+  ASSERT_EQ(fdb_reftable_get_depth(rt, 3), FDB_INVALID_ID);
+  ASSERT_EQ(fdb_reftable_get_level(rt, 2), nullptr);
+
+  // Existing references closing a cycle are left out when building the index
+  fdb_reftable_t* cyclic = fdb_database_find_or_create_reftable(&database, "cyclic");
+  fdb_reftable_add(cyclic, 1, 2);
+  fdb_reftable_add(cyclic, 2, 1);
+  fdb_reftable_track_hierarchy(cyclic);
+  ASSERT_EQ(fdb_reftable_get_depth(cyclic, 2), 0u);
+  ASSERT_EQ(fdb_reftable_get_depth(cyclic, 1), 1u);
+
+  fdb_database_release(&database);
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -44,3 +119,83 @@ int main(int argc, char *argv[])
   return ret;
 }
 
+
+TEST(RefsTest,GatherIntoColumns) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+
+  fdb_table_t* table = FDB_FIND_OR_CREATE_TABLE(&database, ComponentA, nullptr);
+  for(uint32_t i = 0; i < 8; ++i)
+  {
+    ComponentA* component = FDB_ADD_COMPONENT(table, ComponentA, i);
+    component->m_field = i;
+  }
+
+  fdb_bcluster_t child;
+  fdb_bcluster_init(&child, nullptr);
+  fdb_bcluster_append_block(&child, fdb_table_get_block(table, 0));
+  fdb_btree_t hash_table;
+  fdb_btree_init(&hash_table, nullptr);
+  fdb_btree_insert(&hash_table, 0, &child);
+  fdb_btree_t* hash_tables[] = {&hash_table};
+
+  // 1 -> 0, 2 -> 0, 3 -> 1000, where 1000 has no components
+  fdb_reftable_t* rt = fdb_database_find_or_create_reftable(&database, "parent");
+  fdb_reftable_add(rt, 1, 0);
+  fdb_reftable_add(rt, 2, 0);
+  fdb_reftable_add(rt, 3, 1000);
+  fdb_bcluster_t refs;
+  fdb_bcluster_init(&refs, nullptr);
+  fdb_bcluster_append_block(&refs, fdb_table_get_block(&rt->m_table, 0));
+
+  fdb_mem_allocator_t* allocator = fdb_get_global_mem_allocator();
+  fdb_table_block_t columns[1];
+  gather_column_init(&columns[0], allocator);
+  gather(&refs, hash_tables, 1, 1, columns, 1);
+  ASSERT_EQ(columns[0].m_start, 0u);
+  ASSERT_EQ(columns[0].m_enabled.m_num_set, 2u);
+  ASSERT_FALSE(fdb_bitmap_is_set(&columns[0].m_enabled, 3));
+  ComponentA** ptrs = (ComponentA**)columns[0].p_data;
+  ASSERT_EQ(ptrs[1], (ComponentA*)fdb_table_get_component(table, 0));
+  ASSERT_EQ(ptrs[2], (ComponentA*)fdb_table_get_component(table, 0));
+
+  // Gathering again resets the columns
+  fdb_bitmap_set(&columns[0].m_enabled, 5);
+  gather(&refs, hash_tables, 1, 1, columns, 1);
+  ASSERT_EQ(columns[0].m_enabled.m_num_set, 2u);
+  ASSERT_EQ(columns[0].m_num_components, 2u);
+  gather_column_release(&columns[0], allocator);
+
+  // References whose targets are in the frontier move their tails to the next
+  // one, even if nothing was gathered for them
+  fdb_gather_block_t gblock;
+  gather_block_init(&gblock, &refs, 1, allocator);
+  gather(&refs, hash_tables, 1, 1, gblock.p_columns, gblock.m_num_columns);
+  fdb_bittable_t current;
+  fdb_bittable_init(&current, allocator);
+  fdb_bittable_add(&current, 0);
+  fdb_bittable_add(&current, 1000);
+  fdb_bittable_t next;
+  fdb_bittable_init(&next, allocator);
+  fdb_bittable_t* frontiers[] = {&current};
+  fdb_bcluster_t cluster;
+  fdb_bcluster_init(&cluster, nullptr);
+  build_fdb_bcluster_from_refs(&gblock, frontiers, 1, &next, &cluster);
+  ASSERT_EQ(cluster.m_num_columns, 1u);
+  ASSERT_EQ(cluster.m_enabled.m_num_set, 2u);
+  ASSERT_TRUE(fdb_bitmap_is_set(&cluster.m_enabled, 1));
+  ASSERT_TRUE(fdb_bitmap_is_set(&cluster.m_enabled, 2));
+  ASSERT_EQ(fdb_bittable_size(&next), 3u);
+  ASSERT_TRUE(fdb_bittable_exists(&next, 3));
+
+  fdb_bcluster_release(&cluster, nullptr);
+  fdb_bittable_release(&next);
+  fdb_bittable_release(&current);
+  gather_block_release(&gblock, allocator);
+  fdb_bcluster_release(&refs, nullptr);
+  fdb_btree_release(&hash_table);
+  fdb_bcluster_release(&child, nullptr);
+  fdb_database_release(&database);
+}
@@ -97,6 +97,386 @@ TEST(TableTest,TableWorks)
 }
 
 
+FDB_BEGIN_COMPONENT(SoAComponent, KILOBYTES(4))
+  char    m_flag;
+  float   m_x;
+  double  m_y;
+FDB_END_COMPONENT
+
+TEST(TableTest,SoALayout) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_mregistry_t* reg = fdb_database_get_mregistry(&database);
+  fdb_mstruct_t* mstruct = fdb_mregistry_init_mstruct(reg, "SoAComponent", false);
+  fdb_mregistry_init_mfield(reg, mstruct, "m_flag", E_CHAR, offsetof(SoAComponent, m_flag), false);
+  fdb_mregistry_init_mfield(reg, mstruct, "m_x", E_FLOAT, offsetof(SoAComponent, m_x), false);
+  fdb_mregistry_init_mfield(reg, mstruct, "m_y", E_DOUBLE, offsetof(SoAComponent, m_y), false);
+
+  fdb_table_t* t = FDB_CREATE_TABLE(&database, SoAComponent, nullptr);
+  ASSERT_TRUE(FDB_SET_TABLE_LAYOUT(&database, SoAComponent, E_FDB_TABLE_LAYOUT_SOA));
+  ASSERT_EQ(t->m_soa.m_num_columns, 3);
+
+  entity_id_t num_entities = FDB_TABLE_BLOCK_SIZE*4;
+  for(entity_id_t i = 0; i < num_entities; ++i) 
+  {
+    SoAComponent c;
+    c.m_flag = (char)(i % 128);
+    c.m_x = (float)i;
+    c.m_y = 2.0*i;
+    fdb_table_set_component(t, i, &c);
+  }
+  ASSERT_EQ(fdb_table_size(t), num_entities);
+
+  // Each field is stored contiguously in its own column
+  fdb_table_iter_t iter;
+  fdb_table_iter_init(&iter, t, 1, 0, 1);
+  while (fdb_table_iter_has_next(&iter)) 
+  {
+    fdb_table_block_t* block = fdb_table_iter_next(&iter);
+    ASSERT_TRUE(block->p_soa != NULL);
+    const float* xs = (const float*)((char*)block->p_data + FDB_TABLE_BLOCK_SIZE*offsetof(SoAComponent, m_x));
+    const double* ys = (const double*)((char*)block->p_data + FDB_TABLE_BLOCK_SIZE*offsetof(SoAComponent, m_y));
+    for (size_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i) 
+    {
+      ASSERT_EQ(xs[i], (float)(block->m_start + i));
+      ASSERT_EQ(ys[i], 2.0*(block->m_start + i));
+    }
+  }
+  fdb_table_iter_release(&iter);
+
+  fdb_table_destroy_component(t, 7);
+  SoAComponent c;
+  ASSERT_FALSE(fdb_table_read_component(t, 7, &c));
+  ASSERT_TRUE(fdb_table_read_component(t, 300, &c));
+  ASSERT_EQ(c.m_flag, (char)(300 % 128));
+  ASSERT_EQ(c.m_x, 300.0f);
+  ASSERT_EQ(c.m_y, 600.0);
+
+  // Layouts cannot change once the table is populated, but they can after
+  // clearing it
+  fdb_table_clear(t);
+  ASSERT_TRUE(fdb_table_set_layout(t, E_FDB_TABLE_LAYOUT_AOS, NULL));
+  fdb_table_set_component(t, 3, &c);
+  ASSERT_EQ(((SoAComponent*)fdb_table_get_component(t, 3))->m_y, 600.0);
+
+  fdb_database_release(&database);
+}
+
+FDB_BEGIN_COMPONENT(Flag, KILOBYTES(4))
+  int32_t m_value;
+FDB_END_COMPONENT
+
+FDB_BEGIN_COMPONENT(BigComponent, KILOBYTES(4))
+  int32_t m_value;
+  char    m_padding[508];
+FDB_END_COMPONENT
+
+TEST(TableTest,Segments) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_table_t* flags = FDB_CREATE_TABLE(&database, Flag, nullptr);
+  fdb_table_t* bigs = FDB_CREATE_TABLE(&database, BigComponent, nullptr);
+  ASSERT_GT(flags->m_segment_size, 1);
+  ASSERT_EQ(bigs->m_segment_size, 1);
+
+  // Only every third block is populated
+  entity_id_t num_entities = FDB_TABLE_BLOCK_SIZE*flags->m_segment_size*4;
+  for(entity_id_t i = 0; i < num_entities; ++i) 
+  {
+    if((i / FDB_TABLE_BLOCK_SIZE) % 3 == 0)
+    {
+      Flag* flag = FDB_ADD_COMPONENT(flags, Flag, i);
+      flag->m_value = i;
+      BigComponent* big = FDB_ADD_COMPONENT(bigs, BigComponent, i);
+      big->m_value = i;
+    }
+  }
+
+  uint32_t num_blocks = 0;
+  fdb_table_iter_t iter;
+  fdb_table_iter_init(&iter, flags, 1, 0, 1);
+  while (fdb_table_iter_has_next(&iter)) 
+  {
+    fdb_table_block_t* block = fdb_table_iter_next(&iter);
+    uint32_t block_id = block->m_start / FDB_TABLE_BLOCK_SIZE;
+    ASSERT_EQ(block_id % 3, 0);
+    ASSERT_EQ(block, fdb_table_get_block(flags, block_id));
+    ASSERT_EQ(fdb_table_get_block(flags, block_id+1), nullptr);
+
+    // Blocks with the same id align regardless of the segment size
+    fdb_table_block_t* big_block = fdb_table_get_block(bigs, block_id);
+    ASSERT_NE(big_block, nullptr);
+    ASSERT_EQ(big_block->m_start, block->m_start);
+    const Flag* data = (const Flag*)block->p_data;
+    const BigComponent* big_data = (const BigComponent*)big_block->p_data;
+    for(uint32_t i = 0; i < FDB_TABLE_BLOCK_SIZE; ++i)
+    {
+      ASSERT_EQ(data[i].m_value, (int32_t)(block->m_start + i));
+      ASSERT_EQ(big_data[i].m_value, (int32_t)(block->m_start + i));
+    }
+    num_blocks++;
+  }
+  fdb_table_iter_release(&iter);
+  ASSERT_EQ(num_blocks, (num_entities / FDB_TABLE_BLOCK_SIZE + 2) / 3);
+
+  fdb_database_release(&database);
+}
+
+TEST(TableTest,Directory) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_table_t* bigs = FDB_CREATE_TABLE(&database, BigComponent, nullptr);
+
+  // Ids in the dense range are found through the directory, while ids beyond
+  // FDB_TABLE_DIRECTORY_FANOUT^2 segments fall back to the btree
+  entity_id_t sparse_start = FDB_TABLE_DIRECTORY_FANOUT*FDB_TABLE_DIRECTORY_FANOUT*
+                             bigs->m_segment_size*FDB_TABLE_BLOCK_SIZE;
+  const entity_id_t ids[] = {0, 
+                             FDB_TABLE_BLOCK_SIZE*FDB_TABLE_DIRECTORY_FANOUT*bigs->m_segment_size + 3,
+                             sparse_start - 1,
+                             sparse_start, 
+                             sparse_start + FDB_TABLE_BLOCK_SIZE*7 + 5};
+  const uint32_t num_ids = sizeof(ids) / sizeof(entity_id_t);
+
+  for(uint32_t round = 0; round < 2; ++round)
+  {
+    for(uint32_t i = 0; i < num_ids; ++i)
+    {
+      BigComponent* big = FDB_ADD_COMPONENT(bigs, BigComponent, ids[i]);
+      big->m_value = (int32_t)i;
+    }
+
+    for(uint32_t i = 0; i < num_ids; ++i)
+    {
+      const BigComponent* big = FDB_GET_COMPONENT(bigs, BigComponent, ids[i]);
+      ASSERT_NE(big, nullptr);
+      ASSERT_EQ(big->m_value, (int32_t)i);
+      ASSERT_NE(fdb_table_get_block(bigs, ids[i] / FDB_TABLE_BLOCK_SIZE), nullptr);
+      ASSERT_EQ(fdb_table_get_block(bigs, ids[i] / FDB_TABLE_BLOCK_SIZE + 1000), nullptr);
+      ASSERT_EQ(fdb_table_lookup_block(bigs, ids[i] / FDB_TABLE_BLOCK_SIZE), 
+                fdb_table_get_block(bigs, ids[i] / FDB_TABLE_BLOCK_SIZE));
+      ASSERT_EQ(fdb_table_lookup_block(bigs, ids[i] / FDB_TABLE_BLOCK_SIZE + 1000), nullptr);
+    }
+
+    uint32_t num_blocks = 0;
+    uint32_t last_start = 0;
+    fdb_table_iter_t iter;
+    fdb_table_iter_init(&iter, bigs, 1, 0, 1);
+    while (fdb_table_iter_has_next(&iter)) 
+    {
+      fdb_table_block_t* block = fdb_table_iter_next(&iter);
+      ASSERT_TRUE(num_blocks == 0 || block->m_start > last_start);
+      last_start = block->m_start;
+      num_blocks++;
+    }
+    fdb_table_iter_release(&iter);
+    ASSERT_EQ(num_blocks, num_ids);
+
+    fdb_table_clear(bigs);
+    ASSERT_EQ(FDB_GET_COMPONENT(bigs, BigComponent, ids[0]), nullptr);
+    ASSERT_EQ(FDB_GET_COMPONENT(bigs, BigComponent, sparse_start), nullptr);
+  }
+
+  fdb_database_release(&database);
+}
+
+TEST(TableTest,EnabledCount) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_table_t* t = FDB_CREATE_TABLE(&database, Component, nullptr);
+  for(entity_id_t i = 0; i < 4; ++i) 
+  {
+    FDB_ADD_COMPONENT(t, Component, i);
+  }
+  fdb_table_block_t* block = fdb_table_get_block(t, 0);
+  ASSERT_EQ(block->m_num_enabled_components, 4u);
+
+  // Repeated enables and disables do not change the count 
+  fdb_table_disable_component(t, 1);
+  fdb_table_disable_component(t, 1);
+  ASSERT_EQ(block->m_num_enabled_components, 3u);
+  fdb_table_enable_component(t, 1);
+  fdb_table_enable_component(t, 1);
+  ASSERT_EQ(block->m_num_enabled_components, 4u);
+
+  // Removing a disabled component or re-adding an existing one neither
+  fdb_table_disable_component(t, 2);
+  FDB_REMOVE_COMPONENT(t, 2);
+  ASSERT_EQ(block->m_num_enabled_components, 3u);
+  FDB_ADD_COMPONENT(t, Component, 3);
+  ASSERT_EQ(block->m_num_enabled_components, 3u);
+
+  // Enabling a component that does not exist has no effect
+  fdb_table_enable_component(t, 2);
+  ASSERT_FALSE(fdb_table_is_enabled(t, 2));
+  ASSERT_EQ(block->m_num_enabled_components, 3u);
+
+  for(entity_id_t i = 0; i < 4; ++i) 
+  {
+    fdb_table_disable_component(t, i);
+  }
+  ASSERT_EQ(block->m_num_enabled_components, 0u);
+  ASSERT_EQ(block->m_num_enabled_components, block->m_enabled.m_num_set);
+
+  fdb_database_release(&database);
+}
+
+TEST(TableTest,ChangeTracking) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_table_t* t = FDB_CREATE_TABLE(&database, Component, nullptr);
+  FDB_ADD_COMPONENT(t, Component, 0);
+  fdb_table_block_t* block = fdb_table_get_block(t, 0);
+  ASSERT_TRUE(block->p_changed == NULL);
+
+  // Blocks existing when tracking starts and blocks created later both track
+  fdb_table_track_changes(t);
+  ASSERT_TRUE(block->p_changed != NULL);
+  FDB_ADD_COMPONENT(t, Component, FDB_TABLE_BLOCK_SIZE*64);
+  fdb_table_block_t* far_block = fdb_table_get_block(t, 64);
+  ASSERT_TRUE(far_block->p_changed != NULL);
+  ASSERT_FALSE(fdb_table_block_has_changes(far_block, 1));
+
+  for(entity_id_t i = 1; i < 8; ++i) 
+  {
+    FDB_ADD_COMPONENT(t, Component, i);
+  }
+  fdb_table_block_set_changed(block, 2, 3);
+  fdb_table_block_set_changed(block, 5, 4);
+  ASSERT_TRUE(fdb_table_block_has_changes(block, 1));
+  ASSERT_TRUE(fdb_table_block_has_changes(block, 4));
+  ASSERT_FALSE(fdb_table_block_has_changes(block, 5));
+
+  // Filters running in frames 4, 5 and 6 see each change once. Changes of
+  // the current frame are left for the next run
+  fdb_table_changed_filter_t filter = {};
+  ASSERT_EQ(fdb_table_changed_filter_begin(&filter, 4), 1u);
+  ASSERT_EQ(fdb_table_changed_filter_begin(&filter, 4), 1u);
+  fdb_bitmap_t enabled;
+  fdb_bitmap_init(&enabled, FDB_TABLE_BLOCK_SIZE, fdb_get_global_mem_allocator());
+  fdb_bitmap_set_bitmap(&enabled, &block->m_enabled);
+  fdb_table_block_filter_changed(block, &enabled, 1, 4);
+  ASSERT_EQ(enabled.m_num_set, 1u);
+  ASSERT_TRUE(fdb_bitmap_is_set(&enabled, 2));
+
+  ASSERT_EQ(fdb_table_changed_filter_begin(&filter, 5), 4u);
+  fdb_bitmap_set_bitmap(&enabled, &block->m_enabled);
+  fdb_table_block_filter_changed(block, &enabled, 4, 5);
+  ASSERT_EQ(enabled.m_num_set, 1u);
+  ASSERT_TRUE(fdb_bitmap_is_set(&enabled, 5));
+
+  ASSERT_EQ(fdb_table_changed_filter_begin(&filter, 6), 5u);
+  fdb_bitmap_set_bitmap(&enabled, &block->m_enabled);
+  fdb_table_block_filter_changed(block, &enabled, 5, 6);
+  ASSERT_EQ(enabled.m_num_set, 0u);
+
+  // Recreated components start unchanged
+  FDB_REMOVE_COMPONENT(t, 5);
+  FDB_ADD_COMPONENT(t, Component, 5);
+  fdb_bitmap_set_bitmap(&enabled, &block->m_enabled);
+  fdb_table_block_filter_changed(block, &enabled, 4, 5);
+  ASSERT_EQ(enabled.m_num_set, 0u);
+
+  fdb_bitmap_release(&enabled, fdb_get_global_mem_allocator());
+  fdb_database_release(&database);
+}
+
+TEST(TableTest,Events) 
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_table_t* t = FDB_CREATE_TABLE(&database, Component, nullptr);
+  FDB_ADD_COMPONENT(t, Component, 0);
+  fdb_table_track_events(t);
+
+  // Components created in a frame are only seen after swapping the logs. The
+  // added components spread over the log are grouped into their blocks
+  entity_id_t ids[] = {3, FDB_TABLE_BLOCK_SIZE*70 + 1, 5, 7};
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    Component* c = FDB_ADD_COMPONENT(t, Component, ids[i]);
+    c->field1_ = ids[i];
+  }
+  fdb_table_event_iter_t iter;
+  fdb_table_event_iter_init(&iter, t, E_FDB_TABLE_EVENT_ADDED, 1, 0, 1);
+  ASSERT_FALSE(fdb_table_event_iter_has_next(&iter));
+  fdb_table_event_iter_release(&iter);
+
+  fdb_table_swap_events(t);
+  FDB_REMOVE_COMPONENT(t, 7);
+  fdb_table_event_iter_init(&iter, t, E_FDB_TABLE_EVENT_ADDED, 1, 0, 1);
+  fdb_table_block_t* block = fdb_table_event_iter_next(&iter);
+  ASSERT_TRUE(block != NULL);
+  ASSERT_EQ(block->m_start, 0u);
+  ASSERT_EQ(block->m_num_enabled_components, 2u);
+  ASSERT_TRUE(fdb_bitmap_is_set(&block->m_enabled, 3));
+  ASSERT_TRUE(fdb_bitmap_is_set(&block->m_enabled, 5));
+  ASSERT_EQ(((Component*)block->p_data)[5].field1_, 5);
+  block = fdb_table_event_iter_next(&iter);
+  ASSERT_TRUE(block != NULL);
+  ASSERT_EQ(block->m_start, FDB_TABLE_BLOCK_SIZE*70u);
+  ASSERT_EQ(block->m_num_enabled_components, 1u);
+  ASSERT_FALSE(fdb_table_event_iter_has_next(&iter));
+  fdb_table_event_iter_release(&iter);
+
+  // Only the threads responsible of a block see its events
+  fdb_table_event_iter_init(&iter, t, E_FDB_TABLE_EVENT_ADDED, 1, 1, 2);
+  ASSERT_FALSE(fdb_table_event_iter_has_next(&iter));
+  fdb_table_event_iter_release(&iter);
+
+  // Destroyed components are copied into the log
+  fdb_table_swap_events(t);
+  fdb_table_event_iter_init(&iter, t, E_FDB_TABLE_EVENT_REMOVED, 1, 0, 1);
+  block = fdb_table_event_iter_next(&iter);
+  ASSERT_TRUE(block != NULL);
+  ASSERT_EQ(block->m_num_enabled_components, 1u);
+  ASSERT_TRUE(fdb_bitmap_is_set(&block->m_enabled, 7));
+  ASSERT_EQ(((Component*)block->p_data)[7].field1_, 7);
+  ASSERT_FALSE(fdb_table_event_iter_has_next(&iter));
+  fdb_table_event_iter_release(&iter);
+
+  // Events of older frames are discarded 
+  fdb_table_swap_events(t);
+  fdb_table_event_iter_init(&iter, t, E_FDB_TABLE_EVENT_REMOVED, 1, 0, 1);
+  ASSERT_FALSE(fdb_table_event_iter_has_next(&iter));
+  fdb_table_event_iter_release(&iter);
+
+  // Logs grow beyond a node of the chunk directory, and their events are
+  // split among the iterators of each thread
+  const uint32_t num_events = (FDB_TABLE_DIRECTORY_FANOUT + 1)*FDB_TABLE_EVENT_LOG_CHUNK_SIZE;
+  for(entity_id_t i = FDB_TABLE_BLOCK_SIZE*71; i < FDB_TABLE_BLOCK_SIZE*71 + num_events; ++i) 
+  {
+    FDB_ADD_COMPONENT(t, Component, i);
+  }
+  fdb_table_swap_events(t);
+  uint32_t num_added = 0;
+  for(uint32_t offset = 0; offset < 3; ++offset)
+  {
+    fdb_table_event_iter_init(&iter, t, E_FDB_TABLE_EVENT_ADDED, 2, offset, 3);
+    while(fdb_table_event_iter_has_next(&iter))
+    {
+      block = fdb_table_event_iter_next(&iter);
+      ASSERT_EQ(((block->m_start / FDB_TABLE_BLOCK_SIZE) / 2) % 3, offset);
+      num_added += block->m_num_enabled_components;
+    }
+    fdb_table_event_iter_release(&iter);
+  }
+  ASSERT_EQ(num_added, num_events);
+
+  fdb_database_release(&database);
+}
+
 TEST(IteratorTest,TableWorks) 
 {
 
@@ -135,6 +515,103 @@ TEST(IteratorTest,TableWorks)
   fdb_database_release(&database);
 }
 
+TEST(IteratorTest,MorselWorks)
+{
+
+  fdb_database_t database;
+  fdb_database_init(&database, nullptr);
+  fdb_table_t* t = FDB_CREATE_TABLE(&database, Component, nullptr);
+  int32_t num_blocks = 2048;
+  int32_t num_entities = FDB_TABLE_BLOCK_SIZE*num_blocks;
+
+  for(int32_t i = 0; i < num_entities; ++i)
+  {
+    Component* c = FDB_ADD_COMPONENT(t, Component, i);
+    c->field1_ = i;
+    c->field2_ = i;
+  }
+
+  // Two iterators sharing the same cursor, consumed at different paces
+  fdb_table_morsel_t morsel = {0};
+  fdb_table_iter_t it;
+  fdb_table_iter_init_morsel(&it, t, &morsel, FDB_TABLE_MORSEL_SIZE, 2);
+  fdb_table_iter_t it2;
+  fdb_table_iter_init_morsel(&it2, t, &morsel, FDB_TABLE_MORSEL_SIZE, 2);
+
+  std::set<uint32_t> visited;
+  uint32_t num_visited = 0;
+  bool has_next = true;
+  while(has_next)
+  {
+    has_next = false;
+    if(fdb_table_iter_has_next(&it))
+    {
+      fdb_table_block_t* block = fdb_table_iter_next(&it);
+      visited.insert(block->m_start / FDB_TABLE_BLOCK_SIZE);
+      num_visited++;
+      has_next = true;
+    }
+
+    for(uint32_t i = 0; i < 3 && fdb_table_iter_has_next(&it2); ++i)
+    {
+      fdb_table_block_t* block = fdb_table_iter_next(&it2);
+      visited.insert(block->m_start / FDB_TABLE_BLOCK_SIZE);
+      num_visited++;
+      has_next = true;
+    }
+  }
+  fdb_table_iter_release(&it);
+  fdb_table_iter_release(&it2);
+
+  ASSERT_EQ(num_visited, num_blocks);
+  ASSERT_EQ(visited.size(), num_blocks);
+  ASSERT_EQ(morsel.m_next, 0);
+  ASSERT_EQ(morsel.m_num_done, 0);
+
+  // The cursor can be reused once all the iterators have been released
+  fdb_table_iter_t it3;
+  fdb_table_iter_init_morsel(&it3, t, &morsel, FDB_TABLE_MORSEL_SIZE, 1);
+  num_visited = 0;
+  while(fdb_table_iter_has_next(&it3))
+  {
+    fdb_table_iter_next(&it3);
+    num_visited++;
+  }
+  fdb_table_iter_release(&it3);
+  ASSERT_EQ(num_visited, num_blocks);
+
+  fdb_database_release(&database);
+}
+
+TEST(IteratorTest,DriverChoice)
+{
+  fdb_database_t database;
+  fdb_database_init(&database, 
+                    nullptr);
+  fdb_table_t* t = FDB_CREATE_TABLE(&database, Component, nullptr);
+  fdb_table_t* bigs = FDB_CREATE_TABLE(&database, BigComponent, nullptr);
+  for(entity_id_t i = 0; i < FDB_TABLE_BLOCK_SIZE*4; ++i) 
+  {
+    FDB_ADD_COMPONENT(t, Component, i);
+  }
+  FDB_ADD_COMPONENT(bigs, BigComponent, 0);
+
+  fdb_table_t* tables[2] = {t, bigs};
+  fdb_table_driver_t driver = {};
+  ASSERT_EQ(fdb_table_choose_driver(&driver, tables, 2, 1), 1u);
+
+  // The choice holds for the whole frame, even if the tables change
+  for(entity_id_t i = 1; i < FDB_TABLE_BLOCK_SIZE*8; ++i) 
+  {
+    FDB_ADD_COMPONENT(bigs, BigComponent, i);
+  }
+  ASSERT_EQ(fdb_table_choose_driver(&driver, tables, 2, 1), 1u);
+  ASSERT_EQ(fdb_table_choose_driver(&driver, tables, 2, 2), 0u);
+  ASSERT_EQ(fdb_table_choose_driver(&driver, tables, 2, 2), 0u);
+
+  fdb_database_release(&database);
+}
+
 int main(int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
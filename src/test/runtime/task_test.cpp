@@ -0,0 +1,214 @@
+#include "furious.h"
+#include <gtest/gtest.h>
+#include <atomic>
+
+#define NUM_TASKS 4
+
+static std::atomic<uint32_t> executed_parts[NUM_TASKS];
+static std::atomic<uint32_t> executed_offsets[NUM_TASKS];
+static std::atomic<bool>     order_violated;
+static uint32_t              expected_stride;
+
+/**
+ * Diamond shaped task graph: 0 -> {1,2} -> 3
+ */
+static void
+check_parents_done(uint32_t task_id,
+                   uint32_t offset,
+                   uint32_t stride)
+{
+  if(stride != expected_stride || offset >= stride)
+  {
+    order_violated = true;
+  }
+
+  switch(task_id)
+  {
+    case 1:
+    case 2:
+      if(executed_parts[0] != expected_stride)
+      {
+        order_violated = true;
+      }
+      break;
+    case 3:
+      if(executed_parts[1] != expected_stride ||
+         executed_parts[2] != expected_stride)
+      {
+        order_violated = true;
+      }
+      break;
+  }
+  executed_offsets[task_id] |= (1 << offset);
+  executed_parts[task_id]++;
+}
+
+#define TEST_TASK(id) \
+static void \
+task_##id(float delta, \
+          fdb_database_t* database, \
+          void* user_data, \
+          uint32_t chunk_size, \
+          uint32_t offset, \
+          uint32_t stride, \
+          fdb_barrier_t* barrier) \
+{ \
+  check_parents_done(id, offset, stride); \
+}
+
+TEST_TASK(0)
+TEST_TASK(1)
+TEST_TASK(2)
+TEST_TASK(3)
+
+static void
+build_task_graph(fdb_task_graph_t* task_graph)
+{
+  fdb_task_graph_init(task_graph, NUM_TASKS, 1);
+  fdb_task_graph_insert_task(task_graph, 0, task_0, false, "task_0");
+  fdb_task_graph_insert_task(task_graph, 1, task_1, false, "task_1");
+  fdb_task_graph_insert_task(task_graph, 2, task_2, false, "task_2");
+  fdb_task_graph_insert_task(task_graph, 3, task_3, false, "task_3");
+  fdb_task_graph_set_parent(task_graph, 1, 0);
+  fdb_task_graph_set_parent(task_graph, 2, 0);
+  fdb_task_graph_set_parent(task_graph, 3, 1);
+  fdb_task_graph_set_parent(task_graph, 3, 2);
+  fdb_task_graph_set_root(task_graph, 0, 0);
+}
+
+static void
+reset_counters(uint32_t stride)
+{
+  for(uint32_t i = 0; i < NUM_TASKS; ++i)
+  {
+    executed_parts[i] = 0;
+    executed_offsets[i] = 0;
+  }
+  order_violated = false;
+  expected_stride = stride;
+}
+
+TEST(TaskTest, SerialRun)
+{
+  fdb_task_graph_t task_graph;
+  build_task_graph(&task_graph);
+
+  reset_counters(1);
+  fdb_task_graph_run(&task_graph, 0.0f, NULL, NULL);
+  ASSERT_FALSE(order_violated);
+  for(uint32_t i = 0; i < NUM_TASKS; ++i)
+  {
+    ASSERT_EQ(executed_parts[i], 1);
+    ASSERT_EQ(executed_offsets[i], 1);
+  }
+
+  fdb_task_graph_release(&task_graph);
+}
+
+TEST(TaskTest, ExecutorRun)
+{
+  constexpr uint32_t num_threads = 4;
+  fdb_executor_t executor;
+  fdb_executor_init(&executor, num_threads);
+
+  fdb_task_graph_t task_graph;
+  build_task_graph(&task_graph);
+  fdb_task_graph_set_executor(&task_graph, &executor);
+
+  for(uint32_t frame = 0; frame < 100; ++frame)
+  {
+    reset_counters(num_threads);
+    fdb_task_graph_run(&task_graph, 0.0f, NULL, NULL);
+    ASSERT_FALSE(order_violated);
+    for(uint32_t i = 0; i < NUM_TASKS; ++i)
+    {
+      ASSERT_EQ(executed_parts[i], num_threads);
+      ASSERT_EQ(executed_offsets[i], (1 << num_threads) - 1);
+    }
+  }
+
+  fdb_task_graph_release(&task_graph);
+  fdb_executor_release(&executor);
+}
+
+static std::atomic<uint32_t> sync_arrivals[2];
+static std::atomic<bool>     sync_violated;
+
+#define SYNC_TEST_TASK(id) \
+static void \
+sync_task_##id(float delta, \
+               fdb_database_t* database, \
+               void* user_data, \
+               uint32_t chunk_size, \
+               uint32_t offset, \
+               uint32_t stride, \
+               fdb_barrier_t* barrier) \
+{ \
+  int32_t last_barrier = 0; \
+  sync_arrivals[id]++; \
+  if(stride > 1) \
+  { \
+    last_barrier += stride; \
+    barrier->p_wait(barrier->p_state, last_barrier); \
+  } \
+  if(sync_arrivals[id] != stride) \
+  { \
+    sync_violated = true; \
+  } \
+  if(stride > 1) \
+  { \
+    last_barrier += stride; \
+    barrier->p_wait(barrier->p_state, last_barrier); \
+  } \
+}
+
+SYNC_TEST_TASK(0)
+SYNC_TEST_TASK(1)
+
+TEST(TaskTest, ExecutorSyncRun)
+{
+  constexpr uint32_t num_threads = 4;
+  fdb_executor_t executor;
+  fdb_executor_init(&executor, num_threads);
+
+  // Two independent tasks requiring synchronization plus the diamond graph
+  fdb_task_graph_t task_graph;
+  fdb_task_graph_init(&task_graph, NUM_TASKS + 2, 3);
+  fdb_task_graph_insert_task(&task_graph, 0, task_0, false, "task_0");
+  fdb_task_graph_insert_task(&task_graph, 1, task_1, false, "task_1");
+  fdb_task_graph_insert_task(&task_graph, 2, task_2, false, "task_2");
+  fdb_task_graph_insert_task(&task_graph, 3, task_3, false, "task_3");
+  fdb_task_graph_insert_task(&task_graph, 4, sync_task_0, true, "sync_task_0");
+  fdb_task_graph_insert_task(&task_graph, 5, sync_task_1, true, "sync_task_1");
+  fdb_task_graph_set_parent(&task_graph, 1, 0);
+  fdb_task_graph_set_parent(&task_graph, 2, 0);
+  fdb_task_graph_set_parent(&task_graph, 3, 1);
+  fdb_task_graph_set_parent(&task_graph, 3, 2);
+  fdb_task_graph_set_root(&task_graph, 0, 0);
+  fdb_task_graph_set_root(&task_graph, 1, 4);
+  fdb_task_graph_set_root(&task_graph, 2, 5);
+  fdb_task_graph_set_executor(&task_graph, &executor);
+
+  for(uint32_t frame = 0; frame < 100; ++frame)
+  {
+    reset_counters(num_threads);
+    sync_arrivals[0] = 0;
+    sync_arrivals[1] = 0;
+    sync_violated = false;
+    fdb_task_graph_run(&task_graph, 0.0f, NULL, NULL);
+    ASSERT_FALSE(order_violated);
+    ASSERT_FALSE(sync_violated);
+    ASSERT_EQ(sync_arrivals[0], num_threads);
+    ASSERT_EQ(sync_arrivals[1], num_threads);
+  }
+
+  fdb_task_graph_release(&task_graph);
+  fdb_executor_release(&executor);
+}
+
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}